@@ -9,7 +9,8 @@
 
 class REPL {
 public:
-    explicit REPL(const std::string& dbPath = "./data");
+    // readOnly为true时只读打开已有数据库（内存映射，不能修改，退出时不保存）
+    explicit REPL(const std::string& dbPath = "./data", bool readOnly = false);
     ~REPL();
     
     void run();             // 启动 REPL 主循环
@@ -17,6 +18,7 @@ public:
 private:
     bool running_;           // 标志是否继续运行
     std::string dbPath_;     // 数据库路径
+    bool readOnly_;          // 只读模式
     
     // 核心组件
     std::unique_ptr<StorageEngine> storageEngine_;
@@ -47,6 +49,7 @@ private:
     void showStats();
     void saveDatabase();
     void showVersion();
+    void handleSynchronous(const std::string& argument);
     
     // 结果显示
     void displayQueryResults(const ExecutionResult& result);
@@ -1,6 +1,7 @@
 #pragma once
 #include "Executor.h"
 #include "../parser/AST.h"
+#include "../storage/RowView.h"
 
 // DELETE执行算子
 class DeleteExecutor : public Executor {
@@ -26,6 +27,9 @@ private:
     bool finished_;
     
     // 辅助方法
-    Value evaluateExpression(Expression* expr, const Row& currentRow);
-    bool evaluateWhereCondition(Expression* whereExpr, const Row& row);
+    // WHERE条件直接在页面中的行视图(RowView)上求值，只有命中的行才物化
+    template <typename RowT>
+    Value evaluateExpression(Expression* expr, const RowT& currentRow);
+    template <typename RowT>
+    bool evaluateWhereCondition(Expression* whereExpr, const RowT& row);
 };
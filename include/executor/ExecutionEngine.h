@@ -33,10 +33,12 @@ public:
     explicit ExecutionEngine(StorageEngine* storage);
     ~ExecutionEngine() = default;
     
-    // 执行单个语句
+    // 执行单个语句：修改语句不在事务中时作为一个事务执行，结束时提交（等待日志持久化）；
+    // BEGIN之后的修改语句都加入同一个事务，COMMIT时才等待一次日志持久化，ROLLBACK按日志撤销。
+    // 事务中不能修改表结构和索引定义
     ExecutionResult executeStatement(Statement* statement);
     
-    // 执行多个语句
+    // 执行多个语句：每个语句仍是独立的事务，但提交时不等待日志，最后一次同步让整批共享一次fdatasync
     std::vector<ExecutionResult> executeStatements(const std::vector<std::unique_ptr<Statement>>& statements);
     
     // 生成执行计划（不执行）
@@ -80,8 +82,14 @@ private:
     std::shared_ptr<SemanticAnalyzer> semanticAnalyzer_;
     std::unique_ptr<QueryOptimizer> queryOptimizer_;
     bool optimizationEnabled_ = true;
+    bool deferCommitFlush_ = false;  // 批量执行期间提交不等待日志持久化
     ExecutionStats stats_;
     
+    // 在当前事务中执行语句（不开始也不提交事务）
+    ExecutionResult runStatement(Statement* statement);
+    // BEGIN / COMMIT / ROLLBACK
+    ExecutionResult executeTransactionStatement(TransactionStatement* statement);
+    
     // 执行计划生成方法
     std::unique_ptr<Executor> createCreateTableExecutor(CreateTableStatement* stmt);
     std::unique_ptr<Executor> createDropTableExecutor(DropTableStatement* stmt);
@@ -97,6 +105,11 @@ private:
     // 查找列对应的索引名
     std::string findIndexForColumn(const std::string& tableName, const std::string& columnName);
     
+    // 列裁剪：计算SELECT列表引用到的列，无法裁剪时返回空
+    std::vector<bool> computeRequiredColumns(const std::string& tableName,
+                                             const std::vector<std::unique_ptr<Expression>>& selectList);
+    bool collectColumnReferences(Expression* expr, std::vector<std::string>& columns) const;
+    
     // 辅助方法
     std::string generatePlanDescription(Executor* executor, int depth = 0) const;
     bool performSemanticCheck(Statement* statement);
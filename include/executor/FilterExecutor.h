@@ -1,6 +1,7 @@
 #pragma once
 #include "Executor.h"
 #include "../parser/AST.h"
+#include "../storage/RowView.h"
 
 // 过滤执行算子
 class FilterExecutor : public Executor {
@@ -32,12 +33,16 @@ public:
     // 获取执行上下文（用于优化器）
     ExecutionContext* getContext() const { return context_; }
     
+    // 对物化行(Row)或行视图(RowView)求值谓词，SeqScan下推谓词时复用
+    template <typename RowT>
+    static bool evaluatePredicate(Expression* predicate, const RowT& row, const std::vector<ColumnInfo>& schema);
+    
 private:
     Expression* predicate_;
     
     // 辅助方法
-    bool evaluatePredicate(const Row& row, const std::vector<ColumnInfo>& schema);
-    Value evaluateExpression(Expression* expr, const Row& row, const std::vector<ColumnInfo>& schema);
-    bool compareValues(const Value& left, const Value& right, TokenType op);
-    int findColumnIndex(const std::string& columnName, const std::vector<ColumnInfo>& schema);
+    template <typename RowT>
+    static Value evaluateExpression(Expression* expr, const RowT& row, const std::vector<ColumnInfo>& schema);
+    static bool compareValues(const Value& left, const Value& right, TokenType op);
+    static int findColumnIndex(const std::string& columnName, const std::vector<ColumnInfo>& schema);
 };
@@ -1,6 +1,7 @@
 #pragma once
 #include "Executor.h"
 #include "../storage/Row.h"
+#include "../storage/RID.h"
 #include <memory>
 #include <vector>
 
@@ -42,6 +43,6 @@ private:
     bool isRangeSearch_ = false;
     
     std::shared_ptr<Table> tableRef_;    // 保持表的引用
-    std::vector<uint32_t> recordIds_;    // 索引返回的记录ID列表
+    std::vector<RID> recordIds_;         // 索引返回的RID列表
     size_t currentIndex_;                // 当前处理的记录索引
 };
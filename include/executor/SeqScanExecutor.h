@@ -1,14 +1,18 @@
 #pragma once
 #include "Executor.h"
+#include "../storage/RowView.h"
 #include "../storage/RowIterator.h"
 #include <memory>
 
 // 顺序扫描执行算子
+// 通过表堆迭代器逐页遍历，任意时刻只持有当前页面，内存占用与表大小无关
+// 行以RowView的形式直接在页面缓冲区上访问，下推的谓词在视图上求值，
+// 只有满足条件的行才会被物化为Row输出
 class SeqScanExecutor : public Executor {
 public:
     explicit SeqScanExecutor(ExecutionContext* context, const std::string& tableName)
         : Executor(context), tableName_(tableName), tableRef_(nullptr), 
-          currentIterator_(nullptr), endIterator_(nullptr) {}
+          predicate_(nullptr) {}
     
     bool init() override;
     ExecutionResult next() override;
@@ -24,9 +28,18 @@ public:
     // 获取表名
     const std::string& getTableName() const { return tableName_; }
     
+    // 谓词下推：在行视图上过滤，不满足条件的行不会被物化
+    void setPredicate(Expression* predicate) { predicate_ = predicate; }
+    Expression* getPredicate() const { return predicate_; }
+    
+    // 列裁剪：只解码上层算子需要的列，其余列以占位值填充（行宽度保持不变）
+    void setRequiredColumns(const std::vector<bool>& requiredColumns) { requiredColumns_ = requiredColumns; }
+    
 private:
     std::string tableName_;
     std::shared_ptr<Table> tableRef_; // 保持表的引用
-    std::unique_ptr<RowIterator> currentIterator_;
-    std::unique_ptr<RowIterator> endIterator_;
+    Expression* predicate_;
+    std::vector<bool> requiredColumns_;
+    std::vector<ColumnInfo> schema_;
+    std::unique_ptr<RowIterator> iterator_;
 };
@@ -28,6 +28,7 @@ enum class ASTNodeType
     SELECT_STMT,
     DELETE_STMT,
     UPDATE_STMT,
+    TRANSACTION_STMT,
 
     // 表达式类型
     BINARY_EXPR,
@@ -309,6 +310,27 @@ public:
     std::string toString(int indent = 0) const override;
 };
 
+// 事务控制语句的类型
+enum class TransactionAction
+{
+    BEGIN,
+    COMMIT,
+    ROLLBACK
+};
+
+// BEGIN [TRANSACTION] / COMMIT [TRANSACTION] / ROLLBACK [TRANSACTION]语句
+class TransactionStatement : public Statement
+{
+public:
+    TransactionAction action;
+
+    explicit TransactionStatement(TransactionAction transactionAction)
+        : Statement(ASTNodeType::TRANSACTION_STMT), action(transactionAction) {}
+
+    void accept(ASTVisitor *visitor) override;
+    std::string toString(int indent = 0) const override;
+};
+
 // 访问者模式接口
 class ASTVisitor
 {
@@ -329,6 +351,7 @@ public:
     virtual void visit(SelectStatement *node) = 0;
     virtual void visit(DeleteStatement *node) = 0;
     virtual void visit(UpdateStatement *node) = 0;
+    virtual void visit(TransactionStatement *node) = 0;
 };
 
 // AST打印器
@@ -349,4 +372,5 @@ public:
     void visit(SelectStatement *node) override;
     void visit(DeleteStatement *node) override;
     void visit(UpdateStatement *node) override;
+    void visit(TransactionStatement *node) override;
 };
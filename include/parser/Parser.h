@@ -71,6 +71,7 @@ private:
     std::unique_ptr<Statement> parseSelectStatement();
     std::unique_ptr<Statement> parseDeleteStatement();
     std::unique_ptr<Statement> parseUpdateStatement();
+    std::unique_ptr<Statement> parseTransactionStatement(TransactionAction action);
 
     // 表达式解析方法（递归下降）
     std::unique_ptr<Expression> parseExpression();
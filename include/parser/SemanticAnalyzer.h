@@ -97,6 +97,7 @@ public:
     void visit(DeleteStatement *node) override;
     void visit(UpdateStatement *node) override;
     void visit(CreateIndexStatement *node) override;
+    void visit(TransactionStatement *node) override;
 
     // 错误报告
     const std::vector<SemanticError> &getErrors() const { return result_.errors; }
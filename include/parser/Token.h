@@ -59,6 +59,12 @@ enum class TokenType
     KEY,
     NOT_NULL,
 
+    // 事务关键字
+    BEGIN,
+    COMMIT,
+    ROLLBACK,
+    TRANSACTION,
+
     // 数据类型关键字
     INT,
     STRING,
@@ -1,5 +1,6 @@
 #pragma once
 #include "Row.h"
+#include "RID.h"
 #include <vector>
 #include <memory>
 #include <functional>
@@ -35,7 +36,7 @@ protected:
 // B+树叶子节点
 class BPlusTreeLeafNode : public BPlusTreeNode {
 public:
-    std::vector<uint32_t> recordIds;  // 指向记录的ID
+    std::vector<RID> recordIds;       // 指向记录的RID
     BPlusTreeLeafNode* next;          // 指向下一个叶子节点
     BPlusTreeLeafNode* prev;          // 指向前一个叶子节点
     
@@ -44,12 +45,12 @@ public:
     
     void insertKey(const Value& key, int index) override;
     void removeKey(int index) override;
-    void insertRecord(const Value& key, uint32_t recordId);
-    bool removeRecord(const Value& key, uint32_t recordId);
-    std::vector<uint32_t> findRecords(const Value& key) const;
+    void insertRecord(const Value& key, RID recordId);
+    bool removeRecord(const Value& key, RID recordId);
+    std::vector<RID> findRecords(const Value& key) const;
     
     // 范围查询
-    std::vector<uint32_t> findRecordsInRange(const Value& startKey, const Value& endKey) const;
+    std::vector<RID> findRecordsInRange(const Value& startKey, const Value& endKey) const;
 };
 
 // B+树内部节点
@@ -74,12 +75,12 @@ public:
     ~BPlusTree();
     
     // 基本操作
-    bool insert(const Value& key, uint32_t recordId);
-    bool remove(const Value& key, uint32_t recordId);
-    std::vector<uint32_t> search(const Value& key) const;
+    bool insert(const Value& key, RID recordId);
+    bool remove(const Value& key, RID recordId);
+    std::vector<RID> search(const Value& key) const;
     
     // 范围查询
-    std::vector<uint32_t> rangeSearch(const Value& startKey, const Value& endKey) const;
+    std::vector<RID> rangeSearch(const Value& startKey, const Value& endKey) const;
     
     // 树结构操作
     void clear();
@@ -104,7 +105,7 @@ private:
     void deleteEntry(BPlusTreeNode* node, const Value& key, BPlusTreeNode* pointer = nullptr);
     
     // 节点分裂和合并
-    void splitLeafNode(BPlusTreeLeafNode* leaf, const Value& key, uint32_t recordId);
+    void splitLeafNode(BPlusTreeLeafNode* leaf, const Value& key, RID recordId);
     void splitInternalNode(BPlusTreeInternalNode* internal, const Value& key, BPlusTreeNode* child);
     void splitInternalNodeWithData(BPlusTreeInternalNode* internal, 
                                   const std::vector<Value>& keys, 
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace bitops {
+
+// 返回最低位的1所在的位置（mask不能为0）
+inline unsigned lowestSetBit(uint64_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+}
+
+// 返回最高位的1所在的位置（mask不能为0）
+inline unsigned highestSetBit(uint64_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return 63u - static_cast<unsigned>(__builtin_clzll(mask));
+#endif
+}
+
+} // namespace bitops
@@ -1,21 +1,34 @@
 #pragma once
 #include "Page.h"
+#include "DiskBackend.h"
+#include "ReplacementPolicy.h"
+#include "FrameArena.h"
+#include "WriteAheadLog.h"
 #include <unordered_map>
-#include <list>
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <utility>
+#include <vector>
 
-// 缓冲池帧结构
+// 缓冲池帧结构：page是内存池中一段PAGE_SIZE字节帧内存的视图，帧在缓冲池生命周期内不会移动
+// 页面指针只在固定期间有效：pinCount为0的帧可能被淘汰并装入其他页面
 struct BufferFrame {
-    std::shared_ptr<Page> page;
-    uint32_t pageId;
+    Page page;
+    uint32_t pageId;        // 0表示空闲帧
     bool isDirty;           // 脏页标记
-    bool isPinned;          // 是否被固定（正在使用）
-    int pinCount;           // 引用计数
+    bool isFlushing;        // 后台刷新线程正在写回该页（写回完成前不能淘汰，否则可能从磁盘读到旧版本）
+    bool isLoading;         // 正在从磁盘加载（帧内容尚未就绪，请求同一页面的线程等待加载完成）
+    bool isPrefetched;      // 由预读装入且尚未被访问（被淘汰时计为无效预读）
+    int pinCount;           // 固定计数，大于0时不能淘汰
+    int writerCount;        // 以写方式固定的次数（大于0时页面内容可能正在被修改，写回时跳过）
+    uint64_t recLsn;        // 页面变脏以来第一条修改记录的LSN下界（检查点的脏页表），写回成功后清零
     
-    BufferFrame() : pageId(0), isDirty(false), isPinned(false), pinCount(0) {}
-    BufferFrame(std::shared_ptr<Page> p, uint32_t id) 
-        : page(p), pageId(id), isDirty(false), isPinned(false), pinCount(0) {}
+    explicit BufferFrame(uint8_t* frameData)
+        : page(frameData), pageId(0), isDirty(false), isFlushing(false), isLoading(false), isPrefetched(false),
+          pinCount(0), writerCount(0), recLsn(0) {}
 };
 
 // 缓冲池统计信息
@@ -25,8 +38,25 @@ struct BufferPoolStats {
     size_t hitCount;        // 命中次数
     size_t missCount;       // 未命中次数
     size_t evictionCount;   // 淘汰次数
+    size_t dirtyFrames;     // 当前脏页数
+    size_t diskReads;       // 未命中时从磁盘读入的页数
+    size_t loadWaits;       // 等待其他线程加载同一页面的次数（没有重复读盘）
     
-    BufferPoolStats() : totalFrames(0), usedFrames(0), hitCount(0), missCount(0), evictionCount(0) {}
+    // 脏页写回统计
+    size_t evictionWrites;  // 淘汰脏页时的同步写回次数
+    size_t flushedPages;    // 检查点/显式刷新写回的页数
+    size_t flusherRuns;     // 后台刷新线程的刷新轮数
+    size_t flusherWrites;   // 后台刷新线程写回的页数
+    
+    // 预读统计
+    size_t prefetchedPages; // 预读读入的页数
+    size_t prefetchReads;   // 预读发出的I/O次数（相邻页面合并为一次）
+    size_t prefetchHits;    // 预读的页面之后被访问的次数
+    size_t prefetchWasted;  // 预读的页面在被访问之前就被淘汰的次数
+    
+    BufferPoolStats() : totalFrames(0), usedFrames(0), hitCount(0), missCount(0), evictionCount(0),
+                        dirtyFrames(0), diskReads(0), loadWaits(0), evictionWrites(0), flushedPages(0), flusherRuns(0), flusherWrites(0),
+                        prefetchedPages(0), prefetchReads(0), prefetchHits(0), prefetchWasted(0) {}
     
     double getHitRatio() const {
         size_t total = hitCount + missCount;
@@ -34,27 +64,80 @@ struct BufferPoolStats {
     }
 };
 
+// 后台刷新线程配置
+// 脏页比例超过highWatermark时立即唤醒刷新线程；刷新线程每隔intervalMs检查一次，
+// 脏页比例超过lowWatermark时按置换策略从最冷的页面开始写回，直到降到lowWatermark以下
+struct FlusherConfig {
+    bool enabled;
+    double lowWatermark;
+    double highWatermark;
+    unsigned intervalMs;
+    
+    FlusherConfig() : enabled(true), lowWatermark(0.25), highWatermark(0.5), intervalMs(100) {}
+};
+
+// 缓冲池按页ID哈希划分为多个分片，每个分片有独立的锁、帧表和置换策略状态，
+// 不同分片上的页面访问互不阻塞；淘汰只在页面所属的分片内进行
 class BufferPool {
 public:
-    explicit BufferPool(size_t poolSize = 128); // 默认128帧
+    // 默认128帧；diskBackend为空时是纯内存缓冲池（未命中返回nullptr，脏页淘汰时直接丢弃）
+    // 默认使用2Q置换策略，顺序扫描读入的页面不会冲掉热点的索引和目录页面
+    // shardCount为0时按缓冲池大小自动选择（每个分片至少16帧，最多16个分片）
+    // 所有帧在构造时从一块连续内存中分配，useHugePages请求用大页支撑这块内存（不可用时退回普通页）
+    explicit BufferPool(size_t poolSize = 128, std::unique_ptr<DiskBackend> diskBackend = nullptr,
+                        ReplacementPolicyType policyType = ReplacementPolicyType::TWO_Q, size_t shardCount = 0,
+                        bool useHugePages = false);
     ~BufferPool();
     
     // 页面操作
-    std::shared_ptr<Page> getPage(uint32_t pageId);
-    bool putPage(std::shared_ptr<Page> page);
+    // getPage未命中时从磁盘后端把页面直接读入帧内存（读盘期间不持有分片锁），
+    // 返回的页面已被固定，调用方用完后必须unpinPage，之后不能再使用该指针
+    // （存储层通过ReadPageGuard/WritePageGuard访问页面，由守卫负责解除固定）
+    // forWrite表示调用方会修改页面：在对应的unpinPage之前，后台刷新和检查点不会复制这个页面的镜像
+    Page* getPage(uint32_t pageId, bool forWrite = false);
+    bool putPage(const Page& page);  // 把页面镜像复制到缓冲池（放入新页面或替换页面内容），并标记为脏页
     bool flushPage(uint32_t pageId);
     void flushAllPages();
+    // 模糊检查点：只写回recLsn小于lsn的脏页（正在被修改的页面跳过），返回写回的页数；
+    // 写回期间其他线程可以继续访问和修改页面
+    size_t flushPagesBefore(uint64_t lsn);
+    // 脏页表：还有修改没有写回的页面及其recLsn（写回中的页面也包括在内）
+    std::vector<std::pair<uint32_t, uint64_t>> getDirtyPageTable() const;
+    // 丢弃页面：页面已被释放，内容不再需要，直接移出缓冲池且不写回（等待正在进行的加载或写回完成）；
+    // 页面仍被固定时返回false，页面留在缓冲池中
+    bool discardPage(uint32_t pageId);
+    bool markDirty(uint32_t pageId);  // 页面在缓冲池中被直接修改后调用
     
     // 页面固定/解除固定
     bool pinPage(uint32_t pageId);
-    bool unpinPage(uint32_t pageId);
+    bool unpinPage(uint32_t pageId, bool forWrite = false);  // forWrite与getPage一致，为true时同时标记为脏页
+    
+    DiskBackend* getDiskBackend() const;
+    // 预写日志规则：脏页写回之前，日志必须持久化到页面的LSN（为空时不检查）
+    void setWriteAheadLog(WriteAheadLog* wal);
+    const char* getPolicyName() const;
+    size_t getShardCount() const;
+    const FrameArena& getArena() const;
+    
+    // 后台刷新线程
+    void startFlusher(const FlusherConfig& config = FlusherConfig());
+    void stopFlusher();
+    
+    // 预读：由预读线程异步把页面读入缓冲池（已在缓冲池中的页面跳过），页ID相邻的页面合并为一次读取
+    // 预读线程在第一次请求时启动；预读占用的帧不超过每个分片的1/4，不会挤占正在使用的页面
+    void prefetchPages(const std::vector<uint32_t>& pageIds);
+    void stopPrefetcher();
+    // 顺序扫描向前预读的页数（也是合并读取的最大页数），0表示关闭预读
+    static constexpr size_t DEFAULT_PREFETCH_DEPTH = 8;
+    void setPrefetchDepth(size_t depth);
+    size_t getPrefetchDepth() const;
     
     // 缓冲池管理
     bool evictPage();
     void clearPool();
     
-    // 统计信息
-    const BufferPoolStats& getStats() const;
+    // 统计信息（各分片计数器的快照，读取时不加锁）
+    BufferPoolStats getStats() const;
     void resetStats();
     void printStats() const;
     
@@ -63,20 +146,91 @@ public:
     bool isPageInPool(uint32_t pageId) const;
     
 private:
+    // 分片计数器：命中路径上只做relaxed原子加减，统计时不需要获取分片锁
+    struct ShardCounters {
+        std::atomic<size_t> usedFrames{0};
+        std::atomic<size_t> hitCount{0};
+        std::atomic<size_t> missCount{0};
+        std::atomic<size_t> evictionCount{0};
+        std::atomic<size_t> dirtyFrames{0};
+        std::atomic<size_t> diskReads{0};
+        std::atomic<size_t> loadWaits{0};
+        std::atomic<size_t> evictionWrites{0};
+        std::atomic<size_t> flushedPages{0};
+        std::atomic<size_t> flusherWrites{0};
+        std::atomic<size_t> prefetchHits{0};
+        std::atomic<size_t> prefetchWasted{0};
+    };
+    
+    // 按缓存行对齐，避免相邻分片的锁和计数器互相干扰（伪共享）
+    struct alignas(64) Shard {
+        size_t capacity = 0;
+        mutable std::mutex mutex;
+        std::vector<BufferFrame> frames;            // 分片拥有的帧（内存池中连续的一段）
+        std::vector<BufferFrame*> freeFrames;       // 空闲帧
+        std::unordered_map<uint32_t, BufferFrame*> frameTable; // 页面ID到帧的映射
+        std::unique_ptr<ReplacementPolicy> policy;  // 页面置换策略
+        std::condition_variable loadCv;             // 页面加载完成
+        size_t flushingFrames = 0;                  // 正在写回（已释放锁）的帧数
+        std::condition_variable flushDoneCv;
+        size_t prefetchingFrames = 0;               // 预读线程占用的加载中帧数
+        ShardCounters counters;
+    };
+    
     size_t poolSize_;
-    std::unordered_map<uint32_t, std::shared_ptr<BufferFrame>> frameTable_; // 页面ID到帧的映射
-    std::list<uint32_t> lruList_;       // LRU链表，存储页面ID
-    std::unordered_map<uint32_t, std::list<uint32_t>::iterator> lruIterators_; // 页面ID到LRU迭代器的映射
+    FrameArena arena_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::unique_ptr<DiskBackend> diskBackend_;
+    std::atomic<WriteAheadLog*> wal_;
+    
+    // 后台刷新线程
+    FlusherConfig flusherConfig_;
+    std::thread flusherThread_;
+    std::mutex flusherMutex_;
+    std::condition_variable flusherCv_;
+    std::atomic<bool> flusherRunning_;
+    bool flushRequested_;               // 有分片的脏页超过高水位（由flusherMutex_保护）
+    std::atomic<size_t> flusherRuns_;
+    
+    // 预读线程（队列和运行标志由prefetchMutex_保护）
+    std::atomic<size_t> prefetchDepth_;
+    std::thread prefetchThread_;
+    std::mutex prefetchMutex_;
+    std::condition_variable prefetchCv_;
+    std::vector<uint32_t> prefetchQueue_;
+    bool prefetchRunning_;
+    std::atomic<size_t> prefetchedPages_;
+    std::atomic<size_t> prefetchReads_;
     
-    BufferPoolStats stats_;
-    mutable std::mutex mutex_;          // 线程安全
+    Shard& shardFor(uint32_t pageId) const;
     
-    // LRU操作
-    void moveToFront(uint32_t pageId);
-    void removeFromLRU(uint32_t pageId);
-    void addToFront(uint32_t pageId);
+    // 内部辅助方法（调用时持有分片锁）
+    BufferFrame* findVictimFrame(Shard& shard);
+    // 淘汰分片内的一个页面并把帧放回空闲列表（写回脏页期间释放lock）
+    bool evictFrame(Shard& shard, std::unique_lock<std::mutex>& lock);
+    // 把帧从帧表中移除并放回空闲列表
+    void releaseFrame(Shard& shard, BufferFrame* frame);
+    bool writeBackPage(const BufferFrame& frame);
+    // 写回LSN不超过lsn的页面镜像之前调用：等待日志持久化到lsn（不持有分片锁时调用）
+    bool forceLog(uint64_t lsn) const;
+    // 日志当前的末尾（页面变脏时记为recLsn，之后的修改记录都不早于它；没有日志时为0）
+    uint64_t logPosition() const;
+    void setDirty(Shard& shard, BufferFrame& frame, bool dirty);
+    // 从最冷的页面开始写回分片内的脏页，直到脏页数不超过targetDirty（写盘期间释放lock）；
+    // 只写回recLsn小于beforeLsn的页面
+    size_t writeBackColdPages(Shard& shard, std::unique_lock<std::mutex>& lock, size_t targetDirty,
+                              uint64_t beforeLsn = UINT64_MAX);
+    void flusherLoop();
     
-    // 内部辅助方法
-    std::shared_ptr<BufferFrame> findVictimFrame();
-    bool writeBackPage(std::shared_ptr<BufferFrame> frame);
+    // 预读辅助方法（不持有分片锁时调用）
+    void prefetcherLoop();
+    void prefetchBatch(const std::vector<uint32_t>& pageIds);
+    // 为预读占用一个加载中的帧；页面已在缓冲池中或分片没有可用的帧时返回nullptr
+    BufferFrame* reservePrefetchFrame(uint32_t pageId);
+    // 页ID连续的一组预读页面及其帧
+    using PrefetchRun = std::vector<std::pair<uint32_t, BufferFrame*>>;
+    // 把各组作为一批读请求提交给磁盘后端，每组一次读取，完成后填入各自的帧
+    void readPrefetchRuns(const std::vector<PrefetchRun>& runs);
+    // image为空表示读取失败，帧被放回空闲列表
+    void finishPrefetch(uint32_t pageId, BufferFrame* frame, const uint8_t* image);
 };
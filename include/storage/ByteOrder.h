@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// 磁盘格式统一使用小端字节序
+// 在小端机器上编解码就是一次memcpy，大端机器上额外做一次字节翻转
+namespace byteorder {
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool kHostIsLittleEndian = false;
+#else
+constexpr bool kHostIsLittleEndian = true;
+#endif
+
+template <typename T>
+inline T byteSwap(T value) {
+    static_assert(std::is_trivially_copyable_v<T>, "byteSwap requires a trivially copyable type");
+    uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    for (size_t i = 0; i < sizeof(T) / 2; ++i) {
+        uint8_t tmp = bytes[i];
+        bytes[i] = bytes[sizeof(T) - 1 - i];
+        bytes[sizeof(T) - 1 - i] = tmp;
+    }
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+// 将值以小端格式写入dst（dst无需对齐）
+template <typename T>
+inline void storeLE(uint8_t* dst, T value) {
+    if constexpr (!kHostIsLittleEndian) {
+        value = byteSwap(value);
+    }
+    std::memcpy(dst, &value, sizeof(T));
+}
+
+// 从src读取小端格式的值（src无需对齐）
+template <typename T>
+inline T loadLE(const uint8_t* src) {
+    T value;
+    std::memcpy(&value, src, sizeof(T));
+    if constexpr (!kHostIsLittleEndian) {
+        value = byteSwap(value);
+    }
+    return value;
+}
+
+} // namespace byteorder
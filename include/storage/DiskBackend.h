@@ -0,0 +1,144 @@
+#pragma once
+#include "Page.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 批量读请求：从firstPageId开始连续读取count页到data（count * PAGE_SIZE字节），
+// 完成后pagesRead为从头开始完整读入的页数
+struct PageReadRequest {
+    uint32_t firstPageId;
+    size_t count;
+    uint8_t* data;
+    size_t pagesRead;
+};
+
+// 批量写请求：把PAGE_SIZE字节的data写入pageId页，完成后written表示是否写入成功
+struct PageWriteRequest {
+    uint32_t pageId;
+    const uint8_t* data;
+    bool written;
+};
+
+// 磁盘后端：缓冲池通过它按页ID读写数据文件，第pageId页位于文件偏移(pageId - 1) * PAGE_SIZE处
+// 缓冲池在未命中时直接调用readPage把页面读入帧内存，脏页写回时调用writePage（data均为PAGE_SIZE字节）
+// 实现必须是线程安全的：查询线程、淘汰和后台刷新线程可能同时访问
+class DiskBackend {
+public:
+    explicit DiskBackend(const std::string& path) : path_(path) {}
+    virtual ~DiskBackend() = default;
+    
+    virtual bool readPage(uint32_t pageId, uint8_t* data) = 0;
+    virtual bool writePage(uint32_t pageId, const uint8_t* data) = 0;
+    // 从firstPageId开始连续读取count页到data（count * PAGE_SIZE字节），返回从头开始完整读入的页数
+    // 默认逐页调用readPage；预读用它把页ID相邻的页面合并为一次I/O
+    virtual size_t readPages(uint32_t firstPageId, size_t count, uint8_t* data);
+    // 批量提交多个读或写请求，全部完成后返回；预读和脏页写回通过它们提交
+    // 默认逐个同步执行，异步后端一次提交全部请求，让多个I/O同时在途
+    virtual void readPageBatch(std::vector<PageReadRequest>& requests);
+    virtual void writePageBatch(std::vector<PageWriteRequest>& requests);
+    // 把已写入的页面持久化到存储设备
+    virtual bool sync() = 0;
+    // 数据文件当前包含的页数
+    virtual uint32_t getPageCount() = 0;
+    // 把数据文件截断为pageCount页（释放末尾的空闲页）；调用方保证被截掉的页面没有在途的读写。
+    // 默认不支持截断，返回false
+    virtual bool truncate(uint32_t pageCount) { (void)pageCount; return false; }
+    // I/O引擎名称，用于统计输出
+    virtual const char* getEngineName() const { return "custom"; }
+    
+    const std::string& getPath() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+// 基于std::fstream的后端，所有文件操作由一把互斥锁串行化；在没有POSIX文件接口的平台（Windows）上使用
+class FileDiskBackend : public DiskBackend {
+public:
+    explicit FileDiskBackend(const std::string& path);
+    ~FileDiskBackend() override;
+    
+    bool readPage(uint32_t pageId, uint8_t* data) override;
+    bool writePage(uint32_t pageId, const uint8_t* data) override;
+    size_t readPages(uint32_t firstPageId, size_t count, uint8_t* data) override;
+    bool sync() override;
+    uint32_t getPageCount() override;
+    bool truncate(uint32_t pageCount) override;
+    const char* getEngineName() const override { return "fstream"; }
+    
+    bool isOpen() const;
+
+private:
+    std::fstream file_;
+    mutable std::mutex mutex_;
+};
+
+#ifndef _WIN32
+// 基于文件描述符的后端：用pread/pwrite按偏移读写，不共享文件位置，多个线程可以同时读写不同页面，
+// I/O路径上不加锁；写入直接进入内核页缓存，sync用fdatasync只持久化数据和必要的元数据
+// directIo为true时以O_DIRECT打开，绕过页缓存，由缓冲池负责全部缓存；要求缓冲区、偏移和长度按页对齐，
+// 缓冲池的帧内存和临时缓冲区都满足，其他未对齐的缓冲区经对齐的中转缓冲区读写。
+// 文件系统不支持O_DIRECT（如tmpfs）时退回普通I/O
+class PosixDiskBackend : public DiskBackend {
+public:
+    explicit PosixDiskBackend(const std::string& path, bool directIo = false);
+    ~PosixDiskBackend() override;
+    
+    bool readPage(uint32_t pageId, uint8_t* data) override;
+    bool writePage(uint32_t pageId, const uint8_t* data) override;
+    size_t readPages(uint32_t firstPageId, size_t count, uint8_t* data) override;
+    bool sync() override;
+    uint32_t getPageCount() override;
+    bool truncate(uint32_t pageCount) override;
+    const char* getEngineName() const override { return directIo_ ? "pread+O_DIRECT" : "pread"; }
+    
+    bool isOpen() const { return fd_ >= 0; }
+    bool isDirectIo() const { return directIo_; }
+
+protected:
+    int getFd() const { return fd_; }
+
+private:
+    int fd_;
+    bool directIo_;
+};
+
+// io_uring后端：批量读写一次填入提交队列，只用一次系统调用提交并等待全部完成，最多QUEUE_DEPTH个I/O同时在途，
+// 不需要为每个请求准备一个线程。单页读写仍走pread/pwrite（调用方要同步等待结果，提交到环上没有收益）。
+// 读和写各用一个环，预读线程和后台刷新线程互不阻塞；同一个环上的批量请求由互斥锁串行化。
+// 不依赖liburing，直接使用内核系统调用；内核不支持io_uring（非Linux、内核过旧或被禁用）时
+// 批量请求退回PosixDiskBackend的同步实现，某个请求在环上失败或只完成一部分时用pread/pwrite补完
+class UringDiskBackend : public PosixDiskBackend {
+public:
+    static constexpr unsigned QUEUE_DEPTH = 64;
+    
+    explicit UringDiskBackend(const std::string& path, bool directIo = false);
+    ~UringDiskBackend() override;
+    
+    void readPageBatch(std::vector<PageReadRequest>& requests) override;
+    void writePageBatch(std::vector<PageWriteRequest>& requests) override;
+    const char* getEngineName() const override;
+    
+    bool isUringActive() const;
+
+private:
+    struct Ring;
+    std::unique_ptr<Ring> readRing_;
+    std::unique_ptr<Ring> writeRing_;
+};
+#endif
+
+enum class IoEngine {
+    SYNC,       // pread/pwrite（Windows上为std::fstream）
+    IO_URING    // io_uring，不可用时退回SYNC
+};
+
+// 创建平台默认的磁盘后端：POSIX系统上按engine创建UringDiskBackend或PosixDiskBackend，
+// 其他平台为FileDiskBackend（忽略directIo和engine）
+std::unique_ptr<DiskBackend> createDiskBackend(const std::string& path, bool directIo = false,
+                                               IoEngine engine = IoEngine::IO_URING);
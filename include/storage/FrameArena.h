@@ -0,0 +1,47 @@
+#pragma once
+#include "Page.h"
+#include <cstddef>
+#include <cstdint>
+
+// 缓冲池的帧内存：启动时一次性分配frameCount * PAGE_SIZE字节、按页对齐的连续内存，
+// 之后不再为缓存的页面分配堆内存。在Linux上可以请求大页（MAP_HUGETLB），
+// 系统没有预留大页时退回普通页并建议内核使用透明大页
+class FrameArena {
+public:
+    FrameArena(size_t frameCount, bool useHugePages = false);
+    ~FrameArena();
+    
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+    
+    uint8_t* getFrame(size_t index) const;
+    size_t getFrameCount() const;
+    size_t getBytes() const;            // 实际映射的字节数（大页时向上取整到大页大小）
+    bool usesHugePages() const;         // 是否成功使用了显式大页
+    
+private:
+    uint8_t* memory_;
+    size_t frameCount_;
+    size_t bytes_;
+    bool hugePages_;
+};
+
+// 按页对齐的临时缓冲区（pageCount * PAGE_SIZE字节），用于脏页写回镜像和预读的合并读取；
+// 与帧内存一样满足O_DIRECT对用户缓冲区地址的对齐要求。只能移动不能复制
+class AlignedPageBuffer {
+public:
+    explicit AlignedPageBuffer(size_t pageCount = 1);
+    ~AlignedPageBuffer();
+    AlignedPageBuffer(AlignedPageBuffer&& other) noexcept;
+    AlignedPageBuffer& operator=(AlignedPageBuffer&& other) noexcept;
+    
+    AlignedPageBuffer(const AlignedPageBuffer&) = delete;
+    AlignedPageBuffer& operator=(const AlignedPageBuffer&) = delete;
+    
+    uint8_t* data() const { return memory_; }
+    size_t getPageCount() const { return pageCount_; }
+    
+private:
+    uint8_t* memory_;
+    size_t pageCount_;
+};
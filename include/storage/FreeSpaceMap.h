@@ -0,0 +1,66 @@
+#pragma once
+#include "Page.h"
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// 前向声明
+class PageManager;
+
+// 空闲空间分类：把页面的空闲字节数划分为64个等宽区间
+constexpr size_t FSM_CATEGORY_COUNT = 64;
+constexpr size_t FSM_CATEGORY_BYTES = PAGE_SIZE / FSM_CATEGORY_COUNT;
+// 每个FSM页保存的条目数（每个条目：4字节页ID + 1字节分类）
+constexpr size_t FSM_ENTRIES_PER_PAGE = 800;
+
+// 表级空闲空间映射（Free Space Map）
+// 同时充当表的页目录：按分配顺序记录表的所有数据页，并为每页维护一个空闲空间分类。
+// 每个分类是一个桶，另用一个64位掩码标记非空桶，插入时用一次位运算找到
+// 满足大小要求的最小分类，从而在O(1)时间内选出目标页，不需要逐页读取数据页。
+//
+// 持久化格式：FSM页（PageType::FSM_PAGE）组成的链表，每页包含一条记录：
+//   [u32 下一个FSM页ID][u16 条目数] 之后每个条目为 [u32 数据页ID][u8 分类]
+class FreeSpaceMap {
+public:
+    FreeSpaceMap();
+    
+    // 页目录
+    void addPage(uint32_t pageId, size_t freeBytes);
+    const std::vector<uint32_t>& getPageIds() const;
+    size_t getPageCount() const;
+    bool containsPage(uint32_t pageId) const;
+    
+    // 页面空闲空间变化后更新其分类
+    void updatePage(uint32_t pageId, size_t freeBytes);
+    // 找到一个至少有requiredBytes连续空闲空间的页面，没有时返回0
+    uint32_t findPage(size_t requiredBytes) const;
+    
+    // 持久化：把映射写入FSM页链表，返回链表头页ID（表为空时返回0）
+    uint32_t save(PageManager* pageManager);
+    bool load(PageManager* pageManager, uint32_t rootPageId);
+    uint32_t getRootPageId() const;
+    bool isDirty() const;
+    
+    void clear();
+    // 释放所有FSM页并清空映射（删除表时使用）
+    void release(PageManager* pageManager);
+    
+    static uint8_t categoryFor(size_t freeBytes);
+
+private:
+    std::vector<uint32_t> pageIds_;                 // 页目录（按分配顺序）
+    std::vector<uint8_t> categories_;               // 与pageIds_一一对应的空闲空间分类
+    std::unordered_map<uint32_t, size_t> pageIndex_;  // 页ID -> pageIds_中的位置
+    
+    // 分类桶：每个桶保存该分类下的页面位置，bucketPos_记录页面在所在桶中的下标（用于O(1)移除）
+    std::array<std::vector<size_t>, FSM_CATEGORY_COUNT> buckets_;
+    std::vector<size_t> bucketPos_;
+    uint64_t nonEmptyMask_;                         // 第i位为1表示第i个桶非空
+    
+    std::vector<uint32_t> fsmPageIds_;              // 已分配的FSM页
+    bool dirty_;
+    
+    void insertIntoBucket(size_t index, uint8_t category);
+    void removeFromBucket(size_t index);
+};
@@ -37,14 +37,14 @@ public:
     bool dropIndex(const std::string& indexName);
     
     // 索引操作
-    bool insertRecord(const std::string& tableName, const Row& row, uint32_t recordId);
-    bool deleteRecord(const std::string& tableName, const Row& row, uint32_t recordId);
+    bool insertRecord(const std::string& tableName, const Row& row, RID recordId);
+    bool deleteRecord(const std::string& tableName, const Row& row, RID recordId);
     bool updateRecord(const std::string& tableName, const Row& oldRow, 
-                     const Row& newRow, uint32_t recordId);
+                     const Row& newRow, RID recordId, RID newRecordId);
     
     // 查询操作
-    std::vector<uint32_t> searchByIndex(const std::string& indexName, const Value& key) const;
-    std::vector<uint32_t> rangeSearchByIndex(const std::string& indexName, 
+    std::vector<RID> searchByIndex(const std::string& indexName, const Value& key) const;
+    std::vector<RID> rangeSearchByIndex(const std::string& indexName, 
                                             const Value& startKey, const Value& endKey) const;
     
     // 索引信息
@@ -56,10 +56,15 @@ public:
     void registerTable(std::shared_ptr<Table> table);
     void unregisterTable(const std::string& tableName);
     
-    // 持久化
-    bool saveIndexes(const std::string& dbPath) const;
-    bool loadIndexes(const std::string& dbPath);
-    void rebuildIndexes(); // 重建索引（加载后调用）
+    // 持久化：索引定义保存在系统目录页中，B+树本身不落盘
+    std::vector<const IndexInfo*> getAllIndexInfos() const;
+    // 从系统目录恢复索引定义，B+树在第一次使用时才扫描表数据构建
+    bool restoreIndex(const IndexInfo& indexInfo);
+    void rebuildIndexes(); // 立即重建所有索引
+    // 修改表数据之前调用：构建该表尚未构建的索引，避免之后的扫描把本次修改重复计入
+    void ensureIndexesBuilt(const std::string& tableName);
+    // 丢弃该表已构建的B+树（保留索引定义），下次使用时按表数据重新构建；事务回滚之后调用
+    void invalidateTableIndexes(const std::string& tableName);
     bool rebuildTableIndexes(const std::string& tableName); // 重建特定表的索引
     
     // 调试和统计
@@ -67,11 +72,14 @@ public:
     void printIndexInfo(const std::string& indexName) const;
     
 private:
-    std::unordered_map<std::string, std::unique_ptr<BPlusTree>> indexes_;
+    // 已构建的B+树（从系统目录恢复的索引在第一次访问时才构建，因此可以在const方法中填充）
+    mutable std::unordered_map<std::string, std::unique_ptr<BPlusTree>> indexes_;
     std::unordered_map<std::string, std::unique_ptr<IndexInfo>> indexInfos_;
     std::unordered_map<std::string, std::shared_ptr<Table>> tables_;
     
     // 辅助函数
+    BPlusTree* getIndexTree(const std::string& indexName) const;  // 按需构建
+    std::unique_ptr<BPlusTree> buildIndexTree(const IndexInfo& indexInfo) const;
     std::string generateIndexKey(const std::string& tableName, const std::string& columnName) const;
     Value extractColumnValue(const Row& row, const std::string& tableName, 
                            const std::string& columnName) const;
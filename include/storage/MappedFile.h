@@ -0,0 +1,35 @@
+#pragma once
+#include "Page.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 只读内存映射的数据文件：打开时把整个文件映射到地址空间，不读取任何页面，
+// 页面在第一次访问时由操作系统从页缓存调入。第pageId页位于映射偏移(pageId - 1) * PAGE_SIZE处。
+// 映射是只读的，写入映射内存会触发段错误，不会悄悄修改数据文件
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    bool isOpen() const { return open_; }
+    uint32_t getPageCount() const;
+    // 页面镜像的起始地址；页ID超出文件范围时返回nullptr
+    const uint8_t* getPage(uint32_t pageId) const;
+    // 提示操作系统即将访问从firstPageId开始的count页，提前读入页缓存
+    void adviseWillNeed(uint32_t firstPageId, size_t count) const;
+    const std::string& getPath() const { return path_; }
+
+private:
+    std::string path_;
+    const uint8_t* memory_;
+    size_t bytes_;
+    bool open_;
+#ifdef _WIN32
+    void* fileHandle_;
+    void* mappingHandle_;
+#endif
+};
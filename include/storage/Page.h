@@ -6,14 +6,18 @@
 
 // 页的大小定义（4KB）
 constexpr size_t PAGE_SIZE = 4096;
-constexpr size_t PAGE_HEADER_SIZE = 24; // 页头大小
+constexpr size_t PAGE_HEADER_SIZE = 32; // 页头大小
 constexpr size_t PAGE_DATA_SIZE = PAGE_SIZE - PAGE_HEADER_SIZE;
+constexpr size_t SLOT_ENTRY_SIZE = sizeof(uint16_t); // 槽位项大小（记录偏移）
 
 // 页类型枚举
 enum class PageType : uint8_t {
     DATA_PAGE = 0,      // 数据页
     INDEX_PAGE = 1,     // 索引页
-    META_PAGE = 2       // 元数据页
+    META_PAGE = 2,      // 元数据页
+    FSM_PAGE = 3,       // 空闲空间映射页
+    CATALOG_PAGE = 4,   // 系统目录页（表结构、索引定义）
+    ALLOCATION_MAP_PAGE = 5  // 页分配位图页
 };
 
 // 页头结构
@@ -22,34 +26,69 @@ struct PageHeader {
     PageType pageType;         // 页类型
     uint16_t slotCount;        // 槽位数量
     uint16_t freeSpaceOffset;  // 空闲空间偏移
-    uint16_t freeSpaceSize;    // 空闲空间大小
+    uint16_t freeSpaceSize;    // 记录区与槽位数组之间的连续空闲空间大小
+    uint16_t fragmentedBytes;  // 已删除或被覆盖的记录留下的碎片字节（压缩后可回收）
     uint32_t checksum;         // 校验和
     uint64_t lsn;              // 日志序列号（用于恢复）
 };
 
+static_assert(sizeof(PageHeader) <= PAGE_HEADER_SIZE, "PageHeader does not fit in PAGE_HEADER_SIZE");
+
+// 记录引用：直接指向页面缓冲区中的记录字节，不复制数据
+// 只在页面被持有且未被修改期间有效
+struct RecordRef {
+    const uint8_t* data = nullptr;
+    uint16_t size = 0;
+    
+    bool isValid() const { return data != nullptr; }
+};
+
+// 页面：PAGE_SIZE字节的页面镜像，页头位于镜像开头
+// 独立页面自己持有缓冲区；缓冲池中的页面是内存池中帧的视图，不持有内存
 class Page {
 public:
     explicit Page(uint32_t pageId, PageType type = PageType::DATA_PAGE);
+    // 视图：frameData指向PAGE_SIZE字节的帧内存，不做初始化
+    explicit Page(uint8_t* frameData);
+    
+    // 在当前缓冲区上初始化一个空页面
+    void format(uint32_t pageId, PageType type = PageType::DATA_PAGE);
+    // 复制另一个页面的完整镜像
+    void copyFrom(const Page& other);
+    uint8_t* getData();
+    const uint8_t* getData() const;
     
     // 页基本信息
     uint32_t getPageId() const;
     PageType getPageType() const;
+    // 最后一次修改该页面的日志记录LSN（写回前日志必须持久化到这个位置）
+    uint64_t getLsn() const;
+    void setLsn(uint64_t lsn);
     
     // 数据操作
     bool insertRecord(const std::string& record);
     uint16_t insertRecordAndReturnSlot(const std::string& record);  // 返回分配的槽位ID
+    // 在指定的空槽位中插入记录（重做和撤销时使用，槽位号超出槽位数组时扩展数组）
+    bool insertRecordAt(uint16_t slotId, const std::string& record);
     std::string getRecord(uint16_t slotId) const;
+    RecordRef getRecordRef(uint16_t slotId) const;  // 零拷贝访问记录
     bool deleteRecord(uint16_t slotId);
     bool updateRecord(uint16_t slotId, const std::string& newRecord);
     
     // 空间管理
-    size_t getFreeSpace() const;
+    size_t getFreeSpace() const;        // 可用空间（连续空闲空间 + 可回收的碎片）
+    size_t getFragmentedBytes() const;
     uint16_t getSlotCount() const;
     bool hasSpace(size_t recordSize) const;
+    // 页面压缩：回收碎片，保持槽位号不变（插入/更新空间不足时自动调用，也可由清理过程调用）
+    void compactPage();
     
-    // 序列化和反序列化
+    // 序列化和反序列化（写出的镜像带有最新的校验和）
     std::vector<uint8_t> serialize() const;
+    void serializeTo(uint8_t* out) const;
     static std::unique_ptr<Page> deserialize(const std::vector<uint8_t>& data);
+    // 检查从磁盘读入的页面镜像：页头自洽且校验和匹配
+    static bool validateImage(const uint8_t* image);
     
     // 页验证
     bool isValid() const;
@@ -59,12 +98,16 @@ public:
     void printPageInfo() const;
     
 private:
-    PageHeader header_;
-    std::vector<uint8_t> data_;  // 页数据
-    std::vector<uint16_t> slots_; // 槽位目录（记录偏移）
+    std::unique_ptr<uint8_t[]> ownedData_;  // 独立页面持有的缓冲区（视图为空）
+    // 完整的页面镜像：页头之后是向后增长的记录区，页尾是向前增长的槽位数组
+    // （第i个槽位项位于PAGE_SIZE - (i + 1) * SLOT_ENTRY_SIZE，值为记录偏移，0表示空槽位）
+    uint8_t* data_;
+    PageHeader* header_;                    // 指向data_开头的页头
     
-    void initializePage();
-    uint32_t calculateChecksum() const;
+    static uint32_t calculateChecksum(const uint8_t* image);
     uint16_t findFreeSlot() const;
-    void compactPage();
+    uint16_t getSlotOffset(uint16_t slotId) const;
+    void setSlotOffset(uint16_t slotId, uint16_t offset);
+    // 在空闲空间起始处写入记录并让slotId指向它（调用方保证空间足够）
+    void placeRecord(uint16_t slotId, const std::string& record);
 };
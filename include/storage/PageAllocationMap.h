@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 每个页分配位图页覆盖的页数（位图4000字节）
+constexpr uint32_t ALLOCATION_MAP_PAGES_PER_MAP_PAGE = 32000;
+
+// 页分配位图：记录数据文件中每一页是否已分配
+// 每页对应一位（1表示空闲），按64位字存放，分配时从第一个含空闲位的字开始，
+// 用一条求最低位指令找到空闲页，不需要逐页扫描；释放页面时把提示前移。
+// pageLimit之后的页面（文件之外）都视为空闲，分配到它们时文件范围随之扩展。
+//
+// 持久化由PageManager负责：ALLOCATION_MAP_PAGE组成的链表，每页包含一条记录：
+//   [u32 下一个位图页ID][u32 起始页ID][u32 页数] 之后是页数对应的位图（每字节8页，低位在前，1表示空闲）
+class PageAllocationMap {
+public:
+    PageAllocationMap();
+    
+    // 重置为包含pageLimit页的文件，文件中的页面全部视为已分配
+    void reset(uint32_t pageLimit);
+    
+    // 分配页ID最小的空闲页，文件中没有空闲页时在文件末尾之后分配
+    uint32_t allocate();
+    // 分配count个页ID连续的空闲页，返回第一页：从goalPageId开始查找，
+    // 需要扩展文件时先在文件已有范围内寻找足够大的空洞
+    uint32_t allocateRun(uint32_t count, uint32_t goalPageId);
+    // 释放页面，页面未分配时返回false
+    bool free(uint32_t pageId);
+    // 把指定页面标记为已分配（恢复时重做分配记录），页面已分配时返回false
+    bool allocateAt(uint32_t pageId);
+    bool isAllocated(uint32_t pageId) const;
+    
+    // 文件范围：页ID不超过它的页面在数据文件中占有位置
+    uint32_t getPageLimit() const;
+    size_t getAllocatedCount() const;
+    size_t getFreeCount() const;  // 文件范围内的空闲页数
+    // 已分配的最大页ID（没有已分配页时为0），截断文件时使用
+    uint32_t getHighestAllocated() const;
+    // 文件截断后缩小文件范围（pageLimit之后不能有已分配的页面）
+    void shrinkTo(uint32_t pageLimit);
+    
+    // 持久化：导出/导入从firstPageId开始count页的位图（(count + 7) / 8字节，1表示空闲）
+    // 导入时文件范围之外标记为已分配的页面（保存位图之后文件被截短或还没写入）会扩展文件范围
+    void exportBits(uint32_t firstPageId, uint32_t count, uint8_t* out) const;
+    void importBits(uint32_t firstPageId, uint32_t count, const uint8_t* in);
+
+private:
+    std::vector<uint64_t> freeWords_;  // 第p页对应第(p - 1) / 64个字的第(p - 1) % 64位
+    uint32_t pageLimit_;
+    size_t allocatedCount_;
+    size_t firstFreeWord_;             // 提示：此前的字中没有空闲位
+    
+    void ensureWords(size_t wordCount);  // 新增的字全部空闲
+    void markUsed(uint32_t pageId);
+    void markFree(uint32_t pageId);
+    // 从pageId开始查找第一个空闲页/已分配页，位图之外的页面都是空闲的（找不到已分配页时返回UINT64_MAX）
+    uint64_t findNextFree(uint64_t pageId) const;
+    uint64_t findNextUsed(uint64_t pageId) const;
+    // 从startPageId开始查找count个连续空闲页，返回第一页
+    uint64_t findRun(uint32_t count, uint64_t startPageId) const;
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include "Page.h"
+#include <cstdint>
+#include <optional>
+
+class BufferPool;
+
+// 页面守卫：构造时从缓冲池获取并固定页面，析构时解除固定，页面指针不会在守卫之外泄漏
+// 守卫只能移动不能复制；移出后原守卫为空，不再解除固定
+// 守卫不对页面内容加锁，同一线程可以同时持有同一页面的多个守卫；
+// 写守卫存在期间后台刷新线程和检查点不会复制该页面，不会写出修改到一半的镜像
+// 只读映射模式下读守卫持有映射内存上的页面视图，不经过缓冲池
+
+// 只读守卫
+class ReadPageGuard {
+public:
+    ReadPageGuard();  // 空守卫
+    ReadPageGuard(BufferPool& pool, uint32_t pageId);
+    // 只读映射中的页面镜像：零拷贝视图，释放时无需解除固定
+    explicit ReadPageGuard(const uint8_t* mappedImage);
+    ReadPageGuard(ReadPageGuard&& other) noexcept;
+    ReadPageGuard& operator=(ReadPageGuard&& other) noexcept;
+    ~ReadPageGuard();
+    
+    ReadPageGuard(const ReadPageGuard&) = delete;
+    ReadPageGuard& operator=(const ReadPageGuard&) = delete;
+    
+    // 页面不存在或加载失败时守卫为空
+    bool isValid() const { return page_ != nullptr; }
+    explicit operator bool() const { return isValid(); }
+    
+    const Page* get() const { return page_; }
+    const Page* operator->() const { return page_; }
+    const Page& operator*() const { return *page_; }
+    uint32_t getPageId() const;
+    
+    // 提前解除固定，之后守卫为空
+    void release();
+
+private:
+    BufferPool* pool_;
+    Page* page_;
+    std::optional<Page> view_;  // 映射页面的视图（来自缓冲池的页面为空）
+};
+
+// 读写守卫：释放时把页面标记为脏页（先标记再解除固定，页面在写回前不会被淘汰丢失修改）
+class WritePageGuard {
+public:
+    WritePageGuard();  // 空守卫
+    WritePageGuard(BufferPool& pool, uint32_t pageId);
+    WritePageGuard(WritePageGuard&& other) noexcept;
+    WritePageGuard& operator=(WritePageGuard&& other) noexcept;
+    ~WritePageGuard();
+    
+    WritePageGuard(const WritePageGuard&) = delete;
+    WritePageGuard& operator=(const WritePageGuard&) = delete;
+    
+    bool isValid() const { return page_ != nullptr; }
+    explicit operator bool() const { return isValid(); }
+    
+    Page* get() const { return page_; }
+    Page* operator->() const { return page_; }
+    Page& operator*() const { return *page_; }
+    uint32_t getPageId() const;
+    
+    // 标记脏页并提前解除固定，之后守卫为空
+    void release();
+
+private:
+    BufferPool* pool_;
+    Page* page_;
+};
@@ -1,59 +1,206 @@
 #pragma once
 #include "Page.h"
 #include "BufferPool.h"
+#include "PageGuard.h"
+#include "MappedFile.h"
+#include "PageAllocationMap.h"
+#include "WriteAheadLog.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
 #include <string>
-#include <fstream>
+#include <thread>
 #include <vector>
 
+// 后台检查点配置：距上次检查点追加的日志达到logBytes，或者距上次检查点超过interval且有新日志时触发
+struct CheckpointConfig {
+    bool enabled = true;
+    uint64_t logBytes = 4 * WriteAheadLog::SEGMENT_SIZE;
+    std::chrono::milliseconds interval{5 * 60 * 1000};  // 0表示不按时间触发
+    size_t spareSegments = 2;                            // 回收日志段时保留的备用段数
+};
+
+// 检查点统计（包括保存数据库时的检查点）
+struct CheckpointStats {
+    uint64_t checkpoints = 0;          // 完成的检查点数
+    uint64_t backgroundCheckpoints = 0; // 其中由后台检查点线程完成的
+    uint64_t lastCheckpointLsn = 0;    // 最近一次检查点记录的LSN
+    uint64_t lastRedoLsn = 0;          // 最近一次检查点的重做起点
+    uint64_t lastPagesFlushed = 0;     // 最近一次检查点写回的页数
+    uint64_t totalPagesFlushed = 0;
+    uint64_t lastDirtyPages = 0;       // 最近一次检查点记录中的脏页数
+    double lastDurationMs = 0;         // 最近一次检查点的耗时
+};
+
 class PageManager {
 public:
-    explicit PageManager(const std::string& dbFileName, size_t bufferPoolSize = 128);
+    explicit PageManager(const std::string& dbFileName, size_t bufferPoolSize = 128,
+                         const FlusherConfig& flusherConfig = FlusherConfig(),
+                         ReplacementPolicyType policyType = ReplacementPolicyType::TWO_Q);
+    // 使用指定的磁盘后端（所有权交给缓冲池）
+    PageManager(std::unique_ptr<DiskBackend> diskBackend, size_t bufferPoolSize = 128,
+                const FlusherConfig& flusherConfig = FlusherConfig(),
+                ReplacementPolicyType policyType = ReplacementPolicyType::TWO_Q);
     ~PageManager();
     
-    // 页面分配和释放
+    // 只读打开：映射整个数据文件，读守卫是映射内存上的零拷贝视图，不经过缓冲池，
+    // 打开时不读取任何页面；分配、释放和写入页面都会失败并报错。文件不存在或映射失败时返回nullptr
+    static std::unique_ptr<PageManager> openReadOnly(const std::string& dbFileName);
+    bool isReadOnly() const { return mappedFile_ != nullptr; }
+    
+    // 预写日志：打开后页面的每次修改都先追加日志记录，脏页写回之前日志必须持久化到页面的LSN
+    // 没有打开日志时（基准测试、只读模式）所有日志操作都是空操作
+    bool openLog(const std::string& directory, const WalConfig& config = WalConfig());
+    WriteAheadLog* getLog() const { return wal_.get(); }
+    bool isLogging() const { return wal_ != nullptr; }
+    
+    // 同步级别：数据库级别的设置就是日志的级别（见SynchronousMode），检查点和关闭时在OFF级别下也不同步页文件；
+    // 会话级别的设置只影响当前线程的提交，clearSessionSynchronousMode之后恢复使用数据库级别
+    void setSynchronousMode(SynchronousMode mode);
+    SynchronousMode getSynchronousMode() const;
+    void setSessionSynchronousMode(SynchronousMode mode);
+    void clearSessionSynchronousMode();
+    SynchronousMode getSessionSynchronousMode() const;  // 当前线程提交时使用的级别
+    
+    // 事务：每个线程最多有一个进行中的事务，事务ID在第一条修改记录之前才分配（只读事务不写日志）
+    // commitTransaction在waitDurable为true时按当前线程的同步级别等待提交记录（FULL时等待持久化），
+    // 否则只追加提交记录
+    bool beginTransaction();
+    bool commitTransaction(bool waitDurable = true);
+    // 回滚：从事务最后一条记录沿prevLsn链向前，用undoPageChange撤销每条行修改（写补偿记录），
+    // 最后追加ABORT记录；onUndo在每条记录撤销之后调用（调用方据此更新行数和空闲空间）。
+    // 系统目录和页面分配的修改只重做不撤销，回滚后新分配的页面仍属于表
+    bool rollbackTransaction(const std::function<void(const LogRecord&)>& onUndo = nullptr);
+    bool inTransaction() const;
+    uint64_t getTransactionId() const;  // 当前线程的事务ID（还没有写过日志时为0）
+    
+    // 记录页面修改并把页面的LSN设为记录的LSN，在持有页面写守卫、修改页面之后调用
+    uint64_t logPageChange(Page& page, LogRecordType type, uint16_t slotId = 0,
+                           const std::string& before = std::string(), const std::string& after = std::string());
+    // 记录逻辑操作（系统目录的修改），返回记录的LSN
+    uint64_t logOperation(LogRecordType type, const std::string& payload);
+    
+    // 恢复：redoPageChange按页面LSN跳过已经写入页面的修改，返回是否重放了这条记录；
+    // redoAllocation只修改页分配位图（释放的页面追加到freedPageIds），之后用discardFreePages
+    // 丢弃其中仍然空闲的页面（释放之后又被重新分配的页面保留重做的内容）；
+    // undoPageChange对页面执行相反的操作并写补偿记录（不可撤销的记录直接返回true）
+    bool redoPageChange(const LogRecord& record);
+    void redoAllocation(const LogRecord& record, std::vector<uint32_t>& freedPageIds);
+    void discardFreePages(const std::vector<uint32_t>& pageIds);
+    bool undoPageChange(const LogRecord& record);
+    // 检查点：redoLsn之前的修改都已写入页文件后调用，追加检查点记录（带脏页表和活跃事务）并持久化，
+    // 再更新日志目录中的检查点文件，回收不再需要的日志段
+    bool writeCheckpoint(uint64_t redoLsn);
+    
+    // 后台模糊检查点：检查点线程按日志量或时间发出请求，存储引擎在两个操作之间写入系统目录快照后
+    // 调用beginCheckpoint；检查点线程随后写回beginLsn之前变脏的页面、记录检查点并回收日志段，
+    // 写回期间前台的查询和修改照常进行。需要在openLog之后启动
+    void startCheckpointer(const CheckpointConfig& config = CheckpointConfig());
+    void stopCheckpointer();
+    bool isCheckpointRequested() const { return checkpointRequested_.load(std::memory_order_relaxed); }
+    void beginCheckpoint(uint64_t beginLsn);
+    CheckpointStats getCheckpointStats() const;
+    
+    // 页面分配和释放：页分配位图记录每页是否已分配，分配时取页ID最小的空闲页；
+    // 释放的页面直接从缓冲池中丢弃，不再写回
     uint32_t allocatePage(PageType type = PageType::DATA_PAGE);
     void deallocatePage(uint32_t pageId);
+    // 分配pageCount个页ID连续的页面（区段），返回第一页：尽量紧接在goalPageId之后，
+    // 让同一张表的数据页在文件中连续存放。区段中的页面只标记为已分配，由调用方在使用时写入
+    uint32_t allocateExtent(uint32_t pageCount, uint32_t goalPageId = 0);
+    // 把已分配的页面初始化为空页面（记录PAGE_FORMAT，不需要整页镜像）
+    bool formatPage(uint32_t pageId, PageType type);
+    
+    // 页分配位图的持久化：保存为ALLOCATION_MAP_PAGE链表并返回链表头页ID（由元数据页记录），
+    // 打开数据库时加载，重启后之前释放的页面可以重新分配
+    uint32_t saveAllocationMap();
+    bool loadAllocationMap(uint32_t rootPageId);
     
-    // 页面读写
-    std::shared_ptr<Page> getPage(uint32_t pageId);
-    bool writePage(std::shared_ptr<Page> page);
+    // 页面访问：守卫在生命周期内固定页面，WritePageGuard释放时把页面标记为脏页，
+    // 由淘汰、检查点或后台刷新线程写回；页面不存在或读取失败时返回空守卫
+    ReadPageGuard fetchPageRead(uint32_t pageId);
+    WritePageGuard fetchPageWrite(uint32_t pageId);
+    // 把独立页面（不在缓冲池中的Page对象）的镜像复制进缓冲池并标记为脏页（日志中记录整页镜像）
+    bool writePage(const Page& page);
     bool flushPage(uint32_t pageId);
     void flushAllPages();
     
+    // 顺序预读：异步把即将访问的页面读入缓冲池（表扫描提示后续的数据页）
+    void prefetchPages(const std::vector<uint32_t>& pageIds);
+    void setPrefetchDepth(size_t depth);  // 0表示关闭预读
+    size_t getPrefetchDepth() const;
+    
     // 页面管理
     bool pageExists(uint32_t pageId) const;
     size_t getTotalPages() const;
     size_t getFreePages() const;
     
-    // 持久化
-    bool loadFromDisk();
+    // 持久化（saveToDisk是检查点：持久化日志，写回所有脏页并刷新文件；文件末尾的页面都已释放时把文件截断）
     bool saveToDisk();
     
     // 缓冲池操作
-    const BufferPoolStats& getBufferPoolStats() const;
+    BufferPoolStats getBufferPoolStats() const;
     void printBufferPoolStats() const;
     void resetBufferPoolStats();
     
     // 统计信息
+    const std::string& getFileName() const;
     void printStatistics() const;
     
 private:
-    std::string dbFileName_;
-    std::fstream dbFile_;
-    uint32_t nextPageId_;
-    std::vector<bool> freePageBitmap_;  // 空闲页位图
+    explicit PageManager(std::unique_ptr<MappedFile> mappedFile);
+    
+    // 预写日志（在缓冲池之后析构：缓冲池析构时写回脏页仍要检查日志）
+    std::unique_ptr<WriteAheadLog> wal_;
+    // 各线程进行中的事务（线程 -> 事务ID，0表示还没有写过日志）
+    std::unordered_map<std::thread::id, uint64_t> transactions_;
+    // 设置了会话级别同步级别的线程
+    std::unordered_map<std::thread::id, SynchronousMode> sessionSynchronous_;
+    mutable std::mutex transactionMutex_;  // 保护transactions_和sessionSynchronous_
+    
+    PageAllocationMap allocationMap_;   // 页分配位图
+    std::vector<uint32_t> allocationMapPageIds_;  // 保存位图的页面（按链表顺序）
+    mutable std::mutex allocationMutex_;  // 保护allocationMap_
     std::unique_ptr<BufferPool> bufferPool_; // 缓冲池
+    DiskBackend* diskBackend_;          // 磁盘后端（由缓冲池持有）
+    
+    // 只读映射模式（此时没有缓冲池和磁盘后端）
+    std::unique_ptr<MappedFile> mappedFile_;
+    // 每页第一次访问时检查校验和，结果记录在这里（0未检查，1有效，2损坏）
+    mutable std::vector<std::atomic<uint8_t>> mappedPageState_;
+    std::atomic<size_t> mappedPrefetchDepth_;
+    
+    ReadPageGuard fetchMappedPage(uint32_t pageId) const;
+    
+    // 后台检查点线程（运行标志、待完成的检查点和触发状态由checkpointerMutex_保护）
+    CheckpointConfig checkpointConfig_;
+    std::thread checkpointerThread_;
+    mutable std::mutex checkpointerMutex_;
+    std::condition_variable checkpointerCv_;
+    bool checkpointerRunning_ = false;
+    std::atomic<bool> checkpointRequested_{false};
+    uint64_t pendingBeginLsn_ = 0;               // 系统目录快照已写入，等待检查点线程完成
+    uint64_t lastCheckpointEndLsn_ = 0;          // 上次检查点记录之后的位置（按日志量触发的起点）
+    std::chrono::steady_clock::time_point lastCheckpointTime_;
+    CheckpointStats checkpointStats_;
+    // 检查点串行执行（后台检查点与保存时的检查点）
+    std::mutex checkpointMutex_;
+    
+    void checkpointerLoop();
+    bool checkpointDue() const;  // 持有checkpointerMutex_时调用
+    // 持有checkpointMutex_时调用：记录脏页表和活跃事务，持久化检查点并回收日志段
+    bool completeCheckpoint(uint64_t redoLsn, size_t pagesFlushed, std::chrono::steady_clock::time_point startTime,
+                            bool background);
     
-    // 文件操作
-    bool openFile();
-    void closeFile();
-    bool readPageFromDisk(uint32_t pageId, std::vector<uint8_t>& data);
-    bool writePageToDisk(uint32_t pageId, const std::vector<uint8_t>& data);
+    // 当前线程的事务ID，事务中第一次写日志时追加BEGIN记录；不在事务中时返回0（系统操作）
+    uint64_t currentTransactionId();
+    // 把页面镜像放入缓冲池（不写日志）
+    bool putPage(const Page& page);
     
-    // 位图操作
-    void markPageUsed(uint32_t pageId);
-    void markPageFree(uint32_t pageId);
-    uint32_t findFreePageId();
+    // 截断文件末尾已释放的页面
+    void truncateFreeTail();
 };
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+
+// 记录标识（RID）：物理地址 (pageId, slotId) 打包成的64位整数
+// 高48位为页ID，低16位为槽位ID；槽位目录保证记录在页内移动时槽位号不变，
+// 因此RID在记录的整个生命周期内保持稳定，无需额外的recordId映射表
+using RID = uint64_t;
+
+// 页ID从1开始分配，RID为0的记录不存在，可作为无效值
+constexpr RID INVALID_RID = 0;
+
+inline RID makeRID(uint32_t pageId, uint16_t slotId) {
+    return (static_cast<RID>(pageId) << 16) | slotId;
+}
+
+inline uint32_t ridPageId(RID rid) {
+    return static_cast<uint32_t>(rid >> 16);
+}
+
+inline uint16_t ridSlotId(RID rid) {
+    return static_cast<uint16_t>(rid & 0xFFFF);
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 缓冲池页面置换策略
+enum class ReplacementPolicyType {
+    LRU,    // 最近最少使用（顺序扫描会冲掉所有热点页面）
+    CLOCK,  // 时钟算法：LRU的近似，命中时只设置引用位
+    LRU_K,  // LRU-K：按倒数第K次访问时间淘汰，只访问过一次的页面最先淘汰
+    TWO_Q   // 2Q：新页面先进入FIFO队列，被淘汰后再次访问才进入热点LRU队列
+};
+
+// 置换策略接口：只跟踪缓冲池中驻留的页面ID，页面能否淘汰（固定、写回中、加载中）由缓冲池判断
+// 所有方法都在持有缓冲池锁时调用，实现不需要自己加锁
+class ReplacementPolicy {
+public:
+    virtual ~ReplacementPolicy() = default;
+    
+    // 页面被放入缓冲池（未命中加载或新分配）
+    virtual void recordInsert(uint32_t pageId) = 0;
+    // 缓冲池命中
+    virtual void recordAccess(uint32_t pageId) = 0;
+    // 页面离开缓冲池
+    virtual void recordRemove(uint32_t pageId) = 0;
+    // 在可淘汰的页面中选择一个淘汰对象，没有时返回0
+    virtual uint32_t pickVictim(const std::function<bool(uint32_t)>& isEvictable) = 0;
+    // 驻留页面按从冷到热的顺序排列（后台刷新线程按这个顺序写回脏页）
+    virtual std::vector<uint32_t> getColdOrder() const = 0;
+    virtual void clear() = 0;
+    virtual const char* getName() const = 0;
+};
+
+std::unique_ptr<ReplacementPolicy> createReplacementPolicy(ReplacementPolicyType type, size_t capacity);
+const char* replacementPolicyName(ReplacementPolicyType type);
+
+class LRUReplacementPolicy : public ReplacementPolicy {
+public:
+    void recordInsert(uint32_t pageId) override;
+    void recordAccess(uint32_t pageId) override;
+    void recordRemove(uint32_t pageId) override;
+    uint32_t pickVictim(const std::function<bool(uint32_t)>& isEvictable) override;
+    std::vector<uint32_t> getColdOrder() const override;
+    void clear() override;
+    const char* getName() const override { return "LRU"; }
+
+private:
+    std::list<uint32_t> lruList_;       // 前端最近使用，后端最久未使用
+    std::unordered_map<uint32_t, std::list<uint32_t>::iterator> lruIterators_;
+};
+
+class ClockReplacementPolicy : public ReplacementPolicy {
+public:
+    void recordInsert(uint32_t pageId) override;
+    void recordAccess(uint32_t pageId) override;
+    void recordRemove(uint32_t pageId) override;
+    uint32_t pickVictim(const std::function<bool(uint32_t)>& isEvictable) override;
+    std::vector<uint32_t> getColdOrder() const override;
+    void clear() override;
+    const char* getName() const override { return "CLOCK"; }
+
+private:
+    struct Slot {
+        uint32_t pageId;    // 0表示空槽
+        bool referenced;
+    };
+    std::vector<Slot> slots_;           // 时钟环
+    std::vector<size_t> freeSlots_;     // 空槽下标
+    std::unordered_map<uint32_t, size_t> slotIndex_;
+    size_t hand_ = 0;
+};
+
+class LRUKReplacementPolicy : public ReplacementPolicy {
+public:
+    // correlatedPeriod：同一页面在这么多次缓冲池访问之内的重复访问视为同一次（默认1，即只合并连续访问，
+    // 例如扫描时逐行读取同一页）；已淘汰页面最多保留capacity个的访问历史
+    explicit LRUKReplacementPolicy(size_t capacity, size_t k = 2, uint64_t correlatedPeriod = 1);
+    
+    void recordInsert(uint32_t pageId) override;
+    void recordAccess(uint32_t pageId) override;
+    void recordRemove(uint32_t pageId) override;
+    uint32_t pickVictim(const std::function<bool(uint32_t)>& isEvictable) override;
+    std::vector<uint32_t> getColdOrder() const override;
+    void clear() override;
+    const char* getName() const override { return "LRU-K"; }
+
+private:
+    // 淘汰顺序键：(倒数第K次访问时间, 最近一次访问时间)，访问不足K次的页面第一项为0，最先淘汰
+    using OrderKey = std::pair<uint64_t, uint64_t>;
+    struct History {
+        std::vector<uint64_t> accesses;  // 最近K次（不相关）访问时间，最新的在前
+        uint64_t lastAccess = 0;         // 最近一次访问时间（包括相关访问）
+        bool resident = false;
+        std::list<uint32_t>::iterator retiredPos;  // 不驻留时在retired_中的位置
+    };
+    
+    size_t historyCapacity_;            // 已淘汰页面保留访问历史的数量上限
+    size_t k_;
+    uint64_t correlatedPeriod_;
+    uint64_t clock_ = 0;
+    std::unordered_map<uint32_t, History> history_;
+    std::list<uint32_t> retired_;       // 保留了历史的已淘汰页面（FIFO）
+    std::set<std::pair<OrderKey, uint32_t>> order_;  // 驻留页面按淘汰顺序排列
+    
+    OrderKey keyOf(const History& history) const;
+    void touch(uint32_t pageId, History& history);
+};
+
+class TwoQueueReplacementPolicy : public ReplacementPolicy {
+public:
+    // 按论文推荐的参数：A1in占容量的25%，A1out保留容量50%的页面ID
+    explicit TwoQueueReplacementPolicy(size_t capacity);
+    
+    void recordInsert(uint32_t pageId) override;
+    void recordAccess(uint32_t pageId) override;
+    void recordRemove(uint32_t pageId) override;
+    uint32_t pickVictim(const std::function<bool(uint32_t)>& isEvictable) override;
+    std::vector<uint32_t> getColdOrder() const override;
+    void clear() override;
+    const char* getName() const override { return "2Q"; }
+
+private:
+    enum class Queue { A1IN, AM, A1OUT };
+    struct Entry {
+        Queue queue;
+        std::list<uint32_t>::iterator position;
+    };
+    
+    size_t kin_;
+    size_t kout_;
+    std::list<uint32_t> a1in_;          // 首次访问的页面（FIFO，前端最新）
+    std::list<uint32_t> am_;            // 热点页面（LRU，前端最近使用）
+    std::list<uint32_t> a1out_;         // 从A1in淘汰的页面ID（不驻留，FIFO）
+    std::unordered_map<uint32_t, Entry> entries_;
+    
+    uint32_t pickFrom(const std::list<uint32_t>& queue, const std::function<bool(uint32_t)>& isEvictable) const;
+};
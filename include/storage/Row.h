@@ -2,6 +2,7 @@
 #include <vector>
 #include <string>
 #include <variant>
+#include <cstdint>
 
 // 支持的数据类型
 enum class DataType {
@@ -13,6 +14,17 @@ enum class DataType {
 // 数据值的变体类型
 using Value = std::variant<int, std::string, double>;
 
+// 二进制行格式版本号（写在每条记录的第一个字节）
+// 旧的文本格式以字段数量的十进制数字开头，因此版本字节永远不会与其冲突
+constexpr uint8_t ROW_FORMAT_VERSION = 0x01;
+
+// 二进制行格式：
+//   [u8 版本号][u16 字段数量] 之后每个字段为 [u8 类型标签(DataType)][数据]
+//   INT    -> 4字节小端有符号整数
+//   DOUBLE -> 8字节小端IEEE754
+//   STRING -> u16 小端长度 + 原始字节
+constexpr size_t ROW_HEADER_SIZE = sizeof(uint8_t) + sizeof(uint16_t);
+
 class Row {
 public:
     Row() = default;
@@ -28,9 +40,17 @@ public:
     // 获取字段数量
     size_t getFieldCount() const;
     
-    // 序列化和反序列化（用于存储）
+    // 序列化和反序列化（用于存储，二进制格式）
     std::string serialize() const;
+    size_t getSerializedSize() const;
+    // 自动识别二进制格式与旧文本格式，旧数据可以直接读取
     static Row deserialize(const std::string& data);
+    static Row deserialize(const uint8_t* data, size_t size);
+    
+    // 旧的文本格式编解码（"3|I42|S5:hello|D3.14|"），仅用于迁移旧数据和性能对比
+    std::string serializeLegacyText() const;
+    static Row deserializeLegacyText(const std::string& data);
+    static bool isLegacyTextFormat(const uint8_t* data, size_t size);
     
     // 打印行数据
     std::string toString() const;
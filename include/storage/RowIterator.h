@@ -1,31 +1,66 @@
 #pragma once
 #include "Row.h"
-#include <vector>
+#include "RowView.h"
+#include "PageGuard.h"
+#include "RID.h"
+#include <cstdint>
 #include <memory>
 
-class RowIterator {
+// 前向声明
+class Table;
+
+// 表堆迭代器：按页顺序遍历表的数据页（空闲空间映射中的页目录），页内按槽位顺序遍历记录
+// 任意时刻只持有（并固定）当前页面，内存占用与表大小无关
+// 扫描进入第二个页面后按顺序扫描处理，提前请求缓冲池预读后续的数据页
+class TableHeapIterator {
 public:
-    RowIterator(const std::vector<Row>* rows, size_t position = 0);
+    TableHeapIterator();  // 结束迭代器
+    TableHeapIterator(const Table* table, size_t pageIndex);
+    TableHeapIterator(const TableHeapIterator& other);
+    TableHeapIterator& operator=(const TableHeapIterator& other);
+    ~TableHeapIterator();
     
-    // 迭代器操作
-    Row& operator*();
+    // 迭代器操作：解引用时才把当前记录物化为Row
     const Row& operator*() const;
-    Row* operator->();
     const Row* operator->() const;
-    RowIterator& operator++();
-    RowIterator operator++(int);
+    TableHeapIterator& operator++();
+    TableHeapIterator operator++(int);
+    
+    // 零拷贝访问当前记录（只在迭代器停留在当前页期间有效）
+    const RowView& view() const;
+    RecordRef getRecordRef() const;
     
     // 比较操作
-    bool operator==(const RowIterator& other) const;
-    bool operator!=(const RowIterator& other) const;
+    bool operator==(const TableHeapIterator& other) const;
+    bool operator!=(const TableHeapIterator& other) const;
     
     // 检查是否到达末尾
     bool hasNext() const;
     
-    // 获取当前位置
+    // 获取当前位置（已经遍历过的记录数）
     size_t getPosition() const;
     
+    // 当前记录的物理位置
+    uint32_t getPageId() const;
+    uint16_t getSlotId() const;
+    RID getRID() const;
+    
 private:
-    const std::vector<Row>* rows_;
+    const Table* table_;
+    size_t pageIndex_;
+    uint16_t slotId_;
     size_t position_;
+    ReadPageGuard page_;          // 当前固定的页面
+    size_t prefetchedUntil_;      // 已请求预读到的页下标（不含）
+    RowView view_;
+    mutable Row row_;
+    mutable bool rowMaterialized_;
+    
+    bool isEnd() const;
+    void loadPage();
+    void releasePage();
+    void seekValidRecord();  // 从当前(pageIndex_, slotId_)开始找到下一条有效记录
 };
+
+// 保持原有的迭代器名称
+using RowIterator = TableHeapIterator;
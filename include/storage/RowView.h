@@ -0,0 +1,52 @@
+#pragma once
+#include "Row.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 行视图：不拥有数据，直接指向已固定页面中的记录字节（二进制行格式）
+// 字段按需解码，只有真正访问到的列才会被解析；调用toRow()时才物化成Row
+//
+// 视图的生命周期不能超过底层页面缓冲区：调用方需要保持页面固定（例如Table::getRowView的pageGuard）
+// 并且在使用视图期间不能修改该页面
+class RowView {
+public:
+    RowView() = default;
+    // 基于二进制记录字节构造（旧的文本格式记录会先解码为Row，作为迁移兼容路径）
+    RowView(const uint8_t* data, size_t size);
+    // 基于已物化的行构造（用于内存表，不复制数据）
+    explicit RowView(const Row* row);
+    
+    bool isValid() const;
+    size_t getFieldCount() const;
+    
+    // 按列访问：只解码被访问的字段
+    DataType getType(size_t index) const;
+    int getInt(size_t index) const;
+    double getDouble(size_t index) const;
+    std::string_view getString(size_t index) const;  // 指向页面内的字节，不分配内存
+    Value getValue(size_t index) const;
+    
+    // 物化为Row（仅在需要输出时调用）
+    Row toRow() const;
+    // 只解码requiredColumns中为true的列，其余列填充该类型的默认值，保持行宽度不变
+    Row toRow(const std::vector<bool>& requiredColumns) const;
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    uint16_t fieldCount_ = 0;
+    const Row* row_ = nullptr;                 // 物化行（内存表或旧格式记录）
+    std::shared_ptr<const Row> legacyRow_;     // 旧文本格式记录解码后的副本
+    
+    // 顺序访问时的解码游标，避免每次都从记录头部开始跳过字段
+    mutable size_t cursorIndex_ = 0;
+    mutable size_t cursorOffset_ = ROW_HEADER_SIZE;
+    
+    // 返回第index个字段类型标签的偏移
+    size_t locateField(size_t index) const;
+    // 返回从offset处开始的字段的总长度（包括类型标签）
+    size_t fieldLength(size_t offset) const;
+};
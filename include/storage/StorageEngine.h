@@ -8,9 +8,36 @@
 
 class StorageEngine {
 public:
-    explicit StorageEngine(const std::string& dbPath);
+    // readOnly为true时只读打开已有数据库：页文件被映射到内存，查询直接读取映射中的页面，
+    // 所有修改操作失败并报错，退出时不保存；数据库不存在时抛出std::runtime_error
+    explicit StorageEngine(const std::string& dbPath, bool readOnly = false);
     ~StorageEngine();
     
+    bool isReadOnly() const { return readOnly_; }
+    
+    // 事务：每个修改操作在调用线程的事务中执行，不在事务中时自动开始并提交（等待日志持久化）
+    // 多个操作可以放进同一个事务，commitTransaction的waitDurable为false时只追加提交记录，
+    // 之后一次flushLog让多个事务共享一次日志同步。rollbackTransaction按日志撤销事务中的行修改，
+    // 并更新涉及的表的行数、空闲空间和索引；建表、删表和索引定义的修改不能回滚
+    bool beginTransaction();
+    bool commitTransaction(bool waitDurable = true);
+    bool rollbackTransaction();
+    bool inTransaction() const;
+    bool flushLog();
+    const WriteAheadLog* getLog() const;  // 只读模式下为空
+    
+    // 同步级别（off/normal/full，默认full）：数据库级别对所有连接生效，会话级别只影响调用线程的提交，
+    // 优先于数据库级别；设置只在本次打开期间有效，不保存到数据库
+    void setSynchronousMode(SynchronousMode mode);
+    SynchronousMode getSynchronousMode() const;
+    void setSessionSynchronousMode(SynchronousMode mode);
+    void clearSessionSynchronousMode();
+    SynchronousMode getSessionSynchronousMode() const;
+    
+    // 后台检查点：打开数据库后按默认配置启动，setCheckpointConfig用新的触发条件重新启动
+    void setCheckpointConfig(const CheckpointConfig& config);
+    CheckpointStats getCheckpointStats() const;
+    
     // 表管理
     bool createTable(const std::string& tableName, const std::vector<ColumnInfo>& columns);
     bool dropTable(const std::string& tableName);
@@ -26,8 +53,8 @@ public:
     size_t batchInsertRows(const std::string& tableName, const std::vector<std::vector<Value>>& batchData);
     // 快速批量插入（不更新索引，需要手动重建索引）
     size_t fastBatchInsertRows(const std::string& tableName, const std::vector<std::vector<Value>>& batchData);
-    bool deleteRow(const std::string& tableName, const Row& row, uint32_t recordId);
-    bool updateRow(const std::string& tableName, const Row& oldRow, const Row& newRow, uint32_t recordId);
+    bool deleteRow(const std::string& tableName, const Row& row, RID recordId);
+    bool updateRow(const std::string& tableName, const Row& oldRow, const Row& newRow, RID recordId);
     
     // 索引操作
     bool createIndex(const std::string& indexName, const std::string& tableName, 
@@ -37,21 +64,24 @@ public:
     void rebuildTableIndexes(const std::string& tableName);
     // 强制写入所有脏页面
     void flushAllPages();
+    // 清理所有表中碎片较多的数据页，返回压缩的页数
+    size_t vacuum();
     // 检查索引是否存在
     bool indexExists(const std::string& indexName) const;
     
     // 查询操作（支持索引）
-    std::vector<uint32_t> searchByIndex(const std::string& indexName, const Value& key);
-    std::vector<uint32_t> rangeSearchByIndex(const std::string& indexName, 
-                                            const Value& startKey, const Value& endKey);
-    std::vector<uint32_t> searchByColumn(const std::string& tableName, 
-                                        const std::string& columnName, const Value& key);
+    std::vector<RID> searchByIndex(const std::string& indexName, const Value& key);
+    std::vector<RID> rangeSearchByIndex(const std::string& indexName, 
+                                       const Value& startKey, const Value& endKey);
+    std::vector<RID> searchByColumn(const std::string& tableName, 
+                                   const std::string& columnName, const Value& key);
     
     // 持久化
     bool saveToStorage();
     bool loadFromStorage();
     
     // 统计和调试
+    BufferPoolStats getBufferPoolStats() const;
     void printStorageInfo() const;
     void printTableInfo(const std::string& tableName) const;
     void printIndexInfo() const;
@@ -59,14 +89,27 @@ public:
     
 private:
     std::string dbPath_;
+    bool readOnly_;
     std::unique_ptr<PageManager> pageManager_;
     std::unique_ptr<IndexManager> indexManager_;
     std::unordered_map<std::string, std::shared_ptr<Table>> tables_;
-    uint32_t nextRecordId_;
+    std::vector<uint32_t> catalogPageIds_;  // 系统目录页链表
+    
+    // 只读模式下打印错误并返回false
+    bool checkWritable(const std::string& operation) const;
     
-    // 元数据管理
+    // 元数据管理：页文件第1页为元数据页，指向保存表结构和索引定义的系统目录页链表
     bool saveMetadata();
     bool loadMetadata();
+    // 旧版本数据库（metadata.meta + .tbl文本文件）的一次性导入
+    bool importLegacyFiles();
+    // 崩溃恢复（打开数据库时代替loadFromStorage）：从最近的检查点开始一次扫描日志，
+    // 重做页面修改并找出未结束的事务；加载系统目录后补上检查点之后的目录修改、数据页和行数，
+    // 再沿撤销链回滚未结束的事务。重放过日志时最后保存一次，下次打开从新的检查点开始
+    bool recover();
+    // 检查点线程发出请求后，在事务提交之后（不在事务中时）保存系统目录快照，交给检查点线程完成检查点
+    void checkpointIfRequested();
+    std::string getLogDirectory() const;
     std::string getMetadataFileName() const;
     std::string getTableFileName(const std::string& tableName) const;
 };
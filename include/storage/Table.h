@@ -1,8 +1,14 @@
 #pragma once
 #include "Row.h"
 #include "RowIterator.h"
+#include "RowView.h"
+#include "PageGuard.h"
+#include "BPlusTree.h"
+#include "RID.h"
+#include "FreeSpaceMap.h"
 #include <vector>
 #include <string>
+#include <memory>
 #include <unordered_map>
 
 // 列定义结构
@@ -18,6 +24,7 @@ struct ColumnInfo {
 
 // 前向声明
 class PageManager;
+class Page;
 
 class Table {
 public:
@@ -32,39 +39,58 @@ public:
     int getColumnIndex(const std::string& columnName) const;
     
     // 数据操作
-    uint32_t insertRow(const Row& row);  // 返回记录ID
-    uint32_t insertRow(const std::vector<Value>& values);
+    RID insertRow(const Row& row);  // 返回记录的RID
+    RID insertRow(const std::vector<Value>& values);
     // 超快速插入（跳过约束检查和立即写盘）
-    uint32_t fastInsertRow(const Row& row);
-    bool deleteRow(uint32_t recordId);
-    bool updateRow(uint32_t recordId, const Row& newRow);
+    RID fastInsertRow(const Row& row);
+    bool deleteRow(RID recordId);
+    // 新记录放不下原页面时会迁移到其他页面，newRecordId返回迁移后的RID
+    bool updateRow(RID recordId, const Row& newRow, RID* newRecordId = nullptr);
     
-    // 查询操作
+    // 查询操作：流式遍历表的数据页，不会把整张表加载到内存
     RowIterator begin() const;
     RowIterator end() const;
     size_t getRowCount() const;
-    Row getRow(uint32_t recordId) const;  // 根据记录ID获取行
+    Row getRow(RID recordId) const;  // 根据RID获取行
+    // 零拷贝读取：返回指向页面帧的行视图，pageGuard在视图使用期间保持页面固定
+    RowView getRowView(RID recordId, ReadPageGuard& pageGuard) const;
     
     // 页面管理
     void setPageManager(PageManager* pageManager);
+    PageManager* getPageManager() const;
+    const std::vector<uint32_t>& getDataPageIds() const;
+    // 把空闲空间映射写入FSM页，返回FSM链表头页ID
+    uint32_t saveFreeSpaceMap();
+    // 打开已有的表：从FSM链表恢复页目录，不读取数据页（主键索引在第一次使用时构建）
+    bool loadStorage(uint32_t fsmRootPageId, size_t rowCount);
+    // 删除表时释放表占用的数据页和FSM页
+    void releaseStorage();
+    // 归还当前区段中还没有使用的页面（保存元数据之前调用，重启后这些页面不会泄漏）
+    void releaseUnusedExtent();
+    // 崩溃恢复和事务回滚：把重做或撤销过的数据页加入页目录并按页面内容更新空闲空间分类，
+    // 按日志中的插入和删除调整行数；两者都会让主键索引在下次使用时重新构建
+    bool containsDataPage(uint32_t pageId) const;
+    void recoverDataPage(uint32_t pageId);
+    void recoverRowCount(int64_t rowDelta);
+    // 清理：压缩碎片字节不少于minFragmentedBytes的数据页，返回压缩的页数
+    size_t vacuum(size_t minFragmentedBytes = PAGE_DATA_SIZE / 4);
     
     // 表信息
     const std::string& getTableName() const;
-    std::vector<uint32_t> getAllRecordIds() const;
+    std::vector<RID> getAllRecordIds() const;
     
     // 数据验证
     bool validateRow(const Row& row) const;
     bool validateConstraints(const Row& row) const;
-    bool validateConstraints(const Row& row, uint32_t excludeRecordId) const;
+    bool validateConstraints(const Row& row, RID excludeRecordId) const;
     bool checkNotNullConstraints(const Row& row) const;
     bool checkPrimaryKeyConstraint(const Row& row) const;
-    bool checkPrimaryKeyConstraint(const Row& row, uint32_t excludeRecordId) const;
+    bool checkPrimaryKeyConstraint(const Row& row, RID excludeRecordId) const;
     bool hasPrimaryKeyColumn() const;
     int getPrimaryKeyColumnIndex() const;
     
-    // 序列化（用于持久化）
-    std::string serialize() const;
-    static Table deserialize(const std::string& data);
+    // 导入旧版本的.tbl文件（数据以页文件为准，只在迁移旧数据库时使用）
+    static Table deserialize(const std::string& data, PageManager* pageManager);
     
     // 打印表结构和数据
     void printSchema() const;
@@ -73,27 +99,34 @@ public:
 private:
     std::string tableName_;
     std::vector<ColumnInfo> columns_;
-    std::vector<Row> rows_;  // 临时保留，用于兼容性
     std::unordered_map<std::string, size_t> columnNameToIndex_;
     
+    // 主键的隐式唯一索引（表声明了PRIMARY KEY时自动创建），用于O(log n)的重复键检查
+    std::unique_ptr<BPlusTree> primaryKeyIndex_;
+    mutable bool primaryKeyIndexStale_;   // 从页文件打开表后为true，第一次使用主键索引时扫描表数据构建
+    
     // 页面管理
     PageManager* pageManager_;
-    std::vector<uint32_t> dataPageIds_;  // 表的数据页ID列表
-    uint32_t nextRecordId_;
-    
-    // 记录ID到页面位置的映射
-    struct RecordLocation {
-        uint32_t pageId;
-        uint16_t slotId;
-        RecordLocation(uint32_t p = 0, uint16_t s = 0) : pageId(p), slotId(s) {}
-    };
-    std::unordered_map<uint32_t, RecordLocation> recordLocations_;
+    FreeSpaceMap freeSpaceMap_;           // 表的数据页目录及每页的空闲空间分类
+    size_t rowCount_;                     // 有效记录数（RID直接定位页面和槽位，不再需要记录位置映射表）
+    // 数据页按区段分配：一次申请TABLE_EXTENT_PAGES个连续页面，之后逐页使用
+    static constexpr uint32_t TABLE_EXTENT_PAGES = 8;
+    uint32_t extentNextPageId_;           // 当前区段中下一个未使用的页面
+    uint32_t extentEndPageId_;            // 当前区段之后的第一个页面
     
     void buildColumnIndex();
-    uint32_t allocateRecordId();
-    bool insertRowToPage(const Row& row, uint32_t recordId);
+    // 主键索引维护
+    void ensurePrimaryKeyIndex() const;
+    bool readPrimaryKey(RID recordId, Value& key) const;
+    void indexPrimaryKey(const Row& row, RID recordId);
+    void unindexPrimaryKey(const Value& key, RID recordId);
+    bool updateRowInPage(RID recordId, const Row& newRow, RID& newRecordId);
+    // 插入到页面，返回新记录的RID（失败返回INVALID_RID）
+    RID insertRowToPage(const Row& row);
     // 快速插入到页面（跳过约束检查和立即写盘）
-    bool fastInsertRowToPage(const Row& row, uint32_t recordId);
-    void loadRowsFromPages();  // 从页面加载数据到内存数组（用于迭代器兼容性）
-    void rebuildPageRecordLocations(uint32_t pageId);  // 重建指定页面的记录映射
+    RID fastInsertRowToPage(const Row& row);
+    // 通过空闲空间映射选择目标页（没有合适的页时分配新页）并写入记录，页面只标记为脏页
+    RID insertRecordToPage(const std::string& record);
+    // 从当前区段取出下一个页面并格式化为数据页，区段用完时申请新区段
+    uint32_t allocateDataPage();
 };
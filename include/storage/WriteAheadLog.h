@@ -0,0 +1,266 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 日志记录类型
+enum class LogRecordType : uint8_t {
+    // 事务（没有负载）
+    BEGIN = 1,
+    COMMIT = 2,
+    ABORT = 3,
+    
+    // 页面修改（物理逻辑日志：按页ID和槽位号描述修改，负载为PageLogRecord）
+    PAGE_FORMAT = 10,     // 格式化新页面，后像为1字节页类型
+    PAGE_IMAGE = 11,      // 整页写入（FSM页、系统目录页等），后像为完整的页面镜像
+    INSERT = 12,          // 在槽位中插入记录，后像为记录
+    DELETE = 13,          // 删除槽位中的记录，前像为被删除的记录
+    UPDATE = 14,          // 原地更新记录，前像和后像分别为旧记录和新记录
+    COMPACT = 15,         // 压缩页面碎片（槽位号不变）
+    COMPENSATION = 16,    // 补偿记录（CLR）：撤销时写入，只重做不撤销，负载为CompensationLogRecord
+    
+    // 页面分配
+    PAGE_ALLOC = 20,      // [u32 起始页ID][u32 页数]
+    PAGE_FREE = 21,       // [u32 起始页ID][u32 页数]
+    
+    // 系统目录（逻辑日志）
+    CREATE_TABLE = 30,    // 表结构（与系统目录中的编码相同）
+    DROP_TABLE = 31,      // [u16 长度][表名]
+    TABLE_ADD_PAGE = 32,  // [u16 长度][表名][u32 数据页ID]
+    CREATE_INDEX = 33,    // 索引定义（与系统目录中的编码相同）
+    DROP_INDEX = 34,      // [u16 长度][索引名]
+    
+    // 检查点，负载为CheckpointLogRecord
+    CHECKPOINT = 40
+};
+
+// 一条日志记录
+struct LogRecord {
+    uint64_t lsn = 0;
+    uint64_t txnId = 0;     // 0表示不属于任何事务的系统操作
+    uint64_t prevLsn = 0;   // 同一事务的上一条记录（撤销时沿这条链回退）
+    LogRecordType type = LogRecordType::BEGIN;
+    std::string payload;
+};
+
+// 页面修改记录的负载：[u32 页ID][u16 槽位号][u32 前像长度][前像][后像]
+struct PageLogRecord {
+    uint32_t pageId = 0;
+    uint16_t slotId = 0;
+    std::string before;
+    std::string after;
+    
+    std::string encode() const;
+    bool decode(const std::string& payload);
+    // 不构造记录对象直接编码（避免复制前像和后像）
+    static std::string encode(uint32_t pageId, uint16_t slotId, const std::string& before, const std::string& after);
+    // 只读取负载中的页ID（负载无效时返回0）
+    static uint32_t peekPageId(const std::string& payload);
+};
+
+// 补偿记录的负载：[u64 该事务下一条要撤销的记录LSN][u8 补偿操作的类型][补偿操作的PageLogRecord]
+// 撤销一条修改时写入，重做时按补偿操作重放；再次撤销时直接跳到undoNextLsn，撤销过的修改不会被撤销两次
+struct CompensationLogRecord {
+    uint64_t undoNextLsn = 0;
+    LogRecordType type = LogRecordType::INSERT;
+    std::string pageRecord;
+    
+    std::string encode() const;
+    bool decode(const std::string& payload);
+};
+
+// 检查点记录的负载：[u64 重做起点LSN][u32 活跃事务数]{[u64 事务ID][u64 最后一条记录LSN]}
+//                   [u64 脏页表LSN][u32 脏页数]{[u32 页ID][u64 recLsn]}
+// 重做起点之前的修改都已写入页文件；活跃事务是检查点时还没有结束的事务（恢复时从这里开始分析）。
+// 脏页表是dirtyPageTableLsn时缓冲池中还有修改没有写回的页面：LSN小于dirtyPageTableLsn的记录，
+// 页面不在脏页表中或记录早于页面的recLsn时已经在页文件中，重做时不需要读取页面（旧的检查点记录没有脏页表）
+struct CheckpointLogRecord {
+    uint64_t redoLsn = 0;
+    std::vector<std::pair<uint64_t, uint64_t>> activeTransactions;
+    uint64_t dirtyPageTableLsn = 0;
+    std::vector<std::pair<uint32_t, uint64_t>> dirtyPages;
+    
+    std::string encode() const;
+    bool decode(const std::string& payload);
+};
+
+// 表数据页链表增加页面的负载：[u16 长度][表名][u32 数据页ID]
+struct TablePageLogRecord {
+    std::string tableName;
+    uint32_t pageId = 0;
+    
+    std::string encode() const;
+    bool decode(const std::string& payload);
+};
+
+// 同步级别（持久性）：
+//   OFF    从不fdatasync，提交只把日志写入文件（进程崩溃不丢失，操作系统崩溃或断电可能丢失并损坏数据库）
+//   NORMAL 提交写入文件后返回，后台每隔syncInterval同步一次日志，检查点和脏页写回之前也会同步
+//          （断电最多丢失最近一个间隔内提交的事务，不会损坏数据库）
+//   FULL   每次提交等待提交记录持久化（组提交）
+enum class SynchronousMode : uint8_t {
+    OFF = 0,
+    NORMAL = 1,
+    FULL = 2
+};
+
+const char* synchronousModeName(SynchronousMode mode);
+// 解析"off"/"normal"/"full"（不区分大小写，也接受0/1/2），无法识别时返回false
+bool parseSynchronousMode(const std::string& text, SynchronousMode& mode);
+
+struct WalConfig {
+    // 追加缓冲区超过这个大小时先写入日志文件（不等待持久化），限制内存占用
+    size_t bufferSize = 1 << 20;
+    // 组提交等待时间：还有其他活跃事务时，领导者在写出之前等待这么久，让更多提交搭上同一次fdatasync
+    std::chrono::microseconds groupCommitDelay{0};
+    SynchronousMode synchronous = SynchronousMode::FULL;
+    // NORMAL级别下后台同步日志的间隔
+    std::chrono::milliseconds syncInterval{200};
+};
+
+struct WalStats {
+    uint64_t records = 0;        // 追加的记录数
+    uint64_t bytes = 0;          // 追加的字节数
+    uint64_t commits = 0;        // 提交的事务数
+    uint64_t flushRequests = 0;  // 等待日志持久化的请求数（提交和脏页写回）
+    uint64_t writes = 0;         // 写入日志文件的次数
+    uint64_t syncs = 0;          // fdatasync次数
+    uint64_t backgroundSyncs = 0; // 其中由NORMAL级别的后台同步完成的
+    uint64_t recycledSegments = 0;  // 检查点之后重命名为新段重用的旧段数
+    uint64_t removedSegments = 0;   // 检查点之后删除的旧段数
+    uint64_t firstLsn = 0;
+    uint64_t nextLsn = 0;
+    uint64_t flushedLsn = 0;
+};
+
+// 预写日志（WAL）：只追加的重做/撤销日志，由固定大小的段文件组成（目录中的wal_<段号>.log）。
+// LSN是记录在整个日志中的字节位置，第n段覆盖[n * SEGMENT_SIZE, (n + 1) * SEGMENT_SIZE)，
+// 段号从1开始，LSN 0表示页面从未被修改过。记录不跨段，当前段放不下时从下一段开头开始。
+//
+// 记录格式（小端）：[u32 CRC32][u32 总长度][u64 LSN][u64 事务ID][u64 上一条记录LSN][u8 类型][负载]
+// CRC覆盖长度字段之后的全部内容；记录中保存自身的LSN，读取时可以识别段中残留的旧记录。
+//
+// 段的回收：检查点之后，整段都在重做起点和最早的活跃事务之前的段不再需要，
+// 重命名为之后的段号预先备用（段中残留的记录LSN对不上，不会被当作新记录），超过保留数量的直接删除
+//
+// 组提交：追加只写入内存缓冲区；等待持久化的线程中只有一个（领导者）写出缓冲区并fdatasync，
+// 其余线程等待这次同步，领导者写出期间追加的记录由下一个领导者一起写出，
+// 多个并发提交共享一次fdatasync，每次提交的I/O只是日志末尾的一次顺序写入
+class WriteAheadLog {
+public:
+    static constexpr uint64_t SEGMENT_SIZE = 16ull * 1024 * 1024;
+    static constexpr size_t RECORD_HEADER_SIZE = 2 * sizeof(uint32_t) + 3 * sizeof(uint64_t) + sizeof(uint8_t);
+    
+    // 打开（或创建）目录中的日志，从最后一条有效记录之后继续追加
+    explicit WriteAheadLog(const std::string& directory, const WalConfig& config = WalConfig());
+    ~WriteAheadLog();
+    
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+    
+    // 只读打开数据库之前检查目录中的日志（不修改任何文件）：日志中有最近一次检查点之后的记录，
+    // 或者检查点时还有没写回的页面、没结束的事务时，页文件不是最新的状态，需要先打开日志恢复
+    static bool needsRecovery(const std::string& directory);
+    
+    bool isOpen() const;
+    const std::string& getDirectory() const;
+    
+    // 追加一条记录，返回它的LSN（失败时返回0）；记录先进入内存缓冲区，flush之后才持久化
+    // txnId不为0时记录串入该事务的撤销链
+    uint64_t append(LogRecordType type, uint64_t txnId, const std::string& payload = std::string());
+    
+    // 事务：BEGIN记录的LSN就是事务ID
+    uint64_t beginTransaction();
+    // 追加COMMIT记录，返回提交记录的LSN（失败时返回0）；waitDurable为false时只追加，
+    // 否则按同步级别（不指定时是日志的级别）：FULL等待它持久化（组提交），NORMAL和OFF等它写入日志文件
+    uint64_t commitTransaction(uint64_t txnId, bool waitDurable = true);
+    uint64_t commitTransaction(uint64_t txnId, bool waitDurable, SynchronousMode mode);
+    uint64_t abortTransaction(uint64_t txnId);
+    size_t getActiveTransactionCount() const;
+    // 活跃事务最后一条记录的LSN（回滚从这里沿prevLsn链向前撤销），事务不活跃时返回0
+    uint64_t getTransactionLastLsn(uint64_t txnId) const;
+    
+    // 等待LSN为lsn的记录及之前的所有记录持久化（OFF级别下只写入日志文件，不同步）
+    bool flush(uint64_t lsn);
+    bool flushAll();
+    
+    // 日志的同步级别，可以随时修改（NORMAL级别时运行后台同步线程）
+    void setSynchronousMode(SynchronousMode mode);
+    SynchronousMode getSynchronousMode() const;
+    
+    uint64_t getNextLsn() const;
+    uint64_t getFlushedLsn() const;
+    uint64_t getFirstLsn() const;  // 目录中最早的段的起点
+    std::vector<std::pair<uint64_t, uint64_t>> getActiveTransactions() const;  // 事务ID -> 最后一条记录的LSN
+    
+    // 读取：readRecord按LSN读取一条记录（包括还在缓冲区中的记录），scan从fromLsn开始按顺序读取
+    // 打开日志时已存在的记录，visit返回false时停止；两者在记录无效或不存在时返回false
+    bool readRecord(uint64_t lsn, LogRecord& record) const;
+    bool scan(uint64_t fromLsn, const std::function<bool(const LogRecord&)>& visit) const;
+    
+    // 最近一次完成的检查点记录的LSN（没有时为0），保存在目录中的checkpoint文件里（原子替换）
+    uint64_t getCheckpointLsn() const;
+    bool setCheckpointLsn(uint64_t checkpointLsn);
+    // 回收整段都在beforeLsn之前的段：最多保留spareSegments个备用段，返回回收的段数
+    size_t recycleSegments(uint64_t beforeLsn, size_t spareSegments);
+    
+    WalStats getStats() const;
+    void printStats() const;
+
+private:
+    std::string directory_;
+    WalConfig config_;
+    uint64_t firstLsn_;                   // 由mutex_保护
+    uint64_t openEndLsn_;                 // 打开时日志的末尾（scan读到这里为止）
+    uint64_t checkpointLsn_;
+    
+    mutable std::mutex mutex_;
+    mutable std::condition_variable flushDoneCv_;
+    std::string buffer_;                  // 尚未写入日志文件的记录（从bufferStartLsn_开始）
+    std::string spareBuffer_;             // 与buffer_交换使用，写出时不需要重新分配
+    uint64_t bufferStartLsn_;
+    uint64_t nextLsn_;
+    uint64_t writtenLsn_;                 // 之前的记录已写入日志文件
+    uint64_t flushedLsn_;                 // 之前的记录已持久化
+    bool flushing_;                       // 有领导者正在写出
+    bool failed_;                         // 写入失败后日志不再可用
+    std::unordered_map<uint64_t, uint64_t> activeTransactions_;  // 事务ID -> 最后一条记录的LSN
+    WalStats stats_;
+    
+    // 同步级别（切换段时由领导者不加锁读取）和NORMAL级别的后台同步线程（运行标志由mutex_保护）
+    std::atomic<SynchronousMode> synchronous_;
+    std::thread syncerThread_;
+    std::condition_variable syncerCv_;
+    bool syncerRunning_;
+    std::mutex syncerControlMutex_;  // 串行化同步级别的切换（在mutex_之前加锁）
+    
+    // 当前写入的段（只由领导者访问）
+    int segmentFd_;
+    uint64_t segmentNo_;
+    // 段文件的创建、重命名和删除（领导者打开新段与回收旧段互斥）
+    std::mutex segmentMutex_;
+    
+    // 等待lsn及之前的记录写入日志文件（sync为true时等待持久化），需要时成为领导者写出
+    bool waitFor(uint64_t lsn, bool sync);
+    // 持有mutex_且flushing_已设置时调用：写出缓冲区（sync为true时再fdatasync），返回时已重新加锁
+    bool writeOut(std::unique_lock<std::mutex>& lock, bool sync);
+    void stopSyncer();
+    void syncerLoop();
+    bool writeData(uint64_t startLsn, const std::string& data);
+    bool openSegment(uint64_t segmentNo);
+    void closeSegment();
+    static std::string segmentPath(const std::string& directory, uint64_t segmentNo);
+    static std::string checkpointPath(const std::string& directory);
+    static uint64_t readCheckpointFile(const std::string& directory);
+    // 扫描段文件，返回最后一条有效记录之后的段内偏移
+    static uint64_t scanSegment(int fd, uint64_t segmentNo);
+};
@@ -16,6 +16,20 @@
 #include "./include/executor/ExecutionEngine.h"
 #include <iomanip>
 #include <sstream>
+#include <functional>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include <unordered_map>
+#include <unordered_set>
+#ifndef _WIN32
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 // 美化显示查询结果的函数
 void printQueryResult(const ExecutionResult& result) {
@@ -23,14 +37,14 @@ void printQueryResult(const ExecutionResult& result) {
         std::cout << "x Query failed: " << result.message << std::endl;
         return;
     }
-
+    
     if (result.rows.empty()) {
         std::cout << "v Query successful. No rows returned." << std::endl;
         return;
     }
-
+    
     std::cout << "v Query successful. Found " << result.rows.size() << " rows:" << std::endl;
-
+    
     // 如果有列信息，显示表格格式
     if (!result.columnInfo.empty()) {
         // 计算每列的最大宽度
@@ -231,8 +245,8 @@ void testIndexPerformance() {
                     std::cout << "Inserted " << insertCount << " records..." << std::endl;
                 }
             }
-
-
+            
+            
             // 插入一个特殊的100岁雇员记录，作为唯一的100岁雇员
             std::cout << "Inserting special 100-year-old employee..." << std::endl;
             std::ostringstream specialInsertSQL;
@@ -252,7 +266,7 @@ void testIndexPerformance() {
             } else {
                 std::cout << "x Failed to parse special INSERT" << std::endl;
             }
-
+            
             
             auto end_insert = std::chrono::high_resolution_clock::now();
             auto insert_duration = std::chrono::duration_cast<std::chrono::microseconds>(end_insert - start_insert);
@@ -429,18 +443,960 @@ void testIndexPerformance() {
         std::cerr << "Exception occurred during performance testing: " << e.what() << std::endl;
     }
 }
+void benchmarkRowCodec() {
+    std::cout << "=== Row Codec Benchmark (binary vs legacy text) ===" << std::endl;
+    
+    const int ROW_COUNT = 200000;
+    std::vector<std::string> names = {"Alice", "Bob", "Charlie", "David", "Eve", "Frank", "Grace", "Henry", "Ivy", "Jack"};
+    
+    std::vector<Row> rows;
+    rows.reserve(ROW_COUNT);
+    for (int i = 0; i < ROW_COUNT; ++i) {
+        rows.emplace_back(std::vector<Value>{i, names[i % names.size()] + std::to_string(i),
+                                             std::string("Engineering"), 20 + (i % 45), 30000.0 + i * 5.25});
+    }
+    
+    auto runCodec = [&rows](const std::string& label,
+                            const std::function<std::string(const Row&)>& encode,
+                            const std::function<Row(const std::string&)>& decode) {
+        std::vector<std::string> encoded;
+        encoded.reserve(rows.size());
+        
+        auto start_encode = std::chrono::high_resolution_clock::now();
+        size_t totalBytes = 0;
+        for (const auto& row : rows) {
+            encoded.push_back(encode(row));
+            totalBytes += encoded.back().size();
+        }
+        auto end_encode = std::chrono::high_resolution_clock::now();
+        
+        auto start_decode = std::chrono::high_resolution_clock::now();
+        size_t fieldChecksum = 0;
+        for (const auto& data : encoded) {
+            fieldChecksum += decode(data).getFieldCount();
+        }
+        auto end_decode = std::chrono::high_resolution_clock::now();
+        
+        // 校验编解码往返结果一致（文本格式的DOUBLE只保留6位有效数字，会出现精度损失）
+        size_t mismatches = fieldChecksum == rows.size() * rows[0].getFieldCount() ? 0 : 1;
+        for (size_t i = 0; i < rows.size(); i += 997) {
+            if (!(decode(encoded[i]) == rows[i])) {
+                mismatches++;
+            }
+        }
+        
+        auto encode_us = std::chrono::duration_cast<std::chrono::microseconds>(end_encode - start_encode).count();
+        auto decode_us = std::chrono::duration_cast<std::chrono::microseconds>(end_decode - start_decode).count();
+        double encodeRate = encode_us > 0 ? rows.size() * 1000000.0 / encode_us : 0.0;
+        double decodeRate = decode_us > 0 ? rows.size() * 1000000.0 / decode_us : 0.0;
+        
+        std::cout << std::left << std::setw(10) << label
+                  << std::setw(14) << (std::to_string(totalBytes / rows.size()) + " B/row")
+                  << std::setw(22) << (std::to_string(static_cast<long long>(encodeRate)) + " enc rows/s")
+                  << std::setw(22) << (std::to_string(static_cast<long long>(decodeRate)) + " dec rows/s")
+                  << (mismatches == 0 ? "roundtrip ok" : "lossy roundtrip") << std::endl;
+        return std::make_pair(encode_us, decode_us);
+    };
+    
+    std::cout << "Encoding and decoding " << ROW_COUNT << " rows (INT, STRING, STRING, INT, DOUBLE)" << std::endl;
+    auto text = runCodec("text",
+                         [](const Row& row) { return row.serializeLegacyText(); },
+                         [](const std::string& data) { return Row::deserializeLegacyText(data); });
+    auto binary = runCodec("binary",
+                           [](const Row& row) { return row.serialize(); },
+                           [](const std::string& data) { return Row::deserialize(data); });
+    
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Encode speedup: " << (binary.first > 0 ? static_cast<double>(text.first) / binary.first : 0.0) << "x" << std::endl;
+    std::cout << "Decode speedup: " << (binary.second > 0 ? static_cast<double>(text.second) / binary.second : 0.0) << "x" << std::endl;
+    std::cout << "=== Row Codec Benchmark Completed ===" << std::endl;
+}
+
+void benchmarkBulkDelete() {
+    std::cout << "=== Bulk Delete Benchmark (eager vs lazy page compaction) ===" << std::endl;
+    
+    const uint32_t PAGE_COUNT = 2000;
+    const std::string record = Row(std::vector<Value>{12345, std::string("bulk-delete-payload"), 3.14}).serialize();
+    
+    // 构造一批写满记录的页面
+    auto buildPages = [&]() {
+        std::vector<std::unique_ptr<Page>> pages;
+        pages.reserve(PAGE_COUNT);
+        for (uint32_t pageId = 1; pageId <= PAGE_COUNT; ++pageId) {
+            auto page = std::make_unique<Page>(pageId);
+            while (page->insertRecordAndReturnSlot(record) != UINT16_MAX) {
+            }
+            pages.push_back(std::move(page));
+        }
+        return pages;
+    };
+    
+    // 逐条删除页面中的所有记录，eager模式下模拟旧实现：每次删除后立即压缩整页
+    auto runDelete = [&](const std::string& label, bool eager) {
+        auto pages = buildPages();
+        size_t deletedRows = 0;
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        for (auto& page : pages) {
+            for (uint16_t slotId = 0; slotId < page->getSlotCount(); ++slotId) {
+                if (page->deleteRecord(slotId)) {
+                    ++deletedRows;
+                    if (eager) {
+                        page->compactPage();
+                    }
+                }
+            }
+            if (!eager) {
+                // 懒压缩：整批删除结束后由清理过程一次性回收
+                page->compactPage();
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        double rate = us > 0 ? deletedRows * 1000000.0 / us : 0.0;
+        std::cout << std::left << std::setw(8) << label
+                  << std::setw(16) << (std::to_string(deletedRows) + " rows")
+                  << std::setw(14) << (std::to_string(us / 1000) + " ms")
+                  << std::to_string(static_cast<long long>(rate)) << " rows/s" << std::endl;
+        return us;
+    };
+    
+    std::cout << "Deleting every record from " << PAGE_COUNT << " full pages (" 
+              << record.size() << "-byte records)" << std::endl;
+    auto eagerUs = runDelete("eager", true);
+    auto lazyUs = runDelete("lazy", false);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Speedup: " << (lazyUs > 0 ? static_cast<double>(eagerUs) / lazyUs : 0.0) << "x" << std::endl;
+    
+    // 表级吞吐量：通过Table::deleteRow逐条删除（包括缓冲池访问和空闲空间映射维护）
+    const std::string benchDir = "bench_bulk_delete";
+    std::filesystem::remove_all(benchDir);
+    std::filesystem::create_directories(benchDir);
+    {
+        StorageEngine storage(benchDir);
+        storage.createTable("bulk", {ColumnInfo("id", DataType::INT), ColumnInfo("name", DataType::STRING),
+                                     ColumnInfo("score", DataType::DOUBLE)});
+        std::vector<std::vector<Value>> batch;
+        const int TABLE_ROWS = 10000;
+        for (int i = 0; i < TABLE_ROWS; ++i) {
+            batch.push_back({i, std::string("row") + std::to_string(i), i * 0.5});
+        }
+        storage.fastBatchInsertRows("bulk", batch);
+        
+        auto table = storage.getTable("bulk");
+        std::vector<RID> recordIds = table->getAllRecordIds();
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t deletedRows = 0;
+        for (RID recordId : recordIds) {
+            if (table->deleteRow(recordId)) {
+                ++deletedRows;
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        std::cout << "Table delete: " << deletedRows << " rows in " << us / 1000 << " ms ("
+                  << static_cast<long long>(us > 0 ? deletedRows * 1000000.0 / us : 0.0) << " rows/s), "
+                  << "vacuum compacted " << table->vacuum(0) << " pages" << std::endl;
+    }
+    std::filesystem::remove_all(benchDir);
+    
+    std::cout << "=== Bulk Delete Benchmark Completed ===" << std::endl;
+}
+
+// 内存中的磁盘后端：读取任意页面都返回一个空页面镜像，只用于回放访问序列
+class TraceDiskBackend : public DiskBackend {
+public:
+    TraceDiskBackend() : DiskBackend(":trace:") {}
+    
+    bool readPage(uint32_t pageId, uint8_t* data) override {
+        Page(pageId).serializeTo(data);
+        return true;
+    }
+    bool writePage(uint32_t, const uint8_t*) override { return true; }
+    bool sync() override { return true; }
+    uint32_t getPageCount() override { return 0; }
+};
+
+void benchmarkReplacementPolicy() {
+    std::cout << "=== Buffer Replacement Policy Benchmark (trace replay hit ratios) ===" << std::endl;
+    
+    // 模拟的页面布局：B+树索引（根页 + 内部页 + 叶子页）和一张远大于缓冲池的数据表
+    const size_t POOL_FRAMES = 128;
+    const uint32_t ROOT_PAGE = 1;
+    const uint32_t INNER_BEGIN = 2, INNER_COUNT = 15;
+    const uint32_t LEAF_BEGIN = 17, LEAF_COUNT = 100;
+    const uint32_t TABLE_BEGIN = 1001, TABLE_PAGES = 4000;
+    
+    std::mt19937 rng(42);
+    auto pointLookup = [&](std::vector<uint32_t>& trace) {
+        // 点查：根页 -> 内部页 -> 叶子页（80%的查询落在20%的叶子上）-> 数据页
+        std::uniform_int_distribution<uint32_t> inner(0, INNER_COUNT - 1);
+        std::uniform_int_distribution<uint32_t> hotLeaf(0, LEAF_COUNT / 5 - 1);
+        std::uniform_int_distribution<uint32_t> anyLeaf(0, LEAF_COUNT - 1);
+        std::uniform_int_distribution<uint32_t> percent(0, 99);
+        std::uniform_int_distribution<uint32_t> tablePage(0, TABLE_PAGES - 1);
+        trace.push_back(ROOT_PAGE);
+        trace.push_back(INNER_BEGIN + inner(rng));
+        trace.push_back(LEAF_BEGIN + (percent(rng) < 80 ? hotLeaf(rng) : anyLeaf(rng)));
+        trace.push_back(TABLE_BEGIN + tablePage(rng));
+    };
+    auto seqScan = [&](std::vector<uint32_t>& trace) {
+        for (uint32_t i = 0; i < TABLE_PAGES; ++i) {
+            trace.push_back(TABLE_BEGIN + i);
+        }
+    };
+    
+    // 访问序列：
+    //   point  纯点查
+    //   burst  点查和整段的全表扫描交替进行
+    //   mixed  全表扫描与点查并发（每读一个扫描页面穿插一次点查）
+    std::vector<std::pair<std::string, std::vector<uint32_t>>> traces;
+    {
+        std::vector<uint32_t> trace;
+        for (int i = 0; i < 20000; ++i) {
+            pointLookup(trace);
+        }
+        traces.emplace_back("point", std::move(trace));
+    }
+    {
+        std::vector<uint32_t> trace;
+        for (int round = 0; round < 5; ++round) {
+            for (int i = 0; i < 4000; ++i) {
+                pointLookup(trace);
+            }
+            seqScan(trace);
+        }
+        traces.emplace_back("burst", std::move(trace));
+    }
+    {
+        std::vector<uint32_t> scan;
+        seqScan(scan);
+        std::vector<uint32_t> trace;
+        for (int round = 0; round < 5; ++round) {
+            for (uint32_t pageId : scan) {
+                trace.push_back(pageId);
+                pointLookup(trace);
+            }
+        }
+        traces.emplace_back("mixed", std::move(trace));
+    }
+    
+    const ReplacementPolicyType policies[] = {ReplacementPolicyType::LRU, ReplacementPolicyType::CLOCK,
+                                              ReplacementPolicyType::LRU_K, ReplacementPolicyType::TWO_Q};
+    
+    std::cout << POOL_FRAMES << " frames, index of " << (1 + INNER_COUNT + LEAF_COUNT) << " pages, table of "
+              << TABLE_PAGES << " pages" << std::endl;
+    std::cout << std::left << std::setw(8) << "trace" << std::setw(10) << "accesses";
+    for (auto policy : policies) {
+        std::cout << std::setw(10) << replacementPolicyName(policy);
+    }
+    std::cout << std::endl;
+    
+    std::cout << std::fixed << std::setprecision(2);
+    for (const auto& trace : traces) {
+        std::cout << std::left << std::setw(8) << trace.first << std::setw(10) << trace.second.size();
+        for (auto policy : policies) {
+            // 单分片：直接比较置换策略本身，不受分片划分的影响
+            BufferPool pool(POOL_FRAMES, std::make_unique<TraceDiskBackend>(), policy, 1);
+            for (uint32_t pageId : trace.second) {
+                if (pool.getPage(pageId)) {
+                    pool.unpinPage(pageId);
+                }
+            }
+            std::ostringstream ratio;
+            ratio << std::fixed << std::setprecision(2) << pool.getStats().getHitRatio() * 100 << "%";
+            std::cout << std::setw(10) << ratio.str();
+        }
+        std::cout << std::endl;
+    }
+    
+    std::cout << "=== Buffer Replacement Policy Benchmark Completed ===" << std::endl;
+}
+
+void benchmarkBufferPoolConcurrency() {
+    std::cout << "=== Buffer Pool Concurrency Benchmark (getPage throughput) ===" << std::endl;
+    
+    // 工作集全部驻留在缓冲池中，测量的是命中路径上的锁竞争
+    // （工作集取缓冲池的一半：页面按哈希分到各分片，不均匀时整池大小的工作集会让部分分片发生淘汰）
+    const size_t POOL_FRAMES = 1024;
+    const uint32_t WORKING_SET = 512;
+    const size_t OPS_PER_THREAD = 200000;
+    const size_t threadCounts[] = {1, 2, 4, 8, 16, 32};
+    
+    auto runWorkload = [&](BufferPool& pool, size_t threadCount) {
+        std::atomic<bool> start(false);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&, t]() {
+                std::mt19937 rng(static_cast<unsigned>(t + 1));
+                std::uniform_int_distribution<uint32_t> pageDist(1, WORKING_SET);
+                while (!start.load()) {
+                    std::this_thread::yield();
+                }
+                for (size_t i = 0; i < OPS_PER_THREAD; ++i) {
+                    uint32_t pageId = pageDist(rng);
+                    if (pool.getPage(pageId)) {
+                        pool.unpinPage(pageId);
+                    }
+                }
+            });
+        }
+        
+        auto begin = std::chrono::high_resolution_clock::now();
+        start = true;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(end - begin).count();
+        return seconds > 0 ? threadCount * OPS_PER_THREAD / seconds : 0.0;
+    };
+    
+    BufferPool singlePool(POOL_FRAMES, std::make_unique<TraceDiskBackend>(), ReplacementPolicyType::TWO_Q, 1);
+    BufferPool shardedPool(POOL_FRAMES, std::make_unique<TraceDiskBackend>(), ReplacementPolicyType::TWO_Q);
+    for (uint32_t pageId = 1; pageId <= WORKING_SET; ++pageId) {
+        for (BufferPool* pool : {&singlePool, &shardedPool}) {
+            if (pool->getPage(pageId)) {
+                pool->unpinPage(pageId);
+            }
+        }
+    }
+    
+    std::cout << POOL_FRAMES << " frames, " << WORKING_SET << " hot pages, " << OPS_PER_THREAD
+              << " getPage+unpinPage per thread, " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+    std::cout << std::left << std::setw(10) << "threads" << std::setw(20) << "1 shard (ops/s)"
+              << std::setw(24) << (std::to_string(shardedPool.getShardCount()) + " shards (ops/s)") << "speedup" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (size_t threadCount : threadCounts) {
+        double single = runWorkload(singlePool, threadCount);
+        double sharded = runWorkload(shardedPool, threadCount);
+        std::cout << std::left << std::setw(10) << threadCount
+                  << std::setw(20) << static_cast<long long>(single)
+                  << std::setw(24) << static_cast<long long>(sharded)
+                  << (single > 0 ? sharded / single : 0.0) << "x" << std::endl;
+    }
+    
+    std::cout << "=== Buffer Pool Concurrency Benchmark Completed ===" << std::endl;
+}
+
+void benchmarkColdScanIo() {
+    std::cout << "=== Cold Scan I/O Benchmark (synchronous pread vs io_uring) ===" << std::endl;
+#ifdef _WIN32
+    std::cout << "pread/io_uring backends are not available on this platform" << std::endl;
+#else
+    const std::string FILE_NAME = "coldscan_bench.db";
+    const uint32_t PAGE_COUNT = 16384;     // 64MB数据文件
+    const size_t POOL_FRAMES = 1024;
+    const uint32_t WRITE_BACK_PAGES = 4096;
+    
+    // 生成数据文件：每页写满记录
+    {
+        std::filesystem::remove(FILE_NAME);
+        auto backend = createDiskBackend(FILE_NAME, false, IoEngine::SYNC);
+        const std::string record = Row(std::vector<Value>{12345, std::string("cold-scan-payload"), 3.14}).serialize();
+        const uint32_t CHUNK = 256;
+        AlignedPageBuffer buffer(CHUNK);
+        for (uint32_t first = 1; first <= PAGE_COUNT; first += CHUNK) {
+            std::vector<PageWriteRequest> requests;
+            for (uint32_t i = 0; i < CHUNK && first + i <= PAGE_COUNT; ++i) {
+                Page page(first + i);
+                while (page.insertRecordAndReturnSlot(record) != UINT16_MAX) {
+                }
+                page.serializeTo(buffer.data() + i * PAGE_SIZE);
+                requests.push_back({first + i, buffer.data() + i * PAGE_SIZE, false});
+            }
+            backend->writePageBatch(requests);
+        }
+        backend->sync();
+    }
+    
+    // 用O_DIRECT打开，每次扫描都从设备读取，不受页缓存影响
+    // 扫描方式与TableHeapIterator相同：剩余预读页面不足一半时请求下一个窗口，
+    // 窗口包含runsAhead组、每组runPages个相邻页面，每组合并为一次读取
+    auto runScan = [&](IoEngine engine, size_t runPages, size_t runsAhead) {
+        auto backend = createDiskBackend(FILE_NAME, true, engine);
+        std::string engineName = backend->getEngineName();
+        BufferPool pool(POOL_FRAMES, std::move(backend), ReplacementPolicyType::TWO_Q);
+        pool.setPrefetchDepth(runPages);
+        uint32_t window = static_cast<uint32_t>(runPages * runsAhead);
+        
+        size_t slots = 0;
+        uint32_t prefetchedUntil = 1;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t pageId = 1; pageId <= PAGE_COUNT; ++pageId) {
+            if (window > 0 && prefetchedUntil <= pageId + window / 2) {
+                std::vector<uint32_t> pageIds;
+                for (uint32_t id = std::max(prefetchedUntil, pageId + 1); id <= std::min(PAGE_COUNT, pageId + window); ++id) {
+                    pageIds.push_back(id);
+                }
+                if (!pageIds.empty()) {
+                    pool.prefetchPages(pageIds);
+                    prefetchedUntil = pageIds.back() + 1;
+                }
+            }
+            if (Page* page = pool.getPage(pageId)) {
+                slots += page->getSlotCount();
+                pool.unpinPage(pageId);
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        double seconds = std::chrono::duration<double>(end - start).count();
+        double mbPerSecond = seconds > 0 ? PAGE_COUNT * PAGE_SIZE / seconds / (1024.0 * 1024.0) : 0.0;
+        BufferPoolStats stats = pool.getStats();
+        std::cout << std::left << std::setw(20) << engineName
+                  << std::setw(10) << runPages
+                  << std::setw(10) << runsAhead
+                  << std::setw(12) << (std::to_string(static_cast<long long>(seconds * 1000)) + " ms")
+                  << std::setw(12) << mbPerSecond
+                  << std::setw(10) << (stats.getHitRatio() * 100.0)
+                  << (slots > 0 ? "" : "(no rows)") << std::endl;
+        return mbPerSecond;
+    };
+    
+    // 检查点写回：缓冲池中分散在整个文件里的脏页一次性写回
+    auto runWriteBack = [&](IoEngine engine) {
+        auto backend = createDiskBackend(FILE_NAME, true, engine);
+        std::string engineName = backend->getEngineName();
+        BufferPool pool(WRITE_BACK_PAGES, std::move(backend), ReplacementPolicyType::TWO_Q);
+        std::mt19937 rng(42);
+        std::vector<uint32_t> pageIds(PAGE_COUNT);
+        for (uint32_t i = 0; i < PAGE_COUNT; ++i) {
+            pageIds[i] = i + 1;
+        }
+        std::shuffle(pageIds.begin(), pageIds.end(), rng);
+        pageIds.resize(WRITE_BACK_PAGES);
+        for (uint32_t pageId : pageIds) {
+            if (pool.getPage(pageId)) {
+                pool.unpinPage(pageId, true);
+            }
+        }
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        pool.flushAllPages();
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        double pagesPerSecond = seconds > 0 ? WRITE_BACK_PAGES / seconds : 0.0;
+        std::cout << std::left << std::setw(20) << engineName
+                  << std::setw(12) << (std::to_string(static_cast<long long>(seconds * 1000)) + " ms")
+                  << static_cast<long long>(pagesPerSecond) << " pages/s" << std::endl;
+        return pagesPerSecond;
+    };
+    
+    std::cout << "Sequential scan of " << PAGE_COUNT << " pages (" << PAGE_COUNT * PAGE_SIZE / (1024 * 1024)
+              << "MB) through a " << POOL_FRAMES << "-frame pool" << std::endl;
+    std::cout << std::left << std::setw(20) << "engine" << std::setw(10) << "run" << std::setw(10) << "runs"
+              << std::setw(12) << "time" << std::setw(12) << "MB/s" << std::setw(10) << "hit %" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    const std::pair<size_t, size_t> configs[] = {{0, 0}, {8, 1}, {8, 4}, {32, 4}};
+    for (const auto& config : configs) {
+        double sync = runScan(IoEngine::SYNC, config.first, config.second);
+        double uring = runScan(IoEngine::IO_URING, config.first, config.second);
+        std::cout << "  io_uring / sync: " << std::setprecision(2) << (sync > 0 ? uring / sync : 0.0) << "x"
+                  << std::setprecision(1) << std::endl;
+    }
+    
+    std::cout << "Checkpoint write-back of " << WRITE_BACK_PAGES << " dirty pages scattered over the file" << std::endl;
+    double syncWrite = runWriteBack(IoEngine::SYNC);
+    double uringWrite = runWriteBack(IoEngine::IO_URING);
+    std::cout << "  io_uring / sync: " << std::setprecision(2) << (syncWrite > 0 ? uringWrite / syncWrite : 0.0) << "x" << std::endl;
+    
+    std::filesystem::remove(FILE_NAME);
+#endif
+    std::cout << "=== Cold Scan I/O Benchmark Completed ===" << std::endl;
+}
+
+#ifndef _WIN32
+// 崩溃测试中子进程报告的状态：提交之前报告提交后的状态（PENDING），提交返回后再报告一次（COMMITTED）
+struct CrashTestReport {
+    int32_t committed;
+    int64_t rows;
+    int64_t balanceSum;
+};
+
+// 子进程的写入负载：多语句事务随机插入、更新（记录长度变化，部分行会迁移到其他页面）和删除，
+// 后台检查点频繁触发，偶尔保存一次，一直运行到被父进程杀死。
+// 进程被杀死时操作系统仍在运行，三种同步级别都不能丢失已提交的事务
+void runCrashWorkload(const std::string& dbPath, int reportFd, unsigned seed, SynchronousMode synchronous) {
+    std::freopen("/dev/null", "w", stdout);
+    StorageEngine storage(dbPath);
+    storage.setSynchronousMode(synchronous);
+    CheckpointConfig checkpointConfig;
+    checkpointConfig.logBytes = 128 * 1024;
+    checkpointConfig.interval = std::chrono::milliseconds(50);
+    storage.setCheckpointConfig(checkpointConfig);
+    if (!storage.tableExists("accounts")) {
+        storage.createTable("accounts", {ColumnInfo("id", DataType::INT, true, true),
+                                         ColumnInfo("balance", DataType::INT), ColumnInfo("note", DataType::STRING)});
+    }
+    auto table = storage.getTable("accounts");
+    const std::string PK_INDEX = "pk_accounts_id";
+    
+    // 从表中重建模型：id -> balance
+    std::unordered_map<int, int> balances;
+    std::vector<int> ids;
+    int nextId = 1;
+    int64_t balanceSum = 0;
+    for (auto it = table->begin(); it != table->end(); ++it) {
+        int id = std::get<int>(it.view().getValue(0));
+        int balance = std::get<int>(it.view().getValue(1));
+        balances[id] = balance;
+        ids.push_back(id);
+        balanceSum += balance;
+        nextId = std::max(nextId, id + 1);
+    }
+    
+    std::mt19937 rng(seed);
+    auto randomNote = [&]() { return std::string(10 + rng() % 300, static_cast<char>('a' + rng() % 26)); };
+    auto report = [&](bool committed) {
+        CrashTestReport message{committed ? 1 : 0, static_cast<int64_t>(ids.size()), balanceSum};
+        if (write(reportFd, &message, sizeof(message)) != sizeof(message)) {
+            _exit(1);
+        }
+    };
+    
+    report(true); // 打开时的状态（上一轮恢复之后的结果）
+    
+    for (uint64_t txn = 1;; ++txn) {
+        storage.beginTransaction();
+        size_t ops = 1 + rng() % 8;
+        for (size_t op = 0; op < ops; ++op) {
+            uint32_t kind = rng() % 10;
+            if (kind < 5 || ids.empty()) {
+                int id = nextId++;
+                int balance = static_cast<int>(rng() % 1000);
+                if (storage.insertRow("accounts", std::vector<Value>{id, balance, randomNote()})) {
+                    balances[id] = balance;
+                    ids.push_back(id);
+                    balanceSum += balance;
+                }
+                continue;
+            }
+            
+            size_t pos = rng() % ids.size();
+            int id = ids[pos];
+            std::vector<RID> rids = storage.searchByIndex(PK_INDEX, Value(id));
+            if (rids.size() != 1) {
+                std::cerr << "Crash workload: primary key " << id << " has " << rids.size() << " entries" << std::endl;
+                _exit(1);
+            }
+            Row oldRow = table->getRow(rids[0]);
+            if (kind < 8) {
+                int balance = static_cast<int>(rng() % 1000);
+                Row newRow(std::vector<Value>{id, balance, randomNote()});
+                if (storage.updateRow("accounts", oldRow, newRow, rids[0])) {
+                    balanceSum += balance - balances[id];
+                    balances[id] = balance;
+                }
+            } else if (storage.deleteRow("accounts", oldRow, rids[0])) {
+                balanceSum -= balances[id];
+                balances.erase(id);
+                ids[pos] = ids.back();
+                ids.pop_back();
+            }
+        }
+        report(false);
+        storage.commitTransaction();
+        report(true);
+        
+        if (txn % 500 == 0) {
+            storage.saveToStorage();
+        }
+    }
+}
+#endif
+
+void testCrashRecovery() {
+    std::cout << "=== Crash Recovery Fault-Injection Test ===" << std::endl;
+#ifdef _WIN32
+    std::cout << "Fault injection needs fork/kill and is not available on this platform" << std::endl;
+#else
+    const std::string DB_PATH = "./crash_test_db";
+    const int ROUNDS = 20;
+    std::filesystem::remove_all(DB_PATH);
+    std::mt19937 rng(20240601);
+    int failures = 0;
+    // 上一轮恢复后的状态：子进程在报告打开时的状态之前就被杀死时，数据库应该保持这个状态
+    CrashTestReport lastState{1, 0, 0};
+    
+    for (int round = 1; round <= ROUNDS; ++round) {
+        SynchronousMode synchronous = static_cast<SynchronousMode>(round % 3);
+        int pipeFds[2];
+        if (pipe(pipeFds) != 0) {
+            std::cerr << "pipe failed" << std::endl;
+            return;
+        }
+        std::cout.flush();
+        pid_t child = fork();
+        if (child < 0) {
+            std::cerr << "fork failed" << std::endl;
+            return;
+        }
+        if (child == 0) {
+            close(pipeFds[0]);
+            runCrashWorkload(DB_PATH, pipeFds[1], static_cast<unsigned>(rng()), synchronous);
+            _exit(0);
+        }
+        
+        // 在随机时刻杀死子进程（不给它任何清理的机会）
+        close(pipeFds[1]);
+        int delayMs = 50 + static_cast<int>(rng() % 400);
+        std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+        kill(child, SIGKILL);
+        waitpid(child, nullptr, 0);
+        
+        // 最后一次确认提交的状态，以及之后正在提交的状态（提交记录可能已经持久化）
+        CrashTestReport committed = lastState;
+        CrashTestReport pending{0, -1, 0};
+        bool hasCommitted = false;
+        CrashTestReport message;
+        while (read(pipeFds[0], &message, sizeof(message)) == sizeof(message)) {
+            if (message.committed) {
+                committed = message;
+                hasCommitted = true;
+                pending.rows = -1;
+            } else {
+                pending = message;
+            }
+        }
+        close(pipeFds[0]);
+        
+        // 重新打开（崩溃恢复），扫描表并逐行检查主键索引
+        std::streambuf* originalOut = std::cout.rdbuf();
+        std::ostringstream engineOutput;
+        std::cout.rdbuf(engineOutput.rdbuf());
+        int64_t rows = 0;
+        int64_t balanceSum = 0;
+        size_t indexErrors = 0;
+        size_t recordedRows = 0;
+        bool tableFound = false;
+        {
+            StorageEngine storage(DB_PATH);
+            auto table = storage.getTable("accounts");
+            if (table) {
+                tableFound = true;
+                std::unordered_set<int> seen;
+                for (auto it = table->begin(); it != table->end(); ++it) {
+                    int id = std::get<int>(it.view().getValue(0));
+                    balanceSum += std::get<int>(it.view().getValue(1));
+                    ++rows;
+                    std::vector<RID> rids = storage.searchByIndex("pk_accounts_id", Value(id));
+                    if (!seen.insert(id).second || rids.size() != 1 || rids[0] != it.getRID()) {
+                        ++indexErrors;
+                    }
+                }
+                recordedRows = table->getRowCount();
+            }
+        }
+        std::cout.rdbuf(originalOut);
+        
+        bool matchesCommitted = rows == committed.rows && balanceSum == committed.balanceSum;
+        bool matchesPending = rows == pending.rows && balanceSum == pending.balanceSum;
+        bool ok = (tableFound || !hasCommitted) && (matchesCommitted || matchesPending) && indexErrors == 0 &&
+                  recordedRows == static_cast<size_t>(rows);
+        if (!ok) {
+            ++failures;
+        } else {
+            lastState = CrashTestReport{1, rows, balanceSum};
+        }
+        
+        std::string recoveryLine;
+        std::istringstream lines(engineOutput.str());
+        for (std::string line; std::getline(lines, line);) {
+            if (line.rfind("Recovered from write-ahead log", 0) == 0) {
+                recoveryLine = line.substr(line.find(':') + 2);
+            }
+        }
+        std::cout << "Round " << std::setw(2) << round << " (" << std::setw(6) << synchronousModeName(synchronous)
+                  << "): killed after " << std::setw(3) << delayMs << " ms, "
+                  << rows << " rows (committed " << committed.rows << (matchesPending && !matchesCommitted ? ", in-flight commit survived" : "")
+                  << "), row count " << recordedRows << ", index errors " << indexErrors
+                  << (ok ? "  OK" : "  FAILED") << std::endl;
+        if (!recoveryLine.empty()) {
+            std::cout << "          recovery: " << recoveryLine << std::endl;
+        }
+    }
+    
+    std::filesystem::remove_all(DB_PATH);
+    std::cout << (failures == 0 ? "All rounds recovered to a committed state"
+                                : std::to_string(failures) + " rounds FAILED") << std::endl;
+#endif
+    std::cout << "=== Crash Recovery Fault-Injection Test Completed ===" << std::endl;
+}
+
+// 崩溃后只读打开：只读模式不能重做日志，页文件不是最新的状态时必须拒绝打开；
+// 读写打开完成恢复之后，只读打开看到的应该与恢复后的结果相同
+void testReadOnlyAfterCrash() {
+    std::cout << "=== Read-Only Open After Crash Test ===" << std::endl;
+#ifdef _WIN32
+    std::cout << "Fault injection needs fork/kill and is not available on this platform" << std::endl;
+#else
+    const std::string DB_PATH = "./readonly_crash_test_db";
+    const int ROUNDS = 3;
+    std::filesystem::remove_all(DB_PATH);
+    std::mt19937 rng(20240715);
+    int failures = 0;
+    
+    for (int round = 1; round <= ROUNDS; ++round) {
+        int pipeFds[2];
+        if (pipe(pipeFds) != 0) {
+            std::cerr << "pipe failed" << std::endl;
+            return;
+        }
+        std::cout.flush();
+        pid_t child = fork();
+        if (child < 0) {
+            std::cerr << "fork failed" << std::endl;
+            return;
+        }
+        if (child == 0) {
+            close(pipeFds[0]);
+            runCrashWorkload(DB_PATH, pipeFds[1], static_cast<unsigned>(rng()), SynchronousMode::FULL);
+            _exit(0);
+        }
+        
+        // 第一轮在新数据库第一次保存之前杀死子进程（元数据页只被格式化过），之后的轮次在写入过程中杀死
+        close(pipeFds[1]);
+        int delayMs = round == 1 ? 100 : 200 + static_cast<int>(rng() % 300);
+        std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+        kill(child, SIGKILL);
+        waitpid(child, nullptr, 0);
+        CrashTestReport message;
+        while (read(pipeFds[0], &message, sizeof(message)) == sizeof(message)) {
+            // 这里只检查打开方式，不需要子进程报告的状态
+        }
+        close(pipeFds[0]);
+        
+        std::streambuf* originalOut = std::cout.rdbuf();
+        std::ostringstream engineOutput;
+        std::cout.rdbuf(engineOutput.rdbuf());
+        auto countRows = [](StorageEngine& storage) -> int64_t {
+            auto table = storage.getTable("accounts");
+            return table ? static_cast<int64_t>(table->getRowCount()) : -1;
+        };
+        
+        // 1. 崩溃后直接只读打开：应该报告需要恢复
+        std::string refusal;
+        try {
+            StorageEngine storage(DB_PATH, true);
+        } catch (const std::runtime_error& e) {
+            refusal = e.what();
+        }
+        // 2. 读写打开完成恢复，正常关闭
+        int64_t recoveredRows = -1;
+        {
+            StorageEngine storage(DB_PATH);
+            recoveredRows = countRows(storage);
+        }
+        // 3. 恢复之后只读打开：应该成功，看到恢复后的数据
+        int64_t readOnlyRows = -1;
+        std::string reopenError;
+        try {
+            StorageEngine storage(DB_PATH, true);
+            readOnlyRows = countRows(storage);
+        } catch (const std::runtime_error& e) {
+            reopenError = e.what();
+        }
+        std::cout.rdbuf(originalOut);
+        
+        bool ok = refusal.find("needs recovery") != std::string::npos && reopenError.empty() &&
+                  recoveredRows >= 0 && readOnlyRows == recoveredRows;
+        if (!ok) {
+            ++failures;
+        }
+        std::cout << "Round " << round << ": killed after " << std::setw(3) << delayMs << " ms, read-only open "
+                  << (refusal.empty() ? "NOT refused" : "refused") << ", recovered " << recoveredRows
+                  << " rows, read-only after recovery "
+                  << (reopenError.empty() ? std::to_string(readOnlyRows) + " rows" : "failed: " + reopenError)
+                  << (ok ? "  OK" : "  FAILED") << std::endl;
+        if (!refusal.empty()) {
+            std::cout << "          " << refusal << std::endl;
+        }
+    }
+    
+    std::filesystem::remove_all(DB_PATH);
+    std::cout << (failures == 0 ? "Read-only open refused every crashed database and accepted every recovered one"
+                                : std::to_string(failures) + " rounds FAILED") << std::endl;
+#endif
+    std::cout << "=== Read-Only Open After Crash Test Completed ===" << std::endl;
+}
+
+// 同步级别基准：每个级别在新数据库中逐条自动提交插入，比较吞吐量和日志同步次数
+void benchmarkDurabilityLevels() {
+    std::cout << "=== Durability Level Benchmark (synchronous = off / normal / full) ===" << std::endl;
+    
+    const int ROWS = 5000;
+    const std::string benchDir = "bench_durability";
+    std::cout << "Inserting " << ROWS << " rows, one autocommit transaction per row" << std::endl;
+    
+    std::vector<long long> rates;
+    for (SynchronousMode mode : {SynchronousMode::OFF, SynchronousMode::NORMAL, SynchronousMode::FULL}) {
+        std::filesystem::remove_all(benchDir);
+        std::filesystem::create_directories(benchDir);
+        {
+            StorageEngine storage(benchDir);
+            storage.setSynchronousMode(mode);
+            storage.createTable("bench", {ColumnInfo("id", DataType::INT), ColumnInfo("name", DataType::STRING),
+                                          ColumnInfo("score", DataType::DOUBLE)});
+            WalStats before = storage.getLog()->getStats();
+            
+            auto start = std::chrono::high_resolution_clock::now();
+            int inserted = 0;
+            for (int i = 0; i < ROWS; ++i) {
+                if (storage.insertRow("bench", Row(std::vector<Value>{i, std::string("row") + std::to_string(i), i * 0.5}))) {
+                    ++inserted;
+                }
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            WalStats after = storage.getLog()->getStats();
+            
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+            long long rate = static_cast<long long>(us > 0 ? inserted * 1000000.0 / us : 0.0);
+            rates.push_back(rate);
+            std::cout << std::left << std::setw(8) << synchronousModeName(mode)
+                      << std::setw(14) << (std::to_string(inserted) + " rows")
+                      << std::setw(12) << (std::to_string(us / 1000) + " ms")
+                      << std::setw(16) << (std::to_string(rate) + " rows/s")
+                      << (after.syncs - before.syncs) << " log syncs ("
+                      << (after.backgroundSyncs - before.backgroundSyncs) << " in background)" << std::endl;
+        }
+    }
+    std::filesystem::remove_all(benchDir);
+    
+    std::cout << std::fixed << std::setprecision(2);
+    if (rates[2] > 0) {
+        std::cout << "Speedup over full: off " << static_cast<double>(rates[0]) / rates[2] << "x, normal "
+                  << static_cast<double>(rates[1]) / rates[2] << "x" << std::endl;
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << "off: a power loss may lose committed transactions and corrupt the database; "
+              << "normal: may lose the last sync interval of commits; full: no committed transaction is lost" << std::endl;
+    std::cout << "=== Durability Level Benchmark Completed ===" << std::endl;
+}
+
+// 事务批量基准：同样的INSERT语句逐条自动提交和放在一个BEGIN ... COMMIT中执行，再回滚一个同样大小的事务
+void benchmarkTransactionBatching() {
+    std::cout << "=== Transaction Batching Benchmark (autocommit vs BEGIN ... COMMIT) ===" << std::endl;
+    
+    const int ROWS = 5000;
+    const std::string benchDir = "bench_transactions";
+    std::filesystem::remove_all(benchDir);
+    std::filesystem::create_directories(benchDir);
+    {
+        StorageEngine storage(benchDir);
+        ExecutionEngine engine(&storage);
+        auto catalog = std::make_shared<Catalog>(&storage);
+        engine.setSemanticAnalyzer(std::make_shared<SemanticAnalyzer>(catalog));
+        
+        auto execute = [&](const std::string& sql) {
+            Parser parser(sql);
+            auto statement = parser.parseStatement();
+            return statement ? engine.executeStatement(statement.get())
+                             : ExecutionResult(ExecutionResultType::ERROR, "parse error: " + sql);
+        };
+        auto countRows = [&]() {
+            ExecutionResult result = execute("SELECT COUNT(*) FROM bench;");
+            return result.isSuccess() && !result.rows.empty() ? std::get<int>(result.rows[0].getValue(0)) : -1;
+        };
+        execute("CREATE TABLE bench (id INT PRIMARY KEY, name STRING, score DOUBLE);");
+        
+        // 插入firstId开始的ROWS行，返回耗时（微秒）；inTransaction为true时整批放在一个事务中
+        auto insertRows = [&](int firstId, bool inTransaction, const std::string& finish) {
+            WalStats before = storage.getLog()->getStats();
+            auto start = std::chrono::high_resolution_clock::now();
+            if (inTransaction) {
+                execute("BEGIN;");
+            }
+            int failed = 0;
+            for (int id = firstId; id < firstId + ROWS; ++id) {
+                if (!execute("INSERT INTO bench VALUES (" + std::to_string(id) + ", 'row" + std::to_string(id) + "', " +
+                             std::to_string(id * 0.5) + ");").isSuccess()) {
+                    ++failed;
+                }
+            }
+            if (inTransaction) {
+                execute(finish);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            WalStats after = storage.getLog()->getStats();
+            
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+            std::string label = inTransaction ? "BEGIN ... " + finish.substr(0, finish.size() - 1) : "autocommit";
+            std::cout << std::left << std::setw(20) << label
+                      << std::setw(14) << (std::to_string(ROWS - failed) + " rows")
+                      << std::setw(12) << (std::to_string(us / 1000) + " ms")
+                      << std::setw(16) << (std::to_string(static_cast<long long>(us > 0 ? ROWS * 1000000.0 / us : 0.0)) + " rows/s")
+                      << (after.syncs - before.syncs) << " log syncs, " << (after.commits - before.commits) << " commits"
+                      << std::endl;
+            return us;
+        };
+        
+        std::cout << "Inserting " << ROWS << " rows with one INSERT statement per row" << std::endl;
+        auto autocommitUs = insertRows(1, false, "");
+        auto transactionUs = insertRows(ROWS + 1, true, "COMMIT;");
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "Speedup: " << (transactionUs > 0 ? static_cast<double>(autocommitUs) / transactionUs : 0.0) << "x"
+                  << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        
+        // 回滚：撤销之后行数和主键索引都回到事务之前
+        insertRows(2 * ROWS + 1, true, "ROLLBACK;");
+        int rows = countRows();
+        bool indexOk = execute("SELECT * FROM bench WHERE id = " + std::to_string(2 * ROWS + 1) + ";").rows.empty() &&
+                       execute("SELECT * FROM bench WHERE id = " + std::to_string(2 * ROWS) + ";").rows.size() == 1;
+        std::cout << "After rollback: " << rows << " rows (expected " << 2 * ROWS << "), primary key index "
+                  << (indexOk ? "consistent" : "INCONSISTENT") << std::endl;
+    }
+    std::filesystem::remove_all(benchDir);
+    
+    std::cout << "=== Transaction Batching Benchmark Completed ===" << std::endl;
+}
+
 int main() {
     std::cout << "MiniDB Started" << std::endl;
     std::cout << "Choose mode:" << std::endl;
     std::cout << "1. Test Index Performance (Speed comparison with/without indexes)" << std::endl;
     std::cout << "2. Start REPL Interactive Mode" << std::endl;
-    std::cout << "Please enter your choice (1-2): ";
+    std::cout << "3. Benchmark Row Codec (binary vs legacy text)" << std::endl;
+    std::cout << "4. Benchmark Bulk Delete (eager vs lazy page compaction)" << std::endl;
+    std::cout << "5. Benchmark Buffer Replacement Policy (trace replay hit ratios)" << std::endl;
+    std::cout << "6. Benchmark Buffer Pool Concurrency (getPage throughput, 1-32 threads)" << std::endl;
+    std::cout << "7. Benchmark Cold Scan I/O (synchronous pread vs io_uring)" << std::endl;
+    std::cout << "8. Start REPL in Read-Only Mode (memory-mapped database file)" << std::endl;
+    std::cout << "9. Test Crash Recovery (kill the process during writes, then recover)" << std::endl;
+    std::cout << "10. Benchmark Durability Levels (insert throughput with synchronous = off / normal / full)" << std::endl;
+    std::cout << "11. Benchmark Transaction Batching (autocommit vs BEGIN ... COMMIT, then ROLLBACK)" << std::endl;
+    std::cout << "12. Test Read-Only Open After Crash (must be refused until recovered)" << std::endl;
+    std::cout << "Please enter your choice (1-12): ";
     
     int choice;
     std::cin >> choice;
     
     if (choice == 1) {
         testIndexPerformance();
+    } else if (choice == 3) {
+        benchmarkRowCodec();
+    } else if (choice == 4) {
+        benchmarkBulkDelete();
+    } else if (choice == 5) {
+        benchmarkReplacementPolicy();
+    } else if (choice == 6) {
+        benchmarkBufferPoolConcurrency();
+    } else if (choice == 7) {
+        benchmarkColdScanIo();
+    } else if (choice == 8) {
+        std::cin.ignore(); // 清除输入缓冲
+        REPL repl("./data", true);
+        repl.run();
+    } else if (choice == 9) {
+        testCrashRecovery();
+    } else if (choice == 10) {
+        benchmarkDurabilityLevels();
+    } else if (choice == 11) {
+        benchmarkTransactionBatching();
+    } else if (choice == 12) {
+        testReadOnlyAfterCrash();
     } else {
         std::cin.ignore(); // 清除输入缓冲
         REPL repl;
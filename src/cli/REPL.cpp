@@ -8,8 +8,8 @@
 #include <algorithm>
 #include <filesystem>
 
-REPL::REPL(const std::string& dbPath) 
-    : running_(false), dbPath_(dbPath), maxHistorySize_(100) {
+REPL::REPL(const std::string& dbPath, bool readOnly) 
+    : running_(false), dbPath_(dbPath), readOnly_(readOnly), maxHistorySize_(100) {
 }
 
 REPL::~REPL() {
@@ -20,11 +20,13 @@ bool REPL::initialize() {
     try {
         std::cout << "Initializing MiniDB..." << std::endl;
         
-        // 确保数据库目录存在
-        std::filesystem::create_directories(dbPath_);
+        // 确保数据库目录存在（只读模式只打开已有的数据库）
+        if (!readOnly_) {
+            std::filesystem::create_directories(dbPath_);
+        }
         
         // 初始化存储引擎
-        storageEngine_ = std::make_unique<StorageEngine>(dbPath_);
+        storageEngine_ = std::make_unique<StorageEngine>(dbPath_, readOnly_);
         std::cout << "Storage engine initialized successfully" << std::endl;
         
         // 初始化Catalog
@@ -49,7 +51,7 @@ bool REPL::initialize() {
 }
 
 void REPL::cleanup() {
-    if (storageEngine_) {
+    if (storageEngine_ && !readOnly_) {
         std::cout << "Saving database..." << std::endl;
         storageEngine_->saveToStorage();
         std::cout << "Database saved successfully." << std::endl;
@@ -70,7 +72,7 @@ void REPL::run() {
     
     std::cout << std::endl;
     std::cout << "Database ready! Type '.help' for help or 'exit' to quit." << std::endl;
-    std::cout << "Database path: " << dbPath_ << std::endl;
+    std::cout << "Database path: " << dbPath_ << (readOnly_ ? " (read-only)" : "") << std::endl;
     std::cout << std::endl;
     
     running_ = true;
@@ -220,6 +222,8 @@ void REPL::handleMetaCommand(const std::string& command) {
         saveDatabase();
     } else if (command == ".version") {
         showVersion();
+    } else if (command.substr(0, 12) == ".synchronous") {
+        handleSynchronous(command.length() > 13 ? trim(command.substr(13)) : "");
     } else {
         displayError("Unknown command: " + command + ". Type '.help' for help.");
     }
@@ -235,6 +239,7 @@ void REPL::showHelp() {
     std::cout << "  INSERT INTO table VALUES (val1, val2, ...);" << std::endl;
     std::cout << "  SELECT * FROM table [WHERE condition];" << std::endl;
     std::cout << "  DELETE FROM table [WHERE condition];" << std::endl;
+    std::cout << "  BEGIN; ... COMMIT; | ROLLBACK;" << std::endl;
     std::cout << std::endl;
     std::cout << "Meta Commands:" << std::endl;
     std::cout << "  .help          - Show this help message" << std::endl;
@@ -245,6 +250,7 @@ void REPL::showHelp() {
     std::cout << "  .stats         - Show database statistics" << std::endl;
     std::cout << "  .save          - Save database to disk" << std::endl;
     std::cout << "  .version       - Show version information" << std::endl;
+    std::cout << "  .synchronous [off|normal|full] - Show or set durability level" << std::endl;
     std::cout << "  exit           - Exit the database" << std::endl;
     std::cout << std::endl;
     std::cout << "Examples:" << std::endl;
@@ -397,6 +403,43 @@ void REPL::showStats() {
         std::cout << "Success rate: " << std::fixed << std::setprecision(1) << successRate << "%" << std::endl;
     }
     
+    // 显示缓冲池统计（只读模式直接读取映射的页面，不使用缓冲池）
+    if (storageEngine_->isReadOnly()) {
+        std::cout << "Buffer pool: not used (read-only, pages served from the memory-mapped file)" << std::endl;
+        std::cout << std::endl;
+        return;
+    }
+    BufferPoolStats poolStats = storageEngine_->getBufferPoolStats();
+    std::cout << "Buffer pool: " << poolStats.usedFrames << "/" << poolStats.totalFrames << " frames, "
+              << poolStats.dirtyFrames << " dirty, hit ratio " << std::fixed << std::setprecision(1)
+              << poolStats.getHitRatio() * 100.0 << "%" << std::endl;
+    std::cout << "Page write-backs: " << poolStats.evictionWrites << " on eviction, "
+              << poolStats.flusherWrites << " by flusher (" << poolStats.flusherRuns << " runs), "
+              << poolStats.flushedPages << " at checkpoint" << std::endl;
+    std::cout << "Prefetch: " << poolStats.prefetchedPages << " pages in " << poolStats.prefetchReads << " reads, "
+              << poolStats.prefetchHits << " hits, " << poolStats.prefetchWasted << " wasted" << std::endl;
+    
+    // 预写日志：每次同步平均带上的提交数反映组提交的效果
+    if (const WriteAheadLog* wal = storageEngine_->getLog()) {
+        WalStats walStats = wal->getStats();
+        std::cout << "Write-ahead log: " << walStats.records << " records (" << walStats.bytes / 1024 << " KB), "
+                  << walStats.commits << " commits, " << walStats.syncs << " syncs";
+        if (walStats.syncs > 0) {
+            std::cout << " (" << std::setprecision(2)
+                      << static_cast<double>(walStats.commits) / walStats.syncs << " commits per sync)";
+        }
+        std::cout << ", flushed LSN " << walStats.flushedLsn << "; synchronous = "
+                  << synchronousModeName(wal->getSynchronousMode()) << std::endl;
+        
+        // 检查点：重做起点决定崩溃后要重放多少日志，之前的日志段已被回收
+        CheckpointStats checkpointStats = storageEngine_->getCheckpointStats();
+        std::cout << "Checkpoints: " << checkpointStats.checkpoints << " (" << checkpointStats.backgroundCheckpoints
+                  << " in background), last at LSN " << checkpointStats.lastCheckpointLsn << ", redo from LSN "
+                  << checkpointStats.lastRedoLsn << ", " << checkpointStats.lastPagesFlushed << " pages flushed in "
+                  << std::setprecision(1) << checkpointStats.lastDurationMs << " ms; log segments recycled "
+                  << walStats.recycledSegments << ", removed " << walStats.removedSegments << std::endl;
+    }
+    
     std::cout << std::endl;
 }
 
@@ -410,6 +453,24 @@ void REPL::saveDatabase() {
     }
 }
 
+void REPL::handleSynchronous(const std::string& argument) {
+    if (argument.empty()) {
+        std::cout << "synchronous = " << synchronousModeName(storageEngine_->getSynchronousMode()) << std::endl;
+        return;
+    }
+    SynchronousMode mode;
+    if (!parseSynchronousMode(argument, mode)) {
+        displayError("Invalid synchronous mode: " + argument + " (expected off, normal or full)");
+        return;
+    }
+    if (readOnly_) {
+        displayError("Cannot set synchronous mode: database is opened read-only");
+        return;
+    }
+    storageEngine_->setSynchronousMode(mode);
+    displaySuccess(std::string("synchronous = ") + synchronousModeName(mode));
+}
+
 void REPL::showVersion() {
     std::cout << std::endl;
     std::cout << "MiniDB Version 1.0" << std::endl;
@@ -422,7 +483,7 @@ void REPL::showVersion() {
     std::cout << "- SQL DML (INSERT, SELECT, DELETE)" << std::endl;
     std::cout << "- Page-based storage system" << std::endl;
     std::cout << "- B+ tree indexing" << std::endl;
-    std::cout << "- Buffer pool management (LRU)" << std::endl;
+    std::cout << "- Buffer pool management (2Q / LRU-K / CLOCK / LRU)" << std::endl;
     std::cout << "- SQL lexical and syntax analysis" << std::endl;
     std::cout << "- Semantic analysis with catalog" << std::endl;
     std::cout << "- Query execution engine" << std::endl;
@@ -1,4 +1,5 @@
 #include "../../include/executor/DeleteExecutor.h"
+#include "../../include/storage/PageGuard.h"
 #include <iostream>
 
 bool DeleteExecutor::init() {
@@ -47,31 +48,31 @@ ExecutionResult DeleteExecutor::next() {
         size_t failedCount = 0;
         std::string errorMessages;
         
-        // 使用两阶段删除策略：先收集要删除的recordId，然后批量删除
-        std::vector<uint32_t> allRecordIds = table->getAllRecordIds();
-        std::vector<std::pair<uint32_t, Row>> recordsToDelete;
+        // 使用两阶段删除策略：先收集要删除的RID，然后批量删除（删除只清空槽位，其他记录的RID不变）
+        std::vector<RID> allRecordIds = table->getAllRecordIds();
+        std::vector<std::pair<RID, Row>> recordsToDelete;
         
         // 第一阶段：收集所有需要删除的记录
-        for (uint32_t recordId : allRecordIds) {
-            Row currentRow = table->getRow(recordId);
-            if (currentRow.getFieldCount() == 0) {
-                continue;
-            }
+        // WHERE条件在页面中的行视图上求值，只有命中的行才物化（索引维护需要完整的旧行）
+        ReadPageGuard page;
+        for (RID recordId : allRecordIds) {
+            RowView view = table->getRowView(recordId, page);
+            bool shouldDelete = view.isValid() && view.getFieldCount() > 0;
             
             // 检查WHERE条件
-            bool shouldDelete = true;
-            if (deleteStmt_->whereClause) {
-                shouldDelete = evaluateWhereCondition(deleteStmt_->whereClause.get(), currentRow);
+            if (shouldDelete && deleteStmt_->whereClause) {
+                shouldDelete = evaluateWhereCondition(deleteStmt_->whereClause.get(), view);
             }
             
             if (shouldDelete) {
-                recordsToDelete.push_back({recordId, currentRow});
+                recordsToDelete.push_back({recordId, view.toRow()});
             }
         }
+        page.release();
         
         // 第二阶段：执行删除操作
         for (const auto& recordPair : recordsToDelete) {
-            uint32_t recordId = recordPair.first;
+            RID recordId = recordPair.first;
             Row rowCopy = recordPair.second;
             
             bool success = context_->getStorageEngine()->deleteRow(deleteStmt_->tableName, rowCopy, recordId);
@@ -82,7 +83,8 @@ ExecutionResult DeleteExecutor::next() {
                 if (!errorMessages.empty()) {
                     errorMessages += "; ";
                 }
-                errorMessages += "Failed to delete record " + std::to_string(recordId);
+                errorMessages += "Failed to delete record " + std::to_string(ridPageId(recordId)) + 
+                                 ":" + std::to_string(ridSlotId(recordId));
             }
         }
         
@@ -113,7 +115,8 @@ ExecutionResult DeleteExecutor::next() {
     }
 }
 
-Value DeleteExecutor::evaluateExpression(Expression* expr, const Row& currentRow) {
+template <typename RowT>
+Value DeleteExecutor::evaluateExpression(Expression* expr, const RowT& currentRow) {
     if (!expr) {
         throw std::runtime_error("Expression is null");
     }
@@ -160,7 +163,7 @@ Value DeleteExecutor::evaluateExpression(Expression* expr, const Row& currentRow
                         // 处理字符串和其他类型的直接比较
                         return (left == right) ? 1 : 0;
                     }
-                    
+                
                 case TokenType::NOT_EQUAL:
                     {
                         // 处理数值比较
@@ -175,7 +178,7 @@ Value DeleteExecutor::evaluateExpression(Expression* expr, const Row& currentRow
                         // 处理字符串和其他类型的直接比较
                         return (left != right) ? 1 : 0;
                     }
-                    
+                
                 case TokenType::GREATER_THAN:
                     {
                         double leftVal = 0.0, rightVal = 0.0;
@@ -189,7 +192,7 @@ Value DeleteExecutor::evaluateExpression(Expression* expr, const Row& currentRow
                         
                         return (leftVal > rightVal) ? 1 : 0;
                     }
-                    
+                
                 case TokenType::GREATER_EQUAL:
                     {
                         double leftVal = 0.0, rightVal = 0.0;
@@ -203,7 +206,7 @@ Value DeleteExecutor::evaluateExpression(Expression* expr, const Row& currentRow
                         
                         return (leftVal >= rightVal) ? 1 : 0;
                     }
-                    
+                
                 case TokenType::LESS_THAN:
                     {
                         double leftVal = 0.0, rightVal = 0.0;
@@ -218,7 +221,7 @@ Value DeleteExecutor::evaluateExpression(Expression* expr, const Row& currentRow
                         // Comparison: leftVal < rightVal
                         return (leftVal < rightVal) ? 1 : 0;
                     }
-                    
+                
                 case TokenType::LESS_EQUAL:
                     {
                         double leftVal = 0.0, rightVal = 0.0;
@@ -232,7 +235,7 @@ Value DeleteExecutor::evaluateExpression(Expression* expr, const Row& currentRow
                         
                         return (leftVal <= rightVal) ? 1 : 0;
                     }
-                    
+                
                 case TokenType::AND:
                     {
                         int leftVal = 0, rightVal = 0;
@@ -240,7 +243,7 @@ Value DeleteExecutor::evaluateExpression(Expression* expr, const Row& currentRow
                         if (std::holds_alternative<int>(right)) rightVal = std::get<int>(right);
                         return (leftVal && rightVal) ? 1 : 0;
                     }
-                    
+                
                 case TokenType::OR:
                     {
                         int leftVal = 0, rightVal = 0;
@@ -248,7 +251,7 @@ Value DeleteExecutor::evaluateExpression(Expression* expr, const Row& currentRow
                         if (std::holds_alternative<int>(right)) rightVal = std::get<int>(right);
                         return (leftVal || rightVal) ? 1 : 0;
                     }
-                    
+                
                 default:
                     break;
             }
@@ -261,7 +264,8 @@ Value DeleteExecutor::evaluateExpression(Expression* expr, const Row& currentRow
     }
 }
 
-bool DeleteExecutor::evaluateWhereCondition(Expression* whereExpr, const Row& row) {
+template <typename RowT>
+bool DeleteExecutor::evaluateWhereCondition(Expression* whereExpr, const RowT& row) {
     if (!whereExpr) {
         return true; // 没有WHERE条件，所有行都符合
     }
@@ -17,7 +17,71 @@ ExecutionResult ExecutionEngine::executeStatement(Statement* statement) {
     if (!statement) {
         return ExecutionResult(ExecutionResultType::ERROR, "Statement is null");
     }
+    if (statement->nodeType == ASTNodeType::TRANSACTION_STMT) {
+        return executeTransactionStatement(static_cast<TransactionStatement*>(statement));
+    }
+    
+    // 系统目录的修改只重做不撤销，不能放进之后可能回滚的事务
+    bool schemaChange = statement->nodeType == ASTNodeType::CREATE_TABLE_STMT ||
+                        statement->nodeType == ASTNodeType::DROP_TABLE_STMT ||
+                        statement->nodeType == ASTNodeType::CREATE_INDEX_STMT;
+    if (schemaChange && storageEngine_->inTransaction()) {
+        stats_.totalStatements++;
+        stats_.failedStatements++;
+        return ExecutionResult(ExecutionResultType::ERROR,
+                               "Schema changes cannot run inside a transaction; COMMIT or ROLLBACK first");
+    }
+    
+    // 修改语句在自己的事务中执行；调用方已开始事务时（BEGIN之后）加入该事务，由COMMIT或ROLLBACK结束
+    bool ownsTransaction = statement->nodeType != ASTNodeType::SELECT_STMT && !storageEngine_->isReadOnly() &&
+                           storageEngine_->beginTransaction();
+    ExecutionResult result = runStatement(statement);
+    if (ownsTransaction && !storageEngine_->commitTransaction(!deferCommitFlush_) && result.isSuccess()) {
+        return ExecutionResult(ExecutionResultType::ERROR, "Failed to commit: write-ahead log is not writable");
+    }
+    return result;
+}
+
+ExecutionResult ExecutionEngine::executeTransactionStatement(TransactionStatement* statement) {
+    stats_.totalStatements++;
+    if (storageEngine_->isReadOnly()) {
+        stats_.failedStatements++;
+        return ExecutionResult(ExecutionResultType::ERROR, "Transactions are not available: database is opened read-only");
+    }
     
+    ExecutionResult result;
+    bool active = storageEngine_->inTransaction();
+    if (statement->action == TransactionAction::BEGIN) {
+        if (active) {
+            result = ExecutionResult(ExecutionResultType::ERROR, "A transaction is already active");
+        } else if (storageEngine_->beginTransaction()) {
+            result = ExecutionResult(ExecutionResultType::SUCCESS, "Transaction started");
+        } else {
+            result = ExecutionResult(ExecutionResultType::ERROR, "Failed to begin transaction");
+        }
+    } else if (!active) {
+        result = ExecutionResult(ExecutionResultType::ERROR, "No transaction is active");
+    } else if (statement->action == TransactionAction::COMMIT) {
+        // 整个事务只在这里等待一次日志持久化
+        if (storageEngine_->commitTransaction(!deferCommitFlush_)) {
+            result = ExecutionResult(ExecutionResultType::SUCCESS, "Transaction committed");
+        } else {
+            result = ExecutionResult(ExecutionResultType::ERROR, "Failed to commit: write-ahead log is not writable");
+        }
+    } else if (storageEngine_->rollbackTransaction()) {
+        result = ExecutionResult(ExecutionResultType::SUCCESS, "Transaction rolled back");
+    } else {
+        result = ExecutionResult(ExecutionResultType::ERROR, "Failed to roll back transaction");
+    }
+    if (result.isSuccess()) {
+        stats_.successfulStatements++;
+    } else {
+        stats_.failedStatements++;
+    }
+    return result;
+}
+
+ExecutionResult ExecutionEngine::runStatement(Statement* statement) {
     auto startTime = std::chrono::high_resolution_clock::now();
     stats_.totalStatements++;
     
@@ -80,6 +144,7 @@ std::vector<ExecutionResult> ExecutionEngine::executeStatements(const std::vecto
     std::vector<ExecutionResult> results;
     results.reserve(statements.size());
     
+    deferCommitFlush_ = true;
     for (const auto& stmt : statements) {
         auto result = executeStatement(stmt.get());
         results.push_back(result);
@@ -90,6 +155,12 @@ std::vector<ExecutionResult> ExecutionEngine::executeStatements(const std::vecto
             // 继续执行其他语句
         }
     }
+    deferCommitFlush_ = false;
+    
+    // 整批语句的提交记录一起持久化
+    if (!storageEngine_->flushLog()) {
+        std::cerr << "Failed to flush write-ahead log" << std::endl;
+    }
     
     return results;
 }
@@ -220,6 +291,12 @@ std::unique_ptr<Executor> ExecutionEngine::createSelectExecutor(SelectStatement*
     
     std::unique_ptr<Executor> current = std::move(leftScan);
     
+    // 单表顺序扫描时，WHERE谓词和列裁剪下推到SeqScan，直接在页面中的行视图上求值
+    SeqScanExecutor* pushdownScan = nullptr;
+    if (stmt->joinClauses.empty()) {
+        pushdownScan = dynamic_cast<SeqScanExecutor*>(current.get());
+    }
+    
     // 2. 处理JOIN子句
     for (const auto& joinClause : stmt->joinClauses) {
         // 为右表创建SeqScan
@@ -237,7 +314,11 @@ std::unique_ptr<Executor> ExecutionEngine::createSelectExecutor(SelectStatement*
     
     // 2. 如果有WHERE子句，添加Filter算子
     if (stmt->whereClause) {
-        current = std::make_unique<FilterExecutor>(context_.get(), std::move(current), stmt->whereClause.get());
+        if (pushdownScan) {
+            pushdownScan->setPredicate(stmt->whereClause.get());
+        } else {
+            current = std::make_unique<FilterExecutor>(context_.get(), std::move(current), stmt->whereClause.get());
+        }
     }
     
     // 3. 检查是否有聚合函数或GROUP BY
@@ -254,6 +335,10 @@ std::unique_ptr<Executor> ExecutionEngine::createSelectExecutor(SelectStatement*
         current = std::make_unique<GroupByExecutor>(context_.get(), std::move(current), stmt->groupByList, stmt->selectList);
     } else {
         // 否则使用常规的Project算子
+        if (pushdownScan) {
+            pushdownScan->setRequiredColumns(computeRequiredColumns(stmt->fromTable, stmt->selectList));
+        }
+        
         std::vector<Expression*> projections;
         for (const auto& expr : stmt->selectList) {
             projections.push_back(expr.get());
@@ -441,6 +526,67 @@ std::string ExecutionEngine::findIndexForColumn(const std::string& tableName, co
     return "";
 }
 
+std::vector<bool> ExecutionEngine::computeRequiredColumns(const std::string& tableName,
+                                                          const std::vector<std::unique_ptr<Expression>>& selectList) {
+    auto storage = context_->getStorageEngine();
+    auto table = storage ? storage->getTable(tableName) : nullptr;
+    if (!table) {
+        return {};
+    }
+    
+    std::vector<std::string> columns;
+    for (const auto& expr : selectList) {
+        if (!collectColumnReferences(expr.get(), columns)) {
+            return {};
+        }
+    }
+    
+    std::vector<bool> required(table->getColumnCount(), false);
+    for (const auto& name : columns) {
+        int columnIndex = table->getColumnIndex(name);
+        if (columnIndex < 0) {
+            return {}; // 无法识别的列名（例如带表名前缀），不做裁剪
+        }
+        required[columnIndex] = true;
+    }
+    
+    return required;
+}
+
+bool ExecutionEngine::collectColumnReferences(Expression* expr, std::vector<std::string>& columns) const {
+    if (!expr) {
+        return true;
+    }
+    
+    switch (expr->nodeType) {
+        case ASTNodeType::LITERAL_EXPR:
+            return true;
+        
+        case ASTNodeType::IDENTIFIER_EXPR: {
+            auto* identifier = static_cast<IdentifierExpression*>(expr);
+            if (identifier->name == "*") {
+                return false; // SELECT * 需要所有列
+            }
+            columns.push_back(identifier->name);
+            return true;
+        }
+        
+        case ASTNodeType::BINARY_EXPR: {
+            auto* binary = static_cast<BinaryExpression*>(expr);
+            return collectColumnReferences(binary->left.get(), columns) &&
+                   collectColumnReferences(binary->right.get(), columns);
+        }
+        
+        case ASTNodeType::UNARY_EXPR: {
+            auto* unary = static_cast<UnaryExpression*>(expr);
+            return collectColumnReferences(unary->operand.get(), columns);
+        }
+        
+        default:
+            return false;
+    }
+}
+
 std::string ExecutionEngine::generatePlanDescription(Executor* executor, int depth) const {
     if (!executor) {
         return "";
@@ -451,7 +597,11 @@ std::string ExecutionEngine::generatePlanDescription(Executor* executor, int dep
     
     // 添加算子特定信息
     if (auto* seqScan = dynamic_cast<SeqScanExecutor*>(executor)) {
-        desc += "(" + seqScan->getTableName() + ")";
+        desc += "(" + seqScan->getTableName();
+        if (seqScan->getPredicate()) {
+            desc += ", pushed-down filter";
+        }
+        desc += ")";
     }
     
     desc += "\n";
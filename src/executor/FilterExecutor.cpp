@@ -1,5 +1,6 @@
 #include "../../include/executor/FilterExecutor.h"
 #include <iostream>
+#include <type_traits>
 
 bool FilterExecutor::init() {
     if (initialized_) {
@@ -48,7 +49,7 @@ ExecutionResult FilterExecutor::next() {
             
             // 对每一行应用谓词
             for (const auto& row : childResult.rows) {
-                if (evaluatePredicate(row, schema)) {
+                if (evaluatePredicate(predicate_, row, schema)) {
                     ExecutionResult result(ExecutionResultType::SUCCESS);
                     result.rows.push_back(row);
                     result.affectedRows = 1;
@@ -63,9 +64,10 @@ ExecutionResult FilterExecutor::next() {
     }
 }
 
-bool FilterExecutor::evaluatePredicate(const Row& row, const std::vector<ColumnInfo>& schema) {
+template <typename RowT>
+bool FilterExecutor::evaluatePredicate(Expression* predicate, const RowT& row, const std::vector<ColumnInfo>& schema) {
     try {
-        Value result = evaluateExpression(predicate_, row, schema);
+        Value result = evaluateExpression(predicate, row, schema);
         
         // 将结果转换为布尔值
         if (std::holds_alternative<int>(result)) {
@@ -86,7 +88,8 @@ bool FilterExecutor::evaluatePredicate(const Row& row, const std::vector<ColumnI
     }
 }
 
-Value FilterExecutor::evaluateExpression(Expression* expr, const Row& row, const std::vector<ColumnInfo>& schema) {
+template <typename RowT>
+Value FilterExecutor::evaluateExpression(Expression* expr, const RowT& row, const std::vector<ColumnInfo>& schema) {
     if (!expr) {
         throw std::runtime_error("Expression is null");
     }
@@ -108,6 +111,28 @@ Value FilterExecutor::evaluateExpression(Expression* expr, const Row& row, const
         
         case ASTNodeType::BINARY_EXPR: {
             auto* binary = static_cast<BinaryExpression*>(expr);
+            
+            // 行视图上的"字符串列 比较 字符串常量"：直接比较页面中的字节，不构造std::string
+            if constexpr (std::is_same_v<RowT, RowView>) {
+                auto* column = dynamic_cast<IdentifierExpression*>(binary->left.get());
+                auto* literal = dynamic_cast<LiteralExpression*>(binary->right.get());
+                if (column && literal && std::holds_alternative<std::string>(literal->value)) {
+                    int columnIndex = findColumnIndex(column->name, schema);
+                    if (columnIndex >= 0 && row.getType(columnIndex) == DataType::STRING) {
+                        int cmp = row.getString(columnIndex).compare(std::get<std::string>(literal->value));
+                        switch (binary->operator_) {
+                            case TokenType::EQUAL: return cmp == 0 ? 1 : 0;
+                            case TokenType::NOT_EQUAL: return cmp != 0 ? 1 : 0;
+                            case TokenType::LESS_THAN: return cmp < 0 ? 1 : 0;
+                            case TokenType::LESS_EQUAL: return cmp <= 0 ? 1 : 0;
+                            case TokenType::GREATER_THAN: return cmp > 0 ? 1 : 0;
+                            case TokenType::GREATER_EQUAL: return cmp >= 0 ? 1 : 0;
+                            default: break;
+                        }
+                    }
+                }
+            }
+            
             Value left = evaluateExpression(binary->left.get(), row, schema);
             Value right = evaluateExpression(binary->right.get(), row, schema);
             
@@ -256,3 +281,7 @@ int FilterExecutor::findColumnIndex(const std::string& columnName, const std::ve
     }
     return -1;
 }
+
+// 显式实例化：Filter算子使用物化行，SeqScan下推的谓词使用行视图
+template bool FilterExecutor::evaluatePredicate<Row>(Expression*, const Row&, const std::vector<ColumnInfo>&);
+template bool FilterExecutor::evaluatePredicate<RowView>(Expression*, const RowView&, const std::vector<ColumnInfo>&);
@@ -48,7 +48,7 @@ ExecutionResult IndexScanExecutor::next() {
     
     try {
         // 获取当前记录ID对应的行数据
-        uint32_t recordId = recordIds_[currentIndex_];
+        RID recordId = recordIds_[currentIndex_];
         Row row = tableRef_->getRow(recordId);
         
         currentIndex_++;
@@ -1,4 +1,5 @@
 #include "../../include/executor/SeqScanExecutor.h"
+#include "../../include/executor/FilterExecutor.h"
 #include <iostream>
 
 bool SeqScanExecutor::init() {
@@ -18,12 +19,10 @@ bool SeqScanExecutor::init() {
         return false;
     }
     
-    // 初始化迭代器
-    auto beginIter = tableRef_->begin();
-    auto endIter = tableRef_->end();
+    schema_ = tableRef_->getColumns();
     
-    currentIterator_ = std::make_unique<RowIterator>(beginIter);
-    endIterator_ = std::make_unique<RowIterator>(endIter);
+    // 初始化迭代器
+    iterator_ = std::make_unique<RowIterator>(tableRef_->begin());
     
     initialized_ = true;
     return true;
@@ -34,27 +33,37 @@ ExecutionResult SeqScanExecutor::next() {
         return ExecutionResult(ExecutionResultType::ERROR, "Executor not initialized");
     }
     
-    if (!currentIterator_ || !endIterator_) {
-        return ExecutionResult(ExecutionResultType::ERROR, "Iterators not initialized");
-    }
-    
-    if (*currentIterator_ == *endIterator_) {
-        return ExecutionResult(ExecutionResultType::END_OF_DATA);
+    if (!iterator_) {
+        return ExecutionResult(ExecutionResultType::ERROR, "Iterator not initialized");
     }
     
     try {
-        // 获取当前行
-        Row currentRow = **currentIterator_;
-        
-        // 移动到下一行
-        ++(*currentIterator_);
+        for (; iterator_->hasNext(); ++(*iterator_)) {
+            // 在页面缓冲区上直接访问记录
+            const RowView& view = iterator_->view();
+            if (view.getFieldCount() == 0) {
+                continue;
+            }
+            
+            if (predicate_ && !FilterExecutor::evaluatePredicate(predicate_, view, schema_)) {
+                continue;
+            }
+            
+            // 只有输出的行才物化
+            ExecutionResult result(ExecutionResultType::SUCCESS);
+            if (requiredColumns_.empty()) {
+                result.rows.push_back(view.toRow());
+            } else {
+                result.rows.push_back(view.toRow(requiredColumns_));
+            }
+            result.affectedRows = 1;
+            
+            // 移动到下一行
+            ++(*iterator_);
+            return result;
+        }
         
-        // 返回结果
-        ExecutionResult result(ExecutionResultType::SUCCESS);
-        result.rows.push_back(currentRow);
-        result.affectedRows = 1;
-        
-        return result;
+        return ExecutionResult(ExecutionResultType::END_OF_DATA);
         
     } catch (const std::exception& e) {
         return ExecutionResult(ExecutionResultType::ERROR, 
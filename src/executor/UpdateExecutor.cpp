@@ -1,4 +1,5 @@
 #include "../../include/executor/UpdateExecutor.h"
+#include "../../include/storage/PageGuard.h"
 #include <iostream>
 
 bool UpdateExecutor::init() {
@@ -47,144 +48,60 @@ ExecutionResult UpdateExecutor::next() {
         size_t failedCount = 0;
         std::string errorMessages;
         
-        // 使用基于PRIMARY KEY的更新策略来避免recordId变化问题
-        // 如果表有PRIMARY KEY，使用PRIMARY KEY来标识记录；否则使用recordId
+        // RID在更新期间保持稳定（被迁移到其他页面的记录获得新RID，不会出现在本次收集的列表中），
+        // 因此只需要一次扫描，逐条求值WHERE并立即更新
+        std::vector<RID> allRecordIds = table->getAllRecordIds();
         
-        // 获取PRIMARY KEY列索引
-        int pkIndex = -1;
-        for (size_t i = 0; i < table->getColumns().size(); ++i) {
-            if (table->getColumns()[i].isPrimaryKey) {
-                pkIndex = static_cast<int>(i);
-                break;
+        for (RID recordId : allRecordIds) {
+            ReadPageGuard page;
+            RowView view = table->getRowView(recordId, page);
+            bool shouldUpdate = view.isValid() && view.getFieldCount() > 0;
+            
+            // 检查WHERE条件
+            if (shouldUpdate && updateStmt_->whereClause) {
+                shouldUpdate = evaluateWhereCondition(updateStmt_->whereClause.get(), view);
             }
-        }
-        
-        if (pkIndex >= 0) {
-            // 使用PRIMARY KEY策略：先收集所有需要更新的PRIMARY KEY值
-            std::vector<Value> keysToUpdate;
-            std::vector<uint32_t> allRecordIds = table->getAllRecordIds();
             
-            for (uint32_t recordId : allRecordIds) {
-                Row currentRow = table->getRow(recordId);
-                if (currentRow.getFieldCount() == 0) {
-                    continue;
-                }
-                
-                // 检查WHERE条件
-                bool shouldUpdate = true;
-                if (updateStmt_->whereClause) {
-                    shouldUpdate = evaluateWhereCondition(updateStmt_->whereClause.get(), currentRow);
-                }
-                
-                if (shouldUpdate) {
-                    keysToUpdate.push_back(currentRow.getValue(pkIndex));
-                }
+            // 更新会修改页面，因此先物化旧行，再解除页面固定
+            Row oldRow = shouldUpdate ? view.toRow() : Row();
+            page.release();
+            if (!shouldUpdate) {
+                continue;
             }
             
-            // 根据PRIMARY KEY值进行更新
-            for (const Value& pkValue : keysToUpdate) {
-                // 通过PRIMARY KEY查找当前记录
-                std::vector<uint32_t> currentRecordIds = table->getAllRecordIds();
-                for (uint32_t recordId : currentRecordIds) {
-                    Row currentRow = table->getRow(recordId);
-                    if (currentRow.getFieldCount() == 0) {
-                        continue;
-                    }
-                    
-                    // 检查是否是目标记录
-                    if (currentRow.getValue(pkIndex) == pkValue) {
-                        // 立即更新这条记录
-                        Row oldRow = currentRow;
-                        
-                        // 创建新行，保持原有列的顺序，只更新指定的列
-                        std::vector<Value> allValues;
-                        
-                        // 先复制所有原始值
-                        for (size_t j = 0; j < oldRow.getFieldCount(); ++j) {
-                            allValues.push_back(oldRow.getValue(j));
-                        }
-                        
-                        // 然后更新指定的列
-                        for (const auto& assignment : updateStmt_->assignments) {
-                            int columnIndex = table->getColumnIndex(assignment->columnName);
-                            
-                            if (columnIndex >= 0 && columnIndex < static_cast<int>(allValues.size())) {
-                                Value newValue = evaluateExpression(assignment->value.get(), oldRow);
-                                allValues[columnIndex] = newValue;
-                            }
-                        }
-                        
-                        Row newRow(allValues);
-                        
-                        // 执行更新操作
-                        bool success = context_->getStorageEngine()->updateRow(updateStmt_->tableName, oldRow, newRow, recordId);
-                        if (success) {
-                            updatedCount++;
-                        } else {
-                            failedCount++;
-                            if (!errorMessages.empty()) {
-                                errorMessages += "; ";
-                            }
-                            errorMessages += "Failed to update record " + std::to_string(recordId);
-                        }
-                        break; // 找到并更新了目标记录，退出内层循环
-                    }
-                }
+            // 立即更新这条记录
+            
+            // 创建新行，保持原有列的顺序，只更新指定的列
+            std::vector<Value> allValues;
+            
+            // 先复制所有原始值
+            for (size_t j = 0; j < oldRow.getFieldCount(); ++j) {
+                allValues.push_back(oldRow.getValue(j));
             }
-        } else {
-            // 没有PRIMARY KEY的情况，使用原来的recordId策略
-            std::vector<uint32_t> allRecordIds = table->getAllRecordIds();
             
-            for (uint32_t recordId : allRecordIds) {
-                Row currentRow = table->getRow(recordId);
-                if (currentRow.getFieldCount() == 0) {
-                    continue;
-                }
-                
-                // 检查WHERE条件
-                bool shouldUpdate = true;
-                if (updateStmt_->whereClause) {
-                    shouldUpdate = evaluateWhereCondition(updateStmt_->whereClause.get(), currentRow);
-                }
-                
-                if (!shouldUpdate) {
-                    continue;
-                }
+            // 然后更新指定的列
+            for (const auto& assignment : updateStmt_->assignments) {
+                int columnIndex = table->getColumnIndex(assignment->columnName);
                 
-                // 立即更新这条记录
-                Row oldRow = currentRow;
-                
-                // 创建新行，保持原有列的顺序，只更新指定的列
-                std::vector<Value> allValues;
-                
-                // 先复制所有原始值
-                for (size_t j = 0; j < oldRow.getFieldCount(); ++j) {
-                    allValues.push_back(oldRow.getValue(j));
-                }
-                
-                // 然后更新指定的列
-                for (const auto& assignment : updateStmt_->assignments) {
-                    int columnIndex = table->getColumnIndex(assignment->columnName);
-                    
-                    if (columnIndex >= 0 && columnIndex < static_cast<int>(allValues.size())) {
-                        Value newValue = evaluateExpression(assignment->value.get(), oldRow);
-                        allValues[columnIndex] = newValue;
-                    }
+                if (columnIndex >= 0 && columnIndex < static_cast<int>(allValues.size())) {
+                    Value newValue = evaluateExpression(assignment->value.get(), oldRow);
+                    allValues[columnIndex] = newValue;
                 }
-                
-                Row newRow(allValues);
-                
-                // 执行更新操作
-                bool success = context_->getStorageEngine()->updateRow(updateStmt_->tableName, oldRow, newRow, recordId);
-                if (success) {
-                    updatedCount++;
-                } else {
-                    failedCount++;
-                    if (!errorMessages.empty()) {
-                        errorMessages += "; ";
-                    }
-                    errorMessages += "Failed to update record " + std::to_string(recordId);
+            }
+            
+            Row newRow(allValues);
+            
+            // 执行更新操作
+            bool success = context_->getStorageEngine()->updateRow(updateStmt_->tableName, oldRow, newRow, recordId);
+            if (success) {
+                updatedCount++;
+            } else {
+                failedCount++;
+                if (!errorMessages.empty()) {
+                    errorMessages += "; ";
                 }
+                errorMessages += "Failed to update record " + std::to_string(ridPageId(recordId)) + 
+                                 ":" + std::to_string(ridSlotId(recordId));
             }
         }
         
@@ -215,7 +132,8 @@ ExecutionResult UpdateExecutor::next() {
     }
 }
 
-Value UpdateExecutor::evaluateExpression(Expression* expr, const Row& currentRow) {
+template <typename RowT>
+Value UpdateExecutor::evaluateExpression(Expression* expr, const RowT& currentRow) {
     if (!expr) {
         throw std::runtime_error("Expression is null");
     }
@@ -256,7 +174,7 @@ Value UpdateExecutor::evaluateExpression(Expression* expr, const Row& currentRow
                         return std::get<double>(left) + std::get<double>(right);
                     }
                     break;
-                    
+                
                 case TokenType::MINUS:
                     if (std::holds_alternative<int>(left) && std::holds_alternative<int>(right)) {
                         return std::get<int>(left) - std::get<int>(right);
@@ -265,13 +183,13 @@ Value UpdateExecutor::evaluateExpression(Expression* expr, const Row& currentRow
                         return std::get<double>(left) - std::get<double>(right);
                     }
                     break;
-                    
+                
                 case TokenType::EQUAL:
                     return (left == right) ? 1 : 0;
-                    
+                
                 case TokenType::NOT_EQUAL:
                     return (left != right) ? 1 : 0;
-                    
+                
                 case TokenType::GREATER_THAN:
                     if (std::holds_alternative<int>(left) && std::holds_alternative<int>(right)) {
                         return (std::get<int>(left) > std::get<int>(right)) ? 1 : 0;
@@ -280,7 +198,7 @@ Value UpdateExecutor::evaluateExpression(Expression* expr, const Row& currentRow
                         return (std::get<double>(left) > std::get<double>(right)) ? 1 : 0;
                     }
                     break;
-                    
+                
                 case TokenType::GREATER_EQUAL:
                     if (std::holds_alternative<int>(left) && std::holds_alternative<int>(right)) {
                         return (std::get<int>(left) >= std::get<int>(right)) ? 1 : 0;
@@ -289,7 +207,7 @@ Value UpdateExecutor::evaluateExpression(Expression* expr, const Row& currentRow
                         return (std::get<double>(left) >= std::get<double>(right)) ? 1 : 0;
                     }
                     break;
-                    
+                
                 case TokenType::LESS_THAN:
                     if (std::holds_alternative<int>(left) && std::holds_alternative<int>(right)) {
                         return (std::get<int>(left) < std::get<int>(right)) ? 1 : 0;
@@ -298,7 +216,7 @@ Value UpdateExecutor::evaluateExpression(Expression* expr, const Row& currentRow
                         return (std::get<double>(left) < std::get<double>(right)) ? 1 : 0;
                     }
                     break;
-                    
+                
                 case TokenType::LESS_EQUAL:
                     if (std::holds_alternative<int>(left) && std::holds_alternative<int>(right)) {
                         return (std::get<int>(left) <= std::get<int>(right)) ? 1 : 0;
@@ -307,7 +225,7 @@ Value UpdateExecutor::evaluateExpression(Expression* expr, const Row& currentRow
                         return (std::get<double>(left) <= std::get<double>(right)) ? 1 : 0;
                     }
                     break;
-                    
+                
                 default:
                     break;
             }
@@ -320,7 +238,8 @@ Value UpdateExecutor::evaluateExpression(Expression* expr, const Row& currentRow
     }
 }
 
-bool UpdateExecutor::evaluateWhereCondition(Expression* whereExpr, const Row& row) {
+template <typename RowT>
+bool UpdateExecutor::evaluateWhereCondition(Expression* whereExpr, const RowT& row) {
     if (!whereExpr) {
         return true; // 没有WHERE条件，所有行都符合
     }
@@ -348,6 +348,20 @@ std::string UpdateStatement::toString(int indent) const
     return result;
 }
 
+// TransactionStatement实现
+void TransactionStatement::accept(ASTVisitor *visitor)
+{
+    visitor->visit(this);
+}
+
+std::string TransactionStatement::toString(int indent) const
+{
+    const char *name = action == TransactionAction::BEGIN    ? "BEGIN"
+                       : action == TransactionAction::COMMIT ? "COMMIT"
+                                                             : "ROLLBACK";
+    return getIndent(indent) + "TransactionStatement: " + name;
+}
+
 // ASTPrinter实现
 void ASTPrinter::visit(LiteralExpression *node)
 {
@@ -418,3 +432,8 @@ void ASTPrinter::visit(UpdateStatement *node)
 {
     std::cout << node->toString();
 }
+
+void ASTPrinter::visit(TransactionStatement *node)
+{
+    std::cout << node->toString();
+}
@@ -34,9 +34,21 @@ std::unique_ptr<Statement> Parser::parseStatement()
         {
             return parseUpdateStatement();
         }
+        else if (match(TokenType::BEGIN))
+        {
+            return parseTransactionStatement(TransactionAction::BEGIN);
+        }
+        else if (match(TokenType::COMMIT))
+        {
+            return parseTransactionStatement(TransactionAction::COMMIT);
+        }
+        else if (match(TokenType::ROLLBACK))
+        {
+            return parseTransactionStatement(TransactionAction::ROLLBACK);
+        }
         else
         {
-            addError("Expected statement (CREATE, INSERT, SELECT, DELETE, UPDATE)");
+            addError("Expected statement (CREATE, INSERT, SELECT, DELETE, UPDATE, BEGIN, COMMIT, ROLLBACK)");
             synchronize();
             return nullptr;
         }
@@ -374,6 +386,20 @@ std::unique_ptr<Statement> Parser::parseDeleteStatement()
     return std::move(stmt);
 }
 
+std::unique_ptr<Statement> Parser::parseTransactionStatement(TransactionAction action)
+{
+    // 可选的TRANSACTION关键字
+    match(TokenType::TRANSACTION);
+
+    // 可选的分号
+    if (check(TokenType::SEMICOLON))
+    {
+        advance();
+    }
+
+    return std::make_unique<TransactionStatement>(action);
+}
+
 std::unique_ptr<Statement> Parser::parseUpdateStatement()
 {
     // UPDATE table_name SET column1=value1, column2=value2 WHERE condition
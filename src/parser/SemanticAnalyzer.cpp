@@ -273,6 +273,11 @@ void SemanticAnalyzer::visit(UpdateStatement *node)
     analyzeUpdate(node);
 }
 
+void SemanticAnalyzer::visit(TransactionStatement *)
+{
+    // 事务控制语句不引用任何表或列
+}
+
 void SemanticAnalyzer::visit(CreateIndexStatement *node)
 {
     analyzeCreateIndex(node);
@@ -89,7 +89,13 @@ void KeywordMap::initializeKeywords()
         // 约束关键字
         {"PRIMARY", TokenType::PRIMARY},
         {"KEY", TokenType::KEY},
-        {"NOT", TokenType::NOT}};
+        {"NOT", TokenType::NOT},
+
+        // 事务关键字
+        {"BEGIN", TokenType::BEGIN},
+        {"COMMIT", TokenType::COMMIT},
+        {"ROLLBACK", TokenType::ROLLBACK},
+        {"TRANSACTION", TokenType::TRANSACTION}};
 
     initialized_ = true;
 }
@@ -214,6 +220,16 @@ std::string tokenTypeToString(TokenType type)
     case TokenType::NOT_NULL:
         return "NOT_NULL";
 
+    // 事务关键字
+    case TokenType::BEGIN:
+        return "BEGIN";
+    case TokenType::COMMIT:
+        return "COMMIT";
+    case TokenType::ROLLBACK:
+        return "ROLLBACK";
+    case TokenType::TRANSACTION:
+        return "TRANSACTION";
+
     case TokenType::IDENTIFIER:
         return "IDENTIFIER";
     case TokenType::INTEGER:
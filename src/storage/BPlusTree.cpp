@@ -37,7 +37,7 @@ void BPlusTreeLeafNode::removeKey(int index) {
     }
 }
 
-void BPlusTreeLeafNode::insertRecord(const Value& key, uint32_t recordId) {
+void BPlusTreeLeafNode::insertRecord(const Value& key, RID recordId) {
     // 找到插入位置
     int pos = 0;
     while (pos < keyCount) {
@@ -63,7 +63,7 @@ void BPlusTreeLeafNode::insertRecord(const Value& key, uint32_t recordId) {
     keyCount++;
 }
 
-bool BPlusTreeLeafNode::removeRecord(const Value& key, uint32_t recordId) {
+bool BPlusTreeLeafNode::removeRecord(const Value& key, RID recordId) {
     for (int i = 0; i < keyCount; ++i) {
         if (keys[i] == key && recordIds[i] == recordId) {
             removeKey(i);
@@ -73,8 +73,8 @@ bool BPlusTreeLeafNode::removeRecord(const Value& key, uint32_t recordId) {
     return false;
 }
 
-std::vector<uint32_t> BPlusTreeLeafNode::findRecords(const Value& key) const {
-    std::vector<uint32_t> result;
+std::vector<RID> BPlusTreeLeafNode::findRecords(const Value& key) const {
+    std::vector<RID> result;
     for (int i = 0; i < keyCount; ++i) {
         if (keys[i] == key) {
             result.push_back(recordIds[i]);
@@ -83,8 +83,8 @@ std::vector<uint32_t> BPlusTreeLeafNode::findRecords(const Value& key) const {
     return result;
 }
 
-std::vector<uint32_t> BPlusTreeLeafNode::findRecordsInRange(const Value& startKey, const Value& endKey) const {
-    std::vector<uint32_t> result;
+std::vector<RID> BPlusTreeLeafNode::findRecordsInRange(const Value& startKey, const Value& endKey) const {
+    std::vector<RID> result;
     for (int i = 0; i < keyCount; ++i) {
         // 改进的范围比较，支持数值类型之间的转换
         bool inRange = std::visit([&startKey, &endKey](const auto& keyVal) -> bool {
@@ -196,7 +196,7 @@ BPlusTree::~BPlusTree() {
     clear();
 }
 
-bool BPlusTree::insert(const Value& key, uint32_t recordId) {
+bool BPlusTree::insert(const Value& key, RID recordId) {
     if (!root_) {
         // 创建根节点（叶子节点）
         root_ = new BPlusTreeLeafNode(maxKeys_);
@@ -218,7 +218,7 @@ bool BPlusTree::insert(const Value& key, uint32_t recordId) {
     return true;
 }
 
-bool BPlusTree::remove(const Value& key, uint32_t recordId) {
+bool BPlusTree::remove(const Value& key, RID recordId) {
     if (!root_) return false;
     
     BPlusTreeLeafNode* leaf = findLeafNode(key);
@@ -236,7 +236,7 @@ bool BPlusTree::remove(const Value& key, uint32_t recordId) {
     return true;
 }
 
-std::vector<uint32_t> BPlusTree::search(const Value& key) const {
+std::vector<RID> BPlusTree::search(const Value& key) const {
     if (!root_) return {};
     
     BPlusTreeLeafNode* leaf = findLeafNode(key);
@@ -245,8 +245,8 @@ std::vector<uint32_t> BPlusTree::search(const Value& key) const {
     return leaf->findRecords(key);
 }
 
-std::vector<uint32_t> BPlusTree::rangeSearch(const Value& startKey, const Value& endKey) const {
-    std::vector<uint32_t> result;
+std::vector<RID> BPlusTree::rangeSearch(const Value& startKey, const Value& endKey) const {
+    std::vector<RID> result;
     if (!root_) return result;
     
     BPlusTreeLeafNode* leaf = findLeafNode(startKey);
@@ -332,13 +332,13 @@ BPlusTreeLeafNode* BPlusTree::findLeafNode(const Value& key) const {
     return static_cast<BPlusTreeLeafNode*>(current);
 }
 
-void BPlusTree::splitLeafNode(BPlusTreeLeafNode* leaf, const Value& key, uint32_t recordId) {
+void BPlusTree::splitLeafNode(BPlusTreeLeafNode* leaf, const Value& key, RID recordId) {
     // 创建新的叶子节点
     auto newLeaf = new BPlusTreeLeafNode(maxKeys_);
     nodeCount_++;
     
     // 收集所有键值对（包括新的键值对）
-    std::vector<std::pair<Value, uint32_t>> allEntries;
+    std::vector<std::pair<Value, RID>> allEntries;
     
     // 添加现有的键值对
     for (int i = 0; i < leaf->keyCount; ++i) {
@@ -350,7 +350,7 @@ void BPlusTree::splitLeafNode(BPlusTreeLeafNode* leaf, const Value& key, uint32_
     
     // 按键排序所有条目
     std::sort(allEntries.begin(), allEntries.end(), 
-        [this](const std::pair<Value, uint32_t>& a, const std::pair<Value, uint32_t>& b) {
+        [this](const std::pair<Value, RID>& a, const std::pair<Value, RID>& b) {
             return compareValues(a.first, b.first) < 0;
         });
     
@@ -2,104 +2,228 @@
 #include <iostream>
 #include <algorithm>
 #include <iomanip>
+#include <cstring>
 
-BufferPool::BufferPool(size_t poolSize) : poolSize_(poolSize) {
-    stats_.totalFrames = poolSize;
+namespace {
+
+// 统计计数器只需要原子性，不需要与其他内存操作排序
+inline void increment(std::atomic<size_t>& counter, size_t n = 1) {
+    counter.fetch_add(n, std::memory_order_relaxed);
+}
+
+inline void decrement(std::atomic<size_t>& counter, size_t n = 1) {
+    counter.fetch_sub(n, std::memory_order_relaxed);
+}
+
+inline size_t load(const std::atomic<size_t>& counter) {
+    return counter.load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+BufferPool::BufferPool(size_t poolSize, std::unique_ptr<DiskBackend> diskBackend, ReplacementPolicyType policyType,
+                       size_t shardCount, bool useHugePages)
+    : poolSize_(poolSize), arena_(poolSize, useHugePages), diskBackend_(std::move(diskBackend)), wal_(nullptr),
+      flusherRunning_(false), flushRequested_(false), flusherRuns_(0), prefetchDepth_(DEFAULT_PREFETCH_DEPTH), prefetchRunning_(false),
+      prefetchedPages_(0), prefetchReads_(0) {
+    if (shardCount == 0) {
+        shardCount = std::min<size_t>(16, std::max<size_t>(1, poolSize / 16));
+    }
+    shardCount = std::max<size_t>(1, std::min(shardCount, std::max<size_t>(1, poolSize)));
+    
+    // 帧数平均分给各分片，余数分给前几个分片；每个分片使用内存池中连续的一段帧
+    size_t nextFrame = 0;
+    for (size_t i = 0; i < shardCount; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->capacity = poolSize / shardCount + (i < poolSize % shardCount ? 1 : 0);
+        shard->policy = createReplacementPolicy(policyType, shard->capacity);
+        shard->frames.reserve(shard->capacity);
+        shard->freeFrames.reserve(shard->capacity);
+        for (size_t j = 0; j < shard->capacity; ++j) {
+            shard->frames.emplace_back(arena_.getFrame(nextFrame++));
+        }
+        // 逆序放入，先取出低地址的帧
+        for (auto it = shard->frames.rbegin(); it != shard->frames.rend(); ++it) {
+            shard->freeFrames.push_back(&*it);
+        }
+        shards_.push_back(std::move(shard));
+    }
 }
 
 BufferPool::~BufferPool() {
+    stopPrefetcher();
+    stopFlusher();
     flushAllPages();
 }
 
-std::shared_ptr<Page> BufferPool::getPage(uint32_t pageId) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    // 检查页面是否在缓冲池中
-    auto it = frameTable_.find(pageId);
-    if (it != frameTable_.end()) {
-        // 缓存命中
-        stats_.hitCount++;
-        auto frame = it->second;
-        frame->pinCount++;
-        frame->isPinned = true;
+BufferPool::Shard& BufferPool::shardFor(uint32_t pageId) const {
+    // 乘法哈希打散页ID后取高位，连续的页ID和按固定步长访问的页ID都能均匀分布到各分片
+    uint32_t hash = pageId * 2654435761u;
+    return *shards_[(hash >> 16) % shards_.size()];
+}
+
+Page* BufferPool::getPage(uint32_t pageId, bool forWrite) {
+    Shard& shard = shardFor(pageId);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    
+    while (true) {
+        // 检查页面是否在缓冲池中
+        auto it = shard.frameTable.find(pageId);
+        if (it != shard.frameTable.end()) {
+            BufferFrame* frame = it->second;
+            if (frame->isLoading) {
+                // 其他线程正在加载同一页面，等待这次加载而不是重复读盘
+                // （加载失败时帧会被放回空闲列表并可能装入其他页面，所以按页面ID重新查找）
+                increment(shard.counters.loadWaits);
+                shard.loadCv.wait(lock, [&] {
+                    auto current = shard.frameTable.find(pageId);
+                    return current == shard.frameTable.end() || !current->second->isLoading;
+                });
+                continue;
+            }
+            
+            // 缓存命中
+            increment(shard.counters.hitCount);
+            frame->pinCount++;
+            if (forWrite) {
+                frame->writerCount++;
+                // 干净页面第一次以写方式固定：之后的修改记录都不早于当前的日志末尾
+                if (frame->recLsn == 0) {
+                    frame->recLsn = logPosition();
+                }
+            }
+            if (frame->isPrefetched) {
+                frame->isPrefetched = false;
+                increment(shard.counters.prefetchHits);
+            }
+            
+            shard.policy->recordAccess(pageId);
+            
+            return &frame->page;
+        }
         
-        // 移动到LRU链表前端
-        moveToFront(pageId);
+        if (!diskBackend_) {
+            return nullptr;
+        }
+        if (!shard.freeFrames.empty()) {
+            break;
+        }
         
-        return frame->page;
-    }
-    
-    // 缓存未命中
-    stats_.missCount++;
-    
-    // 检查缓冲池是否已满
-    if (frameTable_.size() >= poolSize_) {
-        // 需要淘汰页面
-        if (!evictPage()) {
+        // 分片已满，需要淘汰页面（写回脏页时会释放锁，因此之后要重新检查）
+        if (!evictFrame(shard, lock)) {
+            if (shard.prefetchingFrames > 0) {
+                // 其余的帧都被固定或正在预读，预读完成后这些帧就可以淘汰
+                shard.loadCv.wait(lock);
+                continue;
+            }
             std::cerr << "Failed to evict page from buffer pool" << std::endl;
             return nullptr;
         }
     }
     
-    // 这里应该从磁盘加载页面，暂时创建一个新页面
-    auto page = std::make_shared<Page>(pageId);
-    auto frame = std::make_shared<BufferFrame>(page, pageId);
+    // 缓存未命中：先把空闲帧标记为加载中放入帧表，并发请求同一页面的线程会等待这次加载
+    increment(shard.counters.missCount);
+    BufferFrame* frame = shard.freeFrames.back();
+    shard.freeFrames.pop_back();
+    frame->pageId = pageId;
+    frame->isLoading = true;
     frame->pinCount = 1;
-    frame->isPinned = true;
-    
-    // 添加到缓冲池
-    frameTable_[pageId] = frame;
-    addToFront(pageId);
-    stats_.usedFrames++;
+    frame->writerCount = forWrite ? 1 : 0;
+    frame->recLsn = forWrite ? logPosition() : 0;
+    shard.frameTable[pageId] = frame;
+    shard.policy->recordInsert(pageId);
+    increment(shard.counters.usedFrames);
+    
+    // 读盘期间释放锁，页面直接读入帧内存，不经过中间缓冲区
+    lock.unlock();
+    uint8_t* frameData = frame->page.getData();
+    bool loaded = diskBackend_->readPage(pageId, frameData) && Page::validateImage(frameData);
+    lock.lock();
+    
+    increment(shard.counters.diskReads);
+    frame->isLoading = false;
+    shard.loadCv.notify_all();
+    if (!loaded) {
+        releaseFrame(shard, frame);
+        return nullptr;
+    }
     
-    return page;
+    return &frame->page;
 }
 
-bool BufferPool::putPage(std::shared_ptr<Page> page) {
-    if (!page) return false;
-    
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    uint32_t pageId = page->getPageId();
-    auto it = frameTable_.find(pageId);
-    
-    if (it != frameTable_.end()) {
-        // 页面已在缓冲池中，更新内容
-        it->second->page = page;
-        it->second->isDirty = true;
-        moveToFront(pageId);
-        return true;
-    }
-    
-    // 页面不在缓冲池中，需要添加
-    if (frameTable_.size() >= poolSize_) {
-        if (!evictPage()) {
+bool BufferPool::putPage(const Page& page) {
+    uint32_t pageId = page.getPageId();
+    Shard& shard = shardFor(pageId);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    
+    while (true) {
+        auto it = shard.frameTable.find(pageId);
+        if (it != shard.frameTable.end()) {
+            BufferFrame* frame = it->second;
+            if (frame->isLoading) {
+                // 等待加载完成，否则加载结果会覆盖这里放入的新内容
+                shard.loadCv.wait(lock, [&] {
+                    auto current = shard.frameTable.find(pageId);
+                    return current == shard.frameTable.end() || !current->second->isLoading;
+                });
+                continue;
+            }
+            
+            // 页面已在缓冲池中，更新内容（传入的就是该帧的视图时不需要复制）
+            frame->page.copyFrom(page);
+            frame->isPrefetched = false;
+            if (frame->recLsn == 0) {
+                frame->recLsn = page.getLsn() != 0 ? page.getLsn() : logPosition();
+            }
+            setDirty(shard, *frame, true);
+            shard.policy->recordAccess(pageId);
+            return true;
+        }
+        
+        if (!shard.freeFrames.empty()) {
+            break;
+        }
+        
+        // 页面不在缓冲池中，需要先淘汰一个页面
+        if (!evictFrame(shard, lock)) {
             return false;
         }
     }
     
-    auto frame = std::make_shared<BufferFrame>(page, pageId);
-    frame->isDirty = true;
-    frameTable_[pageId] = frame;
-    addToFront(pageId);
-    stats_.usedFrames++;
+    BufferFrame* frame = shard.freeFrames.back();
+    shard.freeFrames.pop_back();
+    frame->page.copyFrom(page);
+    frame->pageId = pageId;
+    // 页面镜像的日志记录在放入之前写入，它的LSN就是第一条未写回的修改
+    frame->recLsn = page.getLsn() != 0 ? page.getLsn() : logPosition();
+    setDirty(shard, *frame, true);
+    shard.frameTable[pageId] = frame;
+    shard.policy->recordInsert(pageId);
+    increment(shard.counters.usedFrames);
     
     return true;
 }
 
 bool BufferPool::flushPage(uint32_t pageId) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    Shard& shard = shardFor(pageId);
+    std::unique_lock<std::mutex> lock(shard.mutex);
     
-    auto it = frameTable_.find(pageId);
-    if (it == frameTable_.end()) {
+    auto it = shard.frameTable.find(pageId);
+    if (it == shard.frameTable.end()) {
         return false;
     }
     
-    auto frame = it->second;
+    // 等待后台刷新线程的写回完成，避免旧镜像覆盖新镜像
+    BufferFrame* frame = it->second;
+    shard.flushDoneCv.wait(lock, [&] { return !frame->isFlushing; });
+    if (frame->writerCount > 0) {
+        return false; // 页面正在被修改，不能复制镜像
+    }
     if (frame->isDirty) {
-        // 这里应该写回磁盘，暂时只是标记为非脏页
-        if (writeBackPage(frame)) {
-            frame->isDirty = false;
+        if (writeBackPage(*frame)) {
+            setDirty(shard, *frame, false);
+            frame->recLsn = 0;
+            increment(shard.counters.flushedPages);
             return true;
         }
         return false;
@@ -108,177 +232,702 @@ bool BufferPool::flushPage(uint32_t pageId) {
     return true; // 非脏页，无需写回
 }
 
-void BufferPool::flushAllPages() {
-    std::lock_guard<std::mutex> lock(mutex_);
+bool BufferPool::discardPage(uint32_t pageId) {
+    Shard& shard = shardFor(pageId);
+    std::unique_lock<std::mutex> lock(shard.mutex);
     
-    for (auto& pair : frameTable_) {
-        auto frame = pair.second;
-        if (frame->isDirty) {
-            writeBackPage(frame);
-            frame->isDirty = false;
+    while (true) {
+        auto it = shard.frameTable.find(pageId);
+        if (it == shard.frameTable.end()) {
+            return true;
+        }
+        BufferFrame* frame = it->second;
+        if (frame->isLoading) {
+            shard.loadCv.wait(lock, [&] {
+                auto current = shard.frameTable.find(pageId);
+                return current == shard.frameTable.end() || !current->second->isLoading;
+            });
+            continue;
+        }
+        if (frame->isFlushing) {
+            // 写回完成后帧可能已被淘汰，按页面ID重新查找
+            shard.flushDoneCv.wait(lock, [&] { return !frame->isFlushing; });
+            continue;
+        }
+        if (frame->pinCount > 0) {
+            return false;
+        }
+        
+        setDirty(shard, *frame, false);
+        releaseFrame(shard, frame);
+        return true;
+    }
+}
+
+void BufferPool::flushAllPages() {
+    // 检查点：逐个分片写回所有脏页
+    // 先等后台刷新线程正在进行的写回完成，之后仍为脏页的页面由这里写回
+    for (auto& shardPtr : shards_) {
+        Shard& shard = *shardPtr;
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        shard.flushDoneCv.wait(lock, [&] { return shard.flushingFrames == 0; });
+        increment(shard.counters.flushedPages, writeBackColdPages(shard, lock, 0));
+    }
+}
+
+size_t BufferPool::flushPagesBefore(uint64_t lsn) {
+    // 与flushAllPages相同逐个分片写回，但只写回在lsn之前变脏的页面，之后才变脏的页面留给下一个检查点
+    size_t written = 0;
+    for (auto& shardPtr : shards_) {
+        Shard& shard = *shardPtr;
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        shard.flushDoneCv.wait(lock, [&] { return shard.flushingFrames == 0; });
+        size_t shardWritten = writeBackColdPages(shard, lock, 0, lsn);
+        increment(shard.counters.flushedPages, shardWritten);
+        written += shardWritten;
+    }
+    return written;
+}
+
+std::vector<std::pair<uint32_t, uint64_t>> BufferPool::getDirtyPageTable() const {
+    std::vector<std::pair<uint32_t, uint64_t>> dirtyPages;
+    for (const auto& shardPtr : shards_) {
+        const Shard& shard = *shardPtr;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& pair : shard.frameTable) {
+            if (pair.second->recLsn != 0) {
+                dirtyPages.emplace_back(pair.first, pair.second->recLsn);
+            }
         }
     }
+    return dirtyPages;
+}
+
+bool BufferPool::markDirty(uint32_t pageId) {
+    Shard& shard = shardFor(pageId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    
+    auto it = shard.frameTable.find(pageId);
+    if (it == shard.frameTable.end()) {
+        return false;
+    }
+    if (it->second->recLsn == 0) {
+        it->second->recLsn = logPosition();
+    }
+    setDirty(shard, *it->second, true);
+    return true;
 }
 
 bool BufferPool::pinPage(uint32_t pageId) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    Shard& shard = shardFor(pageId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
     
-    auto it = frameTable_.find(pageId);
-    if (it == frameTable_.end()) {
+    auto it = shard.frameTable.find(pageId);
+    if (it == shard.frameTable.end()) {
         return false;
     }
     
-    auto frame = it->second;
-    frame->pinCount++;
-    frame->isPinned = true;
+    it->second->pinCount++;
     
     return true;
 }
 
-bool BufferPool::unpinPage(uint32_t pageId) {
-    std::lock_guard<std::mutex> lock(mutex_);
+bool BufferPool::unpinPage(uint32_t pageId, bool forWrite) {
+    Shard& shard = shardFor(pageId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
     
-    auto it = frameTable_.find(pageId);
-    if (it == frameTable_.end()) {
+    auto it = shard.frameTable.find(pageId);
+    if (it == shard.frameTable.end()) {
         return false;
     }
     
-    auto frame = it->second;
+    BufferFrame* frame = it->second;
+    if (forWrite) {
+        setDirty(shard, *frame, true);
+        if (frame->writerCount > 0) {
+            frame->writerCount--;
+        }
+    }
     if (frame->pinCount > 0) {
         frame->pinCount--;
-        if (frame->pinCount == 0) {
-            frame->isPinned = false;
-        }
     }
     
     return true;
 }
 
 bool BufferPool::evictPage() {
-    // 查找可以淘汰的页面
-    auto victimFrame = findVictimFrame();
-    if (!victimFrame) {
-        return false; // 没有可淘汰的页面
+    // 从第一个有可淘汰页面的分片中淘汰
+    for (auto& shardPtr : shards_) {
+        std::unique_lock<std::mutex> lock(shardPtr->mutex);
+        if (evictFrame(*shardPtr, lock)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BufferPool::evictFrame(Shard& shard, std::unique_lock<std::mutex>& lock) {
+    while (true) {
+        // 查找可以淘汰的页面
+        BufferFrame* victimFrame = findVictimFrame(shard);
+        if (!victimFrame) {
+            return false; // 没有可淘汰的页面
+        }
+        
+        uint32_t victimPageId = victimFrame->pageId;
+        
+        // 如果是脏页，需要写回磁盘：写盘期间释放锁，帧标记为写回中，不会被再次选为淘汰对象
+        // 写回的是持锁时复制的镜像，释放锁后其他线程可以继续固定并修改帧内容
+        if (victimFrame->isDirty) {
+            AlignedPageBuffer image;
+            victimFrame->page.serializeTo(image.data());
+            uint64_t pageLsn = victimFrame->page.getLsn();
+            victimFrame->isFlushing = true;
+            setDirty(shard, *victimFrame, false);
+            shard.flushingFrames++;
+            
+            lock.unlock();
+            bool written = forceLog(pageLsn) && (!diskBackend_ || diskBackend_->writePage(victimPageId, image.data()));
+            lock.lock();
+            
+            victimFrame->isFlushing = false;
+            shard.flushingFrames--;
+            shard.flushDoneCv.notify_all();
+            
+            if (!written) {
+                std::cerr << "Failed to write back dirty page " << victimPageId << std::endl;
+                setDirty(shard, *victimFrame, true);
+                return false;
+            }
+            increment(shard.counters.evictionWrites);
+            
+            // 写盘期间页面可能又被固定或修改，这时不能淘汰，重新选择
+            auto it = shard.frameTable.find(victimPageId);
+            if (it == shard.frameTable.end() || it->second != victimFrame) {
+                return true;
+            }
+            if (victimFrame->pinCount > 0 || victimFrame->isDirty) {
+                if (!victimFrame->isDirty && victimFrame->writerCount == 0) {
+                    victimFrame->recLsn = 0;
+                }
+                continue;
+            }
+        }
+        
+        // 从缓冲池中移除，帧放回空闲列表
+        releaseFrame(shard, victimFrame);
+        increment(shard.counters.evictionCount);
+        
+        return true;
+    }
+}
+
+DiskBackend* BufferPool::getDiskBackend() const {
+    return diskBackend_.get();
+}
+
+void BufferPool::setWriteAheadLog(WriteAheadLog* wal) {
+    wal_.store(wal, std::memory_order_release);
+}
+
+const char* BufferPool::getPolicyName() const {
+    return shards_.front()->policy->getName();
+}
+
+size_t BufferPool::getShardCount() const {
+    return shards_.size();
+}
+
+const FrameArena& BufferPool::getArena() const {
+    return arena_;
+}
+
+void BufferPool::startFlusher(const FlusherConfig& config) {
+    stopFlusher();
+    
+    std::lock_guard<std::mutex> lock(flusherMutex_);
+    flusherConfig_ = config;
+    if (!flusherConfig_.enabled) {
+        return;
+    }
+    flushRequested_ = false;
+    flusherRunning_ = true;
+    flusherThread_ = std::thread(&BufferPool::flusherLoop, this);
+}
+
+void BufferPool::stopFlusher() {
+    {
+        std::lock_guard<std::mutex> lock(flusherMutex_);
+        flusherRunning_ = false;
+    }
+    flusherCv_.notify_all();
+    if (flusherThread_.joinable()) {
+        flusherThread_.join();
+    }
+}
+
+void BufferPool::flusherLoop() {
+    std::unique_lock<std::mutex> lock(flusherMutex_);
+    while (flusherRunning_) {
+        flusherCv_.wait_for(lock, std::chrono::milliseconds(flusherConfig_.intervalMs), [&] {
+            return !flusherRunning_ || flushRequested_;
+        });
+        if (!flusherRunning_) {
+            break;
+        }
+        flushRequested_ = false;
+        double lowWatermark = flusherConfig_.lowWatermark;
+        
+        // 逐个分片检查脏页比例，写回时只持有该分片的锁
+        lock.unlock();
+        bool flushed = false;
+        for (auto& shardPtr : shards_) {
+            Shard& shard = *shardPtr;
+            size_t lowDirty = static_cast<size_t>(shard.capacity * lowWatermark);
+            if (load(shard.counters.dirtyFrames) <= lowDirty) {
+                continue;
+            }
+            std::unique_lock<std::mutex> shardLock(shard.mutex);
+            increment(shard.counters.flusherWrites, writeBackColdPages(shard, shardLock, lowDirty));
+            flushed = true;
+        }
+        if (flushed) {
+            increment(flusherRuns_);
+        }
+        lock.lock();
+    }
+}
+
+void BufferPool::prefetchPages(const std::vector<uint32_t>& pageIds) {
+    if (!diskBackend_ || pageIds.empty() || getPrefetchDepth() == 0) {
+        return;
     }
     
-    uint32_t victimPageId = victimFrame->pageId;
+    {
+        std::lock_guard<std::mutex> lock(prefetchMutex_);
+        // 预读跟不上时丢弃新的请求，队列长度不超过缓冲池大小
+        if (prefetchQueue_.size() + pageIds.size() > poolSize_) {
+            return;
+        }
+        prefetchQueue_.insert(prefetchQueue_.end(), pageIds.begin(), pageIds.end());
+        if (!prefetchRunning_) {
+            prefetchRunning_ = true;
+            prefetchThread_ = std::thread(&BufferPool::prefetcherLoop, this);
+        }
+    }
+    prefetchCv_.notify_one();
+}
+
+void BufferPool::stopPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(prefetchMutex_);
+        prefetchRunning_ = false;
+        prefetchQueue_.clear();
+    }
+    prefetchCv_.notify_all();
+    if (prefetchThread_.joinable()) {
+        prefetchThread_.join();
+    }
+}
+
+void BufferPool::setPrefetchDepth(size_t depth) {
+    prefetchDepth_ = depth;
+}
+
+size_t BufferPool::getPrefetchDepth() const {
+    return prefetchDepth_.load();
+}
+
+void BufferPool::prefetcherLoop() {
+    std::unique_lock<std::mutex> lock(prefetchMutex_);
+    while (true) {
+        prefetchCv_.wait(lock, [&] { return !prefetchRunning_ || !prefetchQueue_.empty(); });
+        if (!prefetchRunning_) {
+            break;
+        }
+        std::vector<uint32_t> batch;
+        batch.swap(prefetchQueue_);
+        
+        lock.unlock();
+        prefetchBatch(batch);
+        lock.lock();
+    }
+}
+
+void BufferPool::prefetchBatch(const std::vector<uint32_t>& pageIds) {
+    // 为每个页面占用一个加载中的帧，页ID连续的页面攒成一组，各组一次性提交给磁盘后端
+    size_t maxRun = std::max<size_t>(1, getPrefetchDepth());
+    std::vector<PrefetchRun> runs(1);
+    for (uint32_t pageId : pageIds) {
+        PrefetchRun& run = runs.back();
+        if (!run.empty() && (pageId != run.back().first + 1 || run.size() >= maxRun)) {
+            runs.emplace_back();
+        }
+        BufferFrame* frame = reservePrefetchFrame(pageId);
+        if (frame) {
+            runs.back().emplace_back(pageId, frame);
+        } else if (!runs.back().empty()) {
+            runs.emplace_back();
+        }
+    }
+    if (runs.back().empty()) {
+        runs.pop_back();
+    }
+    if (!runs.empty()) {
+        readPrefetchRuns(runs);
+    }
+}
+
+BufferFrame* BufferPool::reservePrefetchFrame(uint32_t pageId) {
+    Shard& shard = shardFor(pageId);
+    std::unique_lock<std::mutex> lock(shard.mutex);
     
-    // 如果是脏页，需要写回磁盘
-    if (victimFrame->isDirty) {
-        if (!writeBackPage(victimFrame)) {
-            std::cerr << "Failed to write back dirty page " << victimPageId << std::endl;
-            return false;
+    while (true) {
+        if (shard.frameTable.find(pageId) != shard.frameTable.end()) {
+            return nullptr; // 已在缓冲池中或正在加载
+        }
+        if (shard.prefetchingFrames >= std::max<size_t>(1, shard.capacity / 4)) {
+            return nullptr; // 预读不能占用过多的帧
+        }
+        if (!shard.freeFrames.empty()) {
+            break;
+        }
+        if (!evictFrame(shard, lock)) {
+            return nullptr; // 没有可淘汰的页面，放弃预读
+        }
+    }
+    
+    BufferFrame* frame = shard.freeFrames.back();
+    shard.freeFrames.pop_back();
+    frame->pageId = pageId;
+    frame->isLoading = true;
+    frame->isPrefetched = true;
+    frame->pinCount = 0;
+    shard.frameTable[pageId] = frame;
+    shard.policy->recordInsert(pageId);
+    shard.prefetchingFrames++;
+    increment(shard.counters.usedFrames);
+    return frame;
+}
+
+void BufferPool::readPrefetchRuns(const std::vector<PrefetchRun>& runs) {
+    // 各页面的帧分属不同分片、内存不相邻，先读入连续的临时缓冲区再分别复制
+    size_t totalPages = 0;
+    for (const auto& run : runs) {
+        totalPages += run.size();
+    }
+    AlignedPageBuffer buffer(totalPages);
+    std::vector<PageReadRequest> requests;
+    requests.reserve(runs.size());
+    size_t offset = 0;
+    for (const auto& run : runs) {
+        requests.push_back({run.front().first, run.size(), buffer.data() + offset * PAGE_SIZE, 0});
+        offset += run.size();
+    }
+    diskBackend_->readPageBatch(requests);
+    increment(prefetchReads_, runs.size());
+    
+    for (size_t r = 0; r < runs.size(); ++r) {
+        const PrefetchRun& run = runs[r];
+        const PageReadRequest& request = requests[r];
+        increment(prefetchedPages_, request.pagesRead);
+        for (size_t i = 0; i < run.size(); ++i) {
+            finishPrefetch(run[i].first, run[i].second, i < request.pagesRead ? request.data + i * PAGE_SIZE : nullptr);
+        }
+    }
+}
+
+void BufferPool::finishPrefetch(uint32_t pageId, BufferFrame* frame, const uint8_t* image) {
+    // 帧处于加载中，其他线程不会读写帧内容，可以在锁外复制
+    bool loaded = image && Page::validateImage(image);
+    if (loaded) {
+        std::memcpy(frame->page.getData(), image, PAGE_SIZE);
+    }
+    
+    Shard& shard = shardFor(pageId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    frame->isLoading = false;
+    shard.prefetchingFrames--;
+    if (!loaded) {
+        frame->isPrefetched = false;
+        releaseFrame(shard, frame);
+    }
+    shard.loadCv.notify_all();
+}
+
+size_t BufferPool::writeBackColdPages(Shard& shard, std::unique_lock<std::mutex>& lock, size_t targetDirty,
+                                      uint64_t beforeLsn) {
+    if (load(shard.counters.dirtyFrames) <= targetDirty) {
+        return 0;
+    }
+    
+    // 持有锁时只复制页面镜像并清除脏标记，写盘时释放锁，不阻塞其他线程访问该分片
+    std::vector<std::pair<BufferFrame*, AlignedPageBuffer>> images;
+    uint64_t maxLsn = 0;
+    for (uint32_t pageId : shard.policy->getColdOrder()) {
+        if (load(shard.counters.dirtyFrames) <= targetDirty) {
+            break;
         }
+        BufferFrame* frame = shard.frameTable.find(pageId)->second;
+        // 正在被修改的页面跳过：复制的镜像可能不完整，写守卫释放时页面仍是脏页，之后再写回
+        if (!frame->isDirty || frame->isFlushing || frame->writerCount > 0 || frame->recLsn >= beforeLsn) {
+            continue;
+        }
+        images.emplace_back(frame, AlignedPageBuffer());
+        frame->page.serializeTo(images.back().second.data());
+        maxLsn = std::max(maxLsn, frame->page.getLsn());
+        frame->isFlushing = true;
+        setDirty(shard, *frame, false);
+    }
+    if (images.empty()) {
+        return 0;
     }
+    shard.flushingFrames += images.size();
     
-    // 从缓冲池中移除
-    frameTable_.erase(victimPageId);
-    removeFromLRU(victimPageId);
-    stats_.usedFrames--;
-    stats_.evictionCount++;
+    std::vector<PageWriteRequest> requests;
+    requests.reserve(images.size());
+    for (const auto& image : images) {
+        requests.push_back({image.first->pageId, image.second.data(), true});
+    }
     
-    return true;
+    // 所有镜像作为一批提交，异步后端可以让它们同时在途；整批只需要一次日志强制
+    lock.unlock();
+    if (!forceLog(maxLsn)) {
+        for (auto& request : requests) {
+            request.written = false;
+        }
+    } else if (diskBackend_) {
+        diskBackend_->writePageBatch(requests);
+    }
+    lock.lock();
+    
+    size_t writtenCount = 0;
+    for (size_t i = 0; i < images.size(); ++i) {
+        BufferFrame* frame = images[i].first;
+        frame->isFlushing = false;
+        if (requests[i].written) {
+            ++writtenCount;
+            // 写盘期间没有再被修改时，页面的修改都已写回
+            if (!frame->isDirty && frame->writerCount == 0) {
+                frame->recLsn = 0;
+            }
+        } else {
+            // 写回失败，重新标记为脏页等待下次写回
+            std::cerr << "Failed to write back dirty page " << frame->pageId << std::endl;
+            setDirty(shard, *frame, true);
+        }
+    }
+    shard.flushingFrames -= images.size();
+    shard.flushDoneCv.notify_all();
+    return writtenCount;
 }
 
-void BufferPool::clearPool() {
-    std::lock_guard<std::mutex> lock(mutex_);
+void BufferPool::setDirty(Shard& shard, BufferFrame& frame, bool dirty) {
+    if (frame.isDirty == dirty) {
+        return;
+    }
+    frame.isDirty = dirty;
+    if (!dirty) {
+        decrement(shard.counters.dirtyFrames);
+        return;
+    }
     
+    increment(shard.counters.dirtyFrames);
+    // 分片脏页过多时立即唤醒后台刷新线程（加锁顺序：分片锁 -> flusherMutex_）
+    if (flusherRunning_ &&
+        load(shard.counters.dirtyFrames) > static_cast<size_t>(shard.capacity * flusherConfig_.highWatermark)) {
+        {
+            std::lock_guard<std::mutex> lock(flusherMutex_);
+            flushRequested_ = true;
+        }
+        flusherCv_.notify_one();
+    }
+}
+
+void BufferPool::clearPool() {
+    // 等预读线程退出，不能清空正在加载的帧（之后的预读请求会重新启动它）
+    stopPrefetcher();
     flushAllPages();
-    frameTable_.clear();
-    lruList_.clear();
-    lruIterators_.clear();
-    stats_.usedFrames = 0;
+    
+    for (auto& shardPtr : shards_) {
+        Shard& shard = *shardPtr;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.frameTable.clear();
+        shard.freeFrames.clear();
+        for (auto it = shard.frames.rbegin(); it != shard.frames.rend(); ++it) {
+            it->pageId = 0;
+            it->isDirty = false;
+            it->isPrefetched = false;
+            it->pinCount = 0;
+            it->writerCount = 0;
+            it->recLsn = 0;
+            shard.freeFrames.push_back(&*it);
+        }
+        shard.policy->clear();
+        shard.counters.usedFrames = 0;
+        shard.counters.dirtyFrames = 0;
+    }
 }
 
-const BufferPoolStats& BufferPool::getStats() const {
-    return stats_;
+BufferPoolStats BufferPool::getStats() const {
+    // 汇总各分片的计数器，不获取分片锁，各项之间不保证是同一时刻的值
+    BufferPoolStats stats;
+    stats.totalFrames = poolSize_;
+    for (const auto& shardPtr : shards_) {
+        const ShardCounters& counters = shardPtr->counters;
+        stats.usedFrames += load(counters.usedFrames);
+        stats.hitCount += load(counters.hitCount);
+        stats.missCount += load(counters.missCount);
+        stats.evictionCount += load(counters.evictionCount);
+        stats.dirtyFrames += load(counters.dirtyFrames);
+        stats.diskReads += load(counters.diskReads);
+        stats.loadWaits += load(counters.loadWaits);
+        stats.evictionWrites += load(counters.evictionWrites);
+        stats.flushedPages += load(counters.flushedPages);
+        stats.flusherWrites += load(counters.flusherWrites);
+        stats.prefetchHits += load(counters.prefetchHits);
+        stats.prefetchWasted += load(counters.prefetchWasted);
+    }
+    stats.flusherRuns = load(flusherRuns_);
+    stats.prefetchedPages = load(prefetchedPages_);
+    stats.prefetchReads = load(prefetchReads_);
+    return stats;
 }
 
 void BufferPool::resetStats() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    stats_.hitCount = 0;
-    stats_.missCount = 0;
-    stats_.evictionCount = 0;
+    // 只清零累计计数，当前占用的帧数和脏页数保持不变
+    for (auto& shardPtr : shards_) {
+        ShardCounters& counters = shardPtr->counters;
+        counters.hitCount = 0;
+        counters.missCount = 0;
+        counters.evictionCount = 0;
+        counters.diskReads = 0;
+        counters.loadWaits = 0;
+        counters.evictionWrites = 0;
+        counters.flushedPages = 0;
+        counters.flusherWrites = 0;
+        counters.prefetchHits = 0;
+        counters.prefetchWasted = 0;
+    }
+    flusherRuns_ = 0;
+    prefetchedPages_ = 0;
+    prefetchReads_ = 0;
 }
 
 void BufferPool::printStats() const {
+    BufferPoolStats stats = getStats();
     std::cout << "Buffer Pool Statistics:" << std::endl;
-    std::cout << "  Total Frames: " << stats_.totalFrames << std::endl;
-    std::cout << "  Used Frames: " << stats_.usedFrames << std::endl;
-    std::cout << "  Hit Count: " << stats_.hitCount << std::endl;
-    std::cout << "  Miss Count: " << stats_.missCount << std::endl;
-    std::cout << "  Eviction Count: " << stats_.evictionCount << std::endl;
-    std::cout << "  Hit Ratio: " << std::fixed << std::setprecision(2) 
-              << (stats_.getHitRatio() * 100) << "%" << std::endl;
+    std::cout << "  Replacement Policy: " << getPolicyName() << std::endl;
+    std::cout << "  Shards: " << shards_.size() << std::endl;
+    std::cout << "  Frame Arena: " << arena_.getBytes() / 1024 << " KB"
+              << (arena_.usesHugePages() ? " (huge pages)" : "") << std::endl;
+    std::cout << "  Total Frames: " << stats.totalFrames << std::endl;
+    std::cout << "  Used Frames: " << stats.usedFrames << std::endl;
+    std::cout << "  Hit Count: " << stats.hitCount << std::endl;
+    std::cout << "  Miss Count: " << stats.missCount << std::endl;
+    std::cout << "  Eviction Count: " << stats.evictionCount << std::endl;
+    std::cout << "  Hit Ratio: " << std::fixed << std::setprecision(2)
+              << (stats.getHitRatio() * 100) << "%" << std::endl;
+    std::cout << "  Disk Reads: " << stats.diskReads << std::endl;
+    std::cout << "  Load Waits: " << stats.loadWaits << std::endl;
+    std::cout << "  Dirty Frames: " << stats.dirtyFrames << std::endl;
+    std::cout << "  Eviction Writes: " << stats.evictionWrites << std::endl;
+    std::cout << "  Checkpoint Writes: " << stats.flushedPages << std::endl;
+    std::cout << "  Flusher Runs: " << stats.flusherRuns << std::endl;
+    std::cout << "  Flusher Writes: " << stats.flusherWrites << std::endl;
+    std::cout << "  Prefetch Depth: " << getPrefetchDepth() << std::endl;
+    std::cout << "  Prefetched Pages: " << stats.prefetchedPages << " (" << stats.prefetchReads << " reads)" << std::endl;
+    std::cout << "  Prefetch Hits: " << stats.prefetchHits << std::endl;
+    std::cout << "  Prefetch Wasted: " << stats.prefetchWasted << std::endl;
 }
 
 void BufferPool::printPoolStatus() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     std::cout << "Buffer Pool Status:" << std::endl;
-    std::cout << "  Pool Size: " << poolSize_ << std::endl;
-    std::cout << "  Used Frames: " << frameTable_.size() << std::endl;
-    
-    std::cout << "  Pages in pool: ";
-    for (const auto& pair : frameTable_) {
-        const auto& frame = pair.second;
-        std::cout << pair.first;
-        if (frame->isDirty) std::cout << "(D)";
-        if (frame->isPinned) std::cout << "(P" << frame->pinCount << ")";
-        std::cout << " ";
-    }
-    std::cout << std::endl;
+    std::cout << "  Pool Size: " << poolSize_ << " (" << shards_.size() << " shards)" << std::endl;
     
-    std::cout << "  LRU order: ";
-    for (auto pageId : lruList_) {
-        std::cout << pageId << " ";
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        const Shard& shard = *shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        
+        std::cout << "  Shard " << i << ": " << shard.frameTable.size() << "/" << shard.capacity << " frames" << std::endl;
+        std::cout << "    Pages in pool: ";
+        for (const auto& pair : shard.frameTable) {
+            const BufferFrame* frame = pair.second;
+            std::cout << pair.first;
+            if (frame->isDirty) std::cout << "(D)";
+            if (frame->pinCount > 0) std::cout << "(P" << frame->pinCount << ")";
+            if (frame->writerCount > 0) std::cout << "(W)";
+            std::cout << " ";
+        }
+        std::cout << std::endl;
+        
+        std::cout << "    " << shard.policy->getName() << " order (coldest first): ";
+        for (auto pageId : shard.policy->getColdOrder()) {
+            std::cout << pageId << " ";
+        }
+        std::cout << std::endl;
     }
-    std::cout << std::endl;
 }
 
 bool BufferPool::isPageInPool(uint32_t pageId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return frameTable_.find(pageId) != frameTable_.end();
+    const Shard& shard = shardFor(pageId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.frameTable.find(pageId) != shard.frameTable.end();
 }
 
-void BufferPool::moveToFront(uint32_t pageId) {
-    removeFromLRU(pageId);
-    addToFront(pageId);
+BufferFrame* BufferPool::findVictimFrame(Shard& shard) {
+    // 由置换策略在未固定的页面中选择淘汰对象
+    uint32_t victimPageId = shard.policy->pickVictim([&shard](uint32_t pageId) {
+        auto frameIt = shard.frameTable.find(pageId);
+        if (frameIt == shard.frameTable.end()) {
+            return false;
+        }
+        const BufferFrame* frame = frameIt->second;
+        return frame->pinCount == 0 && !frame->isFlushing && !frame->isLoading;
+    });
+    
+    if (victimPageId == 0) {
+        return nullptr; // 没有找到可淘汰的页面
+    }
+    return shard.frameTable.find(victimPageId)->second;
 }
 
-void BufferPool::removeFromLRU(uint32_t pageId) {
-    auto it = lruIterators_.find(pageId);
-    if (it != lruIterators_.end()) {
-        lruList_.erase(it->second);
-        lruIterators_.erase(it);
+void BufferPool::releaseFrame(Shard& shard, BufferFrame* frame) {
+    if (frame->isPrefetched) {
+        frame->isPrefetched = false;
+        increment(shard.counters.prefetchWasted);
     }
+    shard.frameTable.erase(frame->pageId);
+    shard.policy->recordRemove(frame->pageId);
+    decrement(shard.counters.usedFrames);
+    
+    frame->pageId = 0;
+    frame->pinCount = 0;
+    frame->writerCount = 0;
+    frame->recLsn = 0;
+    shard.freeFrames.push_back(frame);
 }
 
-void BufferPool::addToFront(uint32_t pageId) {
-    lruList_.push_front(pageId);
-    lruIterators_[pageId] = lruList_.begin();
+bool BufferPool::writeBackPage(const BufferFrame& frame) {
+    if (!diskBackend_) {
+        // 没有后端存储（纯内存缓冲池），直接视为写回成功
+        return true;
+    }
+    AlignedPageBuffer image;
+    frame.page.serializeTo(image.data());
+    return forceLog(frame.page.getLsn()) && diskBackend_->writePage(frame.pageId, image.data());
 }
 
-std::shared_ptr<BufferFrame> BufferPool::findVictimFrame() {
-    // 从LRU链表后端开始查找未固定的页面
-    for (auto it = lruList_.rbegin(); it != lruList_.rend(); ++it) {
-        uint32_t pageId = *it;
-        auto frameIt = frameTable_.find(pageId);
-        if (frameIt != frameTable_.end()) {
-            auto frame = frameIt->second;
-            if (!frame->isPinned) {
-                return frame;
-            }
-        }
+bool BufferPool::forceLog(uint64_t lsn) const {
+    WriteAheadLog* wal = wal_.load(std::memory_order_acquire);
+    if (!wal || lsn == 0 || wal->flush(lsn)) {
+        return true;
     }
-    
-    return nullptr; // 没有找到可淘汰的页面
+    std::cerr << "Failed to force the write-ahead log to LSN " << lsn << std::endl;
+    return false;
 }
 
-bool BufferPool::writeBackPage(std::shared_ptr<BufferFrame> frame) {
-    // 这里应该实现实际的磁盘写入操作
-    // 暂时只是模拟写回成功
-    std::cout << "Writing back page " << frame->pageId << " to disk" << std::endl;
-    return true;
+uint64_t BufferPool::logPosition() const {
+    WriteAheadLog* wal = wal_.load(std::memory_order_acquire);
+    return wal ? wal->getNextLsn() : 0;
 }
@@ -0,0 +1,565 @@
+#include "../../include/storage/DiskBackend.h"
+#include "../../include/storage/FrameArena.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#ifndef _WIN32
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define MINIDB_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+size_t DiskBackend::readPages(uint32_t firstPageId, size_t count, uint8_t* data) {
+    size_t pagesRead = 0;
+    while (pagesRead < count && readPage(firstPageId + static_cast<uint32_t>(pagesRead), data + pagesRead * PAGE_SIZE)) {
+        ++pagesRead;
+    }
+    return pagesRead;
+}
+
+void DiskBackend::readPageBatch(std::vector<PageReadRequest>& requests) {
+    for (auto& request : requests) {
+        request.pagesRead = readPages(request.firstPageId, request.count, request.data);
+    }
+}
+
+void DiskBackend::writePageBatch(std::vector<PageWriteRequest>& requests) {
+    for (auto& request : requests) {
+        request.written = writePage(request.pageId, request.data);
+    }
+}
+
+FileDiskBackend::FileDiskBackend(const std::string& path) : DiskBackend(path) {
+    file_.open(path, std::ios::in | std::ios::out | std::ios::binary);
+    
+    if (!file_.is_open()) {
+        // 文件不存在，创建新文件
+        file_.open(path, std::ios::out | std::ios::binary);
+        if (file_.is_open()) {
+            file_.close();
+            file_.open(path, std::ios::in | std::ios::out | std::ios::binary);
+        }
+    }
+    
+    if (!file_.is_open()) {
+        std::cerr << "Failed to open database file: " << path << std::endl;
+    }
+}
+
+FileDiskBackend::~FileDiskBackend() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_.is_open()) {
+        file_.flush();
+        file_.close();
+    }
+}
+
+bool FileDiskBackend::readPage(uint32_t pageId, uint8_t* data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open() || pageId == 0) {
+        return false;
+    }
+    
+    std::streampos pos = static_cast<std::streampos>(pageId - 1) * PAGE_SIZE;
+    file_.seekg(pos);
+    
+    file_.read(reinterpret_cast<char*>(data), PAGE_SIZE);
+    bool complete = file_.gcount() == PAGE_SIZE;
+    file_.clear(); // 读到文件末尾会设置eof标志，清除后才能继续读写
+    
+    return complete;
+}
+
+size_t FileDiskBackend::readPages(uint32_t firstPageId, size_t count, uint8_t* data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open() || firstPageId == 0 || count == 0) {
+        return 0;
+    }
+    
+    // 一次定位、一次读取所有相邻页面
+    std::streampos pos = static_cast<std::streampos>(firstPageId - 1) * PAGE_SIZE;
+    file_.seekg(pos);
+    file_.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(count * PAGE_SIZE));
+    size_t pagesRead = static_cast<size_t>(file_.gcount()) / PAGE_SIZE;
+    file_.clear();
+    
+    return pagesRead;
+}
+
+bool FileDiskBackend::writePage(uint32_t pageId, const uint8_t* data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open() || pageId == 0) {
+        return false;
+    }
+    
+    // 不在每次写入后flush，由检查点（sync）统一刷新
+    std::streampos pos = static_cast<std::streampos>(pageId - 1) * PAGE_SIZE;
+    file_.seekp(pos);
+    file_.write(reinterpret_cast<const char*>(data), PAGE_SIZE);
+    
+    return file_.good();
+}
+
+bool FileDiskBackend::sync() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open()) {
+        return false;
+    }
+    file_.flush();
+    return file_.good();
+}
+
+uint32_t FileDiskBackend::getPageCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open()) {
+        return 0;
+    }
+    
+    file_.seekg(0, std::ios::end);
+    std::streamoff fileSize = file_.tellg();
+    file_.clear();
+    return fileSize > 0 ? static_cast<uint32_t>(fileSize / PAGE_SIZE) : 0;
+}
+
+bool FileDiskBackend::truncate(uint32_t pageCount) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open()) {
+        return false;
+    }
+    
+    // fstream不能截断打开的文件：关闭后调整文件大小再重新打开
+    file_.flush();
+    file_.close();
+    std::error_code ec;
+    std::filesystem::resize_file(getPath(), static_cast<std::uintmax_t>(pageCount) * PAGE_SIZE, ec);
+    file_.open(getPath(), std::ios::in | std::ios::out | std::ios::binary);
+    if (!file_.is_open()) {
+        std::cerr << "Failed to reopen database file after truncation: " << getPath() << std::endl;
+        return false;
+    }
+    return !ec;
+}
+
+bool FileDiskBackend::isOpen() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return file_.is_open();
+}
+
+#ifndef _WIN32
+// ==================== PosixDiskBackend ====================
+
+namespace {
+
+off_t pageOffset(uint32_t pageId) {
+    return static_cast<off_t>(pageId - 1) * PAGE_SIZE;
+}
+
+bool isPageAligned(const void* data) {
+    return reinterpret_cast<uintptr_t>(data) % PAGE_SIZE == 0;
+}
+
+// 读满len字节，处理被信号中断和短读；返回实际读到的字节数（到达文件末尾时小于len），出错返回-1
+ssize_t preadFully(int fd, uint8_t* data, size_t len, off_t offset) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = pread(fd, data + done, len - done, offset + static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return static_cast<ssize_t>(done);
+}
+
+bool pwriteFully(int fd, const uint8_t* data, size_t len, off_t offset) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = pwrite(fd, data + done, len - done, offset + static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+PosixDiskBackend::PosixDiskBackend(const std::string& path, bool directIo)
+    : DiskBackend(path), fd_(-1), directIo_(false) {
+#ifdef O_DIRECT
+    if (directIo) {
+        fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+        if (fd_ >= 0) {
+            directIo_ = true;
+        } else {
+            std::cerr << "O_DIRECT not supported for " << path << " (" << std::strerror(errno)
+                      << "), falling back to buffered I/O" << std::endl;
+        }
+    }
+#endif
+    if (fd_ < 0) {
+        fd_ = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    }
+    
+    if (fd_ < 0) {
+        std::cerr << "Failed to open database file: " << path << " (" << std::strerror(errno) << ")" << std::endl;
+        return;
+    }
+
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+    // macOS没有O_DIRECT，用F_NOCACHE关闭该文件的页缓存
+    if (directIo && fcntl(fd_, F_NOCACHE, 1) == 0) {
+        directIo_ = true;
+    }
+#endif
+}
+
+PosixDiskBackend::~PosixDiskBackend() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+bool PosixDiskBackend::readPage(uint32_t pageId, uint8_t* data) {
+    if (fd_ < 0 || pageId == 0) {
+        return false;
+    }
+    
+    if (directIo_ && !isPageAligned(data)) {
+        AlignedPageBuffer bounce;
+        if (preadFully(fd_, bounce.data(), PAGE_SIZE, pageOffset(pageId)) != static_cast<ssize_t>(PAGE_SIZE)) {
+            return false;
+        }
+        std::memcpy(data, bounce.data(), PAGE_SIZE);
+        return true;
+    }
+    return preadFully(fd_, data, PAGE_SIZE, pageOffset(pageId)) == static_cast<ssize_t>(PAGE_SIZE);
+}
+
+size_t PosixDiskBackend::readPages(uint32_t firstPageId, size_t count, uint8_t* data) {
+    if (fd_ < 0 || firstPageId == 0 || count == 0) {
+        return 0;
+    }
+    if (directIo_ && !isPageAligned(data)) {
+        return DiskBackend::readPages(firstPageId, count, data);
+    }
+    
+    // 一次pread读取所有相邻页面
+    ssize_t bytes = preadFully(fd_, data, count * PAGE_SIZE, pageOffset(firstPageId));
+    return bytes > 0 ? static_cast<size_t>(bytes) / PAGE_SIZE : 0;
+}
+
+bool PosixDiskBackend::writePage(uint32_t pageId, const uint8_t* data) {
+    if (fd_ < 0 || pageId == 0) {
+        return false;
+    }
+    
+    if (directIo_ && !isPageAligned(data)) {
+        AlignedPageBuffer bounce;
+        std::memcpy(bounce.data(), data, PAGE_SIZE);
+        return pwriteFully(fd_, bounce.data(), PAGE_SIZE, pageOffset(pageId));
+    }
+    return pwriteFully(fd_, data, PAGE_SIZE, pageOffset(pageId));
+}
+
+bool PosixDiskBackend::sync() {
+    if (fd_ < 0) {
+        return false;
+    }
+#if defined(__APPLE__)
+    // macOS没有fdatasync
+    return fsync(fd_) == 0;
+#else
+    return fdatasync(fd_) == 0;
+#endif
+}
+
+uint32_t PosixDiskBackend::getPageCount() {
+    struct stat st;
+    if (fd_ < 0 || fstat(fd_, &st) != 0) {
+        return 0;
+    }
+    return st.st_size > 0 ? static_cast<uint32_t>(st.st_size / PAGE_SIZE) : 0;
+}
+
+bool PosixDiskBackend::truncate(uint32_t pageCount) {
+    if (fd_ < 0) {
+        return false;
+    }
+    return ftruncate(fd_, static_cast<off_t>(pageCount) * PAGE_SIZE) == 0;
+}
+
+// ==================== UringDiskBackend ====================
+
+#ifdef MINIDB_HAVE_IO_URING
+// 一个io_uring实例：提交队列、完成队列和SQE数组都映射到用户态内存，
+// 与内核共享的头尾指针用acquire/release访问
+struct UringDiskBackend::Ring {
+    std::mutex mutex;
+    int fd = -1;
+    void* sqRing = MAP_FAILED;
+    size_t sqRingBytes = 0;
+    void* cqRing = MAP_FAILED;
+    size_t cqRingBytes = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesBytes = 0;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqEntries = 0;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    
+    ~Ring() {
+        if (sqes) {
+            munmap(sqes, sqesBytes);
+        }
+        if (cqRing != MAP_FAILED && cqRing != sqRing) {
+            munmap(cqRing, cqRingBytes);
+        }
+        if (sqRing != MAP_FAILED) {
+            munmap(sqRing, sqRingBytes);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    
+    bool setup(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) {
+            return false;
+        }
+        
+        sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+        singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#endif
+        if (singleMmap) {
+            sqRingBytes = cqRingBytes = std::max(sqRingBytes, cqRingBytes);
+        }
+        
+        sqRing = mmap(nullptr, sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) {
+            return false;
+        }
+        cqRing = singleMmap ? sqRing
+                            : mmap(nullptr, cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            return false;
+        }
+        sqesBytes = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqeMemory = mmap(nullptr, sqesBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqeMemory == MAP_FAILED) {
+            return false;
+        }
+        sqes = static_cast<io_uring_sqe*>(sqeMemory);
+        
+        uint8_t* sq = static_cast<uint8_t*>(sqRing);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqEntries = params.sq_entries;
+        uint8_t* cq = static_cast<uint8_t*>(cqRing);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+    
+    // 执行count个请求：每次最多填满提交队列，fill(index, sqe)填写第index个请求，
+    // 提交后等待这一组全部完成，对每个完成事件调用complete(index, res)。
+    // io_uring_enter提交失败时撤回未交给内核的请求并停止，这些请求没有完成事件，由调用方同步补做
+    template <typename Fill, typename Complete>
+    void run(size_t count, Fill fill, Complete complete) {
+        size_t done = 0;
+        while (done < count) {
+            unsigned chunk = static_cast<unsigned>(std::min<size_t>(count - done, sqEntries));
+            unsigned tail = *sqTail;
+            for (unsigned i = 0; i < chunk; ++i) {
+                unsigned slot = (tail + i) & *sqMask;
+                io_uring_sqe* sqe = &sqes[slot];
+                std::memset(sqe, 0, sizeof(*sqe));
+                fill(done + i, sqe);
+                sqe->user_data = done + i;
+                sqArray[slot] = slot;
+            }
+            __atomic_store_n(sqTail, tail + chunk, __ATOMIC_RELEASE);
+            
+            unsigned expected = chunk;
+            unsigned reaped = 0;
+            bool failed = false;
+            while (reaped < expected) {
+                unsigned pending = *sqTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+                long ret = syscall(__NR_io_uring_enter, fd, pending, expected - reaped, IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (ret < 0 && pending > 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                    // 撤回尚未提交的请求，继续等待已在途的请求完成（它们仍在使用调用方的缓冲区）
+                    __atomic_store_n(sqTail, *sqTail - pending, __ATOMIC_RELEASE);
+                    expected -= pending;
+                    failed = true;
+                }
+                
+                unsigned head = *cqHead;
+                unsigned cqTailNow = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+                while (head != cqTailNow) {
+                    const io_uring_cqe& cqe = cqes[head & *cqMask];
+                    complete(static_cast<size_t>(cqe.user_data), cqe.res);
+                    ++head;
+                    ++reaped;
+                }
+                __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+            }
+            if (failed) {
+                return;
+            }
+            done += chunk;
+        }
+    }
+};
+
+#else
+struct UringDiskBackend::Ring {};
+#endif
+
+UringDiskBackend::UringDiskBackend(const std::string& path, bool directIo) : PosixDiskBackend(path, directIo) {
+#ifdef MINIDB_HAVE_IO_URING
+    if (!isOpen()) {
+        return;
+    }
+    readRing_ = std::make_unique<Ring>();
+    writeRing_ = std::make_unique<Ring>();
+    if (!readRing_->setup(QUEUE_DEPTH) || !writeRing_->setup(QUEUE_DEPTH)) {
+        readRing_.reset();
+        writeRing_.reset();
+    }
+#endif
+}
+
+UringDiskBackend::~UringDiskBackend() = default;
+
+bool UringDiskBackend::isUringActive() const {
+    return readRing_ != nullptr;
+}
+
+const char* UringDiskBackend::getEngineName() const {
+    if (!isUringActive()) {
+        return PosixDiskBackend::getEngineName();
+    }
+    return isDirectIo() ? "io_uring+O_DIRECT" : "io_uring";
+}
+
+void UringDiskBackend::readPageBatch(std::vector<PageReadRequest>& requests) {
+#ifdef MINIDB_HAVE_IO_URING
+    if (readRing_) {
+        for (auto& request : requests) {
+            request.pagesRead = 0;
+        }
+        std::vector<bool> finished(requests.size(), false);
+        {
+            std::lock_guard<std::mutex> lock(readRing_->mutex);
+            readRing_->run(requests.size(), [&](size_t index, io_uring_sqe* sqe) {
+                const PageReadRequest& request = requests[index];
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = getFd();
+                sqe->off = static_cast<uint64_t>(request.firstPageId - 1) * PAGE_SIZE;
+                sqe->addr = reinterpret_cast<uint64_t>(request.data);
+                sqe->len = static_cast<uint32_t>(request.count * PAGE_SIZE);
+            }, [&](size_t index, int32_t res) {
+                // 出错时交给同步路径重试
+                if (res >= 0) {
+                    requests[index].pagesRead = static_cast<size_t>(res) / PAGE_SIZE;
+                    finished[index] = true;
+                }
+            });
+        }
+        for (size_t i = 0; i < requests.size(); ++i) {
+            PageReadRequest& request = requests[i];
+            if (!finished[i]) {
+                request.pagesRead = PosixDiskBackend::readPages(request.firstPageId, request.count, request.data);
+            } else if (request.pagesRead < request.count) {
+                // 短读：从第一个未完整读入的页面起同步补读，已到文件末尾时补读不到数据
+                size_t start = request.pagesRead;
+                request.pagesRead = start + PosixDiskBackend::readPages(
+                    request.firstPageId + static_cast<uint32_t>(start), request.count - start, request.data + start * PAGE_SIZE);
+            }
+        }
+        return;
+    }
+#endif
+    PosixDiskBackend::readPageBatch(requests);
+}
+
+void UringDiskBackend::writePageBatch(std::vector<PageWriteRequest>& requests) {
+#ifdef MINIDB_HAVE_IO_URING
+    if (writeRing_) {
+        for (auto& request : requests) {
+            request.written = false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(writeRing_->mutex);
+            writeRing_->run(requests.size(), [&](size_t index, io_uring_sqe* sqe) {
+                const PageWriteRequest& request = requests[index];
+                sqe->opcode = IORING_OP_WRITE;
+                sqe->fd = getFd();
+                sqe->off = static_cast<uint64_t>(request.pageId - 1) * PAGE_SIZE;
+                sqe->addr = reinterpret_cast<uint64_t>(request.data);
+                sqe->len = PAGE_SIZE;
+            }, [&](size_t index, int32_t res) {
+                requests[index].written = res == static_cast<int32_t>(PAGE_SIZE);
+            });
+        }
+        // 失败或只写入一部分的页面用pwrite重写整页
+        for (auto& request : requests) {
+            if (!request.written) {
+                request.written = PosixDiskBackend::writePage(request.pageId, request.data);
+            }
+        }
+        return;
+    }
+#endif
+    PosixDiskBackend::writePageBatch(requests);
+}
+#endif
+
+std::unique_ptr<DiskBackend> createDiskBackend(const std::string& path, bool directIo, IoEngine engine) {
+#ifdef _WIN32
+    (void)directIo;
+    (void)engine;
+    return std::make_unique<FileDiskBackend>(path);
+#else
+    if (engine == IoEngine::IO_URING) {
+        return std::make_unique<UringDiskBackend>(path, directIo);
+    }
+    return std::make_unique<PosixDiskBackend>(path, directIo);
+#endif
+}
@@ -0,0 +1,136 @@
+#include "../../include/storage/FrameArena.h"
+#include <cstdlib>
+#include <new>
+#include <utility>
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#ifndef _WIN32
+namespace {
+
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+} // namespace
+#endif
+
+FrameArena::FrameArena(size_t frameCount, bool useHugePages)
+    : memory_(nullptr), frameCount_(frameCount), bytes_(frameCount * PAGE_SIZE), hugePages_(false) {
+    if (bytes_ == 0) {
+        return;
+    }
+
+#ifdef _WIN32
+    // Windows上大页需要特殊权限，这里只保证按页对齐
+    (void)useHugePages;
+    memory_ = static_cast<uint8_t*>(_aligned_malloc(bytes_, PAGE_SIZE));
+    if (!memory_) {
+        throw std::bad_alloc();
+    }
+#else
+    void* memory = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (useHugePages) {
+        size_t hugeBytes = (bytes_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        memory = mmap(nullptr, hugeBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) {
+            bytes_ = hugeBytes;
+            hugePages_ = true;
+        }
+    }
+#endif
+    if (memory == MAP_FAILED) {
+        // 匿名映射按系统页对齐且初始为零
+        memory = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        if (useHugePages) {
+            madvise(memory, bytes_, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    memory_ = static_cast<uint8_t*>(memory);
+#endif
+}
+
+FrameArena::~FrameArena() {
+    if (!memory_) {
+        return;
+    }
+#ifdef _WIN32
+    _aligned_free(memory_);
+#else
+    munmap(memory_, bytes_);
+#endif
+}
+
+uint8_t* FrameArena::getFrame(size_t index) const {
+    return memory_ + index * PAGE_SIZE;
+}
+
+size_t FrameArena::getFrameCount() const {
+    return frameCount_;
+}
+
+size_t FrameArena::getBytes() const {
+    return bytes_;
+}
+
+bool FrameArena::usesHugePages() const {
+    return hugePages_;
+}
+
+// ==================== AlignedPageBuffer ====================
+
+namespace {
+
+uint8_t* allocateAligned(size_t bytes) {
+    if (bytes == 0) {
+        return nullptr;
+    }
+#ifdef _WIN32
+    void* memory = _aligned_malloc(bytes, PAGE_SIZE);
+#else
+    void* memory = nullptr;
+    if (posix_memalign(&memory, PAGE_SIZE, bytes) != 0) {
+        memory = nullptr;
+    }
+#endif
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return static_cast<uint8_t*>(memory);
+}
+
+void freeAligned(uint8_t* memory) {
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    free(memory);
+#endif
+}
+
+} // namespace
+
+AlignedPageBuffer::AlignedPageBuffer(size_t pageCount)
+    : memory_(allocateAligned(pageCount * PAGE_SIZE)), pageCount_(pageCount) {}
+
+AlignedPageBuffer::~AlignedPageBuffer() {
+    freeAligned(memory_);
+}
+
+AlignedPageBuffer::AlignedPageBuffer(AlignedPageBuffer&& other) noexcept
+    : memory_(std::exchange(other.memory_, nullptr)), pageCount_(std::exchange(other.pageCount_, 0)) {}
+
+AlignedPageBuffer& AlignedPageBuffer::operator=(AlignedPageBuffer&& other) noexcept {
+    if (this != &other) {
+        freeAligned(memory_);
+        memory_ = std::exchange(other.memory_, nullptr);
+        pageCount_ = std::exchange(other.pageCount_, 0);
+    }
+    return *this;
+}
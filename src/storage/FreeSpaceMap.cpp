@@ -0,0 +1,241 @@
+#include "../../include/storage/FreeSpaceMap.h"
+#include "../../include/storage/PageManager.h"
+#include "../../include/storage/ByteOrder.h"
+#include "../../include/storage/BitOps.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// FSM页记录头：[u32 下一个FSM页ID][u16 条目数]
+constexpr size_t FSM_RECORD_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint16_t);
+constexpr size_t FSM_ENTRY_SIZE = sizeof(uint32_t) + sizeof(uint8_t);
+
+} // namespace
+
+FreeSpaceMap::FreeSpaceMap() : nonEmptyMask_(0), dirty_(false) {}
+
+uint8_t FreeSpaceMap::categoryFor(size_t freeBytes) {
+    size_t category = freeBytes / FSM_CATEGORY_BYTES;
+    return static_cast<uint8_t>(category < FSM_CATEGORY_COUNT ? category : FSM_CATEGORY_COUNT - 1);
+}
+
+void FreeSpaceMap::addPage(uint32_t pageId, size_t freeBytes) {
+    if (pageIndex_.count(pageId)) {
+        updatePage(pageId, freeBytes);
+        return;
+    }
+    
+    size_t index = pageIds_.size();
+    pageIds_.push_back(pageId);
+    categories_.push_back(0);
+    bucketPos_.push_back(0);
+    pageIndex_[pageId] = index;
+    insertIntoBucket(index, categoryFor(freeBytes));
+    dirty_ = true;
+}
+
+const std::vector<uint32_t>& FreeSpaceMap::getPageIds() const {
+    return pageIds_;
+}
+
+size_t FreeSpaceMap::getPageCount() const {
+    return pageIds_.size();
+}
+
+bool FreeSpaceMap::containsPage(uint32_t pageId) const {
+    return pageIndex_.count(pageId) > 0;
+}
+
+void FreeSpaceMap::updatePage(uint32_t pageId, size_t freeBytes) {
+    auto it = pageIndex_.find(pageId);
+    if (it == pageIndex_.end()) {
+        return;
+    }
+    
+    uint8_t category = categoryFor(freeBytes);
+    if (categories_[it->second] == category) {
+        return;
+    }
+    
+    removeFromBucket(it->second);
+    insertIntoBucket(it->second, category);
+    dirty_ = true;
+}
+
+uint32_t FreeSpaceMap::findPage(size_t requiredBytes) const {
+    // 分类c中的页面至少有c * FSM_CATEGORY_BYTES字节空闲，向上取整得到满足要求的最小分类
+    size_t minCategory = (requiredBytes + FSM_CATEGORY_BYTES - 1) / FSM_CATEGORY_BYTES;
+    if (minCategory >= FSM_CATEGORY_COUNT) {
+        return 0;
+    }
+    
+    uint64_t candidates = nonEmptyMask_ & (~0ULL << minCategory);
+    if (candidates == 0) {
+        return 0;
+    }
+    
+    // 选择满足要求的最小分类（最佳适配），尽量填满已有页面
+    const auto& bucket = buckets_[bitops::lowestSetBit(candidates)];
+    return pageIds_[bucket.back()];
+}
+
+uint32_t FreeSpaceMap::save(PageManager* pageManager) {
+    if (!pageManager) {
+        return 0;
+    }
+    
+    size_t pagesNeeded = (pageIds_.size() + FSM_ENTRIES_PER_PAGE - 1) / FSM_ENTRIES_PER_PAGE;
+    
+    // 按需分配或释放FSM页
+    while (fsmPageIds_.size() < pagesNeeded) {
+        uint32_t pageId = pageManager->allocatePage(PageType::FSM_PAGE);
+        if (pageId == 0) {
+            std::cerr << "Failed to allocate free space map page" << std::endl;
+            return getRootPageId();
+        }
+        fsmPageIds_.push_back(pageId);
+    }
+    while (fsmPageIds_.size() > pagesNeeded) {
+        pageManager->deallocatePage(fsmPageIds_.back());
+        fsmPageIds_.pop_back();
+    }
+    
+    for (size_t i = 0; i < pagesNeeded; ++i) {
+        size_t begin = i * FSM_ENTRIES_PER_PAGE;
+        size_t count = std::min(FSM_ENTRIES_PER_PAGE, pageIds_.size() - begin);
+        uint32_t nextPageId = (i + 1 < pagesNeeded) ? fsmPageIds_[i + 1] : 0;
+        
+        std::string record(FSM_RECORD_HEADER_SIZE + count * FSM_ENTRY_SIZE, '\0');
+        uint8_t* out = reinterpret_cast<uint8_t*>(&record[0]);
+        byteorder::storeLE<uint32_t>(out, nextPageId);
+        byteorder::storeLE<uint16_t>(out + sizeof(uint32_t), static_cast<uint16_t>(count));
+        out += FSM_RECORD_HEADER_SIZE;
+        for (size_t j = begin; j < begin + count; ++j) {
+            byteorder::storeLE<uint32_t>(out, pageIds_[j]);
+            out[sizeof(uint32_t)] = categories_[j];
+            out += FSM_ENTRY_SIZE;
+        }
+        
+        // FSM页每次整页重写
+        Page page(fsmPageIds_[i], PageType::FSM_PAGE);
+        if (!page.insertRecord(record)) {
+            std::cerr << "Free space map page overflow" << std::endl;
+            return getRootPageId();
+        }
+        pageManager->writePage(page);
+    }
+    
+    dirty_ = false;
+    return getRootPageId();
+}
+
+bool FreeSpaceMap::load(PageManager* pageManager, uint32_t rootPageId) {
+    clear();
+    if (!pageManager) {
+        return false;
+    }
+    
+    uint32_t pageId = rootPageId;
+    while (pageId != 0) {
+        ReadPageGuard page = pageManager->fetchPageRead(pageId);
+        if (!page || page->getPageType() != PageType::FSM_PAGE) {
+            std::cerr << "Invalid free space map page: " << pageId << std::endl;
+            clear();
+            return false;
+        }
+        
+        // 复制出记录后立即解除固定，不需要在解码期间占用缓冲池帧
+        std::string record = page->getRecord(0);
+        page.release();
+        if (record.size() < FSM_RECORD_HEADER_SIZE) {
+            std::cerr << "Corrupted free space map page: " << pageId << std::endl;
+            clear();
+            return false;
+        }
+        
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(record.data());
+        uint32_t nextPageId = byteorder::loadLE<uint32_t>(data);
+        uint16_t count = byteorder::loadLE<uint16_t>(data + sizeof(uint32_t));
+        if (record.size() < FSM_RECORD_HEADER_SIZE + count * FSM_ENTRY_SIZE) {
+            std::cerr << "Corrupted free space map page: " << pageId << std::endl;
+            clear();
+            return false;
+        }
+        
+        const uint8_t* in = data + FSM_RECORD_HEADER_SIZE;
+        for (uint16_t i = 0; i < count; ++i) {
+            uint32_t dataPageId = byteorder::loadLE<uint32_t>(in);
+            uint8_t category = in[sizeof(uint32_t)];
+            in += FSM_ENTRY_SIZE;
+            
+            size_t index = pageIds_.size();
+            pageIds_.push_back(dataPageId);
+            categories_.push_back(0);
+            bucketPos_.push_back(0);
+            pageIndex_[dataPageId] = index;
+            insertIntoBucket(index, category < FSM_CATEGORY_COUNT ? category : FSM_CATEGORY_COUNT - 1);
+        }
+        
+        fsmPageIds_.push_back(pageId);
+        pageId = nextPageId;
+    }
+    
+    dirty_ = false;
+    return true;
+}
+
+uint32_t FreeSpaceMap::getRootPageId() const {
+    return fsmPageIds_.empty() ? 0 : fsmPageIds_.front();
+}
+
+bool FreeSpaceMap::isDirty() const {
+    return dirty_;
+}
+
+void FreeSpaceMap::clear() {
+    pageIds_.clear();
+    categories_.clear();
+    pageIndex_.clear();
+    for (auto& bucket : buckets_) {
+        bucket.clear();
+    }
+    bucketPos_.clear();
+    nonEmptyMask_ = 0;
+    fsmPageIds_.clear();
+    dirty_ = false;
+}
+
+void FreeSpaceMap::release(PageManager* pageManager) {
+    if (pageManager) {
+        for (uint32_t pageId : fsmPageIds_) {
+            pageManager->deallocatePage(pageId);
+        }
+    }
+    clear();
+}
+
+void FreeSpaceMap::insertIntoBucket(size_t index, uint8_t category) {
+    auto& bucket = buckets_[category];
+    bucketPos_[index] = bucket.size();
+    bucket.push_back(index);
+    categories_[index] = category;
+    nonEmptyMask_ |= (1ULL << category);
+}
+
+void FreeSpaceMap::removeFromBucket(size_t index) {
+    uint8_t category = categories_[index];
+    auto& bucket = buckets_[category];
+    
+    // 与桶尾元素交换后弹出，O(1)
+    size_t pos = bucketPos_[index];
+    size_t last = bucket.back();
+    bucket[pos] = last;
+    bucketPos_[last] = pos;
+    bucket.pop_back();
+    
+    if (bucket.empty()) {
+        nonEmptyMask_ &= ~(1ULL << category);
+    }
+}
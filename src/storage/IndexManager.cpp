@@ -1,7 +1,6 @@
 #include "../../include/storage/IndexManager.h"
 #include <iostream>
 #include <algorithm>
-#include <fstream>
 #include <sstream>
 
 bool IndexManager::createIndex(const std::string& indexName, const std::string& tableName,
@@ -42,9 +41,9 @@ bool IndexManager::createIndex(const std::string& indexName, const std::string&
         auto btree = std::make_unique<BPlusTree>();
         
         // 为现有数据建立索引
-        std::vector<uint32_t> allRecordIds = table->getAllRecordIds();
+        std::vector<RID> allRecordIds = table->getAllRecordIds();
         
-        for (uint32_t recordId : allRecordIds) {
+        for (RID recordId : allRecordIds) {
             Row row = table->getRow(recordId);
             if (row.getFieldCount() > 0) {
                 Value columnValue = row.getValue(columnIndex);
@@ -89,22 +88,22 @@ bool IndexManager::dropIndex(const std::string& indexName) {
     return true;
 }
 
-bool IndexManager::insertRecord(const std::string& tableName, const Row& row, uint32_t recordId) {
+bool IndexManager::insertRecord(const std::string& tableName, const Row& row, RID recordId) {
     // 找到该表的所有索引
     for (const auto& pair : indexInfos_) {
         const auto& indexInfo = pair.second;
         if (indexInfo->tableName != tableName) continue;
         
         const std::string& indexName = pair.first;
-        auto indexIt = indexes_.find(indexName);
-        if (indexIt == indexes_.end()) continue;
+        BPlusTree* tree = getIndexTree(indexName);
+        if (!tree) continue;
         
         // 提取列值
         Value columnValue = extractColumnValue(row, tableName, indexInfo->columnName);
         
         // 检查唯一性约束
         if (indexInfo->isUnique) {
-            auto existingRecords = indexIt->second->search(columnValue);
+            auto existingRecords = tree->search(columnValue);
             if (!existingRecords.empty()) {
                 std::cerr << "Unique constraint violation for index " << indexName << std::endl;
                 return false;
@@ -112,7 +111,7 @@ bool IndexManager::insertRecord(const std::string& tableName, const Row& row, ui
         }
         
         // 插入到索引
-        if (!indexIt->second->insert(columnValue, recordId)) {
+        if (!tree->insert(columnValue, recordId)) {
             std::cerr << "Failed to insert into index: " << indexName << std::endl;
             return false;
         }
@@ -121,41 +120,25 @@ bool IndexManager::insertRecord(const std::string& tableName, const Row& row, ui
     return true;
 }
 
-bool IndexManager::deleteRecord(const std::string& tableName, const Row& row, uint32_t recordId) {
+bool IndexManager::deleteRecord(const std::string& tableName, const Row& row, RID recordId) {
     // 从该表的所有索引中删除记录
     for (const auto& pair : indexInfos_) {
         const auto& indexInfo = pair.second;
         if (indexInfo->tableName != tableName) continue;
         
         const std::string& indexName = pair.first;
-        auto indexIt = indexes_.find(indexName);
-        if (indexIt == indexes_.end()) continue;
+        BPlusTree* tree = getIndexTree(indexName);
+        if (!tree) continue;
         
         // 提取列值
         Value columnValue = extractColumnValue(row, tableName, indexInfo->columnName);
         
-        // 先查找所有匹配的记录
-        auto existingRecords = indexIt->second->search(columnValue);
-        
-        // 如果索引中没有该键，跳过
-        if (existingRecords.empty()) {
-            continue;
-        }
-        
-        // 尝试删除所有匹配的记录（解决recordId不一致问题）
-        int removedCount = 0;
-        for (uint32_t existingRecordId : existingRecords) {
-            if (indexIt->second->remove(columnValue, existingRecordId)) {
-                removedCount++;
-            }
-        }
-        
-        // 如果没有成功删除任何记录，显示警告
-        if (removedCount == 0) {
-            std::cerr << "Warning: Could not remove any records from index " << indexName 
+        // RID稳定，直接删除(键, RID)条目，非唯一索引中相同键的其他记录不受影响
+        if (!tree->remove(columnValue, recordId)) {
+            std::cerr << "Warning: Could not remove record from index " << indexName 
                       << " (key=" << std::visit([](const auto& v) -> std::string {
                           std::ostringstream oss; oss << v; return oss.str();
-                      }, columnValue) << ", found " << existingRecords.size() << " matches)" << std::endl;
+                      }, columnValue) << ")" << std::endl;
         }
     }
     
@@ -163,8 +146,8 @@ bool IndexManager::deleteRecord(const std::string& tableName, const Row& row, ui
 }
 
 bool IndexManager::updateRecord(const std::string& tableName, const Row& oldRow, 
-                               const Row& newRow, uint32_t recordId) {
-    // 只更新那些索引列值发生变化的索引
+                               const Row& newRow, RID recordId, RID newRecordId) {
+    // 只更新那些索引列值或记录位置发生变化的索引（记录被迁移到其他页面时RID会改变）
     for (const auto& pair : indexInfos_) {
         const auto& indexInfo = pair.second;
         if (indexInfo->tableName != tableName) continue;
@@ -175,25 +158,25 @@ bool IndexManager::updateRecord(const std::string& tableName, const Row& oldRow,
         Value oldColumnValue = extractColumnValue(oldRow, tableName, indexInfo->columnName);
         Value newColumnValue = extractColumnValue(newRow, tableName, indexInfo->columnName);
         
-        // 如果值没有变化，跳过这个索引
-        if (oldColumnValue == newColumnValue) {
+        // 如果值和RID都没有变化，跳过这个索引
+        if (oldColumnValue == newColumnValue && recordId == newRecordId) {
             continue;
         }
         
-        auto indexIt = indexes_.find(indexName);
-        if (indexIt == indexes_.end()) continue;
+        BPlusTree* tree = getIndexTree(indexName);
+        if (!tree) continue;
         
         // 删除旧记录
-        if (!indexIt->second->remove(oldColumnValue, recordId)) {
+        if (!tree->remove(oldColumnValue, recordId)) {
             std::cerr << "Failed to remove from index: " << indexName << std::endl;
             return false;
         }
         
         // 插入新记录
-        if (!indexIt->second->insert(newColumnValue, recordId)) {
+        if (!tree->insert(newColumnValue, newRecordId)) {
             std::cerr << "Failed to insert into index: " << indexName << std::endl;
             // 尝试回滚
-            indexIt->second->insert(oldColumnValue, recordId);
+            tree->insert(oldColumnValue, recordId);
             return false;
         }
     }
@@ -201,25 +184,25 @@ bool IndexManager::updateRecord(const std::string& tableName, const Row& oldRow,
     return true;
 }
 
-std::vector<uint32_t> IndexManager::searchByIndex(const std::string& indexName, const Value& key) const {
-    auto indexIt = indexes_.find(indexName);
-    if (indexIt == indexes_.end()) {
+std::vector<RID> IndexManager::searchByIndex(const std::string& indexName, const Value& key) const {
+    BPlusTree* tree = getIndexTree(indexName);
+    if (!tree) {
         std::cerr << "Index not found: " << indexName << std::endl;
         return {};
     }
     
-    return indexIt->second->search(key);
+    return tree->search(key);
 }
 
-std::vector<uint32_t> IndexManager::rangeSearchByIndex(const std::string& indexName, 
+std::vector<RID> IndexManager::rangeSearchByIndex(const std::string& indexName, 
                                                       const Value& startKey, const Value& endKey) const {
-    auto indexIt = indexes_.find(indexName);
-    if (indexIt == indexes_.end()) {
+    BPlusTree* tree = getIndexTree(indexName);
+    if (!tree) {
         std::cerr << "Index not found: " << indexName << std::endl;
         return {};
     }
     
-    return indexIt->second->rangeSearch(startKey, endKey);
+    return tree->rangeSearch(startKey, endKey);
 }
 
 bool IndexManager::hasIndex(const std::string& tableName, const std::string& columnName) const {
@@ -356,143 +339,99 @@ bool IndexManager::validateIndexName(const std::string& indexName) const {
     return true;
 }
 
-bool IndexManager::saveIndexes(const std::string& dbPath) const {
-    try {
-        std::string indexPath = dbPath + "/indexes.meta";
-        std::ofstream file(indexPath);
-        if (!file.is_open()) {
-            std::cerr << "Failed to open index metadata file for writing: " << indexPath << std::endl;
-            return false;
-        }
-        
-        // 写入索引数量
-        file << indexInfos_.size() << std::endl;
-        
-        // 写入每个索引的信息
-        for (const auto& pair : indexInfos_) {
-            const auto& indexInfo = pair.second;
-            file << indexInfo->indexName << "|"
-                 << indexInfo->tableName << "|"
-                 << indexInfo->columnName << "|"
-                 << static_cast<int>(indexInfo->indexType) << "|"
-                 << (indexInfo->isUnique ? 1 : 0) << std::endl;
-        }
-        
-        file.close();
-        
-        // 保存每个B+树的数据
-        for (const auto& pair : indexes_) {
-            const std::string& indexName = pair.first;
-            const auto& btree = pair.second;
-            
-            std::string indexDataPath = dbPath + "/" + indexName + ".index";
-            // TODO: 实现B+树的序列化保存
-            // btree->saveToDisk(indexDataPath);
-        }
-        
-        return true;
-        
-    } catch (const std::exception& e) {
-        std::cerr << "Error saving indexes: " << e.what() << std::endl;
-        return false;
+std::vector<const IndexInfo*> IndexManager::getAllIndexInfos() const {
+    std::vector<const IndexInfo*> result;
+    result.reserve(indexInfos_.size());
+    for (const auto& pair : indexInfos_) {
+        result.push_back(pair.second.get());
     }
+    return result;
 }
 
-bool IndexManager::loadIndexes(const std::string& dbPath) {
-    try {
-        std::string indexPath = dbPath + "/indexes.meta";
-        std::ifstream file(indexPath);
-        if (!file.is_open()) {
-            // 索引文件不存在，可能是新数据库
-            return true;
-        }
-        
-        std::string line;
-        
-        // 读取索引数量
-        if (!std::getline(file, line)) {
-            return true; // 空文件
-        }
-        
-        auto indexCount = std::stoull(line);
-        
-        // 读取每个索引的信息
-        for (size_t i = 0; i < indexCount; ++i) {
-            if (!std::getline(file, line)) {
-                break;
-            }
-            
-            std::vector<std::string> parts;
-            size_t pos = 0;
-            size_t pipePos;
-            
-            // 分割字符串
-            while ((pipePos = line.find('|', pos)) != std::string::npos) {
-                parts.push_back(line.substr(pos, pipePos - pos));
-                pos = pipePos + 1;
-            }
-            parts.push_back(line.substr(pos));
-            
-            if (parts.size() >= 5) {
-                std::string indexName = parts[0];
-                std::string tableName = parts[1];
-                std::string columnName = parts[2];
-                IndexType indexType = static_cast<IndexType>(std::stoi(parts[3]));
-                bool isUnique = (std::stoi(parts[4]) != 0);
-                
-                // 重新创建索引（不创建B+树实例，等表加载完成后再创建）
-                auto indexInfo = std::make_unique<IndexInfo>(indexName, tableName, columnName, indexType, isUnique);
-                indexInfos_[indexName] = std::move(indexInfo);
-            }
-        }
-        
-        file.close();
-        
-        // 重建B+树索引（需要在所有表加载完成后调用rebuildIndexes）
-        return true;
-        
-    } catch (const std::exception& e) {
-        std::cerr << "Error loading indexes: " << e.what() << std::endl;
+bool IndexManager::restoreIndex(const IndexInfo& indexInfo) {
+    if (indexInfos_.find(indexInfo.indexName) != indexInfos_.end()) {
+        std::cerr << "Index already exists: " << indexInfo.indexName << std::endl;
         return false;
     }
+    
+    // 只恢复索引定义，启动时不扫描表数据
+    indexInfos_[indexInfo.indexName] = std::make_unique<IndexInfo>(indexInfo);
+    indexes_.erase(indexInfo.indexName);
+    return true;
 }
 
 void IndexManager::rebuildIndexes() {
     for (const auto& pair : indexInfos_) {
-        const std::string& indexName = pair.first;
-        const auto& indexInfo = pair.second;
-        
-        // 检查表是否存在
-        auto tableIt = tables_.find(indexInfo->tableName);
-        if (tableIt == tables_.end()) {
-            std::cerr << "Warning: Table '" << indexInfo->tableName 
-                      << "' not found for index '" << indexName << "'" << std::endl;
+        auto btree = buildIndexTree(*pair.second);
+        if (!btree) {
             continue;
         }
+        indexes_[pair.first] = std::move(btree);
         
-        // 创建B+树实例
-        auto btree = std::make_unique<BPlusTree>(10); // 使用默认阶数
-        
-        // 重建索引数据
-        auto table = tableIt->second;
-        
-        // 获取所有实际的recordId
-        std::vector<uint32_t> allRecordIds = table->getAllRecordIds();
-        
-        for (uint32_t recordId : allRecordIds) {
-            Row row = table->getRow(recordId);
-            if (row.getFieldCount() > 0) {
-                Value columnValue = extractColumnValue(row, indexInfo->tableName, indexInfo->columnName);
-                btree->insert(columnValue, recordId);
-            }
+        std::cout << "Index '" << pair.first << "' rebuilt successfully" << std::endl;
+    }
+}
+
+void IndexManager::ensureIndexesBuilt(const std::string& tableName) {
+    for (const auto& pair : indexInfos_) {
+        if (pair.second->tableName == tableName) {
+            getIndexTree(pair.first);
         }
-        
-        indexes_[indexName] = std::move(btree);
-        
-        std::cout << "Index '" << indexName << "' rebuilt successfully" << std::endl;
     }
 }
 
+void IndexManager::invalidateTableIndexes(const std::string& tableName) {
+    for (const auto& pair : indexInfos_) {
+        if (pair.second->tableName == tableName) {
+            indexes_.erase(pair.first);
+        }
+    }
+}
+
+BPlusTree* IndexManager::getIndexTree(const std::string& indexName) const {
+    auto indexIt = indexes_.find(indexName);
+    if (indexIt != indexes_.end()) {
+        return indexIt->second.get();
+    }
+    
+    // 索引定义存在但B+树尚未构建（从系统目录恢复的索引），现在扫描表数据构建
+    auto infoIt = indexInfos_.find(indexName);
+    if (infoIt == indexInfos_.end()) {
+        return nullptr;
+    }
+    auto btree = buildIndexTree(*infoIt->second);
+    if (!btree) {
+        return nullptr;
+    }
+    BPlusTree* tree = btree.get();
+    indexes_[indexName] = std::move(btree);
+    return tree;
+}
+
+std::unique_ptr<BPlusTree> IndexManager::buildIndexTree(const IndexInfo& indexInfo) const {
+    // 检查表是否存在
+    auto tableIt = tables_.find(indexInfo.tableName);
+    if (tableIt == tables_.end()) {
+        std::cerr << "Warning: Table '" << indexInfo.tableName 
+                  << "' not found for index '" << indexInfo.indexName << "'" << std::endl;
+        return nullptr;
+    }
+    
+    auto table = tableIt->second;
+    int columnIndex = table->getColumnIndex(indexInfo.columnName);
+    if (columnIndex < 0) {
+        std::cerr << "Column not found during rebuild: " << indexInfo.columnName << std::endl;
+        return nullptr;
+    }
+    
+    // 流式扫描堆表，只解码索引列
+    auto btree = std::make_unique<BPlusTree>();
+    for (auto it = table->begin(); it != table->end(); ++it) {
+        btree->insert(it.view().getValue(columnIndex), it.getRID());
+    }
+    return btree;
+}
+
 bool IndexManager::rebuildTableIndexes(const std::string& tableName) {
     // 查找表
     auto tableIt = tables_.find(tableName);
@@ -526,8 +465,8 @@ bool IndexManager::rebuildTableIndexes(const std::string& tableName) {
             continue;
         }
         
-        std::vector<uint32_t> allRecordIds = table->getAllRecordIds();
-        for (uint32_t recordId : allRecordIds) {
+        std::vector<RID> allRecordIds = table->getAllRecordIds();
+        for (RID recordId : allRecordIds) {
             Row row = table->getRow(recordId);
             if (row.getFieldCount() > 0) {
                 Value columnValue = row.getValue(columnIndex);
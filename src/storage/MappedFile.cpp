@@ -0,0 +1,119 @@
+#include "../../include/storage/MappedFile.h"
+#include <algorithm>
+#include <iostream>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path)
+    : path_(path), memory_(nullptr), bytes_(0), open_(false) {
+#ifdef _WIN32
+    fileHandle_ = nullptr;
+    mappingHandle_ = nullptr;
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to open database file: " << path << std::endl;
+        return;
+    }
+    fileHandle_ = file;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        std::cerr << "Failed to get size of database file: " << path << std::endl;
+        return;
+    }
+    bytes_ = static_cast<size_t>(size.QuadPart);
+    open_ = true;
+    if (bytes_ == 0) {
+        return; // 空文件不能映射
+    }
+    mappingHandle_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* memory = mappingHandle_ ? MapViewOfFile(mappingHandle_, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!memory) {
+        std::cerr << "Failed to map database file: " << path << std::endl;
+        open_ = false;
+        return;
+    }
+    memory_ = static_cast<const uint8_t*>(memory);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open database file: " << path << " (" << std::strerror(errno) << ")" << std::endl;
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        std::cerr << "Failed to get size of database file: " << path << " (" << std::strerror(errno) << ")" << std::endl;
+        close(fd);
+        return;
+    }
+    bytes_ = static_cast<size_t>(st.st_size);
+    open_ = true;
+    if (bytes_ > 0) {
+        void* memory = mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0);
+        if (memory == MAP_FAILED) {
+            std::cerr << "Failed to map database file: " << path << " (" << std::strerror(errno) << ")" << std::endl;
+            open_ = false;
+        } else {
+            memory_ = static_cast<const uint8_t*>(memory);
+        }
+    }
+    // 映射建立后不再需要文件描述符
+    close(fd);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+    if (memory_) {
+        UnmapViewOfFile(memory_);
+    }
+    if (mappingHandle_) {
+        CloseHandle(mappingHandle_);
+    }
+    if (fileHandle_) {
+        CloseHandle(fileHandle_);
+    }
+#else
+    if (memory_) {
+        munmap(const_cast<uint8_t*>(memory_), bytes_);
+    }
+#endif
+}
+
+uint32_t MappedFile::getPageCount() const {
+    return memory_ ? static_cast<uint32_t>(bytes_ / PAGE_SIZE) : 0;
+}
+
+const uint8_t* MappedFile::getPage(uint32_t pageId) const {
+    if (pageId == 0 || pageId > getPageCount()) {
+        return nullptr;
+    }
+    return memory_ + static_cast<size_t>(pageId - 1) * PAGE_SIZE;
+}
+
+void MappedFile::adviseWillNeed(uint32_t firstPageId, size_t count) const {
+    uint32_t pageCount = getPageCount();
+    if (firstPageId == 0 || firstPageId > pageCount || count == 0) {
+        return;
+    }
+    count = std::min<size_t>(count, pageCount - firstPageId + 1);
+#if defined(_WIN32)
+    // PrefetchVirtualMemory需要Windows 8以上，这里不做提示，依赖操作系统的按需调入
+#elif defined(MADV_WILLNEED)
+    // madvise要求起始地址按系统页对齐（系统页可能大于PAGE_SIZE）
+    size_t systemPage = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t offset = static_cast<size_t>(firstPageId - 1) * PAGE_SIZE;
+    size_t alignedOffset = offset / systemPage * systemPage;
+    madvise(const_cast<uint8_t*>(memory_ + alignedOffset), offset - alignedOffset + count * PAGE_SIZE, MADV_WILLNEED);
+#endif
+}
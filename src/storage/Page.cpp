@@ -1,282 +1,313 @@
 #include "../../include/storage/Page.h"
+#include "../../include/storage/ByteOrder.h"
 #include <iostream>
 #include <cstring>
 #include <algorithm>
 #include <stdexcept>
 #include <climits>
+#include <cstddef>
 
-Page::Page(uint32_t pageId, PageType type) {
-    header_.pageId = pageId;
-    header_.pageType = type;
-    header_.slotCount = 0;
-    header_.freeSpaceOffset = PAGE_HEADER_SIZE;
-    header_.freeSpaceSize = PAGE_DATA_SIZE;
-    header_.checksum = 0;
-    header_.lsn = 0;
-    
-    data_.resize(PAGE_SIZE);
-    initializePage();
+Page::Page(uint32_t pageId, PageType type)
+    : ownedData_(new uint8_t[PAGE_SIZE]), data_(ownedData_.get()),
+      header_(reinterpret_cast<PageHeader*>(ownedData_.get())) {
+    format(pageId, type);
+}
+
+Page::Page(uint8_t* frameData)
+    : data_(frameData), header_(reinterpret_cast<PageHeader*>(frameData)) {}
+
+void Page::format(uint32_t pageId, PageType type) {
+    // 清零整个页面（包括页头的结构体填充字节），保证页面镜像和校验和是确定的
+    std::memset(data_, 0, PAGE_SIZE);
+    header_->pageId = pageId;
+    header_->pageType = type;
+    header_->slotCount = 0;
+    header_->freeSpaceOffset = PAGE_HEADER_SIZE;
+    header_->freeSpaceSize = PAGE_DATA_SIZE;
+    header_->fragmentedBytes = 0;
+    header_->lsn = 0;
+    updateChecksum();
+}
+
+void Page::copyFrom(const Page& other) {
+    if (other.data_ != data_) {
+        std::memcpy(data_, other.data_, PAGE_SIZE);
+    }
+}
+
+uint8_t* Page::getData() {
+    return data_;
+}
+
+const uint8_t* Page::getData() const {
+    return data_;
 }
 
 uint32_t Page::getPageId() const {
-    return header_.pageId;
+    return header_->pageId;
 }
 
 PageType Page::getPageType() const {
-    return header_.pageType;
+    return header_->pageType;
+}
+
+uint64_t Page::getLsn() const {
+    return header_->lsn;
+}
+
+void Page::setLsn(uint64_t lsn) {
+    header_->lsn = lsn;
 }
 
 bool Page::insertRecord(const std::string& record) {
+    return insertRecordAndReturnSlot(record) != UINT16_MAX;
+}
+
+uint16_t Page::insertRecordAndReturnSlot(const std::string& record) {
     size_t recordSize = record.size() + sizeof(uint16_t); // 记录 + 长度字段
     
-    if (!hasSpace(recordSize)) {
-        return false;
-    }
-    
-    // 找到空闲槽位
+    // 优先复用空槽位，否则在槽位数组末尾追加一个新槽位（额外占用一个槽位项）
     uint16_t slotId = findFreeSlot();
+    bool newSlot = (slotId == header_->slotCount);
+    if (newSlot && slotId == UINT16_MAX) {
+        return UINT16_MAX;
+    }
+    size_t requiredSize = recordSize + (newSlot ? SLOT_ENTRY_SIZE : 0);
     
-    // 写入记录
-    uint16_t offset = header_.freeSpaceOffset;
-    
-    // 写入记录长度
-    *reinterpret_cast<uint16_t*>(&data_[offset]) = static_cast<uint16_t>(record.size());
-    offset += sizeof(uint16_t);
-    
-    // 写入记录数据
-    std::memcpy(&data_[offset], record.data(), record.size());
+    if (getFreeSpace() < requiredSize) {
+        return UINT16_MAX; // 表示失败
+    }
     
-    // 更新槽位目录
-    if (slotId >= slots_.size()) {
-        slots_.resize(slotId + 1, 0);
+    // 连续空闲空间不够但碎片足够时，才进行压缩
+    if (header_->freeSpaceSize < requiredSize) {
+        compactPage();
     }
-    slots_[slotId] = header_.freeSpaceOffset;
     
-    // 更新页头
-    header_.freeSpaceOffset += static_cast<uint16_t>(recordSize);
-    header_.freeSpaceSize -= static_cast<uint16_t>(recordSize);
-    if (slotId >= header_.slotCount) {
-        header_.slotCount = slotId + 1;
+    if (newSlot) {
+        header_->slotCount++;
+        header_->freeSpaceSize -= SLOT_ENTRY_SIZE;
     }
+    placeRecord(slotId, record);
     
-    updateChecksum();
-    return true;
+    return slotId;
 }
 
-uint16_t Page::insertRecordAndReturnSlot(const std::string& record) {
-    size_t recordSize = record.size() + sizeof(uint16_t); // 记录 + 长度字段
-    
-    if (!hasSpace(recordSize)) {
-        return UINT16_MAX; // 表示失败
+bool Page::insertRecordAt(uint16_t slotId, const std::string& record) {
+    if (slotId == UINT16_MAX || (slotId < header_->slotCount && getSlotOffset(slotId) != 0)) {
+        return false;
     }
     
-    // 找到空闲槽位
-    uint16_t slotId = findFreeSlot();
-    
-    // 写入记录
-    uint16_t offset = header_.freeSpaceOffset;
-    
-    // 写入记录长度
-    *reinterpret_cast<uint16_t*>(&data_[offset]) = static_cast<uint16_t>(record.size());
-    offset += sizeof(uint16_t);
-    
-    // 写入记录数据
-    std::memcpy(&data_[offset], record.data(), record.size());
-    
-    // 更新槽位目录
-    if (slotId >= slots_.size()) {
-        slots_.resize(slotId + 1, 0);
+    // 槽位号超出槽位数组时，中间新增的槽位都是空槽位
+    size_t newSlots = slotId < header_->slotCount ? 0 : static_cast<size_t>(slotId) + 1 - header_->slotCount;
+    size_t requiredSize = record.size() + sizeof(uint16_t) + newSlots * SLOT_ENTRY_SIZE;
+    if (getFreeSpace() < requiredSize) {
+        return false;
     }
-    slots_[slotId] = header_.freeSpaceOffset;
-    
-    // 更新页头
-    header_.freeSpaceOffset += static_cast<uint16_t>(recordSize);
-    header_.freeSpaceSize -= static_cast<uint16_t>(recordSize);
-    if (slotId >= header_.slotCount) {
-        header_.slotCount = slotId + 1;
+    if (header_->freeSpaceSize < requiredSize) {
+        compactPage();
     }
     
-    updateChecksum();
-    return slotId;
+    while (header_->slotCount <= slotId) {
+        setSlotOffset(header_->slotCount, 0);
+        header_->slotCount++;
+        header_->freeSpaceSize -= SLOT_ENTRY_SIZE;
+    }
+    placeRecord(slotId, record);
+    return true;
 }
 
 std::string Page::getRecord(uint16_t slotId) const {
-    if (slotId >= slots_.size() || slots_[slotId] == 0) {
+    RecordRef ref = getRecordRef(slotId);
+    if (!ref.isValid()) {
         return "";
     }
     
-    uint16_t offset = slots_[slotId];
-    uint16_t recordSize = *reinterpret_cast<const uint16_t*>(&data_[offset]);
-    offset += sizeof(uint16_t);
+    return std::string(reinterpret_cast<const char*>(ref.data), ref.size);
+}
+
+RecordRef Page::getRecordRef(uint16_t slotId) const {
+    RecordRef ref;
+    if (slotId >= header_->slotCount) {
+        return ref;
+    }
     
-    return std::string(reinterpret_cast<const char*>(&data_[offset]), recordSize);
+    uint16_t offset = getSlotOffset(slotId);
+    if (offset == 0) {
+        return ref;
+    }
+    
+    ref.size = byteorder::loadLE<uint16_t>(&data_[offset]);
+    ref.data = &data_[offset + sizeof(uint16_t)];
+    return ref;
 }
 
 bool Page::deleteRecord(uint16_t slotId) {
-    if (slotId >= slots_.size() || slots_[slotId] == 0) {
+    if (slotId >= header_->slotCount || getSlotOffset(slotId) == 0) {
         return false;
     }
     
-    // 标记槽位为空
-    slots_[slotId] = 0;
-    
-    // 压缩页面（简单实现：重新组织所有记录）
-    compactPage();
+    // 标记槽位为空（墓碑），槽位本身保留，其他记录的槽位号不受影响
+    // 记录占用的字节只计入碎片，等到空间不足时再压缩回收
+    uint16_t offset = getSlotOffset(slotId);
+    uint16_t recordSize = byteorder::loadLE<uint16_t>(&data_[offset]);
+    header_->fragmentedBytes += recordSize + sizeof(uint16_t);
+    setSlotOffset(slotId, 0);
+    
+    // 槽位数组末尾的空槽位可以直接回收
+    while (header_->slotCount > 0 && getSlotOffset(header_->slotCount - 1) == 0) {
+        header_->slotCount--;
+        header_->freeSpaceSize += SLOT_ENTRY_SIZE;
+    }
     
-    updateChecksum();
     return true;
 }
 
 bool Page::updateRecord(uint16_t slotId, const std::string& newRecord) {
-    if (slotId >= slots_.size() || slots_[slotId] == 0) {
+    if (slotId >= header_->slotCount || getSlotOffset(slotId) == 0) {
         return false; // 无效的槽位ID
     }
     
-    uint16_t oldOffset = slots_[slotId];
-    uint16_t oldRecordSize = *reinterpret_cast<const uint16_t*>(&data_[oldOffset]);
+    uint16_t oldOffset = getSlotOffset(slotId);
+    uint16_t oldRecordSize = byteorder::loadLE<uint16_t>(&data_[oldOffset]);
     uint16_t oldTotalSize = oldRecordSize + sizeof(uint16_t); // 原记录总大小
     uint16_t newTotalSize = static_cast<uint16_t>(newRecord.size() + sizeof(uint16_t)); // 新记录总大小
     
     if (newTotalSize <= oldTotalSize) {
         // 情况1：新记录不大于原记录，直接就地更新
-        
-        // 更新长度字段
-        *reinterpret_cast<uint16_t*>(&data_[oldOffset]) = static_cast<uint16_t>(newRecord.size());
-        
-        // 更新数据
+        byteorder::storeLE<uint16_t>(&data_[oldOffset], static_cast<uint16_t>(newRecord.size()));
         std::memcpy(&data_[oldOffset + sizeof(uint16_t)], newRecord.data(), newRecord.size());
         
-        // 如果新记录更小，可能产生碎片（简化处理，不回收）
+        // 新记录更小时，多出的字节计入碎片
+        header_->fragmentedBytes += oldTotalSize - newTotalSize;
         
-        updateChecksum();
         return true;
         
-    } else if (header_.freeSpaceSize >= newTotalSize) {
-        // 情况2：新记录更大但页面有足够空间，在末尾写入新记录
-        
-        // 在页面末尾写入新记录
-        uint16_t newOffset = header_.freeSpaceOffset;
+    } else if (header_->freeSpaceSize >= newTotalSize) {
+        // 情况2：新记录更大但页面有足够的连续空间，在空闲区写入新记录并更新槽位指向
+        placeRecord(slotId, newRecord);
         
-        // 写入新记录长度
-        *reinterpret_cast<uint16_t*>(&data_[newOffset]) = static_cast<uint16_t>(newRecord.size());
-        newOffset += sizeof(uint16_t);
-        
-        // 写入新记录数据
-        std::memcpy(&data_[newOffset], newRecord.data(), newRecord.size());
-        
-        // 更新槽位指向
-        slots_[slotId] = header_.freeSpaceOffset;
+        // 原记录的空间成为碎片，可以在compactPage()时回收
+        header_->fragmentedBytes += oldTotalSize;
         
-        // 更新页头信息
-        header_.freeSpaceOffset += newTotalSize;
-        header_.freeSpaceSize -= newTotalSize;
+        return true;
         
-        // 标记原记录位置为无效（简化处理，不回收空间）
-        // 原记录的空间成为碎片，可以在compactPage()时回收
+    } else if (header_->freeSpaceSize + header_->fragmentedBytes + oldTotalSize >= newTotalSize) {
+        // 情况3：连续空闲空间不足，但回收碎片和原记录后足够：压缩页面再写入，槽位号保持不变
+        setSlotOffset(slotId, 0);
+        header_->fragmentedBytes += oldTotalSize;
+        compactPage();
         
-        updateChecksum();
+        placeRecord(slotId, newRecord);
         return true;
         
     } else {
-        // 情况3：页面空间不足，使用删除+重新插入策略
-        if (!deleteRecord(slotId)) {
-            return false;
-        }
-        return insertRecord(newRecord);
+        // 情况4：压缩后也放不下，原记录保持不变，由调用方迁移到其他页面
+        return false;
     }
 }
 
 size_t Page::getFreeSpace() const {
-    return header_.freeSpaceSize;
+    return static_cast<size_t>(header_->freeSpaceSize) + header_->fragmentedBytes;
+}
+
+size_t Page::getFragmentedBytes() const {
+    return header_->fragmentedBytes;
 }
 
 uint16_t Page::getSlotCount() const {
-    return header_.slotCount;
+    return header_->slotCount;
 }
 
 bool Page::hasSpace(size_t recordSize) const {
-    return header_.freeSpaceSize >= recordSize + sizeof(uint16_t);
+    // 碎片可以通过压缩回收，因此也计入可用空间；额外预留一个槽位项
+    return getFreeSpace() >= recordSize + SLOT_ENTRY_SIZE;
 }
 
 std::vector<uint8_t> Page::serialize() const {
     std::vector<uint8_t> result(PAGE_SIZE);
-    
-    // 序列化页头
-    std::memcpy(result.data(), &header_, sizeof(PageHeader));
-    
-    // 序列化数据
-    std::memcpy(result.data() + PAGE_HEADER_SIZE, 
-                data_.data() + PAGE_HEADER_SIZE, 
-                PAGE_DATA_SIZE);
-    
+    serializeTo(result.data());
     return result;
 }
 
+void Page::serializeTo(uint8_t* out) const {
+    // 页面镜像：页头 + 记录区 + 空闲区 + 页尾的槽位数组，data_本身就是完整的页面布局
+    // 校验和只在页面写出时计算，避免每次修改都扫描整页
+    std::memcpy(out, data_, PAGE_SIZE);
+    uint32_t checksum = calculateChecksum(data_);
+    std::memcpy(out + offsetof(PageHeader, checksum), &checksum, sizeof(checksum));
+}
+
 std::unique_ptr<Page> Page::deserialize(const std::vector<uint8_t>& data) {
-    if (data.size() != PAGE_SIZE) {
+    if (data.size() != PAGE_SIZE || !validateImage(data.data())) {
         return nullptr;
     }
     
-    // 读取页头
+    // 槽位目录保存在页面内，整页复制后即可直接使用
     PageHeader header;
     std::memcpy(&header, data.data(), sizeof(PageHeader));
-    
     auto page = std::make_unique<Page>(header.pageId, header.pageType);
-    page->header_ = header;
+    std::memcpy(page->data_, data.data(), PAGE_SIZE);
     
-    // 读取数据
-    std::memcpy(page->data_.data(), data.data(), PAGE_SIZE);
+    return page;
+}
+
+bool Page::validateImage(const uint8_t* image) {
+    PageHeader header;
+    std::memcpy(&header, image, sizeof(PageHeader));
     
-    // 重建槽位目录
-    page->slots_.resize(header.slotCount);
-    for (uint16_t i = 0; i < header.slotCount; ++i) {
-        // 这里简化处理，实际应该从页面数据中重建槽位目录
-        page->slots_[i] = 0;
+    // 页头自洽性检查：槽位数组和记录区不能重叠
+    if (header.freeSpaceOffset < PAGE_HEADER_SIZE ||
+        static_cast<size_t>(header.freeSpaceOffset) + header.freeSpaceSize +
+            static_cast<size_t>(header.slotCount) * SLOT_ENTRY_SIZE != PAGE_SIZE) {
+        std::cerr << "Corrupted page header for page " << header.pageId << std::endl;
+        return false;
     }
     
-    return page;
+    if (calculateChecksum(image) != header.checksum) {
+        std::cerr << "Checksum mismatch for page " << header.pageId << std::endl;
+        return false;
+    }
+    
+    return true;
 }
 
 bool Page::isValid() const {
-    return calculateChecksum() == header_.checksum;
+    return calculateChecksum(data_) == header_->checksum;
 }
 
 void Page::updateChecksum() {
-    header_.checksum = calculateChecksum();
+    header_->checksum = calculateChecksum(data_);
 }
 
 void Page::printPageInfo() const {
     std::cout << "Page Info:" << std::endl;
-    std::cout << "  Page ID: " << header_.pageId << std::endl;
-    std::cout << "  Page Type: " << static_cast<int>(header_.pageType) << std::endl;
-    std::cout << "  Slot Count: " << header_.slotCount << std::endl;
-    std::cout << "  Free Space: " << header_.freeSpaceSize << " bytes" << std::endl;
-    std::cout << "  Free Space Offset: " << header_.freeSpaceOffset << std::endl;
-}
-
-void Page::initializePage() {
-    // 清零整个页面
-    std::fill(data_.begin(), data_.end(), 0);
-    
-    // 写入页头
-    std::memcpy(data_.data(), &header_, sizeof(PageHeader));
-    
-    updateChecksum();
+    std::cout << "  Page ID: " << header_->pageId << std::endl;
+    std::cout << "  Page Type: " << static_cast<int>(header_->pageType) << std::endl;
+    std::cout << "  Slot Count: " << header_->slotCount << std::endl;
+    std::cout << "  Free Space: " << header_->freeSpaceSize << " bytes" << std::endl;
+    std::cout << "  Free Space Offset: " << header_->freeSpaceOffset << std::endl;
+    std::cout << "  Fragmented: " << header_->fragmentedBytes << " bytes" << std::endl;
 }
 
-uint32_t Page::calculateChecksum() const {
-    // 简单的校验和计算（排除校验和字段本身）
+uint32_t Page::calculateChecksum(const uint8_t* image) {
+    // 简单的校验和计算：覆盖页头（排除校验和字段本身）和数据区
     uint32_t sum = 0;
-    const uint8_t* ptr = data_.data();
+    const uint8_t* headerBytes = image;
     
-    // 校验和字段前的数据
+    // 校验和字段前的页头
     size_t checksumOffset = offsetof(PageHeader, checksum);
     for (size_t i = 0; i < checksumOffset; ++i) {
-        sum += ptr[i];
+        sum += headerBytes[i];
+    }
+    
+    // 校验和字段后的页头
+    for (size_t i = checksumOffset + sizeof(uint32_t); i < sizeof(PageHeader); ++i) {
+        sum += headerBytes[i];
     }
     
-    // 校验和字段后的数据
-    for (size_t i = checksumOffset + sizeof(uint32_t); i < PAGE_SIZE; ++i) {
+    // 数据区（包括页尾的槽位数组）
+    const uint8_t* ptr = image;
+    for (size_t i = PAGE_HEADER_SIZE; i < PAGE_SIZE; ++i) {
         sum += ptr[i];
     }
     
@@ -284,33 +315,53 @@ uint32_t Page::calculateChecksum() const {
 }
 
 uint16_t Page::findFreeSlot() const {
-    for (uint16_t i = 0; i < slots_.size(); ++i) {
-        if (slots_[i] == 0) {
+    for (uint16_t i = 0; i < header_->slotCount; ++i) {
+        if (getSlotOffset(i) == 0) {
             return i;
         }
     }
-    return static_cast<uint16_t>(slots_.size());
+    return header_->slotCount;
+}
+
+uint16_t Page::getSlotOffset(uint16_t slotId) const {
+    return byteorder::loadLE<uint16_t>(&data_[PAGE_SIZE - (static_cast<size_t>(slotId) + 1) * SLOT_ENTRY_SIZE]);
+}
+
+void Page::setSlotOffset(uint16_t slotId, uint16_t offset) {
+    byteorder::storeLE<uint16_t>(&data_[PAGE_SIZE - (static_cast<size_t>(slotId) + 1) * SLOT_ENTRY_SIZE], offset);
 }
 
 void Page::compactPage() {
-    // 简单的页面压缩：重新组织所有有效记录
-    std::vector<std::string> validRecords;
-    
-    // 收集所有有效记录
-    for (uint16_t i = 0; i < slots_.size(); ++i) {
-        if (slots_[i] != 0) {
-            validRecords.push_back(getRecord(i));
+    // 页面压缩：把所有有效记录紧凑地重新排列，每条记录保留原来的槽位号
+    std::vector<uint8_t> oldData(data_, data_ + PAGE_SIZE);
+    uint16_t offset = PAGE_HEADER_SIZE;
+    
+    for (uint16_t i = 0; i < header_->slotCount; ++i) {
+        uint16_t oldOffset = getSlotOffset(i);
+        if (oldOffset == 0) {
+            continue;
         }
+        uint16_t totalSize = byteorder::loadLE<uint16_t>(&oldData[oldOffset]) + sizeof(uint16_t);
+        std::memcpy(&data_[offset], &oldData[oldOffset], totalSize);
+        setSlotOffset(i, offset);
+        offset += totalSize;
     }
     
-    // 重新初始化页面
-    header_.slotCount = 0;
-    header_.freeSpaceOffset = PAGE_HEADER_SIZE;
-    header_.freeSpaceSize = PAGE_DATA_SIZE;
-    slots_.clear();
+    // 碎片全部回收，槽位数组的大小保持不变
+    header_->freeSpaceOffset = offset;
+    header_->freeSpaceSize = static_cast<uint16_t>(PAGE_SIZE - header_->slotCount * SLOT_ENTRY_SIZE - offset);
+    header_->fragmentedBytes = 0;
+}
+
+void Page::placeRecord(uint16_t slotId, const std::string& record) {
+    uint16_t offset = header_->freeSpaceOffset;
+    uint16_t totalSize = static_cast<uint16_t>(record.size() + sizeof(uint16_t));
+    
+    // 写入记录长度和数据
+    byteorder::storeLE<uint16_t>(&data_[offset], static_cast<uint16_t>(record.size()));
+    std::memcpy(&data_[offset + sizeof(uint16_t)], record.data(), record.size());
     
-    // 重新插入所有记录
-    for (const auto& record : validRecords) {
-        insertRecordAndReturnSlot(record);
-    }
+    setSlotOffset(slotId, offset);
+    header_->freeSpaceOffset += totalSize;
+    header_->freeSpaceSize -= totalSize;
 }
@@ -0,0 +1,222 @@
+#include "../../include/storage/PageAllocationMap.h"
+#include "../../include/storage/BitOps.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uint64_t BITS_PER_WORD = 64;
+constexpr uint64_t ALL_FREE = ~0ull;
+constexpr uint64_t NO_PAGE = UINT64_MAX;
+constexpr uint64_t MAX_PAGE_ID = UINT32_MAX;
+
+} // namespace
+
+PageAllocationMap::PageAllocationMap() : pageLimit_(0), allocatedCount_(0), firstFreeWord_(0) {}
+
+void PageAllocationMap::reset(uint32_t pageLimit) {
+    freeWords_.assign((pageLimit + BITS_PER_WORD - 1) / BITS_PER_WORD, 0);
+    if (pageLimit % BITS_PER_WORD != 0) {
+        // 最后一个字中文件之外的页面保持空闲
+        freeWords_.back() = ALL_FREE << (pageLimit % BITS_PER_WORD);
+    }
+    pageLimit_ = pageLimit;
+    allocatedCount_ = pageLimit;
+    firstFreeWord_ = pageLimit / BITS_PER_WORD;
+}
+
+uint32_t PageAllocationMap::allocate() {
+    // 提示之前的字都没有空闲位；分配使字变满时提示在这里惰性前移
+    while (firstFreeWord_ < freeWords_.size() && freeWords_[firstFreeWord_] == 0) {
+        ++firstFreeWord_;
+    }
+    
+    uint64_t pageId = firstFreeWord_ * BITS_PER_WORD + 1;
+    if (firstFreeWord_ < freeWords_.size()) {
+        pageId += bitops::lowestSetBit(freeWords_[firstFreeWord_]);
+    }
+    if (pageId > MAX_PAGE_ID) {
+        return 0;
+    }
+    
+    markUsed(static_cast<uint32_t>(pageId));
+    return static_cast<uint32_t>(pageId);
+}
+
+uint32_t PageAllocationMap::allocateRun(uint32_t count, uint32_t goalPageId) {
+    if (count == 0) {
+        return 0;
+    }
+    
+    uint64_t start = std::max<uint64_t>(goalPageId, 1);
+    uint64_t first = findRun(count, start);
+    if (first != start && first + count - 1 > pageLimit_) {
+        // 无法紧接在goal之后分配，而且需要扩展文件：优先填补文件中已有的空洞
+        uint64_t hole = findRun(count, firstFreeWord_ * BITS_PER_WORD + 1);
+        if (hole + count - 1 <= pageLimit_) {
+            first = hole;
+        }
+    }
+    if (first + count - 1 > MAX_PAGE_ID) {
+        return 0;
+    }
+    
+    for (uint64_t pageId = first; pageId < first + count; ++pageId) {
+        markUsed(static_cast<uint32_t>(pageId));
+    }
+    return static_cast<uint32_t>(first);
+}
+
+bool PageAllocationMap::free(uint32_t pageId) {
+    if (!isAllocated(pageId)) {
+        return false;
+    }
+    markFree(pageId);
+    return true;
+}
+
+bool PageAllocationMap::allocateAt(uint32_t pageId) {
+    if (pageId == 0 || isAllocated(pageId)) {
+        return false;
+    }
+    markUsed(pageId);
+    return true;
+}
+
+bool PageAllocationMap::isAllocated(uint32_t pageId) const {
+    if (pageId == 0 || pageId > pageLimit_) {
+        return false;
+    }
+    uint64_t index = pageId - 1;
+    return (freeWords_[index / BITS_PER_WORD] & (1ull << (index % BITS_PER_WORD))) == 0;
+}
+
+uint32_t PageAllocationMap::getPageLimit() const {
+    return pageLimit_;
+}
+
+size_t PageAllocationMap::getAllocatedCount() const {
+    return allocatedCount_;
+}
+
+size_t PageAllocationMap::getFreeCount() const {
+    return pageLimit_ - allocatedCount_;
+}
+
+uint32_t PageAllocationMap::getHighestAllocated() const {
+    // 文件之外的页面都是空闲位，从最后一个字向前找第一个含已分配位的字
+    for (size_t word = freeWords_.size(); word-- > 0;) {
+        uint64_t used = ~freeWords_[word];
+        if (used != 0) {
+            return static_cast<uint32_t>(word * BITS_PER_WORD + bitops::highestSetBit(used) + 1);
+        }
+    }
+    return 0;
+}
+
+void PageAllocationMap::shrinkTo(uint32_t pageLimit) {
+    if (pageLimit >= pageLimit_ || pageLimit < getHighestAllocated()) {
+        return;
+    }
+    pageLimit_ = pageLimit;
+    freeWords_.resize((pageLimit + BITS_PER_WORD - 1) / BITS_PER_WORD);
+    firstFreeWord_ = std::min(firstFreeWord_, freeWords_.size());
+}
+
+void PageAllocationMap::exportBits(uint32_t firstPageId, uint32_t count, uint8_t* out) const {
+    std::memset(out, 0, (count + 7) / 8);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!isAllocated(firstPageId + i)) {
+            out[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+        }
+    }
+}
+
+void PageAllocationMap::importBits(uint32_t firstPageId, uint32_t count, const uint8_t* in) {
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t pageId = firstPageId + i;
+        if (pageId == 0) {
+            break;
+        }
+        bool isFree = (in[i / 8] >> (i % 8)) & 1u;
+        if (pageId > pageLimit_) {
+            if (!isFree) {
+                markUsed(pageId);
+            }
+        } else if (isFree && isAllocated(pageId)) {
+            markFree(pageId);
+        } else if (!isFree && !isAllocated(pageId)) {
+            markUsed(pageId);
+        }
+    }
+}
+
+void PageAllocationMap::ensureWords(size_t wordCount) {
+    if (freeWords_.size() < wordCount) {
+        freeWords_.resize(wordCount, ALL_FREE);
+    }
+}
+
+void PageAllocationMap::markUsed(uint32_t pageId) {
+    uint64_t index = pageId - 1;
+    ensureWords(index / BITS_PER_WORD + 1);
+    freeWords_[index / BITS_PER_WORD] &= ~(1ull << (index % BITS_PER_WORD));
+    ++allocatedCount_;
+    if (pageId > pageLimit_) {
+        // 在文件之外分配：文件范围扩展到该页，中间跳过的页面成为文件内的空闲页
+        pageLimit_ = pageId;
+    }
+}
+
+void PageAllocationMap::markFree(uint32_t pageId) {
+    uint64_t index = pageId - 1;
+    size_t word = index / BITS_PER_WORD;
+    freeWords_[word] |= 1ull << (index % BITS_PER_WORD);
+    --allocatedCount_;
+    firstFreeWord_ = std::min(firstFreeWord_, word);
+}
+
+uint64_t PageAllocationMap::findNextFree(uint64_t pageId) const {
+    uint64_t index = pageId - 1;
+    size_t word = index / BITS_PER_WORD;
+    if (word >= freeWords_.size()) {
+        return pageId;
+    }
+    uint64_t mask = freeWords_[word] & (ALL_FREE << (index % BITS_PER_WORD));
+    while (mask == 0) {
+        if (++word >= freeWords_.size()) {
+            return word * BITS_PER_WORD + 1;
+        }
+        mask = freeWords_[word];
+    }
+    return word * BITS_PER_WORD + bitops::lowestSetBit(mask) + 1;
+}
+
+uint64_t PageAllocationMap::findNextUsed(uint64_t pageId) const {
+    uint64_t index = pageId - 1;
+    size_t word = index / BITS_PER_WORD;
+    if (word >= freeWords_.size()) {
+        return NO_PAGE;
+    }
+    uint64_t mask = ~freeWords_[word] & (ALL_FREE << (index % BITS_PER_WORD));
+    while (mask == 0) {
+        if (++word >= freeWords_.size()) {
+            return NO_PAGE;
+        }
+        mask = ~freeWords_[word];
+    }
+    return word * BITS_PER_WORD + bitops::lowestSetBit(mask) + 1;
+}
+
+uint64_t PageAllocationMap::findRun(uint32_t count, uint64_t startPageId) const {
+    // 交替查找空闲段的起点和终点，每一步按字跳过整段已分配或空闲的页面
+    uint64_t pageId = startPageId;
+    while (true) {
+        uint64_t runStart = findNextFree(pageId);
+        uint64_t runEnd = findNextUsed(runStart);
+        if (runEnd == NO_PAGE || runEnd - runStart >= count) {
+            return runStart;
+        }
+        pageId = runEnd;
+    }
+}
@@ -0,0 +1,88 @@
+#include "../../include/storage/PageGuard.h"
+#include "../../include/storage/BufferPool.h"
+#include <utility>
+
+// ==================== ReadPageGuard ====================
+
+ReadPageGuard::ReadPageGuard() : pool_(nullptr), page_(nullptr) {}
+
+ReadPageGuard::ReadPageGuard(BufferPool& pool, uint32_t pageId)
+    : pool_(&pool), page_(pageId != 0 ? pool.getPage(pageId) : nullptr) {}
+
+ReadPageGuard::ReadPageGuard(const uint8_t* mappedImage) : pool_(nullptr), page_(nullptr) {
+    if (mappedImage) {
+        // 映射是只读的，视图只通过const接口访问，不会写入映射内存
+        view_.emplace(const_cast<uint8_t*>(mappedImage));
+        page_ = &*view_;
+    }
+}
+
+ReadPageGuard::ReadPageGuard(ReadPageGuard&& other) noexcept : pool_(nullptr), page_(nullptr) {
+    *this = std::move(other);
+}
+
+ReadPageGuard& ReadPageGuard::operator=(ReadPageGuard&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool_ = std::exchange(other.pool_, nullptr);
+        page_ = std::exchange(other.page_, nullptr);
+        if (other.view_) {
+            // 视图随守卫移动，页面指针指向本守卫中的视图
+            view_.emplace(std::move(*other.view_));
+            other.view_.reset();
+            page_ = &*view_;
+        }
+    }
+    return *this;
+}
+
+ReadPageGuard::~ReadPageGuard() {
+    release();
+}
+
+uint32_t ReadPageGuard::getPageId() const {
+    return page_ ? page_->getPageId() : 0;
+}
+
+void ReadPageGuard::release() {
+    if (view_) {
+        view_.reset();
+    } else if (page_) {
+        pool_->unpinPage(page_->getPageId());
+    }
+    page_ = nullptr;
+}
+
+// ==================== WritePageGuard ====================
+
+WritePageGuard::WritePageGuard() : pool_(nullptr), page_(nullptr) {}
+
+WritePageGuard::WritePageGuard(BufferPool& pool, uint32_t pageId)
+    : pool_(&pool), page_(pageId != 0 ? pool.getPage(pageId, true) : nullptr) {}
+
+WritePageGuard::WritePageGuard(WritePageGuard&& other) noexcept
+    : pool_(std::exchange(other.pool_, nullptr)), page_(std::exchange(other.page_, nullptr)) {}
+
+WritePageGuard& WritePageGuard::operator=(WritePageGuard&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool_ = std::exchange(other.pool_, nullptr);
+        page_ = std::exchange(other.page_, nullptr);
+    }
+    return *this;
+}
+
+WritePageGuard::~WritePageGuard() {
+    release();
+}
+
+uint32_t WritePageGuard::getPageId() const {
+    return page_ ? page_->getPageId() : 0;
+}
+
+void WritePageGuard::release() {
+    if (page_) {
+        pool_->unpinPage(page_->getPageId(), true);
+        page_ = nullptr;
+    }
+}
@@ -1,228 +1,910 @@
 #include "../../include/storage/PageManager.h"
+#include "../../include/storage/ByteOrder.h"
 #include <iostream>
 #include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
-PageManager::PageManager(const std::string& dbFileName, size_t bufferPoolSize) 
-    : dbFileName_(dbFileName), nextPageId_(1) {
-    freePageBitmap_.resize(1000, true); // 初始支持1000页
-    freePageBitmap_[0] = false; // 页面ID从1开始
-    bufferPool_ = std::make_unique<BufferPool>(bufferPoolSize);
-    openFile();
+namespace {
+
+// 只读映射模式下每页的校验状态
+constexpr uint8_t MAPPED_PAGE_UNCHECKED = 0;
+constexpr uint8_t MAPPED_PAGE_VALID = 1;
+constexpr uint8_t MAPPED_PAGE_CORRUPTED = 2;
+
+// 后台检查点线程检查触发条件的间隔
+constexpr std::chrono::milliseconds CHECKPOINTER_POLL_INTERVAL(100);
+
+// 页分配位图页记录头：[u32 下一个位图页ID][u32 起始页ID][u32 页数]
+constexpr size_t ALLOCATION_MAP_HEADER_SIZE = 3 * sizeof(uint32_t);
+
+void reportReadOnly(const std::string& operation) {
+    std::cerr << "Cannot " << operation << ": database is opened read-only" << std::endl;
 }
 
-PageManager::~PageManager() {
-    flushAllPages();
-    closeFile();
+// 页面分配和释放记录的负载：[u32 起始页ID][u32 页数]
+std::string encodePageRange(uint32_t firstPageId, uint32_t pageCount) {
+    std::string payload(2 * sizeof(uint32_t), '\0');
+    uint8_t* out = reinterpret_cast<uint8_t*>(&payload[0]);
+    byteorder::storeLE<uint32_t>(out, firstPageId);
+    byteorder::storeLE<uint32_t>(out + sizeof(uint32_t), pageCount);
+    return payload;
 }
 
-uint32_t PageManager::allocatePage(PageType type) {
-    uint32_t pageId = findFreePageId();
-    if (pageId == 0) {
-        // 扩展位图
-        size_t oldSize = freePageBitmap_.size();
-        freePageBitmap_.resize(oldSize * 2, true);
-        pageId = oldSize;
+bool decodePageRange(const std::string& payload, uint32_t& firstPageId, uint32_t& pageCount) {
+    if (payload.size() != 2 * sizeof(uint32_t)) {
+        return false;
     }
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(payload.data());
+    firstPageId = byteorder::loadLE<uint32_t>(in);
+    pageCount = byteorder::loadLE<uint32_t>(in + sizeof(uint32_t));
+    return true;
+}
+
+// 对页面执行一条物理逻辑修改（重做和撤销共用）
+bool applyPageChange(Page& page, LogRecordType type, const PageLogRecord& change) {
+    switch (type) {
+        case LogRecordType::INSERT:
+            return page.insertRecordAt(change.slotId, change.after);
+        case LogRecordType::DELETE:
+            return page.deleteRecord(change.slotId);
+        case LogRecordType::UPDATE:
+            return page.updateRecord(change.slotId, change.after);
+        case LogRecordType::COMPACT:
+            page.compactPage();
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+PageManager::PageManager(const std::string& dbFileName, size_t bufferPoolSize,
+                         const FlusherConfig& flusherConfig, ReplacementPolicyType policyType) 
+    : PageManager(createDiskBackend(dbFileName), bufferPoolSize, flusherConfig, policyType) {}
+
+PageManager::PageManager(std::unique_ptr<DiskBackend> diskBackend, size_t bufferPoolSize,
+                         const FlusherConfig& flusherConfig, ReplacementPolicyType policyType) 
+    : diskBackend_(diskBackend.get()), mappedPrefetchDepth_(BufferPool::DEFAULT_PREFETCH_DEPTH) {
+    // 缓冲池持有磁盘后端：未命中时由缓冲池读盘，淘汰或刷新脏页时由缓冲池写回
+    bufferPool_ = std::make_unique<BufferPool>(bufferPoolSize, std::move(diskBackend), policyType);
     
-    markPageUsed(pageId);
+    // 已有数据文件：在加载持久化的页分配位图之前，文件中的所有页都视为已分配
+    allocationMap_.reset(diskBackend_->getPageCount());
     
-    // 创建新页面
-    auto page = std::make_shared<Page>(pageId, type);
-    bufferPool_->putPage(page);
-    
-    if (pageId >= nextPageId_) {
-        nextPageId_ = pageId + 1;
+    bufferPool_->startFlusher(flusherConfig);
+}
+
+PageManager::PageManager(std::unique_ptr<MappedFile> mappedFile)
+    : diskBackend_(nullptr), mappedFile_(std::move(mappedFile)),
+      mappedPageState_(mappedFile_->getPageCount()), mappedPrefetchDepth_(BufferPool::DEFAULT_PREFETCH_DEPTH) {}
+
+std::unique_ptr<PageManager> PageManager::openReadOnly(const std::string& dbFileName) {
+    auto mappedFile = std::make_unique<MappedFile>(dbFileName);
+    if (!mappedFile->isOpen()) {
+        return nullptr;
     }
-    
-    return pageId;
+    return std::unique_ptr<PageManager>(new PageManager(std::move(mappedFile)));
 }
 
-void PageManager::deallocatePage(uint32_t pageId) {
-    if (pageId == 0 || pageId >= freePageBitmap_.size()) {
-        return;
+PageManager::~PageManager() {
+    if (isReadOnly()) {
+        return; // 没有脏页需要写回
     }
-    
-    markPageFree(pageId);
-    
-    // 从缓冲池中刷新并移除（如果存在）
-    if (bufferPool_->isPageInPool(pageId)) {
-        bufferPool_->flushPage(pageId);
+    stopCheckpointer();
+    bufferPool_->stopPrefetcher();
+    bufferPool_->stopFlusher();
+    saveToDisk();
+}
+
+bool PageManager::openLog(const std::string& directory, const WalConfig& config) {
+    if (isReadOnly()) {
+        reportReadOnly("open write-ahead log");
+        return false;
+    }
+    auto wal = std::make_unique<WriteAheadLog>(directory, config);
+    if (!wal->isOpen()) {
+        std::cerr << "Failed to open write-ahead log: " << directory << std::endl;
+        return false;
     }
+    // 旧日志中的记录先持久化，缓冲池中页面的LSN仍然有效
+    bufferPool_->setWriteAheadLog(nullptr);
+    if (wal_) {
+        wal_->flushAll();
+    }
+    wal_ = std::move(wal);
+    bufferPool_->setWriteAheadLog(wal_.get());
+    return true;
 }
 
-std::shared_ptr<Page> PageManager::getPage(uint32_t pageId) {
-    if (pageId == 0) {
-        return nullptr;
+void PageManager::setSynchronousMode(SynchronousMode mode) {
+    if (wal_) {
+        wal_->setSynchronousMode(mode);
     }
-    
-    // 先从缓冲池中获取
-    auto page = bufferPool_->getPage(pageId);
-    if (page) {
-        return page;
+}
+
+SynchronousMode PageManager::getSynchronousMode() const {
+    return wal_ ? wal_->getSynchronousMode() : SynchronousMode::FULL;
+}
+
+void PageManager::setSessionSynchronousMode(SynchronousMode mode) {
+    std::lock_guard<std::mutex> lock(transactionMutex_);
+    sessionSynchronous_[std::this_thread::get_id()] = mode;
+}
+
+void PageManager::clearSessionSynchronousMode() {
+    std::lock_guard<std::mutex> lock(transactionMutex_);
+    sessionSynchronous_.erase(std::this_thread::get_id());
+}
+
+SynchronousMode PageManager::getSessionSynchronousMode() const {
+    {
+        std::lock_guard<std::mutex> lock(transactionMutex_);
+        auto it = sessionSynchronous_.find(std::this_thread::get_id());
+        if (it != sessionSynchronous_.end()) {
+            return it->second;
+        }
     }
-    
-    // 从磁盘加载
-    std::vector<uint8_t> data;
-    if (readPageFromDisk(pageId, data)) {
-        auto diskPage = Page::deserialize(data);
-        if (diskPage) {
-            auto sharedPage = std::shared_ptr<Page>(diskPage.release());
-            bufferPool_->putPage(sharedPage);
-            return sharedPage;
+    return getSynchronousMode();
+}
+
+bool PageManager::beginTransaction() {
+    std::lock_guard<std::mutex> lock(transactionMutex_);
+    return transactions_.emplace(std::this_thread::get_id(), 0).second;
+}
+
+bool PageManager::commitTransaction(bool waitDurable) {
+    uint64_t txnId;
+    {
+        std::lock_guard<std::mutex> lock(transactionMutex_);
+        auto it = transactions_.find(std::this_thread::get_id());
+        if (it == transactions_.end()) {
+            return false;
         }
+        txnId = it->second;
+        transactions_.erase(it);
     }
-    
-    return nullptr;
+    // 没有写过日志的事务（只读或没有打开日志）不需要提交记录
+    return txnId == 0 || wal_->commitTransaction(txnId, waitDurable, getSessionSynchronousMode()) != 0;
 }
 
-bool PageManager::writePage(std::shared_ptr<Page> page) {
-    if (!page) {
-        return false;
+bool PageManager::rollbackTransaction(const std::function<void(const LogRecord&)>& onUndo) {
+    uint64_t txnId;
+    {
+        std::lock_guard<std::mutex> lock(transactionMutex_);
+        auto it = transactions_.find(std::this_thread::get_id());
+        if (it == transactions_.end()) {
+            return false;
+        }
+        txnId = it->second;
+        transactions_.erase(it);
+    }
+    if (txnId == 0) {
+        return true; // 没有写过日志，没有需要撤销的修改
     }
     
-    uint32_t pageId = page->getPageId();
-    
-    // 放入缓冲池
-    bufferPool_->putPage(page);
-    
-    // 写入磁盘
-    auto data = page->serialize();
-    return writePageToDisk(pageId, data);
+    bool ok = true;
+    uint64_t lsn = wal_->getTransactionLastLsn(txnId);
+    while (lsn != 0) {
+        LogRecord record;
+        if (!wal_->readRecord(lsn, record)) {
+            std::cerr << "Cannot read log record at LSN " << lsn << " while rolling back transaction " << txnId
+                      << std::endl;
+            ok = false;
+            break;
+        }
+        uint64_t nextLsn = record.prevLsn;
+        if (record.type == LogRecordType::BEGIN) {
+            nextLsn = 0;
+        } else if (record.type == LogRecordType::COMPENSATION) {
+            CompensationLogRecord compensation;
+            nextLsn = compensation.decode(record.payload) ? compensation.undoNextLsn : 0;
+        } else if (record.type == LogRecordType::INSERT || record.type == LogRecordType::DELETE ||
+                   record.type == LogRecordType::UPDATE) {
+            if (!undoPageChange(record)) {
+                ok = false;
+            } else if (onUndo) {
+                onUndo(record);
+            }
+        }
+        lsn = nextLsn;
+    }
+    // 中途崩溃时恢复按补偿记录继续撤销剩下的部分；ABORT记录不需要等待持久化
+    wal_->abortTransaction(txnId);
+    return ok;
 }
 
-bool PageManager::flushPage(uint32_t pageId) {
-    return bufferPool_->flushPage(pageId);
+bool PageManager::inTransaction() const {
+    std::lock_guard<std::mutex> lock(transactionMutex_);
+    return transactions_.count(std::this_thread::get_id()) > 0;
 }
 
-void PageManager::flushAllPages() {
-    bufferPool_->flushAllPages();
+uint64_t PageManager::getTransactionId() const {
+    std::lock_guard<std::mutex> lock(transactionMutex_);
+    auto it = transactions_.find(std::this_thread::get_id());
+    return it != transactions_.end() ? it->second : 0;
 }
 
-bool PageManager::pageExists(uint32_t pageId) const {
-    return pageId > 0 && 
-           pageId < freePageBitmap_.size() && 
-           !freePageBitmap_[pageId];
+uint64_t PageManager::currentTransactionId() {
+    std::lock_guard<std::mutex> lock(transactionMutex_);
+    if (transactions_.empty()) {
+        return 0;
+    }
+    auto it = transactions_.find(std::this_thread::get_id());
+    if (it == transactions_.end()) {
+        return 0;
+    }
+    if (it->second == 0) {
+        it->second = wal_->beginTransaction();
+    }
+    return it->second;
 }
 
-size_t PageManager::getTotalPages() const {
-    return std::count(freePageBitmap_.begin(), freePageBitmap_.end(), false);
+uint64_t PageManager::logPageChange(Page& page, LogRecordType type, uint16_t slotId,
+                                    const std::string& before, const std::string& after) {
+    if (!wal_) {
+        return 0;
+    }
+    uint64_t lsn = wal_->append(type, currentTransactionId(),
+                                PageLogRecord::encode(page.getPageId(), slotId, before, after));
+    if (lsn != 0) {
+        page.setLsn(lsn);
+    }
+    return lsn;
 }
 
-size_t PageManager::getFreePages() const {
-    return std::count(freePageBitmap_.begin(), freePageBitmap_.end(), true);
+uint64_t PageManager::logOperation(LogRecordType type, const std::string& payload) {
+    if (!wal_) {
+        return 0;
+    }
+    return wal_->append(type, currentTransactionId(), payload);
 }
 
-bool PageManager::loadFromDisk() {
-    if (!dbFile_.is_open()) {
+bool PageManager::redoPageChange(const LogRecord& record) {
+    LogRecordType type = record.type;
+    PageLogRecord change;
+    bool decoded;
+    if (type == LogRecordType::COMPENSATION) {
+        CompensationLogRecord compensation;
+        decoded = compensation.decode(record.payload) && change.decode(compensation.pageRecord);
+        type = compensation.type;
+    } else {
+        decoded = change.decode(record.payload);
+    }
+    if (!decoded || change.pageId == 0) {
+        std::cerr << "Invalid page log record at LSN " << record.lsn << std::endl;
         return false;
     }
     
-    // 读取元数据（简化实现）
-    dbFile_.seekg(0, std::ios::beg);
+    // 格式化和整页镜像不依赖页面原来的内容，直接覆盖（页面可能还不在文件中）
+    if (type == LogRecordType::PAGE_FORMAT || type == LogRecordType::PAGE_IMAGE) {
+        Page page(change.pageId);
+        if (type == LogRecordType::PAGE_FORMAT) {
+            page.format(change.pageId, change.after.empty() ? PageType::DATA_PAGE
+                                                            : static_cast<PageType>(change.after[0]));
+        } else if (change.after.size() == PAGE_SIZE) {
+            std::memcpy(page.getData(), change.after.data(), PAGE_SIZE);
+        } else {
+            std::cerr << "Invalid page image at LSN " << record.lsn << std::endl;
+            return false;
+        }
+        page.setLsn(record.lsn);
+        return putPage(page);
+    }
     
-    // 这里可以实现更复杂的元数据加载逻辑
+    WritePageGuard page = fetchPageWrite(change.pageId);
+    if (!page) {
+        std::cerr << "Cannot redo log record at LSN " << record.lsn << ": page " << change.pageId
+                  << " is unreadable" << std::endl;
+        return false;
+    }
+    if (page->getLsn() >= record.lsn) {
+        return false; // 修改已经在页面中
+    }
+    if (!applyPageChange(*page, type, change)) {
+        std::cerr << "Failed to redo log record at LSN " << record.lsn << " on page " << change.pageId << std::endl;
+        return false;
+    }
+    page->setLsn(record.lsn);
     return true;
 }
 
-bool PageManager::saveToDisk() {
-    flushAllPages();
+void PageManager::redoAllocation(const LogRecord& record, std::vector<uint32_t>& freedPageIds) {
+    uint32_t firstPageId;
+    uint32_t pageCount;
+    if (!decodePageRange(record.payload, firstPageId, pageCount)) {
+        std::cerr << "Invalid page allocation log record at LSN " << record.lsn << std::endl;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(allocationMutex_);
+    for (uint32_t i = 0; i < pageCount; ++i) {
+        if (record.type == LogRecordType::PAGE_ALLOC) {
+            allocationMap_.allocateAt(firstPageId + i);
+        } else {
+            allocationMap_.free(firstPageId + i);
+            freedPageIds.push_back(firstPageId + i);
+        }
+    }
+}
+
+void PageManager::discardFreePages(const std::vector<uint32_t>& pageIds) {
+    for (uint32_t pageId : pageIds) {
+        if (!pageExists(pageId)) {
+            bufferPool_->discardPage(pageId);
+        }
+    }
+}
+
+bool PageManager::undoPageChange(const LogRecord& record) {
+    if (!wal_) {
+        return false;
+    }
+    
+    // 相反的操作：插入 -> 删除，删除 -> 按前像重新插入，更新 -> 换回前像
+    CompensationLogRecord compensation;
+    compensation.undoNextLsn = record.prevLsn;
+    PageLogRecord change;
+    switch (record.type) {
+        case LogRecordType::INSERT:
+        case LogRecordType::DELETE:
+        case LogRecordType::UPDATE:
+            if (!change.decode(record.payload)) {
+                std::cerr << "Invalid page log record at LSN " << record.lsn << std::endl;
+                return false;
+            }
+            break;
+        default:
+            return true; // 格式化、整页镜像和压缩不改变记录内容，不需要撤销
+    }
+    compensation.type = record.type == LogRecordType::INSERT   ? LogRecordType::DELETE
+                        : record.type == LogRecordType::DELETE ? LogRecordType::INSERT
+                                                               : LogRecordType::UPDATE;
+    std::swap(change.before, change.after);
     
-    if (dbFile_.is_open()) {
-        dbFile_.flush();
+    WritePageGuard page = fetchPageWrite(change.pageId);
+    if (!page || !applyPageChange(*page, compensation.type, change)) {
+        std::cerr << "Failed to undo log record at LSN " << record.lsn << " on page " << change.pageId << std::endl;
+        return false;
+    }
+    compensation.pageRecord = change.encode();
+    uint64_t lsn = wal_->append(LogRecordType::COMPENSATION, record.txnId, compensation.encode());
+    if (lsn != 0) {
+        page->setLsn(lsn);
+    }
+    return lsn != 0;
+}
+
+bool PageManager::writeCheckpoint(uint64_t redoLsn) {
+    if (!wal_) {
         return true;
     }
-    return false;
+    std::lock_guard<std::mutex> lock(checkpointMutex_);
+    return completeCheckpoint(redoLsn, 0, std::chrono::steady_clock::now(), false);
 }
 
-const BufferPoolStats& PageManager::getBufferPoolStats() const {
-    return bufferPool_->getStats();
+bool PageManager::completeCheckpoint(uint64_t redoLsn, size_t pagesFlushed,
+                                     std::chrono::steady_clock::time_point startTime, bool background) {
+    // 先取脏页表再同步页文件：不在脏页表中的页面，写回在这之前已经完成，同步之后都在磁盘上
+    CheckpointLogRecord checkpoint;
+    checkpoint.dirtyPageTableLsn = wal_->getNextLsn();
+    checkpoint.dirtyPages = bufferPool_->getDirtyPageTable();
+    // OFF级别不同步：写回的页面已交给操作系统，进程崩溃后仍然可以从检查点恢复
+    if (getSynchronousMode() != SynchronousMode::OFF && !diskBackend_->sync()) {
+        std::cerr << "Failed to sync the database file for checkpoint" << std::endl;
+        return false;
+    }
+    // 还没写回的页面从它们最早的修改开始重做
+    checkpoint.redoLsn = redoLsn;
+    for (const auto& dirtyPage : checkpoint.dirtyPages) {
+        checkpoint.redoLsn = std::min(checkpoint.redoLsn, dirtyPage.second);
+    }
+    checkpoint.activeTransactions = wal_->getActiveTransactions();
+    uint64_t lsn = wal_->append(LogRecordType::CHECKPOINT, 0, checkpoint.encode());
+    if (lsn == 0 || !wal_->flush(lsn) || !wal_->setCheckpointLsn(lsn)) {
+        return false;
+    }
+    
+    // 重做起点和最早的活跃事务（事务ID就是BEGIN记录的LSN）之前的日志不再需要
+    uint64_t keepLsn = checkpoint.redoLsn;
+    for (const auto& transaction : checkpoint.activeTransactions) {
+        keepLsn = std::min(keepLsn, transaction.first);
+    }
+    wal_->recycleSegments(keepLsn, checkpointConfig_.spareSegments);
+    
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(checkpointerMutex_);
+    ++checkpointStats_.checkpoints;
+    if (background) {
+        ++checkpointStats_.backgroundCheckpoints;
+    }
+    checkpointStats_.lastCheckpointLsn = lsn;
+    checkpointStats_.lastRedoLsn = checkpoint.redoLsn;
+    checkpointStats_.lastPagesFlushed = pagesFlushed;
+    checkpointStats_.totalPagesFlushed += pagesFlushed;
+    checkpointStats_.lastDirtyPages = checkpoint.dirtyPages.size();
+    checkpointStats_.lastDurationMs = std::chrono::duration<double, std::milli>(now - startTime).count();
+    lastCheckpointEndLsn_ = wal_->getNextLsn();
+    lastCheckpointTime_ = now;
+    // 刚完成检查点，之前发出的请求不再需要
+    checkpointRequested_ = false;
+    return true;
 }
 
-void PageManager::printBufferPoolStats() const {
-    bufferPool_->printStats();
+void PageManager::startCheckpointer(const CheckpointConfig& config) {
+    stopCheckpointer();
+    if (!wal_) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(checkpointerMutex_);
+    checkpointConfig_ = config;
+    if (!checkpointConfig_.enabled) {
+        return;
+    }
+    lastCheckpointEndLsn_ = wal_->getNextLsn();
+    lastCheckpointTime_ = std::chrono::steady_clock::now();
+    pendingBeginLsn_ = 0;
+    checkpointerRunning_ = true;
+    checkpointerThread_ = std::thread(&PageManager::checkpointerLoop, this);
 }
 
-void PageManager::resetBufferPoolStats() {
-    bufferPool_->resetStats();
+void PageManager::stopCheckpointer() {
+    {
+        std::lock_guard<std::mutex> lock(checkpointerMutex_);
+        checkpointerRunning_ = false;
+        checkpointRequested_ = false;
+    }
+    checkpointerCv_.notify_all();
+    if (checkpointerThread_.joinable()) {
+        checkpointerThread_.join();
+    }
 }
 
-void PageManager::printStatistics() const {
-    std::cout << "PageManager Statistics:" << std::endl;
-    std::cout << "  Database file: " << dbFileName_ << std::endl;
-    std::cout << "  Total pages: " << getTotalPages() << std::endl;
-    std::cout << "  Free pages: " << getFreePages() << std::endl;
-    std::cout << "  Next page ID: " << nextPageId_ << std::endl;
-    
-    std::cout << std::endl;
-    printBufferPoolStats();
+void PageManager::beginCheckpoint(uint64_t beginLsn) {
+    {
+        std::lock_guard<std::mutex> lock(checkpointerMutex_);
+        if (!checkpointerRunning_) {
+            return;
+        }
+        pendingBeginLsn_ = beginLsn;
+        checkpointRequested_ = false;
+    }
+    checkpointerCv_.notify_one();
 }
 
-bool PageManager::openFile() {
-    dbFile_.open(dbFileName_, std::ios::in | std::ios::out | std::ios::binary);
+CheckpointStats PageManager::getCheckpointStats() const {
+    std::lock_guard<std::mutex> lock(checkpointerMutex_);
+    return checkpointStats_;
+}
+
+bool PageManager::checkpointDue() const {
+    uint64_t logged = wal_->getNextLsn() - lastCheckpointEndLsn_;
+    if (logged == 0) {
+        return false; // 没有新日志
+    }
+    return logged >= checkpointConfig_.logBytes ||
+           (checkpointConfig_.interval.count() > 0 &&
+            std::chrono::steady_clock::now() - lastCheckpointTime_ >= checkpointConfig_.interval);
+}
+
+void PageManager::checkpointerLoop() {
+    std::unique_lock<std::mutex> lock(checkpointerMutex_);
+    while (checkpointerRunning_) {
+        checkpointerCv_.wait_for(lock, CHECKPOINTER_POLL_INTERVAL, [&] {
+            return !checkpointerRunning_ || pendingBeginLsn_ != 0;
+        });
+        if (!checkpointerRunning_) {
+            break;
+        }
+        if (pendingBeginLsn_ == 0) {
+            // 系统目录只能由执行操作的线程在两个操作之间保存，这里只发出请求
+            if (checkpointDue()) {
+                checkpointRequested_ = true;
+            }
+            continue;
+        }
+        uint64_t beginLsn = pendingBeginLsn_;
+        pendingBeginLsn_ = 0;
+        lock.unlock();
+        
+        {
+            std::lock_guard<std::mutex> checkpointLock(checkpointMutex_);
+            // 等待期间保存数据库时已经完成了更新的检查点
+            if (beginLsn > getCheckpointStats().lastRedoLsn) {
+                auto startTime = std::chrono::steady_clock::now();
+                size_t pagesFlushed = bufferPool_->flushPagesBefore(beginLsn);
+                completeCheckpoint(beginLsn, pagesFlushed, startTime, true);
+            }
+        }
+        lock.lock();
+    }
+}
+
+uint32_t PageManager::allocatePage(PageType type) {
+    if (isReadOnly()) {
+        reportReadOnly("allocate page");
+        return 0;
+    }
     
-    if (!dbFile_.is_open()) {
-        // 文件不存在，创建新文件
-        dbFile_.open(dbFileName_, std::ios::out | std::ios::binary);
-        if (dbFile_.is_open()) {
-            dbFile_.close();
-            dbFile_.open(dbFileName_, std::ios::in | std::ios::out | std::ios::binary);
+    uint32_t pageId;
+    {
+        // 在分配锁内记录，同一页面的分配和释放记录与位图的修改顺序一致
+        std::lock_guard<std::mutex> lock(allocationMutex_);
+        pageId = allocationMap_.allocate();
+        if (pageId != 0) {
+            logOperation(LogRecordType::PAGE_ALLOC, encodePageRange(pageId, 1));
         }
     }
+    if (pageId == 0) {
+        std::cerr << "Failed to allocate page: database file is full" << std::endl;
+        return 0;
+    }
     
-    return dbFile_.is_open();
+    // 创建新页面
+    formatPage(pageId, type);
+    
+    return pageId;
 }
 
-void PageManager::closeFile() {
-    if (dbFile_.is_open()) {
-        dbFile_.close();
+uint32_t PageManager::allocateExtent(uint32_t pageCount, uint32_t goalPageId) {
+    if (isReadOnly()) {
+        reportReadOnly("allocate pages");
+        return 0;
     }
+    
+    uint32_t firstPageId;
+    {
+        std::lock_guard<std::mutex> lock(allocationMutex_);
+        firstPageId = allocationMap_.allocateRun(pageCount, goalPageId);
+        if (firstPageId != 0) {
+            logOperation(LogRecordType::PAGE_ALLOC, encodePageRange(firstPageId, pageCount));
+        }
+    }
+    if (firstPageId == 0 && pageCount > 0) {
+        std::cerr << "Failed to allocate " << pageCount << " contiguous pages" << std::endl;
+    }
+    return firstPageId;
 }
 
-bool PageManager::readPageFromDisk(uint32_t pageId, std::vector<uint8_t>& data) {
-    if (!dbFile_.is_open()) {
+bool PageManager::formatPage(uint32_t pageId, PageType type) {
+    if (isReadOnly()) {
+        reportReadOnly("write page " + std::to_string(pageId));
         return false;
     }
+    Page page(pageId, type);
+    logPageChange(page, LogRecordType::PAGE_FORMAT, 0, std::string(), std::string(1, static_cast<char>(type)));
+    return putPage(page);
+}
+
+void PageManager::deallocatePage(uint32_t pageId) {
+    if (isReadOnly()) {
+        reportReadOnly("free page");
+        return;
+    }
     
-    std::streampos pos = static_cast<std::streampos>(pageId - 1) * PAGE_SIZE;
-    dbFile_.seekg(pos);
+    {
+        std::lock_guard<std::mutex> lock(allocationMutex_);
+        if (!allocationMap_.free(pageId)) {
+            return; // 无效页ID或页面已释放
+        }
+        logOperation(LogRecordType::PAGE_FREE, encodePageRange(pageId, 1));
+    }
+    
+    // 页面内容不再需要，直接从缓冲池中移除，不写回磁盘
+    // （仍被固定时留在缓冲池中，之后可能被写回，位图中它已是空闲页，不影响正确性）
+    bufferPool_->discardPage(pageId);
+}
+
+uint32_t PageManager::saveAllocationMap() {
+    if (isReadOnly()) {
+        return 0;
+    }
     
-    data.resize(PAGE_SIZE);
-    dbFile_.read(reinterpret_cast<char*>(data.data()), PAGE_SIZE);
+    // 按需分配或释放位图页（分配位图页本身会扩大文件范围，所以循环到页数不再变化）
+    while (true) {
+        size_t pagesNeeded;
+        {
+            std::lock_guard<std::mutex> lock(allocationMutex_);
+            pagesNeeded = (static_cast<size_t>(allocationMap_.getPageLimit()) + ALLOCATION_MAP_PAGES_PER_MAP_PAGE - 1) /
+                          ALLOCATION_MAP_PAGES_PER_MAP_PAGE;
+        }
+        if (allocationMapPageIds_.size() < pagesNeeded) {
+            uint32_t pageId = allocatePage(PageType::ALLOCATION_MAP_PAGE);
+            if (pageId == 0) {
+                std::cerr << "Failed to allocate page allocation map page" << std::endl;
+                return 0;
+            }
+            allocationMapPageIds_.push_back(pageId);
+        } else if (allocationMapPageIds_.size() > pagesNeeded) {
+            deallocatePage(allocationMapPageIds_.back());
+            allocationMapPageIds_.pop_back();
+        } else {
+            break;
+        }
+    }
     
-    return dbFile_.gcount() == PAGE_SIZE;
+    // 先在锁内导出全部位图，再逐页写入（写入期间不阻塞分配）
+    std::vector<std::string> records(allocationMapPageIds_.size());
+    {
+        std::lock_guard<std::mutex> lock(allocationMutex_);
+        uint32_t pageLimit = allocationMap_.getPageLimit();
+        for (size_t i = 0; i < records.size(); ++i) {
+            uint32_t firstPageId = static_cast<uint32_t>(i * ALLOCATION_MAP_PAGES_PER_MAP_PAGE + 1);
+            uint32_t count = std::min(ALLOCATION_MAP_PAGES_PER_MAP_PAGE, pageLimit - (firstPageId - 1));
+            uint32_t nextPageId = (i + 1 < records.size()) ? allocationMapPageIds_[i + 1] : 0;
+            
+            std::string& record = records[i];
+            record.assign(ALLOCATION_MAP_HEADER_SIZE + (count + 7) / 8, '\0');
+            uint8_t* out = reinterpret_cast<uint8_t*>(&record[0]);
+            byteorder::storeLE<uint32_t>(out, nextPageId);
+            byteorder::storeLE<uint32_t>(out + sizeof(uint32_t), firstPageId);
+            byteorder::storeLE<uint32_t>(out + 2 * sizeof(uint32_t), count);
+            allocationMap_.exportBits(firstPageId, count, out + ALLOCATION_MAP_HEADER_SIZE);
+        }
+    }
+    
+    // 位图页每次整页重写
+    for (size_t i = 0; i < records.size(); ++i) {
+        Page page(allocationMapPageIds_[i], PageType::ALLOCATION_MAP_PAGE);
+        if (!page.insertRecord(records[i])) {
+            std::cerr << "Page allocation map page overflow" << std::endl;
+            return 0;
+        }
+        writePage(page);
+    }
+    
+    return allocationMapPageIds_.empty() ? 0 : allocationMapPageIds_.front();
+}
+
+bool PageManager::loadAllocationMap(uint32_t rootPageId) {
+    if (isReadOnly()) {
+        return true; // 只读模式不分配页面，不需要位图
+    }
+    
+    // 先读出整条链表，全部有效时才应用；失败时保持文件中所有页都已分配的保守状态
+    std::vector<uint32_t> mapPageIds;
+    std::vector<std::string> records;
+    uint32_t pageId = rootPageId;
+    while (pageId != 0) {
+        ReadPageGuard page = fetchPageRead(pageId);
+        if (!page || page->getPageType() != PageType::ALLOCATION_MAP_PAGE) {
+            std::cerr << "Invalid page allocation map page: " << pageId << std::endl;
+            return false;
+        }
+        std::string record = page->getRecord(0);
+        page.release();
+        
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(record.data());
+        uint32_t count = record.size() >= ALLOCATION_MAP_HEADER_SIZE
+                             ? byteorder::loadLE<uint32_t>(data + 2 * sizeof(uint32_t)) : 0;
+        // 链表长度超过文件页数说明链表有环
+        if (record.size() < ALLOCATION_MAP_HEADER_SIZE || count > ALLOCATION_MAP_PAGES_PER_MAP_PAGE ||
+            record.size() < ALLOCATION_MAP_HEADER_SIZE + (count + 7) / 8 ||
+            mapPageIds.size() >= allocationMap_.getPageLimit()) {
+            std::cerr << "Corrupted page allocation map page: " << pageId << std::endl;
+            return false;
+        }
+        
+        mapPageIds.push_back(pageId);
+        pageId = byteorder::loadLE<uint32_t>(data);
+        records.push_back(std::move(record));
+    }
+    
+    std::lock_guard<std::mutex> lock(allocationMutex_);
+    for (const std::string& record : records) {
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(record.data());
+        uint32_t firstPageId = byteorder::loadLE<uint32_t>(data + sizeof(uint32_t));
+        uint32_t count = byteorder::loadLE<uint32_t>(data + 2 * sizeof(uint32_t));
+        // 位图之后写入文件的页面（保存位图之后分配的）不在任何记录中，保持已分配
+        allocationMap_.importBits(firstPageId, count, data + ALLOCATION_MAP_HEADER_SIZE);
+    }
+    allocationMapPageIds_ = std::move(mapPageIds);
+    return true;
+}
+
+ReadPageGuard PageManager::fetchPageRead(uint32_t pageId) {
+    if (isReadOnly()) {
+        return fetchMappedPage(pageId);
+    }
+    // 缓冲池未命中时由缓冲池从磁盘后端加载
+    return ReadPageGuard(*bufferPool_, pageId);
+}
+
+WritePageGuard PageManager::fetchPageWrite(uint32_t pageId) {
+    if (isReadOnly()) {
+        reportReadOnly("modify page " + std::to_string(pageId));
+        return WritePageGuard();
+    }
+    return WritePageGuard(*bufferPool_, pageId);
 }
 
-bool PageManager::writePageToDisk(uint32_t pageId, const std::vector<uint8_t>& data) {
-    if (!dbFile_.is_open() || data.size() != PAGE_SIZE) {
+ReadPageGuard PageManager::fetchMappedPage(uint32_t pageId) const {
+    const uint8_t* image = mappedFile_->getPage(pageId);
+    if (!image) {
+        return ReadPageGuard();
+    }
+    
+    // 每页第一次访问时检查页头和校验和（并发的第一次访问可能重复检查，结果相同）
+    std::atomic<uint8_t>& state = mappedPageState_[pageId - 1];
+    uint8_t checked = state.load(std::memory_order_relaxed);
+    if (checked == MAPPED_PAGE_UNCHECKED) {
+        checked = Page::validateImage(image) ? MAPPED_PAGE_VALID : MAPPED_PAGE_CORRUPTED;
+        state.store(checked, std::memory_order_relaxed);
+    }
+    return checked == MAPPED_PAGE_VALID ? ReadPageGuard(image) : ReadPageGuard();
+}
+
+bool PageManager::writePage(const Page& page) {
+    if (isReadOnly()) {
+        reportReadOnly("write page " + std::to_string(page.getPageId()));
         return false;
     }
     
-    std::streampos pos = static_cast<std::streampos>(pageId - 1) * PAGE_SIZE;
-    dbFile_.seekp(pos);
-    dbFile_.write(reinterpret_cast<const char*>(data.data()), PAGE_SIZE);
-    dbFile_.flush();
+    if (!wal_) {
+        return putPage(page);
+    }
+    
+    // 日志中记录整页镜像，放入缓冲池的副本带有这条记录的LSN
+    Page loggedPage(page.getPageId());
+    loggedPage.copyFrom(page);
+    std::string image(PAGE_SIZE, '\0');
+    loggedPage.serializeTo(reinterpret_cast<uint8_t*>(&image[0]));
+    logPageChange(loggedPage, LogRecordType::PAGE_IMAGE, 0, std::string(), image);
+    return putPage(loggedPage);
+}
+
+bool PageManager::putPage(const Page& page) {
+    // 放入缓冲池并标记为脏页，延迟写盘
+    if (bufferPool_->putPage(page)) {
+        return true;
+    }
     
-    return dbFile_.good();
+    // 缓冲池已满且没有可淘汰的页面时直接写盘（日志先持久化到页面的LSN）
+    if (wal_ && page.getLsn() != 0 && !wal_->flush(page.getLsn())) {
+        return false;
+    }
+    AlignedPageBuffer image;
+    page.serializeTo(image.data());
+    return diskBackend_->writePage(page.getPageId(), image.data());
 }
 
-void PageManager::markPageUsed(uint32_t pageId) {
-    if (pageId < freePageBitmap_.size()) {
-        freePageBitmap_[pageId] = false;
+bool PageManager::flushPage(uint32_t pageId) {
+    if (isReadOnly()) {
+        return true; // 只读模式没有脏页
     }
+    return bufferPool_->flushPage(pageId);
 }
 
-void PageManager::markPageFree(uint32_t pageId) {
-    if (pageId < freePageBitmap_.size()) {
-        freePageBitmap_[pageId] = true;
+void PageManager::flushAllPages() {
+    if (isReadOnly()) {
+        return;
     }
+    bufferPool_->flushAllPages();
 }
 
-uint32_t PageManager::findFreePageId() {
-    for (size_t i = 1; i < freePageBitmap_.size(); ++i) {
-        if (freePageBitmap_[i]) {
-            return static_cast<uint32_t>(i);
+void PageManager::prefetchPages(const std::vector<uint32_t>& pageIds) {
+    if (!isReadOnly()) {
+        bufferPool_->prefetchPages(pageIds);
+        return;
+    }
+    
+    // 只读映射模式：把页ID连续的页面合并为一次提示，由操作系统读入页缓存
+    size_t runStart = 0;
+    for (size_t i = 1; i <= pageIds.size(); ++i) {
+        if (i == pageIds.size() || pageIds[i] != pageIds[i - 1] + 1) {
+            mappedFile_->adviseWillNeed(pageIds[runStart], i - runStart);
+            runStart = i;
         }
     }
-    return 0; // 没有找到空闲页面
+}
+
+void PageManager::setPrefetchDepth(size_t depth) {
+    if (isReadOnly()) {
+        mappedPrefetchDepth_ = depth;
+        return;
+    }
+    bufferPool_->setPrefetchDepth(depth);
+}
+
+size_t PageManager::getPrefetchDepth() const {
+    if (isReadOnly()) {
+        return mappedPrefetchDepth_.load();
+    }
+    return bufferPool_->getPrefetchDepth();
+}
+
+bool PageManager::pageExists(uint32_t pageId) const {
+    if (isReadOnly()) {
+        return mappedFile_->getPage(pageId) != nullptr;
+    }
+    std::lock_guard<std::mutex> lock(allocationMutex_);
+    return allocationMap_.isAllocated(pageId);
+}
+
+size_t PageManager::getTotalPages() const {
+    if (isReadOnly()) {
+        return mappedFile_->getPageCount();
+    }
+    std::lock_guard<std::mutex> lock(allocationMutex_);
+    return allocationMap_.getAllocatedCount();
+}
+
+size_t PageManager::getFreePages() const {
+    if (isReadOnly()) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(allocationMutex_);
+    return allocationMap_.getFreeCount();
+}
+
+bool PageManager::saveToDisk() {
+    if (isReadOnly()) {
+        return true; // 没有修改需要保存
+    }
+    // 先持久化日志：写回的脏页对应的日志记录都已在磁盘上
+    if (wal_ && !wal_->flushAll()) {
+        return false;
+    }
+    flushAllPages();
+    truncateFreeTail();
+    return getSynchronousMode() == SynchronousMode::OFF || diskBackend_->sync();
+}
+
+void PageManager::truncateFreeTail() {
+    // 持有分配锁，截断期间不会有新页面分配到被截掉的范围
+    std::lock_guard<std::mutex> lock(allocationMutex_);
+    uint32_t lastUsedPageId = allocationMap_.getHighestAllocated();
+    if (lastUsedPageId >= diskBackend_->getPageCount()) {
+        return;
+    }
+    // 末尾的页面在释放时已从缓冲池中丢弃，截断之后不会再被写回
+    if (diskBackend_->truncate(lastUsedPageId)) {
+        allocationMap_.shrinkTo(lastUsedPageId);
+    }
+}
+
+BufferPoolStats PageManager::getBufferPoolStats() const {
+    if (isReadOnly()) {
+        return BufferPoolStats(); // 只读映射模式不使用缓冲池
+    }
+    return bufferPool_->getStats();
+}
+
+void PageManager::printBufferPoolStats() const {
+    if (isReadOnly()) {
+        std::cout << "Buffer pool: not used (read-only memory-mapped database)" << std::endl;
+        return;
+    }
+    bufferPool_->printStats();
+}
+
+void PageManager::resetBufferPoolStats() {
+    if (isReadOnly()) {
+        return;
+    }
+    bufferPool_->resetStats();
+}
+
+const std::string& PageManager::getFileName() const {
+    if (isReadOnly()) {
+        return mappedFile_->getPath();
+    }
+    return diskBackend_->getPath();
+}
+
+void PageManager::printStatistics() const {
+    std::cout << "PageManager Statistics:" << std::endl;
+    std::cout << "  Database file: " << getFileName() << (isReadOnly() ? " (read-only, memory-mapped)" : "") << std::endl;
+    std::cout << "  Total pages: " << getTotalPages() << std::endl;
+    std::cout << "  Free pages: " << getFreePages() << std::endl;
+    if (isReadOnly()) {
+        std::cout << "  File pages: " << mappedFile_->getPageCount() << std::endl;
+    } else {
+        std::lock_guard<std::mutex> lock(allocationMutex_);
+        std::cout << "  File pages: " << allocationMap_.getPageLimit() << std::endl;
+    }
+    
+    std::cout << std::endl;
+    printBufferPoolStats();
 }
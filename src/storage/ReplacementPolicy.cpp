@@ -0,0 +1,343 @@
+#include "../../include/storage/ReplacementPolicy.h"
+#include <algorithm>
+
+std::unique_ptr<ReplacementPolicy> createReplacementPolicy(ReplacementPolicyType type, size_t capacity) {
+    switch (type) {
+        case ReplacementPolicyType::CLOCK:
+            return std::make_unique<ClockReplacementPolicy>();
+        case ReplacementPolicyType::LRU_K:
+            return std::make_unique<LRUKReplacementPolicy>(capacity);
+        case ReplacementPolicyType::TWO_Q:
+            return std::make_unique<TwoQueueReplacementPolicy>(capacity);
+        case ReplacementPolicyType::LRU:
+        default:
+            return std::make_unique<LRUReplacementPolicy>();
+    }
+}
+
+const char* replacementPolicyName(ReplacementPolicyType type) {
+    switch (type) {
+        case ReplacementPolicyType::CLOCK: return "CLOCK";
+        case ReplacementPolicyType::LRU_K: return "LRU-K";
+        case ReplacementPolicyType::TWO_Q: return "2Q";
+        case ReplacementPolicyType::LRU:
+        default: return "LRU";
+    }
+}
+
+// ==================== LRU ====================
+
+void LRUReplacementPolicy::recordInsert(uint32_t pageId) {
+    recordRemove(pageId);
+    lruList_.push_front(pageId);
+    lruIterators_[pageId] = lruList_.begin();
+}
+
+void LRUReplacementPolicy::recordAccess(uint32_t pageId) {
+    auto it = lruIterators_.find(pageId);
+    if (it != lruIterators_.end()) {
+        // 移动到LRU链表前端
+        lruList_.splice(lruList_.begin(), lruList_, it->second);
+    }
+}
+
+void LRUReplacementPolicy::recordRemove(uint32_t pageId) {
+    auto it = lruIterators_.find(pageId);
+    if (it != lruIterators_.end()) {
+        lruList_.erase(it->second);
+        lruIterators_.erase(it);
+    }
+}
+
+uint32_t LRUReplacementPolicy::pickVictim(const std::function<bool(uint32_t)>& isEvictable) {
+    // 从LRU链表后端开始查找可淘汰的页面
+    for (auto it = lruList_.rbegin(); it != lruList_.rend(); ++it) {
+        if (isEvictable(*it)) {
+            return *it;
+        }
+    }
+    return 0;
+}
+
+std::vector<uint32_t> LRUReplacementPolicy::getColdOrder() const {
+    return std::vector<uint32_t>(lruList_.rbegin(), lruList_.rend());
+}
+
+void LRUReplacementPolicy::clear() {
+    lruList_.clear();
+    lruIterators_.clear();
+}
+
+// ==================== CLOCK ====================
+
+void ClockReplacementPolicy::recordInsert(uint32_t pageId) {
+    if (slotIndex_.count(pageId)) {
+        recordAccess(pageId);
+        return;
+    }
+    
+    size_t index;
+    if (!freeSlots_.empty()) {
+        index = freeSlots_.back();
+        freeSlots_.pop_back();
+    } else {
+        index = slots_.size();
+        slots_.push_back(Slot());
+    }
+    slots_[index] = {pageId, true};
+    slotIndex_[pageId] = index;
+}
+
+void ClockReplacementPolicy::recordAccess(uint32_t pageId) {
+    auto it = slotIndex_.find(pageId);
+    if (it != slotIndex_.end()) {
+        slots_[it->second].referenced = true;
+    }
+}
+
+void ClockReplacementPolicy::recordRemove(uint32_t pageId) {
+    auto it = slotIndex_.find(pageId);
+    if (it != slotIndex_.end()) {
+        slots_[it->second] = {0, false};
+        freeSlots_.push_back(it->second);
+        slotIndex_.erase(it);
+    }
+}
+
+uint32_t ClockReplacementPolicy::pickVictim(const std::function<bool(uint32_t)>& isEvictable) {
+    if (slots_.empty()) {
+        return 0;
+    }
+    
+    // 指针转动：引用位为1的页面清零后跳过（第二次机会），最多转两圈
+    for (size_t step = 0; step < slots_.size() * 2; ++step) {
+        Slot& slot = slots_[hand_];
+        hand_ = (hand_ + 1) % slots_.size();
+        
+        if (slot.pageId == 0 || !isEvictable(slot.pageId)) {
+            continue;
+        }
+        if (slot.referenced) {
+            slot.referenced = false;
+            continue;
+        }
+        return slot.pageId;
+    }
+    return 0;
+}
+
+std::vector<uint32_t> ClockReplacementPolicy::getColdOrder() const {
+    // 从指针位置开始，引用位为0的页面在前
+    std::vector<uint32_t> cold;
+    std::vector<uint32_t> referenced;
+    for (size_t step = 0; step < slots_.size(); ++step) {
+        const Slot& slot = slots_[(hand_ + step) % slots_.size()];
+        if (slot.pageId != 0) {
+            (slot.referenced ? referenced : cold).push_back(slot.pageId);
+        }
+    }
+    cold.insert(cold.end(), referenced.begin(), referenced.end());
+    return cold;
+}
+
+void ClockReplacementPolicy::clear() {
+    slots_.clear();
+    freeSlots_.clear();
+    slotIndex_.clear();
+    hand_ = 0;
+}
+
+// ==================== LRU-K ====================
+
+LRUKReplacementPolicy::LRUKReplacementPolicy(size_t capacity, size_t k, uint64_t correlatedPeriod)
+    : historyCapacity_(capacity), k_(std::max<size_t>(k, 1)), correlatedPeriod_(correlatedPeriod) {}
+
+LRUKReplacementPolicy::OrderKey LRUKReplacementPolicy::keyOf(const History& history) const {
+    uint64_t kthAccess = history.accesses.size() >= k_ ? history.accesses[k_ - 1] : 0;
+    return OrderKey(kthAccess, history.lastAccess);
+}
+
+void LRUKReplacementPolicy::touch(uint32_t pageId, History& history) {
+    ++clock_;
+    // 相关访问（短时间内的重复访问）只更新最近访问时间，不计入访问历史，
+    // 否则扫描时逐行读取同一页面会让扫描页面看起来和热点页面一样
+    bool correlated = !history.accesses.empty() && clock_ - history.lastAccess <= correlatedPeriod_;
+    if (!correlated) {
+        history.accesses.insert(history.accesses.begin(), clock_);
+        if (history.accesses.size() > k_) {
+            history.accesses.resize(k_);
+        }
+    }
+    history.lastAccess = clock_;
+}
+
+void LRUKReplacementPolicy::recordInsert(uint32_t pageId) {
+    History& history = history_[pageId];
+    if (history.resident) {
+        recordAccess(pageId);
+        return;
+    }
+    
+    // 之前被淘汰过的页面沿用保留的访问历史，再次访问后即可达到K次
+    if (!history.accesses.empty()) {
+        retired_.erase(history.retiredPos);
+    }
+    history.resident = true;
+    touch(pageId, history);
+    order_.insert({keyOf(history), pageId});
+}
+
+void LRUKReplacementPolicy::recordAccess(uint32_t pageId) {
+    auto it = history_.find(pageId);
+    if (it == history_.end() || !it->second.resident) {
+        return;
+    }
+    
+    History& history = it->second;
+    order_.erase({keyOf(history), pageId});
+    touch(pageId, history);
+    order_.insert({keyOf(history), pageId});
+}
+
+void LRUKReplacementPolicy::recordRemove(uint32_t pageId) {
+    auto it = history_.find(pageId);
+    if (it == history_.end() || !it->second.resident) {
+        return;
+    }
+    
+    History& history = it->second;
+    order_.erase({keyOf(history), pageId});
+    history.resident = false;
+    
+    // 保留访问历史，超过上限时丢弃最早淘汰的页面的历史
+    retired_.push_front(pageId);
+    history.retiredPos = retired_.begin();
+    while (retired_.size() > historyCapacity_) {
+        history_.erase(retired_.back());
+        retired_.pop_back();
+    }
+}
+
+uint32_t LRUKReplacementPolicy::pickVictim(const std::function<bool(uint32_t)>& isEvictable) {
+    for (const auto& entry : order_) {
+        if (isEvictable(entry.second)) {
+            return entry.second;
+        }
+    }
+    return 0;
+}
+
+std::vector<uint32_t> LRUKReplacementPolicy::getColdOrder() const {
+    std::vector<uint32_t> cold;
+    cold.reserve(order_.size());
+    for (const auto& entry : order_) {
+        cold.push_back(entry.second);
+    }
+    return cold;
+}
+
+void LRUKReplacementPolicy::clear() {
+    history_.clear();
+    retired_.clear();
+    order_.clear();
+    clock_ = 0;
+}
+
+// ==================== 2Q ====================
+
+TwoQueueReplacementPolicy::TwoQueueReplacementPolicy(size_t capacity)
+    : kin_(std::max<size_t>(capacity / 4, 1)), kout_(std::max<size_t>(capacity / 2, 1)) {}
+
+void TwoQueueReplacementPolicy::recordInsert(uint32_t pageId) {
+    auto it = entries_.find(pageId);
+    if (it != entries_.end()) {
+        if (it->second.queue != Queue::A1OUT) {
+            recordAccess(pageId);
+            return;
+        }
+        // 在A1out中：页面在首次访问的FIFO阶段之后又被访问，说明是热点页面
+        a1out_.erase(it->second.position);
+        am_.push_front(pageId);
+        it->second = {Queue::AM, am_.begin()};
+        return;
+    }
+    
+    a1in_.push_front(pageId);
+    entries_[pageId] = {Queue::A1IN, a1in_.begin()};
+}
+
+void TwoQueueReplacementPolicy::recordAccess(uint32_t pageId) {
+    auto it = entries_.find(pageId);
+    if (it == entries_.end()) {
+        return;
+    }
+    
+    // A1in中的重复访问不提升（通常是同一次扫描内的相关访问）
+    if (it->second.queue == Queue::AM) {
+        am_.splice(am_.begin(), am_, it->second.position);
+    }
+}
+
+void TwoQueueReplacementPolicy::recordRemove(uint32_t pageId) {
+    auto it = entries_.find(pageId);
+    if (it == entries_.end()) {
+        return;
+    }
+    
+    switch (it->second.queue) {
+        case Queue::A1IN:
+            // 从A1in淘汰的页面只保留页面ID，用来识别之后的再次访问
+            a1in_.erase(it->second.position);
+            a1out_.push_front(pageId);
+            it->second = {Queue::A1OUT, a1out_.begin()};
+            while (a1out_.size() > kout_) {
+                entries_.erase(a1out_.back());
+                a1out_.pop_back();
+            }
+            break;
+        case Queue::AM:
+            am_.erase(it->second.position);
+            entries_.erase(it);
+            break;
+        case Queue::A1OUT:
+            break;
+    }
+}
+
+uint32_t TwoQueueReplacementPolicy::pickFrom(const std::list<uint32_t>& queue,
+                                             const std::function<bool(uint32_t)>& isEvictable) const {
+    for (auto it = queue.rbegin(); it != queue.rend(); ++it) {
+        if (isEvictable(*it)) {
+            return *it;
+        }
+    }
+    return 0;
+}
+
+uint32_t TwoQueueReplacementPolicy::pickVictim(const std::function<bool(uint32_t)>& isEvictable) {
+    // A1in超过配额时优先淘汰其中最早进入的页面，否则淘汰Am中最久未使用的页面
+    uint32_t victim = 0;
+    if (a1in_.size() > kin_) {
+        victim = pickFrom(a1in_, isEvictable);
+    }
+    if (victim == 0) {
+        victim = pickFrom(am_, isEvictable);
+    }
+    if (victim == 0) {
+        victim = pickFrom(a1in_, isEvictable);
+    }
+    return victim;
+}
+
+std::vector<uint32_t> TwoQueueReplacementPolicy::getColdOrder() const {
+    std::vector<uint32_t> cold(a1in_.rbegin(), a1in_.rend());
+    cold.insert(cold.end(), am_.rbegin(), am_.rend());
+    return cold;
+}
+
+void TwoQueueReplacementPolicy::clear() {
+    a1in_.clear();
+    am_.clear();
+    a1out_.clear();
+    entries_.clear();
+}
@@ -1,6 +1,8 @@
 #include "../../include/storage/Row.h"
+#include "../../include/storage/ByteOrder.h"
 #include <sstream>
 #include <stdexcept>
+#include <cstring>
 
 Row::Row(const std::vector<Value>& values) : values_(values) {}
 
@@ -26,7 +28,134 @@ size_t Row::getFieldCount() const {
     return values_.size();
 }
 
+size_t Row::getSerializedSize() const {
+    size_t size = ROW_HEADER_SIZE;
+    for (const auto& value : values_) {
+        size += sizeof(uint8_t);
+        std::visit([&size](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, int>) {
+                size += sizeof(int32_t);
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                size += sizeof(uint16_t) + v.length();
+            } else if constexpr (std::is_same_v<T, double>) {
+                size += sizeof(double);
+            }
+        }, value);
+    }
+    return size;
+}
+
 std::string Row::serialize() const {
+    if (values_.size() > UINT16_MAX) {
+        throw std::length_error("Row has too many fields to serialize");
+    }
+    
+    std::string result(getSerializedSize(), '\0');
+    uint8_t* out = reinterpret_cast<uint8_t*>(&result[0]);
+    
+    // 写入格式版本和字段数量
+    *out++ = ROW_FORMAT_VERSION;
+    byteorder::storeLE<uint16_t>(out, static_cast<uint16_t>(values_.size()));
+    out += sizeof(uint16_t);
+    
+    for (const auto& value : values_) {
+        std::visit([&out](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, int>) {
+                *out++ = static_cast<uint8_t>(DataType::INT);
+                byteorder::storeLE<int32_t>(out, static_cast<int32_t>(v));
+                out += sizeof(int32_t);
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                if (v.length() > UINT16_MAX) {
+                    throw std::length_error("String value too long to serialize");
+                }
+                *out++ = static_cast<uint8_t>(DataType::STRING);
+                byteorder::storeLE<uint16_t>(out, static_cast<uint16_t>(v.length()));
+                out += sizeof(uint16_t);
+                std::memcpy(out, v.data(), v.length());
+                out += v.length();
+            } else if constexpr (std::is_same_v<T, double>) {
+                *out++ = static_cast<uint8_t>(DataType::DOUBLE);
+                byteorder::storeLE<double>(out, v);
+                out += sizeof(double);
+            }
+        }, value);
+    }
+    
+    return result;
+}
+
+Row Row::deserialize(const std::string& data) {
+    return deserialize(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+}
+
+Row Row::deserialize(const uint8_t* data, size_t size) {
+    if (isLegacyTextFormat(data, size)) {
+        // 迁移路径：旧版本写入的文本记录仍然可以读取，下次写回时会转换为二进制格式
+        return deserializeLegacyText(std::string(reinterpret_cast<const char*>(data), size));
+    }
+    
+    if (size < ROW_HEADER_SIZE || data[0] != ROW_FORMAT_VERSION) {
+        throw std::runtime_error("Unsupported row format");
+    }
+    
+    const uint8_t* in = data + 1;
+    const uint8_t* end = data + size;
+    uint16_t fieldCount = byteorder::loadLE<uint16_t>(in);
+    in += sizeof(uint16_t);
+    
+    Row row;
+    row.values_.reserve(fieldCount);
+    for (uint16_t i = 0; i < fieldCount; ++i) {
+        if (in >= end) {
+            throw std::runtime_error("Corrupted row record: truncated field");
+        }
+        
+        switch (static_cast<DataType>(*in++)) {
+            case DataType::INT: {
+                if (end - in < static_cast<ptrdiff_t>(sizeof(int32_t))) {
+                    throw std::runtime_error("Corrupted row record: truncated INT");
+                }
+                row.values_.emplace_back(static_cast<int>(byteorder::loadLE<int32_t>(in)));
+                in += sizeof(int32_t);
+                break;
+            }
+            case DataType::STRING: {
+                if (end - in < static_cast<ptrdiff_t>(sizeof(uint16_t))) {
+                    throw std::runtime_error("Corrupted row record: truncated STRING length");
+                }
+                uint16_t length = byteorder::loadLE<uint16_t>(in);
+                in += sizeof(uint16_t);
+                if (end - in < static_cast<ptrdiff_t>(length)) {
+                    throw std::runtime_error("Corrupted row record: truncated STRING");
+                }
+                row.values_.emplace_back(std::string(reinterpret_cast<const char*>(in), length));
+                in += length;
+                break;
+            }
+            case DataType::DOUBLE: {
+                if (end - in < static_cast<ptrdiff_t>(sizeof(double))) {
+                    throw std::runtime_error("Corrupted row record: truncated DOUBLE");
+                }
+                row.values_.emplace_back(byteorder::loadLE<double>(in));
+                in += sizeof(double);
+                break;
+            }
+            default:
+                throw std::runtime_error("Corrupted row record: unknown type tag");
+        }
+    }
+    
+    return row;
+}
+
+bool Row::isLegacyTextFormat(const uint8_t* data, size_t size) {
+    // 旧格式以十进制字段数量开头，例如 "3|..."
+    return size > 0 && data[0] >= '0' && data[0] <= '9';
+}
+
+std::string Row::serializeLegacyText() const {
     std::ostringstream oss;
     oss << values_.size() << "|";
     
@@ -46,7 +175,7 @@ std::string Row::serialize() const {
     return oss.str();
 }
 
-Row Row::deserialize(const std::string& data) {
+Row Row::deserializeLegacyText(const std::string& data) {
     std::istringstream iss(data);
     std::string token;
     
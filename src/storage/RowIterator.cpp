@@ -1,60 +1,185 @@
 #include "../../include/storage/RowIterator.h"
+#include "../../include/storage/Table.h"
+#include "../../include/storage/PageManager.h"
+#include <algorithm>
 #include <stdexcept>
 
-RowIterator::RowIterator(const std::vector<Row>* rows, size_t position) 
-    : rows_(rows), position_(position) {}
+TableHeapIterator::TableHeapIterator() 
+    : table_(nullptr), pageIndex_(0), slotId_(0), position_(0), prefetchedUntil_(0), rowMaterialized_(false) {}
 
-Row& RowIterator::operator*() {
-    if (!rows_ || position_ >= rows_->size()) {
-        throw std::out_of_range("Iterator out of range");
-    }
-    return const_cast<Row&>((*rows_)[position_]);
+TableHeapIterator::TableHeapIterator(const Table* table, size_t pageIndex) 
+    : table_(table), pageIndex_(pageIndex), slotId_(0), position_(0), prefetchedUntil_(0), rowMaterialized_(false) {
+    seekValidRecord();
 }
 
-const Row& RowIterator::operator*() const {
-    if (!rows_ || position_ >= rows_->size()) {
-        throw std::out_of_range("Iterator out of range");
+TableHeapIterator::TableHeapIterator(const TableHeapIterator& other)
+    : table_(other.table_), pageIndex_(other.pageIndex_), slotId_(other.slotId_),
+      position_(other.position_), prefetchedUntil_(other.prefetchedUntil_), view_(other.view_),
+      row_(other.row_), rowMaterialized_(other.rowMaterialized_) {
+    // 副本用自己的守卫再固定一次当前页面（原迭代器持有固定，一定命中同一帧，视图依然有效）
+    if (other.page_) {
+        page_ = table_->getPageManager()->fetchPageRead(other.page_.getPageId());
     }
-    return (*rows_)[position_];
 }
 
-Row* RowIterator::operator->() {
-    if (!rows_ || position_ >= rows_->size()) {
-        throw std::out_of_range("Iterator out of range");
+TableHeapIterator& TableHeapIterator::operator=(const TableHeapIterator& other) {
+    if (this == &other) {
+        return *this;
+    }
+    
+    releasePage();
+    table_ = other.table_;
+    pageIndex_ = other.pageIndex_;
+    slotId_ = other.slotId_;
+    position_ = other.position_;
+    prefetchedUntil_ = other.prefetchedUntil_;
+    if (other.page_) {
+        page_ = table_->getPageManager()->fetchPageRead(other.page_.getPageId());
     }
-    return const_cast<Row*>(&(*rows_)[position_]);
+    view_ = other.view_;
+    row_ = other.row_;
+    rowMaterialized_ = other.rowMaterialized_;
+    return *this;
+}
+
+TableHeapIterator::~TableHeapIterator() {
+    releasePage();
 }
 
-const Row* RowIterator::operator->() const {
-    if (!rows_ || position_ >= rows_->size()) {
+const Row& TableHeapIterator::operator*() const {
+    if (isEnd()) {
         throw std::out_of_range("Iterator out of range");
     }
-    return &(*rows_)[position_];
+    if (!rowMaterialized_) {
+        row_ = view_.toRow();
+        rowMaterialized_ = true;
+    }
+    return row_;
+}
+
+const Row* TableHeapIterator::operator->() const {
+    return &(**this);
 }
 
-RowIterator& RowIterator::operator++() {
+TableHeapIterator& TableHeapIterator::operator++() {
+    if (isEnd()) {
+        return *this;
+    }
+    ++slotId_;
     ++position_;
+    seekValidRecord();
     return *this;
 }
 
-RowIterator RowIterator::operator++(int) {
-    RowIterator temp = *this;
-    ++position_;
+TableHeapIterator TableHeapIterator::operator++(int) {
+    TableHeapIterator temp = *this;
+    ++(*this);
     return temp;
 }
 
-bool RowIterator::operator==(const RowIterator& other) const {
-    return rows_ == other.rows_ && position_ == other.position_;
+const RowView& TableHeapIterator::view() const {
+    if (isEnd()) {
+        throw std::out_of_range("Iterator out of range");
+    }
+    return view_;
+}
+
+RecordRef TableHeapIterator::getRecordRef() const {
+    if (isEnd()) {
+        throw std::out_of_range("Iterator out of range");
+    }
+    return page_->getRecordRef(slotId_);
 }
 
-bool RowIterator::operator!=(const RowIterator& other) const {
+bool TableHeapIterator::operator==(const TableHeapIterator& other) const {
+    // 所有结束迭代器相等（表在迭代期间可能追加新页面）
+    if (isEnd() || other.isEnd()) {
+        return isEnd() && other.isEnd();
+    }
+    return table_ == other.table_ && pageIndex_ == other.pageIndex_ && slotId_ == other.slotId_;
+}
+
+bool TableHeapIterator::operator!=(const TableHeapIterator& other) const {
     return !(*this == other);
 }
 
-bool RowIterator::hasNext() const {
-    return rows_ && position_ < rows_->size();
+bool TableHeapIterator::hasNext() const {
+    return !isEnd();
 }
 
-size_t RowIterator::getPosition() const {
+size_t TableHeapIterator::getPosition() const {
     return position_;
 }
+
+uint32_t TableHeapIterator::getPageId() const {
+    return page_.getPageId();
+}
+
+uint16_t TableHeapIterator::getSlotId() const {
+    return slotId_;
+}
+
+RID TableHeapIterator::getRID() const {
+    return page_ ? makeRID(page_.getPageId(), slotId_) : INVALID_RID;
+}
+
+bool TableHeapIterator::isEnd() const {
+    return !table_ || pageIndex_ >= table_->getDataPageIds().size();
+}
+
+void TableHeapIterator::loadPage() {
+    PageManager* pageManager = table_->getPageManager();
+    if (!pageManager) {
+        page_ = ReadPageGuard();
+        return;
+    }
+    
+    // 预读窗口剩余不到一半时补充请求，先发出预读再读取当前页，两者的I/O可以重叠
+    const std::vector<uint32_t>& pageIds = table_->getDataPageIds();
+    size_t depth = pageManager->getPrefetchDepth();
+    if (depth > 0 && pageIndex_ > 0 && prefetchedUntil_ <= pageIndex_ + depth / 2) {
+        size_t first = std::max(prefetchedUntil_, pageIndex_ + 1);
+        size_t last = std::min(pageIds.size(), pageIndex_ + 1 + depth);
+        if (first < last) {
+            pageManager->prefetchPages(std::vector<uint32_t>(pageIds.begin() + first, pageIds.begin() + last));
+            prefetchedUntil_ = last;
+        }
+    }
+    
+    page_ = pageManager->fetchPageRead(pageIds[pageIndex_]);
+}
+
+void TableHeapIterator::releasePage() {
+    page_.release();
+}
+
+void TableHeapIterator::seekValidRecord() {
+    view_ = RowView();
+    rowMaterialized_ = false;
+    
+    while (!isEnd()) {
+        if (!page_) {
+            loadPage();
+            if (!page_) {
+                // 页面无法读取，跳过
+                ++pageIndex_;
+                slotId_ = 0;
+                continue;
+            }
+        }
+        
+        while (slotId_ < page_->getSlotCount()) {
+            RecordRef record = page_->getRecordRef(slotId_);
+            if (record.isValid() && record.size > 0) {
+                view_ = RowView(record.data, record.size);
+                return;
+            }
+            ++slotId_;
+        }
+        
+        // 当前页已遍历完，释放后移动到下一页
+        releasePage();
+        ++pageIndex_;
+        slotId_ = 0;
+    }
+}
@@ -0,0 +1,170 @@
+#include "../../include/storage/RowView.h"
+#include "../../include/storage/ByteOrder.h"
+#include <stdexcept>
+
+RowView::RowView(const uint8_t* data, size_t size) {
+    if (Row::isLegacyTextFormat(data, size)) {
+        // 迁移路径：旧文本记录无法原地解析，先解码为Row
+        legacyRow_ = std::make_shared<const Row>(Row::deserialize(data, size));
+        row_ = legacyRow_.get();
+        return;
+    }
+    
+    if (size < ROW_HEADER_SIZE || data[0] != ROW_FORMAT_VERSION) {
+        throw std::runtime_error("Unsupported row format");
+    }
+    
+    data_ = data;
+    size_ = size;
+    fieldCount_ = byteorder::loadLE<uint16_t>(data + 1);
+}
+
+RowView::RowView(const Row* row) : row_(row) {}
+
+bool RowView::isValid() const {
+    return data_ != nullptr || row_ != nullptr;
+}
+
+size_t RowView::getFieldCount() const {
+    if (row_) {
+        return row_->getFieldCount();
+    }
+    return fieldCount_;
+}
+
+DataType RowView::getType(size_t index) const {
+    if (row_) {
+        const Value& value = row_->getValue(index);
+        if (std::holds_alternative<int>(value)) return DataType::INT;
+        if (std::holds_alternative<double>(value)) return DataType::DOUBLE;
+        return DataType::STRING;
+    }
+    return static_cast<DataType>(data_[locateField(index)]);
+}
+
+int RowView::getInt(size_t index) const {
+    if (row_) {
+        return std::get<int>(row_->getValue(index));
+    }
+    size_t offset = locateField(index);
+    if (static_cast<DataType>(data_[offset]) != DataType::INT) {
+        throw std::runtime_error("Field is not an INT");
+    }
+    return static_cast<int>(byteorder::loadLE<int32_t>(data_ + offset + 1));
+}
+
+double RowView::getDouble(size_t index) const {
+    if (row_) {
+        return std::get<double>(row_->getValue(index));
+    }
+    size_t offset = locateField(index);
+    if (static_cast<DataType>(data_[offset]) != DataType::DOUBLE) {
+        throw std::runtime_error("Field is not a DOUBLE");
+    }
+    return byteorder::loadLE<double>(data_ + offset + 1);
+}
+
+std::string_view RowView::getString(size_t index) const {
+    if (row_) {
+        return std::get<std::string>(row_->getValue(index));
+    }
+    size_t offset = locateField(index);
+    if (static_cast<DataType>(data_[offset]) != DataType::STRING) {
+        throw std::runtime_error("Field is not a STRING");
+    }
+    uint16_t length = byteorder::loadLE<uint16_t>(data_ + offset + 1);
+    return std::string_view(reinterpret_cast<const char*>(data_ + offset + 1 + sizeof(uint16_t)), length);
+}
+
+Value RowView::getValue(size_t index) const {
+    if (row_) {
+        return row_->getValue(index);
+    }
+    switch (getType(index)) {
+        case DataType::INT:
+            return getInt(index);
+        case DataType::DOUBLE:
+            return getDouble(index);
+        case DataType::STRING:
+            return std::string(getString(index));
+    }
+    throw std::runtime_error("Corrupted row record: unknown field type");
+}
+
+Row RowView::toRow() const {
+    if (row_) {
+        return *row_;
+    }
+    return Row::deserialize(data_, size_);
+}
+
+Row RowView::toRow(const std::vector<bool>& requiredColumns) const {
+    size_t fieldCount = getFieldCount();
+    std::vector<Value> values;
+    values.reserve(fieldCount);
+    
+    for (size_t i = 0; i < fieldCount; ++i) {
+        if (i < requiredColumns.size() && !requiredColumns[i]) {
+            // 被裁剪的列不解码，只保留一个同类型的占位值
+            switch (getType(i)) {
+                case DataType::INT: values.emplace_back(0); break;
+                case DataType::DOUBLE: values.emplace_back(0.0); break;
+                case DataType::STRING: values.emplace_back(std::string()); break;
+            }
+            continue;
+        }
+        values.push_back(getValue(i));
+    }
+    
+    return Row(values);
+}
+
+size_t RowView::locateField(size_t index) const {
+    if (index >= fieldCount_) {
+        throw std::out_of_range("Row field index out of range");
+    }
+    
+    // 向后访问时从游标继续，否则从记录头部重新开始
+    if (index < cursorIndex_) {
+        cursorIndex_ = 0;
+        cursorOffset_ = ROW_HEADER_SIZE;
+    }
+    
+    while (cursorIndex_ < index) {
+        cursorOffset_ += fieldLength(cursorOffset_);
+        ++cursorIndex_;
+    }
+    
+    // 校验当前字段没有越界
+    fieldLength(cursorOffset_);
+    return cursorOffset_;
+}
+
+size_t RowView::fieldLength(size_t offset) const {
+    if (offset >= size_) {
+        throw std::runtime_error("Corrupted row record: truncated field");
+    }
+    
+    size_t length = 0;
+    switch (static_cast<DataType>(data_[offset])) {
+        case DataType::INT:
+            length = 1 + sizeof(int32_t);
+            break;
+        case DataType::DOUBLE:
+            length = 1 + sizeof(double);
+            break;
+        case DataType::STRING:
+            if (offset + 1 + sizeof(uint16_t) > size_) {
+                throw std::runtime_error("Corrupted row record: truncated STRING length");
+            }
+            length = 1 + sizeof(uint16_t) + byteorder::loadLE<uint16_t>(data_ + offset + 1);
+            break;
+        default:
+            throw std::runtime_error("Corrupted row record: unknown field type");
+    }
+    
+    if (offset + length > size_) {
+        throw std::runtime_error("Corrupted row record: field exceeds record bounds");
+    }
+    return length;
+}
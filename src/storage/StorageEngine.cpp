@@ -1,34 +1,344 @@
 #include "../../include/storage/StorageEngine.h"
+#include "../../include/storage/ByteOrder.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <queue>
+#include <stdexcept>
+#include <unordered_set>
 
-StorageEngine::StorageEngine(const std::string& dbPath) : dbPath_(dbPath), nextRecordId_(1) {
-    // 确保数据库目录存在
-    std::filesystem::create_directories(dbPath);
+namespace {
+
+// 页文件格式：第1页是元数据页，记录格式标记、版本号、系统目录链表的头页ID和页分配位图链表的头页ID
+// 系统目录（表结构、每个表的FSM链表头、索引定义）编码为一段二进制数据，
+// 按块存放在CATALOG_PAGE链表中，每页一条记录：[u32 下一个目录页ID][目录数据块]
+// 版本1没有页分配位图，打开时文件中的页面全部视为已分配，下次保存时升级为版本2
+constexpr uint32_t META_PAGE_ID = 1;
+constexpr char DATABASE_FILE_MAGIC[8] = {'M', 'I', 'N', 'I', 'D', 'B', 'P', 'F'};
+constexpr uint32_t DATABASE_FORMAT_VERSION = 2;
+constexpr uint32_t DATABASE_FORMAT_VERSION_NO_ALLOCATION_MAP = 1;
+constexpr size_t META_RECORD_SIZE_V1 = sizeof(DATABASE_FILE_MAGIC) + 2 * sizeof(uint32_t);
+constexpr size_t META_RECORD_SIZE = META_RECORD_SIZE_V1 + sizeof(uint32_t);
+constexpr size_t CATALOG_CHUNK_SIZE = 4000;
+
+// 系统目录编码（小端）
+class CatalogWriter {
+public:
+    template <typename T>
+    void put(T value) {
+        uint8_t bytes[sizeof(T)];
+        byteorder::storeLE<T>(bytes, value);
+        data_.append(reinterpret_cast<const char*>(bytes), sizeof(T));
+    }
+    
+    void putString(const std::string& value) {
+        put<uint16_t>(static_cast<uint16_t>(value.size()));
+        data_.append(value);
+    }
+    
+    const std::string& data() const { return data_; }
+
+private:
+    std::string data_;
+};
+
+// 系统目录解码，越界时ok()返回false
+class CatalogReader {
+public:
+    explicit CatalogReader(const std::string& data)
+        : pos_(reinterpret_cast<const uint8_t*>(data.data())), end_(pos_ + data.size()), ok_(true) {}
+    
+    template <typename T>
+    T get() {
+        if (!ok_ || static_cast<size_t>(end_ - pos_) < sizeof(T)) {
+            ok_ = false;
+            return T{};
+        }
+        T value = byteorder::loadLE<T>(pos_);
+        pos_ += sizeof(T);
+        return value;
+    }
+    
+    std::string getString() {
+        uint16_t size = get<uint16_t>();
+        if (!ok_ || static_cast<size_t>(end_ - pos_) < size) {
+            ok_ = false;
+            return "";
+        }
+        std::string value(reinterpret_cast<const char*>(pos_), size);
+        pos_ += size;
+        return value;
+    }
+    
+    bool ok() const { return ok_; }
+
+private:
+    const uint8_t* pos_;
+    const uint8_t* end_;
+    bool ok_;
+};
+
+// 表结构和索引定义的编码（系统目录和日志中的CREATE_TABLE/CREATE_INDEX记录共用）
+void writeTableSchema(CatalogWriter& writer, const std::string& tableName, const std::vector<ColumnInfo>& columns) {
+    writer.putString(tableName);
+    writer.put<uint16_t>(static_cast<uint16_t>(columns.size()));
+    for (const auto& col : columns) {
+        writer.putString(col.name);
+        writer.put<uint8_t>(static_cast<uint8_t>(col.type));
+        writer.put<uint8_t>(static_cast<uint8_t>((col.isNotNull ? 1 : 0) | (col.isPrimaryKey ? 2 : 0)));
+    }
+}
+
+void writeIndexDefinition(CatalogWriter& writer, const IndexInfo& indexInfo) {
+    writer.putString(indexInfo.indexName);
+    writer.putString(indexInfo.tableName);
+    writer.putString(indexInfo.columnName);
+    writer.put<uint8_t>(static_cast<uint8_t>(indexInfo.indexType));
+    writer.put<uint8_t>(indexInfo.isUnique ? 1 : 0);
+}
+
+std::vector<ColumnInfo> readTableSchema(CatalogReader& reader, std::string& tableName) {
+    tableName = reader.getString();
+    uint16_t columnCount = reader.get<uint16_t>();
     
-    // 初始化页面管理器
+    std::vector<ColumnInfo> columns;
+    for (uint16_t j = 0; j < columnCount && reader.ok(); ++j) {
+        std::string colName = reader.getString();
+        DataType type = static_cast<DataType>(reader.get<uint8_t>());
+        uint8_t flags = reader.get<uint8_t>();
+        columns.emplace_back(colName, type, (flags & 1) != 0, (flags & 2) != 0);
+    }
+    return columns;
+}
+
+IndexInfo readIndexDefinition(CatalogReader& reader) {
+    std::string indexName = reader.getString();
+    std::string tableName = reader.getString();
+    std::string columnName = reader.getString();
+    IndexType indexType = static_cast<IndexType>(reader.get<uint8_t>());
+    bool isUnique = reader.get<uint8_t>() != 0;
+    return IndexInfo(indexName, tableName, columnName, indexType, isUnique);
+}
+
+// 恢复时收集的日志事件：系统目录和页面分配记录（带负载），以及数据页上的行插入/删除
+// （补偿记录按补偿操作的类型记录），加载系统目录之后按LSN顺序应用
+struct RecoveryEvent {
+    uint64_t lsn;
+    LogRecordType type;
+    uint32_t pageId;
+    std::string payload;
+};
+
+// 自动提交：不在事务中时为这次操作开始一个事务并在结束时提交（等待提交记录持久化），
+// 已在事务中时加入该事务，由事务的所有者提交
+class AutoCommitScope {
+public:
+    explicit AutoCommitScope(StorageEngine& engine)
+        : engine_(engine), ownsTransaction_(engine.beginTransaction()) {}
+    ~AutoCommitScope() {
+        if (ownsTransaction_) {
+            engine_.commitTransaction();
+        }
+    }
+    
+    AutoCommitScope(const AutoCommitScope&) = delete;
+    AutoCommitScope& operator=(const AutoCommitScope&) = delete;
+
+private:
+    StorageEngine& engine_;
+    bool ownsTransaction_;
+};
+
+} // namespace
+
+StorageEngine::StorageEngine(const std::string& dbPath, bool readOnly) : dbPath_(dbPath), readOnly_(readOnly) {
     std::string dbFile = dbPath + "/database.db";
-    pageManager_ = std::make_unique<PageManager>(dbFile);
+    if (readOnly) {
+        // 只读模式：映射已有的页文件，不创建目录和文件
+        pageManager_ = PageManager::openReadOnly(dbFile);
+        if (!pageManager_) {
+            throw std::runtime_error("Cannot open database read-only: " + dbFile);
+        }
+        // 只读模式不能重做日志：崩溃后已提交的修改可能只在日志中，页文件不是最新的状态时拒绝打开
+        if (WriteAheadLog::needsRecovery(getLogDirectory())) {
+            throw std::runtime_error("Database needs recovery; open it read-write first: " + dbPath);
+        }
+    } else {
+        // 确保数据库目录存在
+        std::filesystem::create_directories(dbPath);
+        
+        // 初始化页面管理器，打开预写日志
+        pageManager_ = std::make_unique<PageManager>(dbFile);
+        pageManager_->openLog(getLogDirectory());
+    }
     
     // 初始化索引管理器
     indexManager_ = std::make_unique<IndexManager>();
     
-    // 加载元数据
-    loadFromStorage();
+    // 加载元数据（有日志时先按日志恢复；旧版本数据库直接导入）
+    if (!readOnly_ && pageManager_->isLogging() && !std::filesystem::exists(getMetadataFileName())) {
+        recover();
+    } else if (!loadFromStorage() && readOnly_) {
+        // 元数据页缺失或无效（例如新数据库第一次保存之前崩溃），只读模式下无法修复
+        throw std::runtime_error("Database needs recovery; open it read-write first: " + dbPath);
+    }
+    
+    // 恢复完成之后再启动后台检查点
+    if (!readOnly_) {
+        pageManager_->startCheckpointer();
+    }
 }
 
 StorageEngine::~StorageEngine() {
-    saveToStorage();
+    if (!readOnly_) {
+        // 关闭时没有提交的事务（例如REPL中BEGIN之后直接退出）回滚
+        if (pageManager_->inTransaction()) {
+            rollbackTransaction();
+        }
+        pageManager_->stopCheckpointer();
+        saveToStorage();
+    }
+}
+
+bool StorageEngine::checkWritable(const std::string& operation) const {
+    if (readOnly_) {
+        std::cerr << "Cannot " << operation << ": database is opened read-only" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool StorageEngine::beginTransaction() {
+    if (!checkWritable("begin transaction")) {
+        return false;
+    }
+    return pageManager_->beginTransaction();
+}
+
+bool StorageEngine::commitTransaction(bool waitDurable) {
+    if (readOnly_) {
+        return false;
+    }
+    bool committed = pageManager_->commitTransaction(waitDurable);
+    // 事务之间是保存系统目录快照的安全点
+    if (pageManager_->isCheckpointRequested()) {
+        checkpointIfRequested();
+    }
+    return committed;
+}
+
+bool StorageEngine::rollbackTransaction() {
+    if (readOnly_) {
+        return false;
+    }
+    // 撤销的记录所在的数据页和各页的行数变化（插入撤销为删除，删除撤销为重新插入）
+    std::unordered_map<uint32_t, int64_t> pageRowDeltas;
+    bool rolledBack = pageManager_->rollbackTransaction([&](const LogRecord& record) {
+        int64_t& delta = pageRowDeltas[PageLogRecord::peekPageId(record.payload)];
+        if (record.type == LogRecordType::INSERT) {
+            --delta;
+        } else if (record.type == LogRecordType::DELETE) {
+            ++delta;
+        }
+    });
+    
+    // 与崩溃恢复相同：撤销过的页面重新计算空闲空间分类，行数加上变化，索引在下次使用时按表数据重建
+    for (const auto& [pageId, delta] : pageRowDeltas) {
+        for (const auto& [tableName, table] : tables_) {
+            if (table->containsDataPage(pageId)) {
+                table->recoverDataPage(pageId);
+                table->recoverRowCount(delta);
+                indexManager_->invalidateTableIndexes(tableName);
+                break;
+            }
+        }
+    }
+    if (pageManager_->isCheckpointRequested()) {
+        checkpointIfRequested();
+    }
+    return rolledBack;
+}
+
+bool StorageEngine::inTransaction() const {
+    return !readOnly_ && pageManager_->inTransaction();
+}
+
+bool StorageEngine::flushLog() {
+    WriteAheadLog* wal = readOnly_ ? nullptr : pageManager_->getLog();
+    return !wal || wal->flushAll();
+}
+
+const WriteAheadLog* StorageEngine::getLog() const {
+    return readOnly_ ? nullptr : pageManager_->getLog();
+}
+
+void StorageEngine::setSynchronousMode(SynchronousMode mode) {
+    if (checkWritable("set synchronous mode")) {
+        pageManager_->setSynchronousMode(mode);
+    }
+}
+
+SynchronousMode StorageEngine::getSynchronousMode() const {
+    return readOnly_ ? SynchronousMode::FULL : pageManager_->getSynchronousMode();
+}
+
+void StorageEngine::setSessionSynchronousMode(SynchronousMode mode) {
+    if (checkWritable("set synchronous mode")) {
+        pageManager_->setSessionSynchronousMode(mode);
+    }
+}
+
+void StorageEngine::clearSessionSynchronousMode() {
+    if (!readOnly_) {
+        pageManager_->clearSessionSynchronousMode();
+    }
+}
+
+SynchronousMode StorageEngine::getSessionSynchronousMode() const {
+    return readOnly_ ? SynchronousMode::FULL : pageManager_->getSessionSynchronousMode();
+}
+
+void StorageEngine::setCheckpointConfig(const CheckpointConfig& config) {
+    if (!readOnly_) {
+        pageManager_->startCheckpointer(config);
+    }
+}
+
+CheckpointStats StorageEngine::getCheckpointStats() const {
+    return readOnly_ ? CheckpointStats() : pageManager_->getCheckpointStats();
+}
+
+void StorageEngine::checkpointIfRequested() {
+    if (pageManager_->inTransaction()) {
+        return;
+    }
+    // 快照在beginLsn之后写入日志，恢复时从不晚于beginLsn的重做起点开始，能看到快照之后的所有目录修改
+    uint64_t beginLsn = pageManager_->getLog()->getNextLsn();
+    if (saveMetadata()) {
+        pageManager_->beginCheckpoint(beginLsn);
+    }
 }
 
 bool StorageEngine::createTable(const std::string& tableName, const std::vector<ColumnInfo>& columns) {
+    if (!checkWritable("create table '" + tableName + "'")) {
+        return false;
+    }
     if (tableExists(tableName)) {
         std::cerr << "Table '" << tableName << "' already exists" << std::endl;
         return false;
     }
     
+    AutoCommitScope transaction(*this);
+    if (pageManager_->isLogging()) {
+        CatalogWriter writer;
+        writeTableSchema(writer, tableName, columns);
+        pageManager_->logOperation(LogRecordType::CREATE_TABLE, writer.data());
+    }
+    
     auto table = std::make_shared<Table>(tableName, columns, pageManager_.get());
     tables_[tableName] = table;
     
@@ -54,21 +364,29 @@ bool StorageEngine::createTable(const std::string& tableName, const std::vector<
 }
 
 bool StorageEngine::dropTable(const std::string& tableName) {
+    if (!checkWritable("drop table '" + tableName + "'")) {
+        return false;
+    }
     auto it = tables_.find(tableName);
     if (it == tables_.end()) {
         std::cerr << "Table '" << tableName << "' does not exist" << std::endl;
         return false;
     }
     
+    AutoCommitScope transaction(*this);
+    if (pageManager_->isLogging()) {
+        CatalogWriter writer;
+        writer.putString(tableName);
+        pageManager_->logOperation(LogRecordType::DROP_TABLE, writer.data());
+    }
+    
     // 从索引管理器中注销表
     indexManager_->unregisterTable(tableName);
     
+    // 释放表占用的数据页和FSM页
+    it->second->releaseStorage();
     tables_.erase(it);
     
-    // 删除表文件
-    std::string tableFile = getTableFileName(tableName);
-    std::filesystem::remove(tableFile);
-    
     std::cout << "Table '" << tableName << "' dropped successfully" << std::endl;
     return true;
 }
@@ -96,15 +414,21 @@ std::vector<std::string> StorageEngine::getAllTableNames() const {
 }
 
 bool StorageEngine::insertRow(const std::string& tableName, const Row& row) {
+    if (!checkWritable("insert into table '" + tableName + "'")) {
+        return false;
+    }
     auto table = getTable(tableName);
     if (!table) {
         std::cerr << "Table '" << tableName << "' does not exist" << std::endl;
         return false;
     }
     
+    AutoCommitScope transaction(*this);
     try {
+        indexManager_->ensureIndexesBuilt(tableName);
+        
         // 插入到表中（现在会使用页面管理）
-        uint32_t recordId = table->insertRow(row);
+        RID recordId = table->insertRow(row);
         
         // 更新索引
         if (!indexManager_->insertRecord(tableName, row, recordId)) {
@@ -127,12 +451,17 @@ bool StorageEngine::insertRow(const std::string& tableName, const std::vector<Va
 }
 
 size_t StorageEngine::batchInsertRows(const std::string& tableName, const std::vector<std::vector<Value>>& batchData) {
+    if (!checkWritable("insert into table '" + tableName + "'")) {
+        return 0;
+    }
     auto table = getTable(tableName);
     if (!table) {
         std::cerr << "Table '" << tableName << "' does not exist" << std::endl;
         return 0;
     }
     
+    // 整批在一个事务中，只在最后提交一次
+    AutoCommitScope transaction(*this);
     size_t successCount = 0;
     
     try {
@@ -151,12 +480,16 @@ size_t StorageEngine::batchInsertRows(const std::string& tableName, const std::v
 }
 
 size_t StorageEngine::fastBatchInsertRows(const std::string& tableName, const std::vector<std::vector<Value>>& batchData) {
+    if (!checkWritable("insert into table '" + tableName + "'")) {
+        return 0;
+    }
     auto table = getTable(tableName);
     if (!table) {
         std::cerr << "Table '" << tableName << "' does not exist" << std::endl;
         return 0;
     }
     
+    AutoCommitScope transaction(*this);
     size_t successCount = 0;
     
     try {
@@ -165,7 +498,7 @@ size_t StorageEngine::fastBatchInsertRows(const std::string& tableName, const st
             Row row(values);
             
             // 使用超快速插入方法
-            uint32_t recordId = table->fastInsertRow(row);
+            table->fastInsertRow(row);
             successCount++;
         }
         
@@ -222,6 +555,18 @@ void StorageEngine::flushAllPages() {
     }
 }
 
+size_t StorageEngine::vacuum() {
+    if (!checkWritable("vacuum")) {
+        return 0;
+    }
+    AutoCommitScope transaction(*this);
+    size_t compactedPages = 0;
+    for (const auto& pair : tables_) {
+        compactedPages += pair.second->vacuum();
+    }
+    return compactedPages;
+}
+
 bool StorageEngine::indexExists(const std::string& indexName) const {
     if (!indexManager_) {
         return false;
@@ -233,14 +578,20 @@ bool StorageEngine::indexExists(const std::string& indexName) const {
     return indexInfo != nullptr;
 }
 
-bool StorageEngine::deleteRow(const std::string& tableName, const Row& row, uint32_t recordId) {
+bool StorageEngine::deleteRow(const std::string& tableName, const Row& row, RID recordId) {
+    if (!checkWritable("delete from table '" + tableName + "'")) {
+        return false;
+    }
     auto table = getTable(tableName);
     if (!table) {
         std::cerr << "Table '" << tableName << "' does not exist" << std::endl;
         return false;
     }
     
-    // 先从索引中删除，因为删除表记录后recordId可能失效
+    AutoCommitScope transaction(*this);
+    
+    // 先从索引中删除
+    indexManager_->ensureIndexesBuilt(tableName);
     bool indexDeleteSuccess = indexManager_->deleteRecord(tableName, row, recordId);
     if (!indexDeleteSuccess) {
         std::cerr << "Warning: Failed to remove from indexes for record " << recordId << std::endl;
@@ -248,10 +599,10 @@ bool StorageEngine::deleteRow(const std::string& tableName, const Row& row, uint
     
     // 然后从表中删除行
     if (!table->deleteRow(recordId)) {
-        // 检查是否是因为recordId不存在（可能已经被删除）
+        // 检查是否是因为RID指向的槽位已经为空（可能已经被删除）
         Row testRow = table->getRow(recordId);
         if (testRow.getFieldCount() == 0) {
-            // recordId不存在，可能已经被删除，这不算错误
+            // 记录不存在，可能已经被删除，这不算错误
             std::cout << "Row deleted from table " << tableName << " (already removed)" << std::endl;
             return true;
         } else {
@@ -264,21 +615,28 @@ bool StorageEngine::deleteRow(const std::string& tableName, const Row& row, uint
     return true;
 }
 
-bool StorageEngine::updateRow(const std::string& tableName, const Row& oldRow, const Row& newRow, uint32_t recordId) {
+bool StorageEngine::updateRow(const std::string& tableName, const Row& oldRow, const Row& newRow, RID recordId) {
+    if (!checkWritable("update table '" + tableName + "'")) {
+        return false;
+    }
     auto table = getTable(tableName);
     if (!table) {
         std::cerr << "Table '" << tableName << "' does not exist" << std::endl;
         return false;
     }
     
-    // 先更新表中的数据
-    if (!table->updateRow(recordId, newRow)) {
+    AutoCommitScope transaction(*this);
+    
+    // 先更新表中的数据（新记录放不下原页面时会被迁移，RID随之改变）
+    indexManager_->ensureIndexesBuilt(tableName);
+    RID newRecordId = recordId;
+    if (!table->updateRow(recordId, newRow, &newRecordId)) {
         std::cerr << "Failed to update row in table" << std::endl;
         return false;
     }
     
     // 更新索引
-    if (!indexManager_->updateRecord(tableName, oldRow, newRow, recordId)) {
+    if (!indexManager_->updateRecord(tableName, oldRow, newRow, recordId, newRecordId)) {
         std::cerr << "Failed to update indexes" << std::endl;
         // 这里理想情况下应该回滚表的更新，但为简化先不实现
         return false;
@@ -290,23 +648,47 @@ bool StorageEngine::updateRow(const std::string& tableName, const Row& oldRow, c
 
 bool StorageEngine::createIndex(const std::string& indexName, const std::string& tableName, 
                                const std::string& columnName, bool isUnique) {
-    return indexManager_->createIndex(indexName, tableName, columnName, IndexType::BTREE, isUnique);
+    if (!checkWritable("create index '" + indexName + "'")) {
+        return false;
+    }
+    AutoCommitScope transaction(*this);
+    if (!indexManager_->createIndex(indexName, tableName, columnName, IndexType::BTREE, isUnique)) {
+        return false;
+    }
+    if (pageManager_->isLogging()) {
+        CatalogWriter writer;
+        writeIndexDefinition(writer, IndexInfo(indexName, tableName, columnName, IndexType::BTREE, isUnique));
+        pageManager_->logOperation(LogRecordType::CREATE_INDEX, writer.data());
+    }
+    return true;
 }
 
 bool StorageEngine::dropIndex(const std::string& indexName) {
-    return indexManager_->dropIndex(indexName);
+    if (!checkWritable("drop index '" + indexName + "'")) {
+        return false;
+    }
+    AutoCommitScope transaction(*this);
+    if (!indexManager_->dropIndex(indexName)) {
+        return false;
+    }
+    if (pageManager_->isLogging()) {
+        CatalogWriter writer;
+        writer.putString(indexName);
+        pageManager_->logOperation(LogRecordType::DROP_INDEX, writer.data());
+    }
+    return true;
 }
 
-std::vector<uint32_t> StorageEngine::searchByIndex(const std::string& indexName, const Value& key) {
+std::vector<RID> StorageEngine::searchByIndex(const std::string& indexName, const Value& key) {
     return indexManager_->searchByIndex(indexName, key);
 }
 
-std::vector<uint32_t> StorageEngine::rangeSearchByIndex(const std::string& indexName, 
+std::vector<RID> StorageEngine::rangeSearchByIndex(const std::string& indexName, 
                                                        const Value& startKey, const Value& endKey) {
     return indexManager_->rangeSearchByIndex(indexName, startKey, endKey);
 }
 
-std::vector<uint32_t> StorageEngine::searchByColumn(const std::string& tableName, 
+std::vector<RID> StorageEngine::searchByColumn(const std::string& tableName, 
                                                     const std::string& columnName, const Value& key) {
     // 首先检查是否有索引可用
     if (indexManager_->hasIndex(tableName, columnName)) {
@@ -323,7 +705,7 @@ std::vector<uint32_t> StorageEngine::searchByColumn(const std::string& tableName
     
     // 没有索引，使用全表扫描
     std::cout << "No index available, using full table scan" << std::endl;
-    std::vector<uint32_t> result;
+    std::vector<RID> result;
     
     auto table = getTable(tableName);
     if (!table) return result;
@@ -331,10 +713,9 @@ std::vector<uint32_t> StorageEngine::searchByColumn(const std::string& tableName
     int columnIndex = table->getColumnIndex(columnName);
     if (columnIndex < 0) return result;
     
-    uint32_t recordId = 0;
-    for (auto it = table->begin(); it != table->end(); ++it, ++recordId) {
-        if (it->getValue(columnIndex) == key) {
-            result.push_back(recordId);
+    for (auto it = table->begin(); it != table->end(); ++it) {
+        if (it.view().getValue(columnIndex) == key) {
+            result.push_back(it.getRID());
         }
     }
     
@@ -342,51 +723,334 @@ std::vector<uint32_t> StorageEngine::searchByColumn(const std::string& tableName
 }
 
 bool StorageEngine::saveToStorage() {
-    // 保存元数据
+    if (!checkWritable("save database")) {
+        return false;
+    }
+    
+    // 保存前清理碎片较多的页面（删除只留下墓碑，空间在这里或下一次插入时回收）
+    vacuum();
+    
+    // 这之前的修改在保存完成后都已写入页文件，恢复从这里开始重做
+    WriteAheadLog* wal = pageManager_->getLog();
+    uint64_t redoLsn = wal ? wal->getNextLsn() : 0;
+    
+    // 保存系统目录（其中包括每个表的空闲空间映射页）
     if (!saveMetadata()) {
         return false;
     }
     
-    // 保存每个表的数据
-    for (const auto& pair : tables_) {
-        std::string tableFile = getTableFileName(pair.first);
-        std::ofstream file(tableFile, std::ios::binary);
-        if (!file.is_open()) {
-            std::cerr << "Failed to open file for table: " << pair.first << std::endl;
-            continue;
+    // 把缓冲池中的脏页写回页文件，再记录检查点
+    return pageManager_->saveToDisk() && pageManager_->writeCheckpoint(redoLsn);
+}
+
+bool StorageEngine::loadFromStorage() {
+    // 旧版本的数据库（metadata.meta + 每表一个.tbl文件），导入到页文件中
+    if (std::filesystem::exists(getMetadataFileName())) {
+        if (!checkWritable("import legacy database files")) {
+            return false;
         }
-        
-        std::string serializedData = pair.second->serialize();
-        file.write(serializedData.c_str(), serializedData.size());
-        file.close();
+        return importLegacyFiles();
     }
     
-    // 保存页面管理器数据
-    pageManager_->saveToDisk();
-    
-    // 保存索引数据
-    indexManager_->saveIndexes(dbPath_);
+    // 新数据库：预留第1页作为元数据页
+    if (!pageManager_->pageExists(META_PAGE_ID)) {
+        if (readOnly_) {
+            std::cerr << "Invalid database file: missing meta page" << std::endl;
+            return false;
+        }
+        pageManager_->allocatePage(PageType::META_PAGE);
+        return true;
+    }
     
-    return true;
+    // 只读取元数据页和系统目录页，数据页在查询时按需读入
+    return loadMetadata();
 }
 
-bool StorageEngine::loadFromStorage() {
-    // 加载元数据
-    if (!loadMetadata()) {
-        // 如果没有元数据文件，说明是新数据库
+bool StorageEngine::recover() {
+    WriteAheadLog* wal = pageManager_->getLog();
+    auto startTime = std::chrono::steady_clock::now();
+    
+    // 起点：最近一次完成的检查点记录中的重做起点，以及检查点时还没有结束的事务
+    uint64_t checkpointLsn = wal->getCheckpointLsn();
+    uint64_t redoLsn = wal->getFirstLsn();
+    std::unordered_map<uint64_t, uint64_t> activeTransactions;  // 事务ID -> 最后一条记录的LSN
+    uint64_t dirtyPageTableLsn = 0;
+    std::unordered_map<uint32_t, uint64_t> dirtyPages;          // 页ID -> recLsn
+    if (checkpointLsn != 0) {
+        LogRecord record;
+        CheckpointLogRecord checkpoint;
+        if (wal->readRecord(checkpointLsn, record) && record.type == LogRecordType::CHECKPOINT &&
+            checkpoint.decode(record.payload)) {
+            redoLsn = std::max(redoLsn, checkpoint.redoLsn);
+            activeTransactions.insert(checkpoint.activeTransactions.begin(), checkpoint.activeTransactions.end());
+            dirtyPageTableLsn = checkpoint.dirtyPageTableLsn;
+            dirtyPages.insert(checkpoint.dirtyPages.begin(), checkpoint.dirtyPages.end());
+        } else {
+            std::cerr << "Invalid checkpoint record at LSN " << checkpointLsn << ", replaying the whole log" << std::endl;
+            checkpointLsn = 0;
+        }
+    }
+    
+    // 分析和重做合并为一次顺序扫描：重做所有页面修改（按检查点的脏页表已经写回的修改不读取页面，
+    // 其余的在页面LSN不小于记录LSN时跳过），同时维护活跃事务表，并收集加载系统目录之后才能应用的事件
+    std::vector<RecoveryEvent> events;
+    std::unordered_set<uint32_t> touchedPages;  // 记录内容被修改过的页面（之后更新它们的空闲空间分类）
+    size_t scannedRecords = 0;
+    size_t redoneChanges = 0;
+    bool replayedPastCheckpoint = false;
+    bool complete = wal->scan(redoLsn, [&](const LogRecord& record) {
+        ++scannedRecords;
+        replayedPastCheckpoint = replayedPastCheckpoint || record.lsn > checkpointLsn;
+        if (record.txnId != 0) {
+            if (record.type == LogRecordType::COMMIT || record.type == LogRecordType::ABORT) {
+                activeTransactions.erase(record.txnId);
+            } else {
+                uint64_t& lastLsn = activeTransactions[record.txnId];
+                lastLsn = std::max(lastLsn, record.lsn);
+            }
+        }
+        
+        switch (record.type) {
+            case LogRecordType::PAGE_FORMAT:
+            case LogRecordType::PAGE_IMAGE:
+            case LogRecordType::INSERT:
+            case LogRecordType::DELETE:
+            case LogRecordType::UPDATE:
+            case LogRecordType::COMPACT:
+            case LogRecordType::COMPENSATION: {
+                LogRecordType type = record.type;
+                uint32_t pageId = PageLogRecord::peekPageId(record.payload);
+                CompensationLogRecord compensation;
+                if (type == LogRecordType::COMPENSATION && compensation.decode(record.payload)) {
+                    type = compensation.type;
+                    pageId = PageLogRecord::peekPageId(compensation.pageRecord);
+                }
+                auto dirtyPage = dirtyPages.find(pageId);
+                bool flushed = record.lsn < dirtyPageTableLsn &&
+                               (dirtyPage == dirtyPages.end() || record.lsn < dirtyPage->second);
+                if (!flushed && pageManager_->redoPageChange(record)) {
+                    ++redoneChanges;
+                }
+                // 行的插入和删除（补偿记录按补偿操作）影响行数；格式化的页面上之前的行都已不存在
+                if (type == LogRecordType::INSERT || type == LogRecordType::DELETE ||
+                    type == LogRecordType::PAGE_FORMAT) {
+                    events.push_back({record.lsn, type, pageId, std::string()});
+                }
+                if (type != LogRecordType::PAGE_FORMAT && type != LogRecordType::PAGE_IMAGE) {
+                    touchedPages.insert(pageId);
+                }
+                break;
+            }
+            case LogRecordType::PAGE_ALLOC:
+            case LogRecordType::PAGE_FREE:
+            case LogRecordType::CREATE_TABLE:
+            case LogRecordType::DROP_TABLE:
+            case LogRecordType::TABLE_ADD_PAGE:
+            case LogRecordType::CREATE_INDEX:
+            case LogRecordType::DROP_INDEX:
+                events.push_back({record.lsn, record.type, 0, record.payload});
+                break;
+            default:
+                break;
+        }
         return true;
+    });
+    if (!complete) {
+        std::cerr << "Warning: write-ahead log is incomplete, recovering up to the last readable record" << std::endl;
     }
     
-    // 加载页面管理器数据
-    pageManager_->loadFromDisk();
+    // 加载检查点时的系统目录；目录快照之后的修改来自日志（目录页的LSN就是快照之后的第一个位置）
+    if (!loadFromStorage()) {
+        return false;
+    }
+    uint64_t catalogLsn = 0;
+    if (!catalogPageIds_.empty()) {
+        ReadPageGuard catalogPage = pageManager_->fetchPageRead(catalogPageIds_.front());
+        catalogLsn = catalogPage ? catalogPage->getLsn() : 0;
+    }
     
-    // 加载索引数据（在表加载完成后）
-    indexManager_->loadIndexes(dbPath_);
+    // 数据页的归属：系统目录中的页目录加上日志中新增的数据页；新页面上的插入记录在
+    // TABLE_ADD_PAGE之前，先记在页面上，页面加入表时再计入该表
+    std::unordered_map<uint32_t, std::string> pageOwners;
+    for (const auto& pair : tables_) {
+        for (uint32_t pageId : pair.second->getDataPageIds()) {
+            pageOwners[pageId] = pair.first;
+        }
+    }
+    std::unordered_map<uint32_t, int64_t> pendingRows;
+    std::unordered_map<std::string, int64_t> rowDeltas;
+    std::vector<uint32_t> freedPageIds;
+    
+    for (const RecoveryEvent& event : events) {
+        // 页面分配是幂等的位操作，从重做起点开始全部应用；其余事件只应用目录快照之后的
+        if (event.type == LogRecordType::PAGE_ALLOC || event.type == LogRecordType::PAGE_FREE) {
+            LogRecord record;
+            record.lsn = event.lsn;
+            record.type = event.type;
+            record.payload = event.payload;
+            pageManager_->redoAllocation(record, freedPageIds);
+            continue;
+        }
+        if (event.lsn <= catalogLsn) {
+            continue;
+        }
+        
+        CatalogReader reader(event.payload);
+        switch (event.type) {
+            case LogRecordType::CREATE_TABLE: {
+                std::string tableName;
+                std::vector<ColumnInfo> columns = readTableSchema(reader, tableName);
+                if (!reader.ok() || tables_.count(tableName)) {
+                    break;
+                }
+                auto table = std::make_shared<Table>(tableName, columns, pageManager_.get());
+                tables_[tableName] = table;
+                indexManager_->registerTable(table);
+                // 主键索引由建表自动创建，日志中没有单独的CREATE_INDEX记录
+                for (const auto& column : columns) {
+                    if (column.isPrimaryKey) {
+                        indexManager_->restoreIndex(IndexInfo("pk_" + tableName + "_" + column.name, tableName,
+                                                              column.name, IndexType::BTREE, true));
+                        break;
+                    }
+                }
+                break;
+            }
+            case LogRecordType::DROP_TABLE: {
+                // 表的页面由之后的PAGE_FREE记录释放
+                std::string tableName = reader.getString();
+                auto it = tables_.find(tableName);
+                if (!reader.ok() || it == tables_.end()) {
+                    break;
+                }
+                for (uint32_t pageId : it->second->getDataPageIds()) {
+                    pageOwners.erase(pageId);
+                }
+                indexManager_->unregisterTable(tableName);
+                tables_.erase(it);
+                rowDeltas.erase(tableName);
+                break;
+            }
+            case LogRecordType::TABLE_ADD_PAGE: {
+                TablePageLogRecord added;
+                auto it = added.decode(event.payload) ? tables_.find(added.tableName) : tables_.end();
+                if (it == tables_.end()) {
+                    break;
+                }
+                it->second->recoverDataPage(added.pageId);
+                pageOwners[added.pageId] = added.tableName;
+                auto pending = pendingRows.find(added.pageId);
+                if (pending != pendingRows.end()) {
+                    rowDeltas[added.tableName] += pending->second;
+                    pendingRows.erase(pending);
+                }
+                break;
+            }
+            case LogRecordType::CREATE_INDEX: {
+                IndexInfo indexInfo = readIndexDefinition(reader);
+                if (reader.ok() && !indexExists(indexInfo.indexName) && tables_.count(indexInfo.tableName)) {
+                    indexManager_->restoreIndex(indexInfo);
+                }
+                break;
+            }
+            case LogRecordType::DROP_INDEX: {
+                std::string indexName = reader.getString();
+                if (reader.ok() && indexExists(indexName)) {
+                    indexManager_->dropIndex(indexName);
+                }
+                break;
+            }
+            case LogRecordType::PAGE_FORMAT:
+                pendingRows.erase(event.pageId);
+                break;
+            default: {
+                int64_t delta = event.type == LogRecordType::INSERT ? 1 : -1;
+                auto owner = pageOwners.find(event.pageId);
+                if (owner != pageOwners.end()) {
+                    rowDeltas[owner->second] += delta;
+                } else {
+                    pendingRows[event.pageId] += delta;
+                }
+                break;
+            }
+        }
+    }
     
-    // 重建索引结构
-    indexManager_->rebuildIndexes();
+    // 撤销：每次取LSN最大的待撤销记录，所有未结束事务的修改按与执行相反的顺序回滚，
+    // 每撤销一条写一条补偿记录；遇到补偿记录直接跳到它指向的位置（之前的恢复已撤销过的部分不再撤销）
+    std::priority_queue<std::pair<uint64_t, uint64_t>> undoQueue;  // (下一条要撤销的LSN, 事务ID)
+    for (const auto& [txnId, lastLsn] : activeTransactions) {
+        undoQueue.emplace(lastLsn, txnId);
+    }
+    size_t undoneChanges = 0;
+    while (!undoQueue.empty()) {
+        auto [lsn, txnId] = undoQueue.top();
+        undoQueue.pop();
+        
+        LogRecord record;
+        if (!wal->readRecord(lsn, record)) {
+            std::cerr << "Cannot read log record at LSN " << lsn << " while rolling back transaction " << txnId
+                      << std::endl;
+            wal->abortTransaction(txnId);
+            continue;
+        }
+        uint64_t nextLsn = record.prevLsn;
+        if (record.type == LogRecordType::BEGIN) {
+            nextLsn = 0;
+        } else if (record.type == LogRecordType::COMPENSATION) {
+            CompensationLogRecord compensation;
+            nextLsn = compensation.decode(record.payload) ? compensation.undoNextLsn : 0;
+        } else if (record.type == LogRecordType::INSERT || record.type == LogRecordType::DELETE ||
+                   record.type == LogRecordType::UPDATE) {
+            // 系统目录和页面分配的修改只重做不撤销
+            if (pageManager_->undoPageChange(record)) {
+                ++undoneChanges;
+                uint32_t pageId = PageLogRecord::peekPageId(record.payload);
+                touchedPages.insert(pageId);
+                auto owner = pageOwners.find(pageId);
+                if (owner != pageOwners.end() && record.type != LogRecordType::UPDATE) {
+                    rowDeltas[owner->second] += record.type == LogRecordType::INSERT ? -1 : 1;
+                }
+            }
+        }
+        
+        if (nextLsn != 0) {
+            undoQueue.emplace(nextLsn, txnId);
+        } else {
+            wal->abortTransaction(txnId);
+        }
+    }
     
-    return true;
+    // 修改过的数据页重新计算空闲空间分类，行数加上日志中的变化
+    for (uint32_t pageId : touchedPages) {
+        auto owner = pageOwners.find(pageId);
+        if (owner != pageOwners.end()) {
+            tables_[owner->second]->recoverDataPage(pageId);
+        }
+    }
+    for (const auto& [tableName, delta] : rowDeltas) {
+        auto it = tables_.find(tableName);
+        if (it != tables_.end() && delta != 0) {
+            it->second->recoverRowCount(delta);
+        }
+    }
+    pageManager_->discardFreePages(freedPageIds);
+    
+    if (!replayedPastCheckpoint && activeTransactions.empty()) {
+        return true; // 上次正常关闭，检查点之后没有修改
+    }
+    
+    // 保存恢复后的状态并记录新的检查点，下次打开不再重放这些日志
+    bool saved = saveToStorage();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+    std::cout << "Recovered from write-ahead log: " << scannedRecords << " records scanned, " << redoneChanges
+              << " page changes redone, " << activeTransactions.size() << " incomplete transactions rolled back ("
+              << undoneChanges << " changes undone) in " << elapsed.count() << " ms" << std::endl;
+    return saved;
+}
+
+BufferPoolStats StorageEngine::getBufferPoolStats() const {
+    return pageManager_->getBufferPoolStats();
 }
 
 void StorageEngine::printStorageInfo() const {
@@ -440,40 +1104,190 @@ void StorageEngine::printIndexInfo(const std::string& indexName) const {
 }
 
 bool StorageEngine::saveMetadata() {
-    std::string metaFile = getMetadataFileName();
-    std::ofstream file(metaFile);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open metadata file for writing" << std::endl;
+    // 编码系统目录
+    CatalogWriter writer;
+    writer.put<uint32_t>(static_cast<uint32_t>(tables_.size()));
+    for (const auto& pair : tables_) {
+        const auto& table = pair.second;
+        // 未使用的区段页面先归还，随页分配位图一起保存为空闲页
+        table->releaseUnusedExtent();
+        writeTableSchema(writer, table->getTableName(), table->getColumns());
+        writer.put<uint32_t>(table->saveFreeSpaceMap());
+        writer.put<uint64_t>(static_cast<uint64_t>(table->getRowCount()));
+    }
+    
+    auto indexInfos = indexManager_->getAllIndexInfos();
+    writer.put<uint32_t>(static_cast<uint32_t>(indexInfos.size()));
+    for (const auto* indexInfo : indexInfos) {
+        writeIndexDefinition(writer, *indexInfo);
+    }
+    
+    // 按需分配或释放系统目录页
+    const std::string& catalog = writer.data();
+    size_t pagesNeeded = (catalog.size() + CATALOG_CHUNK_SIZE - 1) / CATALOG_CHUNK_SIZE;
+    while (catalogPageIds_.size() < pagesNeeded) {
+        uint32_t pageId = pageManager_->allocatePage(PageType::CATALOG_PAGE);
+        if (pageId == 0) {
+            std::cerr << "Failed to allocate catalog page" << std::endl;
+            return false;
+        }
+        catalogPageIds_.push_back(pageId);
+    }
+    while (catalogPageIds_.size() > pagesNeeded) {
+        pageManager_->deallocatePage(catalogPageIds_.back());
+        catalogPageIds_.pop_back();
+    }
+    
+    for (size_t i = 0; i < pagesNeeded; ++i) {
+        size_t begin = i * CATALOG_CHUNK_SIZE;
+        size_t count = std::min(CATALOG_CHUNK_SIZE, catalog.size() - begin);
+        uint32_t nextPageId = (i + 1 < pagesNeeded) ? catalogPageIds_[i + 1] : 0;
+        
+        std::string record(sizeof(uint32_t), '\0');
+        byteorder::storeLE<uint32_t>(reinterpret_cast<uint8_t*>(&record[0]), nextPageId);
+        record.append(catalog, begin, count);
+        
+        Page page(catalogPageIds_[i], PageType::CATALOG_PAGE);
+        if (!page.insertRecord(record)) {
+            std::cerr << "Catalog page overflow" << std::endl;
+            return false;
+        }
+        pageManager_->writePage(page);
+    }
+    
+    // 所有页面分配完成之后保存页分配位图（位图页本身也记录为已分配）
+    uint32_t allocationMapPageId = pageManager_->saveAllocationMap();
+    
+    // 最后写元数据页，指向新的系统目录和页分配位图
+    std::string meta(META_RECORD_SIZE, '\0');
+    uint8_t* out = reinterpret_cast<uint8_t*>(&meta[0]);
+    std::memcpy(out, DATABASE_FILE_MAGIC, sizeof(DATABASE_FILE_MAGIC));
+    byteorder::storeLE<uint32_t>(out + sizeof(DATABASE_FILE_MAGIC), DATABASE_FORMAT_VERSION);
+    byteorder::storeLE<uint32_t>(out + sizeof(DATABASE_FILE_MAGIC) + sizeof(uint32_t),
+                                 catalogPageIds_.empty() ? 0 : catalogPageIds_.front());
+    byteorder::storeLE<uint32_t>(out + sizeof(DATABASE_FILE_MAGIC) + 2 * sizeof(uint32_t), allocationMapPageId);
+    
+    Page metaPage(META_PAGE_ID, PageType::META_PAGE);
+    metaPage.insertRecord(meta);
+    return pageManager_->writePage(metaPage);
+}
+
+bool StorageEngine::loadMetadata() {
+    // 读取元数据页
+    ReadPageGuard metaPage = pageManager_->fetchPageRead(META_PAGE_ID);
+    if (!metaPage || metaPage->getPageType() != PageType::META_PAGE) {
+        std::cerr << "Invalid database file: missing meta page" << std::endl;
         return false;
     }
+    std::string metaRecord = metaPage->getRecord(0);
+    metaPage.release();
+    if (metaRecord.empty() && pageManager_->isLogging()) {
+        return true; // 新数据库第一次保存之前崩溃：元数据页只被格式化过，系统目录按日志恢复
+    }
+    const uint8_t* meta = reinterpret_cast<const uint8_t*>(metaRecord.data());
+    if (metaRecord.size() < META_RECORD_SIZE_V1 ||
+        std::memcmp(meta, DATABASE_FILE_MAGIC, sizeof(DATABASE_FILE_MAGIC)) != 0) {
+        std::cerr << "Invalid database file: bad meta page" << std::endl;
+        return false;
+    }
+    uint32_t version = byteorder::loadLE<uint32_t>(meta + sizeof(DATABASE_FILE_MAGIC));
+    if (version != DATABASE_FORMAT_VERSION && version != DATABASE_FORMAT_VERSION_NO_ALLOCATION_MAP) {
+        std::cerr << "Unsupported database format version: " << version << std::endl;
+        return false;
+    }
+    if (version == DATABASE_FORMAT_VERSION && metaRecord.size() < META_RECORD_SIZE) {
+        std::cerr << "Invalid database file: bad meta page" << std::endl;
+        return false;
+    }
+    uint32_t catalogPageId = byteorder::loadLE<uint32_t>(meta + sizeof(DATABASE_FILE_MAGIC) + sizeof(uint32_t));
     
-    // 保存表数量
-    file << tables_.size() << std::endl;
+    // 恢复页分配位图；位图损坏时文件中的页面全部保持已分配，只是之前释放的页面暂时不能重用
+    if (version == DATABASE_FORMAT_VERSION) {
+        uint32_t allocationMapPageId =
+            byteorder::loadLE<uint32_t>(meta + sizeof(DATABASE_FILE_MAGIC) + 2 * sizeof(uint32_t));
+        if (allocationMapPageId != 0 && !pageManager_->loadAllocationMap(allocationMapPageId)) {
+            std::cerr << "Warning: page allocation map is unreadable, freed pages will not be reused" << std::endl;
+        }
+    }
     
-    // 保存每个表的基本信息
-    for (const auto& pair : tables_) {
-        const auto& table = pair.second;
-        file << table->getTableName() << std::endl;
-        file << table->getColumnCount() << std::endl;
+    // 沿系统目录链表读取完整的目录数据
+    std::string catalog;
+    catalogPageIds_.clear();
+    while (catalogPageId != 0) {
+        ReadPageGuard page = pageManager_->fetchPageRead(catalogPageId);
+        RecordRef record = page ? page->getRecordRef(0) : RecordRef();
+        if (!page || page->getPageType() != PageType::CATALOG_PAGE ||
+            !record.isValid() || record.size < sizeof(uint32_t)) {
+            std::cerr << "Corrupted catalog page: " << catalogPageId << std::endl;
+            return false;
+        }
+        catalogPageIds_.push_back(catalogPageId);
+        catalog.append(reinterpret_cast<const char*>(record.data) + sizeof(uint32_t),
+                       record.size - sizeof(uint32_t));
+        catalogPageId = byteorder::loadLE<uint32_t>(record.data);
+    }
+    if (catalog.empty()) {
+        return true; // 还没有保存过系统目录
+    }
+    
+    // 解码表定义
+    CatalogReader reader(catalog);
+    uint32_t tableCount = reader.get<uint32_t>();
+    for (uint32_t i = 0; i < tableCount && reader.ok(); ++i) {
+        std::string tableName;
+        std::vector<ColumnInfo> columns = readTableSchema(reader, tableName);
+        uint32_t fsmRootPageId = reader.get<uint32_t>();
+        uint64_t rowCount = reader.get<uint64_t>();
+        if (!reader.ok()) {
+            break;
+        }
         
-        for (const auto& col : table->getColumns()) {
-            file << col.name << "|" << static_cast<int>(col.type) 
-                 << "|" << (col.isNotNull ? 1 : 0) 
-                 << "|" << (col.isPrimaryKey ? 1 : 0) << std::endl;
+        // 只恢复页目录，不读取数据页
+        auto table = std::make_shared<Table>(tableName, columns, pageManager_.get());
+        if (!table->loadStorage(fsmRootPageId, static_cast<size_t>(rowCount))) {
+            return false;
         }
+        tables_[tableName] = table;
+        
+        // 注册表到索引管理器
+        indexManager_->registerTable(table);
     }
     
-    file.close();
+    // 解码索引定义（B+树在第一次使用时构建）
+    uint32_t indexCount = reader.get<uint32_t>();
+    for (uint32_t i = 0; i < indexCount && reader.ok(); ++i) {
+        IndexInfo indexInfo = readIndexDefinition(reader);
+        if (reader.ok()) {
+            indexManager_->restoreIndex(indexInfo);
+        }
+    }
+    
+    if (!reader.ok()) {
+        std::cerr << "Corrupted system catalog" << std::endl;
+        return false;
+    }
     return true;
 }
 
-bool StorageEngine::loadMetadata() {
+bool StorageEngine::importLegacyFiles() {
     std::string metaFile = getMetadataFileName();
     std::ifstream file(metaFile);
     if (!file.is_open()) {
         return false; // 元数据文件不存在
     }
     
+    // 旧版本从不读取页文件，其中的内容不可用：重新创建页文件，第1页为元数据页
+    std::string dbFile = pageManager_->getFileName();
+    pageManager_.reset();
+    std::filesystem::remove(dbFile);
+    pageManager_ = std::make_unique<PageManager>(dbFile);
+    // 日志中的记录属于被删除的页文件，从新的空日志开始
+    std::error_code ec;
+    std::filesystem::remove_all(getLogDirectory(), ec);
+    pageManager_->openLog(getLogDirectory());
+    pageManager_->allocatePage(PageType::META_PAGE);
+    std::vector<std::string> legacyFiles = {metaFile};
+    
     std::string line;
     
     // 读取表数量
@@ -529,8 +1343,9 @@ bool StorageEngine::loadMetadata() {
         // 创建表
         auto table = std::make_shared<Table>(tableName, columns, pageManager_.get());
         
-        // 加载表数据
+        // 加载表数据（逐行重新插入到页文件）
         std::string tableFile = getTableFileName(tableName);
+        legacyFiles.push_back(tableFile);
         std::ifstream dataFile(tableFile, std::ios::binary);
         if (dataFile.is_open()) {
             std::string serializedData((std::istreambuf_iterator<char>(dataFile)),
@@ -538,7 +1353,7 @@ bool StorageEngine::loadMetadata() {
             dataFile.close();
             
             if (!serializedData.empty()) {
-                *table = Table::deserialize(serializedData);
+                *table = Table::deserialize(serializedData, pageManager_.get());
             }
         }
         
@@ -549,9 +1364,45 @@ bool StorageEngine::loadMetadata() {
     }
     
     file.close();
+    
+    // 旧的索引定义文件：name|table|column|type|unique
+    std::string indexFile = dbPath_ + "/indexes.meta";
+    std::ifstream indexStream(indexFile);
+    if (indexStream.is_open()) {
+        legacyFiles.push_back(indexFile);
+        std::getline(indexStream, line); // 索引数量
+        while (std::getline(indexStream, line)) {
+            std::vector<std::string> parts;
+            std::stringstream ss(line);
+            std::string part;
+            while (std::getline(ss, part, '|')) {
+                parts.push_back(part);
+            }
+            if (parts.size() >= 5) {
+                indexManager_->restoreIndex(IndexInfo(parts[0], parts[1], parts[2],
+                                                      static_cast<IndexType>(std::stoi(parts[3])),
+                                                      std::stoi(parts[4]) != 0));
+            }
+        }
+        indexStream.close();
+    }
+    
+    // 写入页文件后删除旧文件
+    if (!saveToStorage()) {
+        std::cerr << "Failed to migrate legacy database files" << std::endl;
+        return false;
+    }
+    for (const auto& legacyFile : legacyFiles) {
+        std::filesystem::remove(legacyFile);
+    }
+    std::cout << "Migrated legacy database files into " << dbFile << std::endl;
     return true;
 }
 
+std::string StorageEngine::getLogDirectory() const {
+    return dbPath_ + "/wal";
+}
+
 std::string StorageEngine::getMetadataFileName() const {
     return dbPath_ + "/metadata.meta";
 }
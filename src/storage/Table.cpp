@@ -1,20 +1,24 @@
 #include "../../include/storage/Table.h"
 #include "../../include/storage/PageManager.h"
+#include "../../include/storage/ByteOrder.h"
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
 #include <climits>
 
+// .tbl文件格式标记（二进制行格式）
+static const char* const TABLE_FILE_MAGIC = "#MINIDB-TBL 2";
+
 Table::Table(const std::string& tableName) 
-    : tableName_(tableName), pageManager_(nullptr), nextRecordId_(1) {}
+    : tableName_(tableName), primaryKeyIndexStale_(false), pageManager_(nullptr), rowCount_(0), extentNextPageId_(0), extentEndPageId_(0) {}
 
 Table::Table(const std::string& tableName, const std::vector<ColumnInfo>& columns) 
-    : tableName_(tableName), columns_(columns), pageManager_(nullptr), nextRecordId_(1) {
+    : tableName_(tableName), columns_(columns), primaryKeyIndexStale_(false), pageManager_(nullptr), rowCount_(0), extentNextPageId_(0), extentEndPageId_(0) {
     buildColumnIndex();
 }
 
 Table::Table(const std::string& tableName, const std::vector<ColumnInfo>& columns, PageManager* pageManager)
-    : tableName_(tableName), columns_(columns), pageManager_(pageManager), nextRecordId_(1) {
+    : tableName_(tableName), columns_(columns), primaryKeyIndexStale_(false), pageManager_(pageManager), rowCount_(0), extentNextPageId_(0), extentEndPageId_(0) {
     buildColumnIndex();
 }
 
@@ -36,7 +40,7 @@ int Table::getColumnIndex(const std::string& columnName) const {
     return (it != columnNameToIndex_.end()) ? static_cast<int>(it->second) : -1;
 }
 
-uint32_t Table::insertRow(const Row& row) {
+RID Table::insertRow(const Row& row) {
     if (!validateRow(row)) {
         throw std::invalid_argument("Row validation failed: column count mismatch");
     }
@@ -46,121 +50,80 @@ uint32_t Table::insertRow(const Row& row) {
         throw std::invalid_argument("Row validation failed: constraint violation");
     }
     
-    uint32_t recordId = allocateRecordId();
+    if (!pageManager_) {
+        throw std::runtime_error("Table '" + tableName_ + "' has no page storage");
+    }
     
-    // 如果有页面管理器，使用页式存储
-    if (pageManager_) {
-        if (insertRowToPage(row, recordId)) {
-            return recordId;
-        } else {
-            throw std::runtime_error("Failed to insert row to page storage");
-        }
-    } else {
-        // 回退到内存存储（兼容性）
-        rows_.push_back(row);
-        return recordId;
+    RID recordId = insertRowToPage(row);
+    if (recordId == INVALID_RID) {
+        throw std::runtime_error("Failed to insert row to page storage");
     }
+    ++rowCount_;
+    indexPrimaryKey(row, recordId);
+    return recordId;
 }
 
-uint32_t Table::insertRow(const std::vector<Value>& values) {
+RID Table::insertRow(const std::vector<Value>& values) {
     Row row(values);
     return insertRow(row);
 }
 
-uint32_t Table::fastInsertRow(const Row& row) {
+RID Table::fastInsertRow(const Row& row) {
     // 跳过所有验证和约束检查，直接插入
-    uint32_t recordId = allocateRecordId();
+    if (!pageManager_) {
+        throw std::runtime_error("Table '" + tableName_ + "' has no page storage");
+    }
+    // 主键索引必须在写入页面之前构建，否则扫描会把新记录也加入索引
+    ensurePrimaryKeyIndex();
     
-    // 如果有页面管理器，使用快速页式存储
-    if (pageManager_) {
-        if (fastInsertRowToPage(row, recordId)) {
-            return recordId;
-        } else {
-            throw std::runtime_error("Failed to fast insert row to page storage");
-        }
-    } else {
-        // 回退到内存存储（兼容性）
-        rows_.push_back(row);
-        return recordId;
+    RID recordId = fastInsertRowToPage(row);
+    if (recordId == INVALID_RID) {
+        throw std::runtime_error("Failed to fast insert row to page storage");
     }
+    ++rowCount_;
+    // 跳过约束检查，但主键索引仍需维护，否则后续插入的重复键检查会失效
+    indexPrimaryKey(row, recordId);
+    return recordId;
 }
 
-bool Table::deleteRow(uint32_t recordId) {
-    if (!pageManager_) {
-        // 内存存储的删除逻辑（简化）
-        return false;
-    }
-    
-    auto it = recordLocations_.find(recordId);
-    if (it == recordLocations_.end()) {
+bool Table::deleteRow(RID recordId) {
+    if (!pageManager_ || recordId == INVALID_RID) {
         return false;
     }
     
-    auto page = pageManager_->getPage(it->second.pageId);
+    // RID直接给出页面和槽位，不需要查找映射表
+    WritePageGuard page = pageManager_->fetchPageWrite(ridPageId(recordId));
     if (!page) {
         return false;
     }
     
-    bool result = page->deleteRecord(it->second.slotId);
+    // 删除前记下主键值，用于维护主键索引
+    ensurePrimaryKeyIndex();
+    Value oldKey;
+    bool hasOldKey = readPrimaryKey(recordId, oldKey);
     
-    if (result) {
-        // 在删除迭代器之前保存pageId
-        uint32_t pageId = it->second.pageId;
-        recordLocations_.erase(it);
-        
-        // compactPage()可能改变了页面中其他记录的slot分配，需要重建该页面的映射
-        rebuildPageRecordLocations(pageId);
-        
-        pageManager_->writePage(page);
+    // 日志中记录被删除的记录（前像），撤销时放回原槽位
+    std::string oldRecord;
+    if (pageManager_->isLogging()) {
+        oldRecord = page->getRecord(ridSlotId(recordId));
     }
     
-    return result;
-}
-
-void Table::rebuildPageRecordLocations(uint32_t pageId) {
-    auto page = pageManager_->getPage(pageId);
-    if (!page) {
-        return;
-    }
+    // 只把槽位标记为空，其他记录的槽位号保持不变，它们的RID依然有效
+    bool result = page->deleteRecord(ridSlotId(recordId));
     
-    // 先移除该页面的所有映射
-    std::vector<uint32_t> recordIdsToRemove;
-    for (const auto& pair : recordLocations_) {
-        if (pair.second.pageId == pageId) {
-            recordIdsToRemove.push_back(pair.first);
+    if (result) {
+        pageManager_->logPageChange(*page, LogRecordType::DELETE, ridSlotId(recordId), oldRecord);
+        if (hasOldKey) {
+            unindexPrimaryKey(oldKey, recordId);
         }
+        --rowCount_;
+        freeSpaceMap_.updatePage(page->getPageId(), page->getFreeSpace());
     }
     
-    for (uint32_t recordId : recordIdsToRemove) {
-        recordLocations_.erase(recordId);
-    }
-    
-    // 重新扫描页面，建立新的映射
-    uint16_t slotCount = page->getSlotCount();
-    
-    for (uint16_t slotId = 0; slotId < slotCount; ++slotId) {
-        std::string recordData = page->getRecord(slotId);
-        if (!recordData.empty()) {
-            // 从记录数据中提取recordId
-            Row row = Row::deserialize(recordData);
-            if (row.getFieldCount() > 0) {
-                // 假设第一个字段是主键（recordId）
-                auto firstField = row.getValue(0);
-                uint32_t recordId = 0;
-                if (std::holds_alternative<int>(firstField)) {
-                    recordId = static_cast<uint32_t>(std::get<int>(firstField));
-                } else {
-                    continue;
-                }
-                
-                // 建立新的映射
-                recordLocations_[recordId] = RecordLocation(pageId, slotId);
-            }
-        }
-    }
+    return result;
 }
 
-bool Table::updateRow(uint32_t recordId, const Row& newRow) {
+bool Table::updateRow(RID recordId, const Row& newRow, RID* newRecordId) {
     if (!validateRow(newRow)) {
         return false;
     }
@@ -171,177 +134,268 @@ bool Table::updateRow(uint32_t recordId, const Row& newRow) {
     }
     
     if (!pageManager_) {
-        // 内存存储的更新逻辑（简化）
-        if (recordId > 0 && recordId <= rows_.size()) {
-            rows_[recordId - 1] = newRow;
-            return true;
-        }
         return false;
     }
     
-    // 页式存储的更新逻辑
-    auto it = recordLocations_.find(recordId);
-    if (it == recordLocations_.end()) {
+    Value oldKey;
+    bool hasOldKey = readPrimaryKey(recordId, oldKey);
+    
+    RID movedRecordId = recordId;
+    if (!updateRowInPage(recordId, newRow, movedRecordId)) {
         return false;
     }
     
-    auto page = pageManager_->getPage(it->second.pageId);
+    // 主键值或记录位置发生变化时更新主键索引
+    if (primaryKeyIndex_ && hasOldKey) {
+        const Value& newKey = newRow.getValue(getPrimaryKeyColumnIndex());
+        if (newKey != oldKey || movedRecordId != recordId) {
+            unindexPrimaryKey(oldKey, recordId);
+            indexPrimaryKey(newRow, movedRecordId);
+        }
+    }
+    
+    if (newRecordId) {
+        *newRecordId = movedRecordId;
+    }
+    return true;
+}
+
+bool Table::updateRowInPage(RID recordId, const Row& newRow, RID& newRecordId) {
+    WritePageGuard page = pageManager_->fetchPageWrite(ridPageId(recordId));
     if (!page) {
         return false;
     }
     
     // 序列化新行数据
     std::string newRecordData = newRow.serialize();
+    std::string oldRecordData;
+    if (pageManager_->isLogging()) {
+        oldRecordData = page->getRecord(ridSlotId(recordId));
+    }
     
-    // 尝试就地更新记录
-    bool result = page->updateRecord(it->second.slotId, newRecordData);
-    if (result) {
-        pageManager_->writePage(page);
+    // 尝试在原页面内更新（必要时页面会压缩，槽位号保持不变）
+    if (page->updateRecord(ridSlotId(recordId), newRecordData)) {
+        pageManager_->logPageChange(*page, LogRecordType::UPDATE, ridSlotId(recordId), oldRecordData, newRecordData);
+        freeSpaceMap_.updatePage(page->getPageId(), page->getFreeSpace());
+        newRecordId = recordId;
         return true;
-    } else {
-        // 如果就地更新失败（可能是因为新数据太大），则使用删除后插入的策略
-        // 但是要保持相同的recordId以避免索引不一致问题
-        
-        // 先保存旧的位置信息
-        RecordLocation oldLocation = it->second;
-        
-        // 删除旧记录（但不从recordLocations_中移除）
-        page->deleteRecord(oldLocation.slotId);
-        pageManager_->writePage(page);
-        
-        // 尝试插入新记录到同一个页面
-        std::string newRecordData = newRow.serialize();
-        uint16_t newSlotId = page->insertRecordAndReturnSlot(newRecordData);
-        
-        if (newSlotId != UINT16_MAX) {
-            // 成功插入到同一页面，更新位置映射
-            recordLocations_[recordId] = RecordLocation(oldLocation.pageId, newSlotId);
-            // 重建该页面的所有记录映射以确保一致性
-            rebuildPageRecordLocations(oldLocation.pageId);
-            pageManager_->writePage(page);
-            return true;
-        } else {
-            // 同一页面空间不足，尝试插入到其他页面
-            if (insertRowToPage(newRow, recordId)) {
-                return true;
-            } else {
-                // 插入失败，恢复原记录（简化处理，实际应该更严谨）
-                return false;
-            }
-        }
     }
+    
+    // 原页面放不下新记录：先插入到其他页面，成功后再删除旧记录，失败时原记录保持不变
+    RID movedRecordId = insertRowToPage(newRow);
+    if (movedRecordId == INVALID_RID) {
+        return false;
+    }
+    
+    page->deleteRecord(ridSlotId(recordId));
+    pageManager_->logPageChange(*page, LogRecordType::DELETE, ridSlotId(recordId), oldRecordData);
+    freeSpaceMap_.updatePage(page->getPageId(), page->getFreeSpace());
+    newRecordId = movedRecordId;
+    return true;
 }
 
 RowIterator Table::begin() const {
-    if (pageManager_) {
-        // 使用页式存储时，需要重新构建内存数组用于迭代
-        // 这是一个临时解决方案，实际应该实现页面迭代器
-        const_cast<Table*>(this)->loadRowsFromPages();
-    }
-    return RowIterator(&rows_, 0);
+    return RowIterator(this, 0);
 }
 
 RowIterator Table::end() const {
-    if (pageManager_) {
-        const_cast<Table*>(this)->loadRowsFromPages();
-    }
-    return RowIterator(&rows_, rows_.size());
+    return RowIterator(this, freeSpaceMap_.getPageCount());
 }
 
 size_t Table::getRowCount() const {
-    if (pageManager_) {
-        return recordLocations_.size();
-    } else {
-        return rows_.size();
-    }
+    return rowCount_;
 }
 
-Row Table::getRow(uint32_t recordId) const {
-    if (!pageManager_) {
-        // 内存存储的简单实现
-        if (recordId > 0 && recordId <= rows_.size()) {
-            return rows_[recordId - 1];
-        }
+Row Table::getRow(RID recordId) const {
+    if (!pageManager_ || recordId == INVALID_RID) {
         return Row();
     }
     
-    auto it = recordLocations_.find(recordId);
-    if (it == recordLocations_.end()) {
+    ReadPageGuard page = pageManager_->fetchPageRead(ridPageId(recordId));
+    if (!page) {
         return Row();
     }
     
-    auto page = pageManager_->getPage(it->second.pageId);
-    if (!page) {
-        return Row();
+    // 直接从页面缓冲区解码，避免中间的std::string副本
+    RecordRef record = page->getRecordRef(ridSlotId(recordId));
+    return (record.isValid() && record.size > 0) ? Row::deserialize(record.data, record.size) : Row();
+}
+
+RowView Table::getRowView(RID recordId, ReadPageGuard& pageGuard) const {
+    pageGuard.release();
+    if (!pageManager_ || recordId == INVALID_RID) {
+        return RowView();
     }
     
-    std::string recordData = page->getRecord(it->second.slotId);
-    if (recordData.empty()) {
-        return Row();
+    pageGuard = pageManager_->fetchPageRead(ridPageId(recordId));
+    if (!pageGuard) {
+        return RowView();
+    }
+    
+    RecordRef record = pageGuard->getRecordRef(ridSlotId(recordId));
+    if (!record.isValid() || record.size == 0) {
+        return RowView();
     }
     
-    return Row::deserialize(recordData);
+    return RowView(record.data, record.size);
 }
 
 void Table::setPageManager(PageManager* pageManager) {
     pageManager_ = pageManager;
 }
 
-const std::string& Table::getTableName() const {
-    return tableName_;
+PageManager* Table::getPageManager() const {
+    return pageManager_;
+}
+
+const std::vector<uint32_t>& Table::getDataPageIds() const {
+    return freeSpaceMap_.getPageIds();
 }
 
-std::vector<uint32_t> Table::getAllRecordIds() const {
-    std::vector<uint32_t> recordIds;
+uint32_t Table::saveFreeSpaceMap() {
+    if (!pageManager_) {
+        return 0;
+    }
+    if (!freeSpaceMap_.isDirty()) {
+        return freeSpaceMap_.getRootPageId();
+    }
+    return freeSpaceMap_.save(pageManager_);
+}
+
+bool Table::loadStorage(uint32_t fsmRootPageId, size_t rowCount) {
+    if (!pageManager_) {
+        return false;
+    }
+    if (fsmRootPageId != 0 && !freeSpaceMap_.load(pageManager_, fsmRootPageId)) {
+        std::cerr << "Failed to load page directory for table " << tableName_ << std::endl;
+        return false;
+    }
     
-    if (pageManager_) {
-        // 页式存储，从recordLocations_获取所有recordId
-        for (const auto& pair : recordLocations_) {
-            recordIds.push_back(pair.first);
-        }
-    } else {
-        // 内存存储，recordId从1开始
-        for (size_t i = 0; i < rows_.size(); ++i) {
-            recordIds.push_back(static_cast<uint32_t>(i + 1));
-        }
+    rowCount_ = rowCount;
+    primaryKeyIndexStale_ = (primaryKeyIndex_ != nullptr);
+    return true;
+}
+
+void Table::releaseStorage() {
+    if (!pageManager_) {
+        return;
     }
     
-    return recordIds;
+    for (uint32_t pageId : freeSpaceMap_.getPageIds()) {
+        pageManager_->deallocatePage(pageId);
+    }
+    releaseUnusedExtent();
+    freeSpaceMap_.release(pageManager_);
+    rowCount_ = 0;
+    if (primaryKeyIndex_) {
+        primaryKeyIndex_ = std::make_unique<BPlusTree>();
+        primaryKeyIndexStale_ = false;
+    }
 }
 
-bool Table::validateRow(const Row& row) const {
-    return row.getFieldCount() == columns_.size();
+void Table::releaseUnusedExtent() {
+    if (!pageManager_) {
+        return;
+    }
+    while (extentNextPageId_ < extentEndPageId_) {
+        pageManager_->deallocatePage(extentNextPageId_++);
+    }
+    extentNextPageId_ = 0;
+    extentEndPageId_ = 0;
 }
 
-std::string Table::serialize() const {
-    std::ostringstream oss;
-    
-    // 序列化表名
-    oss << tableName_ << "\n";
+bool Table::containsDataPage(uint32_t pageId) const {
+    return freeSpaceMap_.containsPage(pageId);
+}
+
+void Table::recoverDataPage(uint32_t pageId) {
+    if (!pageManager_) {
+        return;
+    }
+    size_t freeBytes = 0;
+    {
+        ReadPageGuard page = pageManager_->fetchPageRead(pageId);
+        if (!page) {
+            return;
+        }
+        freeBytes = page->getFreeSpace();
+    }
+    freeSpaceMap_.addPage(pageId, freeBytes);
+    if (primaryKeyIndex_) {
+        primaryKeyIndex_ = std::make_unique<BPlusTree>();
+        primaryKeyIndexStale_ = true;
+    }
+}
+
+void Table::recoverRowCount(int64_t rowDelta) {
+    int64_t rowCount = static_cast<int64_t>(rowCount_) + rowDelta;
+    rowCount_ = rowCount > 0 ? static_cast<size_t>(rowCount) : 0;
+    if (primaryKeyIndex_) {
+        primaryKeyIndex_ = std::make_unique<BPlusTree>();
+        primaryKeyIndexStale_ = true;
+    }
+}
+
+size_t Table::vacuum(size_t minFragmentedBytes) {
+    if (!pageManager_) {
+        return 0;
+    }
     
-    // 序列化列信息
-    oss << columns_.size() << "\n";
-    for (const auto& col : columns_) {
-        oss << col.name << "|" << static_cast<int>(col.type) 
-            << "|" << (col.isNotNull ? 1 : 0) 
-            << "|" << (col.isPrimaryKey ? 1 : 0) << "\n";
+    size_t compactedPages = 0;
+    for (uint32_t pageId : freeSpaceMap_.getPageIds()) {
+        // 先用只读守卫检查，只有需要压缩的页面才以写方式获取（会被标记为脏页）
+        size_t fragmentedBytes = 0;
+        {
+            ReadPageGuard page = pageManager_->fetchPageRead(pageId);
+            if (!page) {
+                continue;
+            }
+            fragmentedBytes = page->getFragmentedBytes();
+        }
+        if (fragmentedBytes > 0 && fragmentedBytes >= minFragmentedBytes) {
+            // 压缩只把碎片变为连续空闲空间，页面的可用空间和空闲空间分类不变
+            WritePageGuard page = pageManager_->fetchPageWrite(pageId);
+            if (page) {
+                page->compactPage();
+                pageManager_->logPageChange(*page, LogRecordType::COMPACT);
+                ++compactedPages;
+            }
+        }
     }
+    return compactedPages;
+}
+
+const std::string& Table::getTableName() const {
+    return tableName_;
+}
+
+std::vector<RID> Table::getAllRecordIds() const {
+    std::vector<RID> recordIds;
+    recordIds.reserve(rowCount_);
     
-    // 序列化行数据
-    oss << rows_.size() << "\n";
-    for (const auto& row : rows_) {
-        oss << row.serialize() << "\n";
+    for (auto it = begin(); it != end(); ++it) {
+        recordIds.push_back(it.getRID());
     }
     
-    return oss.str();
+    return recordIds;
 }
 
-Table Table::deserialize(const std::string& data) {
+bool Table::validateRow(const Row& row) const {
+    return row.getFieldCount() == columns_.size();
+}
+
+Table Table::deserialize(const std::string& data, PageManager* pageManager) {
     std::istringstream iss(data);
     std::string line;
     
-    // 读取表名
+    // 识别文件格式：新格式以格式标记开头，旧格式直接以表名开头且每行是一条文本记录
     std::getline(iss, line);
+    bool legacyFormat = (line != TABLE_FILE_MAGIC);
+    if (!legacyFormat) {
+        std::getline(iss, line);
+    }
+    
+    // 读取表名
     std::string tableName = line;
     
     // 读取列数量
@@ -374,16 +428,30 @@ Table Table::deserialize(const std::string& data) {
         }
     }
     
-    Table table(tableName, columns);
+    // 行数据写入页式存储
+    Table table(tableName, columns, pageManager);
     
     // 读取行数量
     std::getline(iss, line);
     auto rowCount = std::stoull(line);
     
     for (size_t i = 0; i < rowCount; ++i) {
-        std::getline(iss, line);
-        Row row = Row::deserialize(line);
-        table.insertRow(row);
+        if (legacyFormat) {
+            // 迁移路径：旧的文本记录在重新插入时会被编码为二进制格式
+            std::getline(iss, line);
+            table.insertRow(Row::deserialize(line));
+            continue;
+        }
+        
+        uint8_t lengthBytes[sizeof(uint32_t)];
+        if (!iss.read(reinterpret_cast<char*>(lengthBytes), sizeof(lengthBytes))) {
+            break;
+        }
+        std::string record(byteorder::loadLE<uint32_t>(lengthBytes), '\0');
+        if (!iss.read(&record[0], record.size())) {
+            break;
+        }
+        table.insertRow(Row::deserialize(record));
     }
     
     return table;
@@ -406,23 +474,11 @@ void Table::printSchema() const {
 void Table::printData() const {
     std::cout << "Data in table " << tableName_ << ":" << std::endl;
     
-    if (pageManager_) {
-        // 使用页式存储时，从页面中读取数据
-        for (const auto& pair : recordLocations_) {
-            uint32_t recordId = pair.first;
-            Row row = getRow(recordId);
-            if (row.getFieldCount() > 0) {
-                std::cout << "  [" << recordId << "] " << row.toString() << std::endl;
-            }
-        }
-        std::cout << "Total rows: " << recordLocations_.size() << std::endl;
-    } else {
-        // 内存存储
-        for (const auto& row : rows_) {
-            std::cout << "  " << row.toString() << std::endl;
-        }
-        std::cout << "Total rows: " << rows_.size() << std::endl;
+    for (auto it = begin(); it != end(); ++it) {
+        std::cout << "  [" << it.getPageId() << ":" << it.getSlotId() << "] " 
+                  << it->toString() << std::endl;
     }
+    std::cout << "Total rows: " << rowCount_ << std::endl;
 }
 
 void Table::buildColumnIndex() {
@@ -430,137 +486,135 @@ void Table::buildColumnIndex() {
     for (size_t i = 0; i < columns_.size(); ++i) {
         columnNameToIndex_[columns_[i].name] = i;
     }
+    
+    // 表声明了主键时创建隐式唯一索引
+    if (hasPrimaryKeyColumn() && !primaryKeyIndex_) {
+        primaryKeyIndex_ = std::make_unique<BPlusTree>();
+    }
 }
 
-uint32_t Table::allocateRecordId() {
-    return nextRecordId_++;
-}
-
-bool Table::insertRowToPage(const Row& row, uint32_t recordId) {
-    if (!pageManager_) {
-        return false;
+void Table::ensurePrimaryKeyIndex() const {
+    if (!primaryKeyIndexStale_) {
+        return;
     }
+    primaryKeyIndexStale_ = false;
     
-    // 序列化行数据
-    std::string serializedRow = row.serialize();
-    
-    // 尝试在现有页面中插入
-    for (uint32_t pageId : dataPageIds_) {
-        auto page = pageManager_->getPage(pageId);
-        if (page && page->hasSpace(serializedRow.size())) {
-            uint16_t slotId = page->insertRecordAndReturnSlot(serializedRow);
-            if (slotId != UINT16_MAX) {
-                // 记录插入成功，保存位置信息
-                recordLocations_[recordId] = RecordLocation(pageId, slotId);
-                pageManager_->writePage(page);
-                return true;
-            }
-        }
+    // 流式扫描数据页，只解码主键列
+    int pkIndex = getPrimaryKeyColumnIndex();
+    for (auto it = begin(); it != end(); ++it) {
+        primaryKeyIndex_->insert(it.view().getValue(pkIndex), it.getRID());
     }
-    
-    // 现有页面都没有足够空间，分配新页面
-    uint32_t newPageId = pageManager_->allocatePage(PageType::DATA_PAGE);
-    if (newPageId == 0) {
+}
+
+bool Table::readPrimaryKey(RID recordId, Value& key) const {
+    int pkIndex = getPrimaryKeyColumnIndex();
+    if (pkIndex == -1) {
         return false;
     }
     
-    auto newPage = pageManager_->getPage(newPageId);
-    if (!newPage) {
-        pageManager_->deallocatePage(newPageId);
+    // 只解码主键列
+    ReadPageGuard page;
+    RowView view = getRowView(recordId, page);
+    if (!view.isValid() || static_cast<size_t>(pkIndex) >= view.getFieldCount()) {
         return false;
     }
-    
-    uint16_t slotId = newPage->insertRecordAndReturnSlot(serializedRow);
-    if (slotId != UINT16_MAX) {
-        dataPageIds_.push_back(newPageId);
-        recordLocations_[recordId] = RecordLocation(newPageId, slotId);
-        pageManager_->writePage(newPage);
-        return true;
+    key = view.getValue(pkIndex);
+    return true;
+}
+
+void Table::indexPrimaryKey(const Row& row, RID recordId) {
+    if (!primaryKeyIndex_) {
+        return;
     }
-    
-    pageManager_->deallocatePage(newPageId);
-    return false;
+    primaryKeyIndex_->insert(row.getValue(getPrimaryKeyColumnIndex()), recordId);
+}
+
+void Table::unindexPrimaryKey(const Value& key, RID recordId) {
+    if (!primaryKeyIndex_) {
+        return;
+    }
+    primaryKeyIndex_->remove(key, recordId);
 }
 
-bool Table::fastInsertRowToPage(const Row& row, uint32_t recordId) {
+RID Table::insertRowToPage(const Row& row) {
     if (!pageManager_) {
-        return false;
+        return INVALID_RID;
     }
-    
-    // 序列化行数据
-    std::string serializedRow = row.serialize();
-    
-    // 优化：缓存最后使用的页面，减少页面查找
-    static uint32_t lastUsedPageId = 0;
-    
-    // 先尝试最后使用的页面
-    if (lastUsedPageId != 0) {
-        auto page = pageManager_->getPage(lastUsedPageId);
-        if (page && page->hasSpace(serializedRow.size())) {
-            uint16_t slotId = page->insertRecordAndReturnSlot(serializedRow);
-            if (slotId != UINT16_MAX) {
-                recordLocations_[recordId] = RecordLocation(lastUsedPageId, slotId);
-                // 关键优化：不立即写盘，延迟到批量操作结束
-                return true;
-            }
-        }
+    return insertRecordToPage(row.serialize());
+}
+
+RID Table::fastInsertRowToPage(const Row& row) {
+    if (!pageManager_) {
+        return INVALID_RID;
     }
+    // 关键优化：不立即写盘，延迟到批量操作结束
+    return insertRecordToPage(row.serialize());
+}
+
+RID Table::insertRecordToPage(const std::string& record) {
+    // 记录本身、长度字段以及hasSpace要求的额外余量
+    size_t requiredBytes = record.size() + 2 * sizeof(uint16_t);
     
-    // 尝试在现有页面中插入
-    for (uint32_t pageId : dataPageIds_) {
-        auto page = pageManager_->getPage(pageId);
-        if (page && page->hasSpace(serializedRow.size())) {
-            uint16_t slotId = page->insertRecordAndReturnSlot(serializedRow);
+    // 通过空闲空间映射直接定位有足够空间的页面，不需要逐页读取
+    uint32_t pageId = freeSpaceMap_.findPage(requiredBytes);
+    if (pageId != 0) {
+        WritePageGuard page = pageManager_->fetchPageWrite(pageId);
+        if (page) {
+            uint16_t slotId = page->insertRecordAndReturnSlot(record);
+            freeSpaceMap_.updatePage(pageId, page->getFreeSpace());
             if (slotId != UINT16_MAX) {
-                recordLocations_[recordId] = RecordLocation(pageId, slotId);
-                lastUsedPageId = pageId; // 缓存这个页面
-                // 关键优化：不立即写盘
-                return true;
+                pageManager_->logPageChange(*page, LogRecordType::INSERT, slotId, std::string(), record);
+                return makeRID(pageId, slotId);
             }
         }
     }
     
-    // 现有页面都没有足够空间，分配新页面
-    uint32_t newPageId = pageManager_->allocatePage(PageType::DATA_PAGE);
+    // 没有页面有足够空间，分配新页面
+    uint32_t newPageId = allocateDataPage();
     if (newPageId == 0) {
-        return false;
-    }
-    
-    auto newPage = pageManager_->getPage(newPageId);
-    if (!newPage) {
-        pageManager_->deallocatePage(newPageId);
-        return false;
+        return INVALID_RID;
     }
     
-    uint16_t slotId = newPage->insertRecordAndReturnSlot(serializedRow);
-    if (slotId != UINT16_MAX) {
-        dataPageIds_.push_back(newPageId);
-        recordLocations_[recordId] = RecordLocation(newPageId, slotId);
-        lastUsedPageId = newPageId; // 缓存新页面
-        // 关键优化：不立即写盘
-        return true;
+    {
+        WritePageGuard newPage = pageManager_->fetchPageWrite(newPageId);
+        if (newPage) {
+            uint16_t slotId = newPage->insertRecordAndReturnSlot(record);
+            if (slotId != UINT16_MAX) {
+                pageManager_->logPageChange(*newPage, LogRecordType::INSERT, slotId, std::string(), record);
+                // 数据页链表保存在元数据中，恢复时按日志把新页面加回表中
+                if (pageManager_->isLogging()) {
+                    TablePageLogRecord added;
+                    added.tableName = tableName_;
+                    added.pageId = newPageId;
+                    pageManager_->logOperation(LogRecordType::TABLE_ADD_PAGE, added.encode());
+                }
+                freeSpaceMap_.addPage(newPageId, newPage->getFreeSpace());
+                return makeRID(newPageId, slotId);
+            }
+        }
     }
     
+    // 释放守卫之后再回收页面
     pageManager_->deallocatePage(newPageId);
-    return false;
+    return INVALID_RID;
 }
 
-void Table::loadRowsFromPages() {
-    if (!pageManager_) {
-        return;
-    }
-    
-    // 清空内存数组
-    rows_.clear();
-    
-    // 从页面中加载所有数据
-    for (const auto& pair : recordLocations_) {
-        uint32_t recordId = pair.first;
-        Row row = getRow(recordId);
-        if (row.getFieldCount() > 0) {
-            rows_.push_back(row);
+uint32_t Table::allocateDataPage() {
+    if (extentNextPageId_ == extentEndPageId_) {
+        // 当前区段已用完：紧接在表的最后一个数据页之后申请新区段，使表的数据页在文件中连续存放
+        const std::vector<uint32_t>& pageIds = freeSpaceMap_.getPageIds();
+        uint32_t goalPageId = pageIds.empty() ? 0 : pageIds.back() + 1;
+        uint32_t firstPageId = pageManager_->allocateExtent(TABLE_EXTENT_PAGES, goalPageId);
+        if (firstPageId == 0) {
+            return 0;
         }
+        extentNextPageId_ = firstPageId;
+        extentEndPageId_ = firstPageId + TABLE_EXTENT_PAGES;
     }
+    
+    uint32_t pageId = extentNextPageId_++;
+    pageManager_->formatPage(pageId, PageType::DATA_PAGE);
+    return pageId;
 }
 
 bool Table::validateConstraints(const Row& row) const {
@@ -582,7 +636,7 @@ bool Table::validateConstraints(const Row& row) const {
     return true;
 }
 
-bool Table::validateConstraints(const Row& row, uint32_t excludeRecordId) const {
+bool Table::validateConstraints(const Row& row, RID excludeRecordId) const {
     // 检查列数是否匹配
     if (row.getFieldCount() != columns_.size()) {
         return false;
@@ -622,136 +676,41 @@ bool Table::checkNotNullConstraints(const Row& row) const {
 }
 
 bool Table::checkPrimaryKeyConstraint(const Row& row) const {
+    // INVALID_RID不会排除任何记录
+    return checkPrimaryKeyConstraint(row, INVALID_RID);
+}
+
+bool Table::checkPrimaryKeyConstraint(const Row& row, RID excludeRecordId) const {
     int pkIndex = getPrimaryKeyColumnIndex();
-    if (pkIndex == -1) {
+    if (pkIndex == -1 || !primaryKeyIndex_) {
         return true; // 没有主键列，不需要检查
     }
     
     const Value& pkValue = row.getValue(pkIndex);
+    ensurePrimaryKeyIndex();
     
-    // 检查主键值是否与现有记录重复
-    // 首先确保数据已加载
-    const_cast<Table*>(this)->loadRowsFromPages();
-    
-    for (const auto& existingRow : rows_) {
-        const Value& existingPkValue = existingRow.getValue(pkIndex);
-        
-        // 比较主键值
-        if (std::holds_alternative<int>(pkValue) && std::holds_alternative<int>(existingPkValue)) {
-            if (std::get<int>(pkValue) == std::get<int>(existingPkValue)) {
-                std::cerr << "PRIMARY KEY constraint violation: Duplicate key value " 
-                          << std::get<int>(pkValue) << " in column '" 
-                          << columns_[pkIndex].name << "'" << std::endl;
-                return false;
-            }
-        } else if (std::holds_alternative<std::string>(pkValue) && std::holds_alternative<std::string>(existingPkValue)) {
-            if (std::get<std::string>(pkValue) == std::get<std::string>(existingPkValue)) {
-                std::cerr << "PRIMARY KEY constraint violation: Duplicate key value '" 
-                          << std::get<std::string>(pkValue) << "' in column '" 
-                          << columns_[pkIndex].name << "'" << std::endl;
-                return false;
-            }
-        } else if (std::holds_alternative<double>(pkValue) && std::holds_alternative<double>(existingPkValue)) {
-            if (std::get<double>(pkValue) == std::get<double>(existingPkValue)) {
-                std::cerr << "PRIMARY KEY constraint violation: Duplicate key value " 
-                          << std::get<double>(pkValue) << " in column '" 
-                          << columns_[pkIndex].name << "'" << std::endl;
-                return false;
-            }
-        }
+    // 通过主键索引检查重复，O(log n)
+    std::vector<RID> existing = primaryKeyIndex_->search(pkValue);
+    if (existing.empty()) {
+        return true;
     }
     
-    return true;
-}
-
-bool Table::checkPrimaryKeyConstraint(const Row& row, uint32_t excludeRecordId) const {
-    int pkIndex = getPrimaryKeyColumnIndex();
-    if (pkIndex == -1) {
-        return true; // 没有主键列，不需要检查
+    // 键已存在：如果它正是被排除的记录（更新时主键未改变），则不算冲突
+    if (excludeRecordId != INVALID_RID && existing.size() == 1 && existing[0] == excludeRecordId) {
+        return true;
     }
     
-    const Value& pkValue = row.getValue(pkIndex);
-    
-    // 检查主键值是否与现有记录重复（排除指定记录）
-    if (pageManager_) {
-        // 使用页式存储时，遍历recordLocations_来检查
-        for (const auto& pair : recordLocations_) {
-            uint32_t existingRecordId = pair.first;
-            
-            // 跳过我们要排除的记录
-            if (existingRecordId == excludeRecordId) {
-                continue;
-            }
-            
-            Row existingRow = getRow(existingRecordId);
-            if (existingRow.getFieldCount() == 0) {
-                continue; // 跳过无效记录
-            }
-            
-            const Value& existingPkValue = existingRow.getValue(pkIndex);
-            
-            // 比较主键值
-            if (std::holds_alternative<int>(pkValue) && std::holds_alternative<int>(existingPkValue)) {
-                if (std::get<int>(pkValue) == std::get<int>(existingPkValue)) {
-                    std::cerr << "PRIMARY KEY constraint violation: Duplicate key value " 
-                              << std::get<int>(pkValue) << " in column '" 
-                              << columns_[pkIndex].name << "'" << std::endl;
-                    return false;
-                }
-            } else if (std::holds_alternative<std::string>(pkValue) && std::holds_alternative<std::string>(existingPkValue)) {
-                if (std::get<std::string>(pkValue) == std::get<std::string>(existingPkValue)) {
-                    std::cerr << "PRIMARY KEY constraint violation: Duplicate key value '" 
-                              << std::get<std::string>(pkValue) << "' in column '" 
-                              << columns_[pkIndex].name << "'" << std::endl;
-                    return false;
-                }
-            } else if (std::holds_alternative<double>(pkValue) && std::holds_alternative<double>(existingPkValue)) {
-                if (std::get<double>(pkValue) == std::get<double>(existingPkValue)) {
-                    std::cerr << "PRIMARY KEY constraint violation: Duplicate key value " 
-                              << std::get<double>(pkValue) << " in column '" 
-                              << columns_[pkIndex].name << "'" << std::endl;
-                    return false;
-                }
-            }
-        }
-    } else {
-        // 内存存储的检查逻辑（简化）
-        for (size_t i = 0; i < rows_.size(); ++i) {
-            // 跳过我们要排除的记录（内存存储中recordId从1开始）
-            if (static_cast<uint32_t>(i + 1) == excludeRecordId) {
-                continue;
-            }
-            
-            const Row& existingRow = rows_[i];
-            const Value& existingPkValue = existingRow.getValue(pkIndex);
-            
-            // 比较主键值
-            if (std::holds_alternative<int>(pkValue) && std::holds_alternative<int>(existingPkValue)) {
-                if (std::get<int>(pkValue) == std::get<int>(existingPkValue)) {
-                    std::cerr << "PRIMARY KEY constraint violation: Duplicate key value " 
-                              << std::get<int>(pkValue) << " in column '" 
-                              << columns_[pkIndex].name << "'" << std::endl;
-                    return false;
-                }
-            } else if (std::holds_alternative<std::string>(pkValue) && std::holds_alternative<std::string>(existingPkValue)) {
-                if (std::get<std::string>(pkValue) == std::get<std::string>(existingPkValue)) {
-                    std::cerr << "PRIMARY KEY constraint violation: Duplicate key value '" 
-                              << std::get<std::string>(pkValue) << "' in column '" 
-                              << columns_[pkIndex].name << "'" << std::endl;
-                    return false;
-                }
-            } else if (std::holds_alternative<double>(pkValue) && std::holds_alternative<double>(existingPkValue)) {
-                if (std::get<double>(pkValue) == std::get<double>(existingPkValue)) {
-                    std::cerr << "PRIMARY KEY constraint violation: Duplicate key value " 
-                              << std::get<double>(pkValue) << " in column '" 
-                              << columns_[pkIndex].name << "'" << std::endl;
-                    return false;
-                }
-            }
+    std::cerr << "PRIMARY KEY constraint violation: Duplicate key value ";
+    std::visit([](const auto& v) {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, std::string>) {
+            std::cerr << "'" << v << "'";
+        } else {
+            std::cerr << v;
         }
-    }
-    
-    return true;
+    }, pkValue);
+    std::cerr << " in column '" << columns_[pkIndex].name << "'" << std::endl;
+    return false;
 }
 
 bool Table::hasPrimaryKeyColumn() const {
@@ -0,0 +1,1081 @@
+#include "../../include/storage/WriteAheadLog.h"
+#include "../../include/storage/ByteOrder.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 记录头中各字段的偏移
+constexpr size_t CRC_OFFSET = 0;
+constexpr size_t LENGTH_OFFSET = CRC_OFFSET + sizeof(uint32_t);
+constexpr size_t LSN_OFFSET = LENGTH_OFFSET + sizeof(uint32_t);
+constexpr size_t TXN_OFFSET = LSN_OFFSET + sizeof(uint64_t);
+constexpr size_t PREV_LSN_OFFSET = TXN_OFFSET + sizeof(uint64_t);
+constexpr size_t TYPE_OFFSET = PREV_LSN_OFFSET + sizeof(uint64_t);
+
+constexpr size_t PAGE_RECORD_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint16_t) + sizeof(uint32_t);
+
+// 检查点文件：[u32 魔数][u64 检查点记录LSN][u32 前12字节的CRC32]
+constexpr uint32_t CHECKPOINT_FILE_MAGIC = 0x4B435057; // "WPCK"
+constexpr size_t CHECKPOINT_FILE_SIZE = sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+
+// CRC-32（IEEE 802.3，反射多项式0xEDB88320）
+const std::array<uint32_t, 256>& crcTable() {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> result{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+            }
+            result[i] = crc;
+        }
+        return result;
+    }();
+    return table;
+}
+
+uint32_t crc32(const uint8_t* data, size_t size) {
+    const auto& table = crcTable();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// 检查data处是否是LSN为expectedLsn的完整记录，是则返回记录长度，否则返回0
+size_t validRecordLength(const uint8_t* data, size_t available, uint64_t expectedLsn) {
+    if (available < WriteAheadLog::RECORD_HEADER_SIZE) {
+        return 0;
+    }
+    uint32_t length = byteorder::loadLE<uint32_t>(data + LENGTH_OFFSET);
+    if (length < WriteAheadLog::RECORD_HEADER_SIZE || length > available ||
+        byteorder::loadLE<uint64_t>(data + LSN_OFFSET) != expectedLsn) {
+        return 0;
+    }
+    if (crc32(data + LENGTH_OFFSET, length - LENGTH_OFFSET) != byteorder::loadLE<uint32_t>(data + CRC_OFFSET)) {
+        return 0;
+    }
+    return length;
+}
+
+// 从已校验的记录中取出各字段
+void decodeRecord(const uint8_t* data, size_t length, LogRecord& record) {
+    record.lsn = byteorder::loadLE<uint64_t>(data + LSN_OFFSET);
+    record.txnId = byteorder::loadLE<uint64_t>(data + TXN_OFFSET);
+    record.prevLsn = byteorder::loadLE<uint64_t>(data + PREV_LSN_OFFSET);
+    record.type = static_cast<LogRecordType>(data[TYPE_OFFSET]);
+    record.payload.assign(reinterpret_cast<const char*>(data) + WriteAheadLog::RECORD_HEADER_SIZE,
+                          length - WriteAheadLog::RECORD_HEADER_SIZE);
+}
+
+// 日志文件的底层读写（Windows上用CRT的低级I/O）
+int openFile(const std::string& path) {
+#ifdef _WIN32
+    return _open(path.c_str(), _O_RDWR | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+#endif
+}
+
+int openFileForRead(const std::string& path) {
+#ifdef _WIN32
+    return _open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    return open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+}
+
+void closeFile(int fd) {
+#ifdef _WIN32
+    _close(fd);
+#else
+    close(fd);
+#endif
+}
+
+bool writeAt(int fd, const char* data, size_t size, uint64_t offset) {
+#ifdef _WIN32
+    if (_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0) {
+        return false;
+    }
+    while (size > 0) {
+        int written = _write(fd, data, static_cast<unsigned>(std::min<size_t>(size, 1u << 30)));
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+#else
+    while (size > 0) {
+        ssize_t written = pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+#endif
+}
+
+size_t readAt(int fd, char* data, size_t size, uint64_t offset) {
+    size_t total = 0;
+#ifdef _WIN32
+    if (_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0) {
+        return 0;
+    }
+    while (total < size) {
+        int got = _read(fd, data + total, static_cast<unsigned>(std::min<size_t>(size - total, 1u << 30)));
+        if (got <= 0) {
+            break;
+        }
+        total += static_cast<size_t>(got);
+    }
+#else
+    while (total < size) {
+        ssize_t got = pread(fd, data + total, size - total, static_cast<off_t>(offset + total));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;
+        }
+        total += static_cast<size_t>(got);
+    }
+#endif
+    return total;
+}
+
+bool syncFile(int fd) {
+#ifdef _WIN32
+    return _commit(fd) == 0;
+#elif defined(__APPLE__)
+    return fsync(fd) == 0;
+#else
+    return fdatasync(fd) == 0;
+#endif
+}
+
+bool resizeFile(int fd, uint64_t size) {
+#ifdef _WIN32
+    return _chsize_s(fd, static_cast<__int64>(size)) == 0;
+#else
+    return ftruncate(fd, static_cast<off_t>(size)) == 0;
+#endif
+}
+
+// 新建段文件后同步目录，保证崩溃后文件本身存在
+void syncDirectory(const std::string& directory) {
+#ifndef _WIN32
+    int fd = open(directory.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+#else
+    (void)directory;
+#endif
+}
+
+// 段文件名：wal_<8位段号>.log，不是段文件时返回0
+uint64_t parseSegmentNo(const std::string& fileName) {
+    const std::string prefix = "wal_";
+    const std::string suffix = ".log";
+    if (fileName.size() <= prefix.size() + suffix.size() || fileName.compare(0, prefix.size(), prefix) != 0 ||
+        fileName.compare(fileName.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        return 0;
+    }
+    std::string digits = fileName.substr(prefix.size(), fileName.size() - prefix.size() - suffix.size());
+    if (digits.empty() || !std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        return 0;
+    }
+    return std::stoull(digits);
+}
+
+} // namespace
+
+// ==================== PageLogRecord ====================
+
+std::string PageLogRecord::encode() const {
+    return encode(pageId, slotId, before, after);
+}
+
+std::string PageLogRecord::encode(uint32_t pageId, uint16_t slotId, const std::string& before,
+                                  const std::string& after) {
+    std::string payload;
+    payload.reserve(PAGE_RECORD_HEADER_SIZE + before.size() + after.size());
+    payload.resize(PAGE_RECORD_HEADER_SIZE);
+    uint8_t* out = reinterpret_cast<uint8_t*>(&payload[0]);
+    byteorder::storeLE<uint32_t>(out, pageId);
+    byteorder::storeLE<uint16_t>(out + sizeof(uint32_t), slotId);
+    byteorder::storeLE<uint32_t>(out + sizeof(uint32_t) + sizeof(uint16_t), static_cast<uint32_t>(before.size()));
+    payload.append(before);
+    payload.append(after);
+    return payload;
+}
+
+bool PageLogRecord::decode(const std::string& payload) {
+    if (payload.size() < PAGE_RECORD_HEADER_SIZE) {
+        return false;
+    }
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(payload.data());
+    uint32_t beforeSize = byteorder::loadLE<uint32_t>(in + sizeof(uint32_t) + sizeof(uint16_t));
+    if (payload.size() - PAGE_RECORD_HEADER_SIZE < beforeSize) {
+        return false;
+    }
+    pageId = byteorder::loadLE<uint32_t>(in);
+    slotId = byteorder::loadLE<uint16_t>(in + sizeof(uint32_t));
+    before.assign(payload, PAGE_RECORD_HEADER_SIZE, beforeSize);
+    after.assign(payload, PAGE_RECORD_HEADER_SIZE + beforeSize, std::string::npos);
+    return true;
+}
+
+uint32_t PageLogRecord::peekPageId(const std::string& payload) {
+    if (payload.size() < PAGE_RECORD_HEADER_SIZE) {
+        return 0;
+    }
+    return byteorder::loadLE<uint32_t>(reinterpret_cast<const uint8_t*>(payload.data()));
+}
+
+// ==================== CompensationLogRecord ====================
+
+std::string CompensationLogRecord::encode() const {
+    std::string payload(sizeof(uint64_t) + sizeof(uint8_t), '\0');
+    uint8_t* out = reinterpret_cast<uint8_t*>(&payload[0]);
+    byteorder::storeLE<uint64_t>(out, undoNextLsn);
+    out[sizeof(uint64_t)] = static_cast<uint8_t>(type);
+    payload.append(pageRecord);
+    return payload;
+}
+
+bool CompensationLogRecord::decode(const std::string& payload) {
+    if (payload.size() < sizeof(uint64_t) + sizeof(uint8_t) + PAGE_RECORD_HEADER_SIZE) {
+        return false;
+    }
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(payload.data());
+    undoNextLsn = byteorder::loadLE<uint64_t>(in);
+    type = static_cast<LogRecordType>(in[sizeof(uint64_t)]);
+    pageRecord.assign(payload, sizeof(uint64_t) + sizeof(uint8_t), std::string::npos);
+    return true;
+}
+
+// ==================== CheckpointLogRecord ====================
+
+std::string CheckpointLogRecord::encode() const {
+    const size_t entrySize = 2 * sizeof(uint64_t);
+    const size_t headerSize = sizeof(uint64_t) + sizeof(uint32_t);
+    const size_t pageEntrySize = sizeof(uint32_t) + sizeof(uint64_t);
+    std::string payload(headerSize + activeTransactions.size() * entrySize + headerSize +
+                        dirtyPages.size() * pageEntrySize, '\0');
+    uint8_t* out = reinterpret_cast<uint8_t*>(&payload[0]);
+    byteorder::storeLE<uint64_t>(out, redoLsn);
+    byteorder::storeLE<uint32_t>(out + sizeof(uint64_t), static_cast<uint32_t>(activeTransactions.size()));
+    out += headerSize;
+    for (const auto& [txnId, lastLsn] : activeTransactions) {
+        byteorder::storeLE<uint64_t>(out, txnId);
+        byteorder::storeLE<uint64_t>(out + sizeof(uint64_t), lastLsn);
+        out += entrySize;
+    }
+    byteorder::storeLE<uint64_t>(out, dirtyPageTableLsn);
+    byteorder::storeLE<uint32_t>(out + sizeof(uint64_t), static_cast<uint32_t>(dirtyPages.size()));
+    out += headerSize;
+    for (const auto& [pageId, recLsn] : dirtyPages) {
+        byteorder::storeLE<uint32_t>(out, pageId);
+        byteorder::storeLE<uint64_t>(out + sizeof(uint32_t), recLsn);
+        out += pageEntrySize;
+    }
+    return payload;
+}
+
+bool CheckpointLogRecord::decode(const std::string& payload) {
+    const size_t entrySize = 2 * sizeof(uint64_t);
+    const size_t headerSize = sizeof(uint64_t) + sizeof(uint32_t);
+    if (payload.size() < headerSize) {
+        return false;
+    }
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(payload.data());
+    uint32_t count = byteorder::loadLE<uint32_t>(in + sizeof(uint64_t));
+    if ((payload.size() - headerSize) / entrySize < count) {
+        return false;
+    }
+    redoLsn = byteorder::loadLE<uint64_t>(in);
+    activeTransactions.clear();
+    activeTransactions.reserve(count);
+    in += headerSize;
+    for (uint32_t i = 0; i < count; ++i, in += entrySize) {
+        activeTransactions.emplace_back(byteorder::loadLE<uint64_t>(in), byteorder::loadLE<uint64_t>(in + sizeof(uint64_t)));
+    }
+    
+    // 脏页表（没有时是旧格式的检查点记录）
+    dirtyPageTableLsn = 0;
+    dirtyPages.clear();
+    size_t remaining = payload.size() - headerSize - count * entrySize;
+    if (remaining == 0) {
+        return true;
+    }
+    const size_t pageEntrySize = sizeof(uint32_t) + sizeof(uint64_t);
+    uint32_t pageCount = remaining >= headerSize ? byteorder::loadLE<uint32_t>(in + sizeof(uint64_t)) : 0;
+    if (remaining < headerSize || (remaining - headerSize) / pageEntrySize < pageCount) {
+        return false;
+    }
+    dirtyPageTableLsn = byteorder::loadLE<uint64_t>(in);
+    dirtyPages.reserve(pageCount);
+    in += headerSize;
+    for (uint32_t i = 0; i < pageCount; ++i, in += pageEntrySize) {
+        dirtyPages.emplace_back(byteorder::loadLE<uint32_t>(in), byteorder::loadLE<uint64_t>(in + sizeof(uint32_t)));
+    }
+    return true;
+}
+
+// ==================== TablePageLogRecord ====================
+
+std::string TablePageLogRecord::encode() const {
+    std::string payload(sizeof(uint16_t) + tableName.size() + sizeof(uint32_t), '\0');
+    uint8_t* out = reinterpret_cast<uint8_t*>(&payload[0]);
+    byteorder::storeLE<uint16_t>(out, static_cast<uint16_t>(tableName.size()));
+    std::memcpy(out + sizeof(uint16_t), tableName.data(), tableName.size());
+    byteorder::storeLE<uint32_t>(out + sizeof(uint16_t) + tableName.size(), pageId);
+    return payload;
+}
+
+bool TablePageLogRecord::decode(const std::string& payload) {
+    if (payload.size() < sizeof(uint16_t)) {
+        return false;
+    }
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(payload.data());
+    uint16_t nameSize = byteorder::loadLE<uint16_t>(in);
+    if (payload.size() != sizeof(uint16_t) + nameSize + sizeof(uint32_t)) {
+        return false;
+    }
+    tableName.assign(payload, sizeof(uint16_t), nameSize);
+    pageId = byteorder::loadLE<uint32_t>(in + sizeof(uint16_t) + nameSize);
+    return true;
+}
+
+// ==================== SynchronousMode ====================
+
+const char* synchronousModeName(SynchronousMode mode) {
+    switch (mode) {
+        case SynchronousMode::OFF: return "off";
+        case SynchronousMode::NORMAL: return "normal";
+        case SynchronousMode::FULL: return "full";
+    }
+    return "unknown";
+}
+
+bool parseSynchronousMode(const std::string& text, SynchronousMode& mode) {
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "off" || lower == "0") {
+        mode = SynchronousMode::OFF;
+    } else if (lower == "normal" || lower == "1") {
+        mode = SynchronousMode::NORMAL;
+    } else if (lower == "full" || lower == "2") {
+        mode = SynchronousMode::FULL;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// ==================== WriteAheadLog ====================
+
+WriteAheadLog::WriteAheadLog(const std::string& directory, const WalConfig& config)
+    : directory_(directory), config_(config), firstLsn_(SEGMENT_SIZE), openEndLsn_(SEGMENT_SIZE), checkpointLsn_(0),
+      bufferStartLsn_(0), nextLsn_(0), writtenLsn_(0), flushedLsn_(0),
+      flushing_(false), failed_(true), synchronous_(SynchronousMode::FULL), syncerRunning_(false),
+      segmentFd_(-1), segmentNo_(0) {
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    
+    std::vector<uint64_t> segmentNos;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, ec)) {
+        uint64_t segmentNo = parseSegmentNo(entry.path().filename().string());
+        if (segmentNo != 0) {
+            segmentNos.push_back(segmentNo);
+        }
+    }
+    std::sort(segmentNos.begin(), segmentNos.end());
+    
+    uint64_t startLsn = SEGMENT_SIZE; // 新日志从第1段开头开始
+    if (!segmentNos.empty()) {
+        // 从编号最大的段往前找第一个有有效记录的段，日志在其中最后一条有效记录之后继续；
+        // 之后的段是回收备用的旧段（或刚切换还没写入记录的段），留到写满当前段时重用
+        uint64_t endOffset = 0;
+        uint64_t lastSegmentNo = 0;
+        for (auto it = segmentNos.rbegin(); it != segmentNos.rend(); ++it) {
+            closeSegment();
+            if (!openSegment(*it)) {
+                std::cerr << "Failed to open write-ahead log segment: " << segmentPath(directory_, *it) << std::endl;
+                return;
+            }
+            lastSegmentNo = *it;
+            endOffset = scanSegment(segmentFd_, lastSegmentNo);
+            if (endOffset != 0) {
+                break;
+            }
+        }
+        // 清除最后一条有效记录之后的残留内容（崩溃前没有持久化完整的记录），
+        // 避免之后追加的记录与残留的旧记录恰好首尾相接、被当作有效记录读出
+        if (!resizeFile(segmentFd_, endOffset) || !resizeFile(segmentFd_, SEGMENT_SIZE) || !syncFile(segmentFd_)) {
+            std::cerr << "Failed to reset write-ahead log tail: " << segmentPath(directory_, lastSegmentNo) << std::endl;
+            return;
+        }
+        startLsn = lastSegmentNo * SEGMENT_SIZE + endOffset;
+        firstLsn_ = segmentNos.front() * SEGMENT_SIZE;
+    }
+    
+    bufferStartLsn_ = nextLsn_ = writtenLsn_ = flushedLsn_ = openEndLsn_ = startLsn;
+    checkpointLsn_ = readCheckpointFile(directory_);
+    buffer_.reserve(config_.bufferSize);
+    failed_ = false;
+    setSynchronousMode(config_.synchronous);
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    stopSyncer();
+    if (!failed_) {
+        flushAll();
+    }
+    closeSegment();
+}
+
+bool WriteAheadLog::isOpen() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !failed_;
+}
+
+const std::string& WriteAheadLog::getDirectory() const {
+    return directory_;
+}
+
+bool WriteAheadLog::needsRecovery(const std::string& directory) {
+    std::error_code ec;
+    std::vector<uint64_t> segmentNos;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        uint64_t segmentNo = parseSegmentNo(entry.path().filename().string());
+        if (segmentNo != 0) {
+            segmentNos.push_back(segmentNo);
+        }
+    }
+    std::sort(segmentNos.begin(), segmentNos.end());
+    
+    // 与打开日志时相同：从编号最大的段往前找最后一条有效记录（之后的段是回收备用的旧段）
+    uint64_t endLsn = 0;
+    for (auto it = segmentNos.rbegin(); it != segmentNos.rend(); ++it) {
+        int fd = openFileForRead(segmentPath(directory, *it));
+        if (fd < 0) {
+            return true;
+        }
+        uint64_t endOffset = scanSegment(fd, *it);
+        closeFile(fd);
+        if (endOffset != 0) {
+            endLsn = *it * SEGMENT_SIZE + endOffset;
+            break;
+        }
+    }
+    if (endLsn == 0) {
+        return false; // 没有日志，或者日志中还没有记录
+    }
+    
+    // 正常关闭时保存完成后写入的检查点是日志的最后一条记录：脏页都已写回，也没有活跃事务
+    uint64_t checkpointLsn = readCheckpointFile(directory);
+    if (checkpointLsn == 0 || checkpointLsn >= endLsn) {
+        return true;
+    }
+    int fd = openFileForRead(segmentPath(directory, checkpointLsn / SEGMENT_SIZE));
+    if (fd < 0) {
+        return true;
+    }
+    uint64_t offset = checkpointLsn % SEGMENT_SIZE;
+    std::string data(static_cast<size_t>(std::min(endLsn - checkpointLsn, SEGMENT_SIZE - offset)), '\0');
+    size_t size = readAt(fd, &data[0], data.size(), offset);
+    closeFile(fd);
+    size_t length = validRecordLength(reinterpret_cast<const uint8_t*>(data.data()), size, checkpointLsn);
+    if (length == 0) {
+        return true;
+    }
+    LogRecord record;
+    decodeRecord(reinterpret_cast<const uint8_t*>(data.data()), length, record);
+    CheckpointLogRecord checkpoint;
+    return record.type != LogRecordType::CHECKPOINT || !checkpoint.decode(record.payload) ||
+           !checkpoint.dirtyPages.empty() || !checkpoint.activeTransactions.empty() || checkpointLsn + length != endLsn;
+}
+
+uint64_t WriteAheadLog::append(LogRecordType type, uint64_t txnId, const std::string& payload) {
+    size_t length = RECORD_HEADER_SIZE + payload.size();
+    if (length > SEGMENT_SIZE) {
+        return 0;
+    }
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (failed_) {
+        return 0;
+    }
+    
+    // 记录不跨段：当前段放不下时用零填满，从下一段开头开始（读取时遇到无效记录跳到下一段）
+    uint64_t offsetInSegment = nextLsn_ % SEGMENT_SIZE;
+    if (offsetInSegment + length > SEGMENT_SIZE) {
+        buffer_.append(SEGMENT_SIZE - offsetInSegment, '\0');
+        nextLsn_ += SEGMENT_SIZE - offsetInSegment;
+    }
+    
+    uint64_t lsn = nextLsn_;
+    uint64_t prevLsn = 0;
+    if (type == LogRecordType::BEGIN) {
+        txnId = lsn;
+        activeTransactions_[txnId] = lsn;
+    } else if (txnId != 0) {
+        auto it = activeTransactions_.find(txnId);
+        if (it != activeTransactions_.end()) {
+            prevLsn = it->second;
+            it->second = lsn;
+            if (type == LogRecordType::COMMIT || type == LogRecordType::ABORT) {
+                activeTransactions_.erase(it);
+            }
+        }
+    }
+    
+    size_t start = buffer_.size();
+    buffer_.resize(start + length);
+    uint8_t* out = reinterpret_cast<uint8_t*>(&buffer_[start]);
+    byteorder::storeLE<uint32_t>(out + LENGTH_OFFSET, static_cast<uint32_t>(length));
+    byteorder::storeLE<uint64_t>(out + LSN_OFFSET, lsn);
+    byteorder::storeLE<uint64_t>(out + TXN_OFFSET, txnId);
+    byteorder::storeLE<uint64_t>(out + PREV_LSN_OFFSET, prevLsn);
+    out[TYPE_OFFSET] = static_cast<uint8_t>(type);
+    if (!payload.empty()) {
+        std::memcpy(out + RECORD_HEADER_SIZE, payload.data(), payload.size());
+    }
+    byteorder::storeLE<uint32_t>(out + CRC_OFFSET, crc32(out + LENGTH_OFFSET, length - LENGTH_OFFSET));
+    
+    nextLsn_ += length;
+    ++stats_.records;
+    stats_.bytes += length;
+    
+    // 缓冲区过大时先写入文件（不等待持久化）；已有领导者在写出时由它之后的领导者处理
+    if (buffer_.size() >= config_.bufferSize && !flushing_) {
+        flushing_ = true;
+        writeOut(lock, false);
+    }
+    return lsn;
+}
+
+uint64_t WriteAheadLog::beginTransaction() {
+    return append(LogRecordType::BEGIN, 0);
+}
+
+uint64_t WriteAheadLog::commitTransaction(uint64_t txnId, bool waitDurable) {
+    return commitTransaction(txnId, waitDurable, getSynchronousMode());
+}
+
+uint64_t WriteAheadLog::commitTransaction(uint64_t txnId, bool waitDurable, SynchronousMode mode) {
+    uint64_t lsn = append(LogRecordType::COMMIT, txnId);
+    if (lsn == 0) {
+        return 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.commits;
+    }
+    // 只有FULL级别在提交时等待fdatasync；NORMAL和OFF写入日志文件后即返回（进程崩溃不丢失已提交的事务）
+    if (waitDurable && !waitFor(lsn, mode == SynchronousMode::FULL)) {
+        return 0;
+    }
+    return lsn;
+}
+
+uint64_t WriteAheadLog::abortTransaction(uint64_t txnId) {
+    return append(LogRecordType::ABORT, txnId);
+}
+
+size_t WriteAheadLog::getActiveTransactionCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return activeTransactions_.size();
+}
+
+uint64_t WriteAheadLog::getTransactionLastLsn(uint64_t txnId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = activeTransactions_.find(txnId);
+    return it != activeTransactions_.end() ? it->second : 0;
+}
+
+bool WriteAheadLog::flush(uint64_t lsn) {
+    // 脏页写回和检查点之前在NORMAL级别下也要持久化日志，只有OFF级别从不同步
+    return waitFor(lsn, getSynchronousMode() != SynchronousMode::OFF);
+}
+
+bool WriteAheadLog::waitFor(uint64_t lsn, bool sync) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++stats_.flushRequests;
+    while (!failed_) {
+        // flushedLsn_之前的记录都已持久化，writtenLsn_之前的记录都已写入日志文件；
+        // lsn超出已追加的范围时等待全部记录
+        uint64_t doneLsn = sync ? flushedLsn_ : writtenLsn_;
+        if (doneLsn == nextLsn_ || doneLsn > std::min(lsn, nextLsn_ - 1)) {
+            return true;
+        }
+        if (flushing_) {
+            // 其他线程正在写出，等它完成后再检查（它可能已经带上了这条记录）
+            flushDoneCv_.wait(lock);
+            continue;
+        }
+        
+        // 成为领导者：还有其他活跃事务时稍等片刻，让它们的提交进入同一次写出
+        flushing_ = true;
+        if (sync && config_.groupCommitDelay.count() > 0 && !activeTransactions_.empty()) {
+            lock.unlock();
+            std::this_thread::sleep_for(config_.groupCommitDelay);
+            lock.lock();
+        }
+        writeOut(lock, sync);
+    }
+    return false;
+}
+
+bool WriteAheadLog::flushAll() {
+    return flush(UINT64_MAX);
+}
+
+void WriteAheadLog::setSynchronousMode(SynchronousMode mode) {
+    std::lock_guard<std::mutex> controlLock(syncerControlMutex_);
+    synchronous_.store(mode, std::memory_order_relaxed);
+    bool runSyncer = mode == SynchronousMode::NORMAL;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (runSyncer == syncerRunning_ || (runSyncer && failed_)) {
+            return;
+        }
+        if (runSyncer) {
+            syncerRunning_ = true;
+            syncerThread_ = std::thread(&WriteAheadLog::syncerLoop, this);
+            return;
+        }
+    }
+    stopSyncer();
+}
+
+SynchronousMode WriteAheadLog::getSynchronousMode() const {
+    return synchronous_.load(std::memory_order_relaxed);
+}
+
+void WriteAheadLog::stopSyncer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        syncerRunning_ = false;
+    }
+    syncerCv_.notify_all();
+    if (syncerThread_.joinable()) {
+        syncerThread_.join();
+    }
+}
+
+void WriteAheadLog::syncerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (syncerRunning_) {
+        syncerCv_.wait_for(lock, config_.syncInterval, [this] { return !syncerRunning_; });
+        // 有领导者正在写出时跳过这一轮：它可能正在同步，没有同步的记录留到下一轮
+        if (!syncerRunning_ || failed_ || flushing_ || flushedLsn_ == nextLsn_) {
+            continue;
+        }
+        flushing_ = true;
+        if (writeOut(lock, true)) {
+            ++stats_.backgroundSyncs;
+        }
+    }
+}
+
+uint64_t WriteAheadLog::getNextLsn() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nextLsn_;
+}
+
+uint64_t WriteAheadLog::getFlushedLsn() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return flushedLsn_;
+}
+
+uint64_t WriteAheadLog::getFirstLsn() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return firstLsn_;
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> WriteAheadLog::getActiveTransactions() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::vector<std::pair<uint64_t, uint64_t>>(activeTransactions_.begin(), activeTransactions_.end());
+}
+
+bool WriteAheadLog::readRecord(uint64_t lsn, LogRecord& record) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // 领导者正在写出的记录既不在缓冲区也可能还没写完，等这次写出结束
+    while (!failed_ && lsn >= writtenLsn_ && lsn < bufferStartLsn_) {
+        flushDoneCv_.wait(lock);
+    }
+    if (lsn >= nextLsn_ || lsn < firstLsn_) {
+        return false;
+    }
+    if (lsn >= bufferStartLsn_) {
+        size_t offset = static_cast<size_t>(lsn - bufferStartLsn_);
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer_.data()) + offset;
+        size_t length = validRecordLength(data, buffer_.size() - offset, lsn);
+        if (length == 0) {
+            return false;
+        }
+        decodeRecord(data, length, record);
+        return true;
+    }
+    lock.unlock();
+    
+    // 已写入日志文件：先读记录头得到长度，再读整条记录
+    int fd = openFileForRead(segmentPath(directory_, lsn / SEGMENT_SIZE));
+    if (fd < 0) {
+        return false;
+    }
+    uint64_t offset = lsn % SEGMENT_SIZE;
+    std::string data(RECORD_HEADER_SIZE, '\0');
+    bool ok = readAt(fd, &data[0], data.size(), offset) == data.size();
+    if (ok) {
+        uint32_t length = byteorder::loadLE<uint32_t>(reinterpret_cast<const uint8_t*>(data.data()) + LENGTH_OFFSET);
+        ok = length >= RECORD_HEADER_SIZE && length <= SEGMENT_SIZE - offset;
+        if (ok && length > RECORD_HEADER_SIZE) {
+            data.resize(length);
+            ok = readAt(fd, &data[RECORD_HEADER_SIZE], length - RECORD_HEADER_SIZE, offset + RECORD_HEADER_SIZE) ==
+                 length - RECORD_HEADER_SIZE;
+        }
+    }
+    closeFile(fd);
+    
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    if (!ok || validRecordLength(bytes, data.size(), lsn) != data.size()) {
+        return false;
+    }
+    decodeRecord(bytes, data.size(), record);
+    return true;
+}
+
+bool WriteAheadLog::scan(uint64_t fromLsn, const std::function<bool(const LogRecord&)>& visit) const {
+    uint64_t lsn = std::max(fromLsn, getFirstLsn());
+    LogRecord record;
+    std::string data;
+    while (lsn < openEndLsn_) {
+        // 每次读入一整段（最后一段只读到打开时的末尾）
+        uint64_t segmentNo = lsn / SEGMENT_SIZE;
+        uint64_t segmentStart = segmentNo * SEGMENT_SIZE;
+        uint64_t segmentEnd = std::min(segmentStart + SEGMENT_SIZE, openEndLsn_);
+        int fd = openFileForRead(segmentPath(directory_, segmentNo));
+        if (fd < 0) {
+            std::cerr << "Missing write-ahead log segment: " << segmentPath(directory_, segmentNo) << std::endl;
+            return false;
+        }
+        data.resize(static_cast<size_t>(segmentEnd - segmentStart));
+        size_t size = readAt(fd, &data[0], data.size(), 0);
+        closeFile(fd);
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+        
+        // 遇到无效记录说明是段末尾的填充，继续读下一段
+        while (lsn < segmentEnd) {
+            size_t offset = static_cast<size_t>(lsn - segmentStart);
+            size_t length = offset < size ? validRecordLength(bytes + offset, size - offset, lsn) : 0;
+            if (length == 0) {
+                break;
+            }
+            decodeRecord(bytes + offset, length, record);
+            if (!visit(record)) {
+                return true;
+            }
+            lsn += length;
+        }
+        if (segmentEnd == openEndLsn_ && lsn < segmentEnd) {
+            std::cerr << "Invalid write-ahead log record at LSN " << lsn << std::endl;
+            return false;
+        }
+        lsn = segmentStart + SEGMENT_SIZE;
+    }
+    return true;
+}
+
+uint64_t WriteAheadLog::getCheckpointLsn() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return checkpointLsn_;
+}
+
+bool WriteAheadLog::setCheckpointLsn(uint64_t checkpointLsn) {
+    std::string data(CHECKPOINT_FILE_SIZE, '\0');
+    uint8_t* out = reinterpret_cast<uint8_t*>(&data[0]);
+    byteorder::storeLE<uint32_t>(out, CHECKPOINT_FILE_MAGIC);
+    byteorder::storeLE<uint64_t>(out + sizeof(uint32_t), checkpointLsn);
+    byteorder::storeLE<uint32_t>(out + sizeof(uint32_t) + sizeof(uint64_t), crc32(out, sizeof(uint32_t) + sizeof(uint64_t)));
+    
+    // 写入临时文件并持久化后再替换，崩溃后看到的要么是旧检查点要么是新检查点
+    std::string path = checkpointPath(directory_);
+    std::string tempPath = path + ".tmp";
+    std::error_code ec;
+    std::filesystem::remove(tempPath, ec);
+    int fd = openFile(tempPath);
+    if (fd < 0) {
+        std::cerr << "Failed to create checkpoint file: " << tempPath << std::endl;
+        return false;
+    }
+    bool ok = writeAt(fd, data.data(), data.size(), 0) && syncFile(fd);
+    closeFile(fd);
+    if (ok) {
+        std::filesystem::rename(tempPath, path, ec);
+        ok = !ec;
+    }
+    if (!ok) {
+        std::cerr << "Failed to write checkpoint file: " << path << std::endl;
+        return false;
+    }
+    syncDirectory(directory_);
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    checkpointLsn_ = checkpointLsn;
+    return true;
+}
+
+size_t WriteAheadLog::recycleSegments(uint64_t beforeLsn, size_t spareSegments) {
+    std::lock_guard<std::mutex> segmentLock(segmentMutex_);
+    uint64_t firstSegmentNo;
+    uint64_t endSegmentNo;      // 这之前的段可以回收（不超过正在写入的段）
+    uint64_t currentSegmentNo;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (failed_) {
+            return 0;
+        }
+        firstSegmentNo = firstLsn_ / SEGMENT_SIZE;
+        currentSegmentNo = nextLsn_ / SEGMENT_SIZE;
+        endSegmentNo = std::min(beforeLsn, nextLsn_) / SEGMENT_SIZE;
+        if (endSegmentNo <= firstSegmentNo) {
+            return 0;
+        }
+        // 先推进起点，之后的读取不会再访问这些段
+        firstLsn_ = endSegmentNo * SEGMENT_SIZE;
+    }
+    
+    // 当前段之后已有的备用段（之前回收的或已经创建的下一段）；持有segmentMutex_，
+    // 领导者这期间不会创建新段，新的段号不会与之后打开的段冲突
+    std::error_code ec;
+    uint64_t lastSegmentNo = currentSegmentNo;
+    size_t spareCount = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, ec)) {
+        uint64_t segmentNo = parseSegmentNo(entry.path().filename().string());
+        lastSegmentNo = std::max(lastSegmentNo, segmentNo);
+        if (segmentNo > currentSegmentNo) {
+            ++spareCount;
+        }
+    }
+    
+    size_t recycled = 0;
+    size_t removed = 0;
+    for (uint64_t segmentNo = firstSegmentNo; segmentNo < endSegmentNo; ++segmentNo) {
+        std::string path = segmentPath(directory_, segmentNo);
+        if (spareCount < spareSegments) {
+            // 重命名为新的段号，写到那一段时直接使用，不需要重新创建和扩展文件
+            std::filesystem::rename(path, segmentPath(directory_, ++lastSegmentNo), ec);
+            if (!ec) {
+                ++spareCount;
+                ++recycled;
+                continue;
+            }
+        }
+        if (std::filesystem::remove(path, ec)) {
+            ++removed;
+        }
+    }
+    syncDirectory(directory_);
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.recycledSegments += recycled;
+    stats_.removedSegments += removed;
+    return recycled + removed;
+}
+
+WalStats WriteAheadLog::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    WalStats stats = stats_;
+    stats.firstLsn = firstLsn_;
+    stats.nextLsn = nextLsn_;
+    stats.flushedLsn = flushedLsn_;
+    return stats;
+}
+
+void WriteAheadLog::printStats() const {
+    WalStats stats = getStats();
+    std::cout << "Write-Ahead Log Statistics:" << std::endl;
+    std::cout << "  Directory: " << directory_ << std::endl;
+    std::cout << "  Records: " << stats.records << " (" << stats.bytes / 1024 << " KB)" << std::endl;
+    std::cout << "  Commits: " << stats.commits << std::endl;
+    std::cout << "  Synchronous: " << synchronousModeName(getSynchronousMode()) << std::endl;
+    std::cout << "  Log writes: " << stats.writes << ", syncs: " << stats.syncs
+              << " (" << stats.backgroundSyncs << " in background)" << std::endl;
+    if (stats.syncs > 0) {
+        std::cout << "  Commits per sync: " << std::fixed << std::setprecision(2)
+                  << static_cast<double>(stats.commits) / stats.syncs << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+    }
+    std::cout << "  Segments recycled: " << stats.recycledSegments << ", removed: " << stats.removedSegments << std::endl;
+    std::cout << "  First LSN: " << stats.firstLsn << ", next LSN: " << stats.nextLsn
+              << ", flushed LSN: " << stats.flushedLsn << std::endl;
+}
+
+bool WriteAheadLog::writeOut(std::unique_lock<std::mutex>& lock, bool sync) {
+    // 取出缓冲区，写盘期间其他线程继续向新的缓冲区追加
+    std::string data = std::move(buffer_);
+    buffer_ = std::move(spareBuffer_);
+    buffer_.clear();
+    uint64_t startLsn = bufferStartLsn_;
+    uint64_t endLsn = nextLsn_;
+    bufferStartLsn_ = endLsn;
+    
+    lock.unlock();
+    bool ok = data.empty() || writeData(startLsn, data);
+    if (ok && sync && segmentFd_ >= 0) {
+        ok = syncFile(segmentFd_);
+    }
+    lock.lock();
+    
+    if (ok) {
+        writtenLsn_ = endLsn;
+        if (sync) {
+            flushedLsn_ = endLsn;
+            ++stats_.syncs;
+        }
+        if (!data.empty()) {
+            ++stats_.writes;
+        }
+    } else {
+        // 无法确定哪些记录已经写入，之后的提交全部失败
+        std::cerr << "Failed to write the write-ahead log in " << directory_ << std::endl;
+        failed_ = true;
+    }
+    data.clear();
+    spareBuffer_ = std::move(data);
+    flushing_ = false;
+    flushDoneCv_.notify_all();
+    return ok;
+}
+
+bool WriteAheadLog::writeData(uint64_t startLsn, const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        uint64_t lsn = startLsn + written;
+        uint64_t segmentNo = lsn / SEGMENT_SIZE;
+        if (segmentNo != segmentNo_) {
+            // 切换到下一段之前先持久化当前段：之后的段中出现有效记录，说明之前的段都是完整的
+            // （OFF级别从不同步，操作系统崩溃后不保证这一点）
+            if (segmentFd_ >= 0 && getSynchronousMode() != SynchronousMode::OFF && !syncFile(segmentFd_)) {
+                return false;
+            }
+            closeSegment();
+            if (!openSegment(segmentNo)) {
+                return false;
+            }
+        }
+        uint64_t offset = lsn % SEGMENT_SIZE;
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(data.size() - written, SEGMENT_SIZE - offset));
+        if (!writeAt(segmentFd_, data.data() + written, chunk, offset)) {
+            return false;
+        }
+        written += chunk;
+    }
+    return true;
+}
+
+bool WriteAheadLog::openSegment(uint64_t segmentNo) {
+    std::lock_guard<std::mutex> segmentLock(segmentMutex_);
+    std::string path = segmentPath(directory_, segmentNo);
+    bool created = !std::filesystem::exists(path);
+    int fd = openFile(path);
+    if (fd < 0) {
+        return false;
+    }
+    // 段文件预先扩展到固定大小，追加时文件大小不变，fdatasync不需要更新文件长度
+    if (created && (!resizeFile(fd, SEGMENT_SIZE) || !syncFile(fd))) {
+        closeFile(fd);
+        return false;
+    }
+    if (created) {
+        syncDirectory(directory_);
+    }
+    segmentFd_ = fd;
+    segmentNo_ = segmentNo;
+    return true;
+}
+
+void WriteAheadLog::closeSegment() {
+    if (segmentFd_ >= 0) {
+        closeFile(segmentFd_);
+        segmentFd_ = -1;
+        segmentNo_ = 0;
+    }
+}
+
+std::string WriteAheadLog::segmentPath(const std::string& directory, uint64_t segmentNo) {
+    std::ostringstream name;
+    name << "wal_" << std::setw(8) << std::setfill('0') << segmentNo << ".log";
+    return (std::filesystem::path(directory) / name.str()).string();
+}
+
+std::string WriteAheadLog::checkpointPath(const std::string& directory) {
+    return (std::filesystem::path(directory) / "checkpoint").string();
+}
+
+uint64_t WriteAheadLog::readCheckpointFile(const std::string& directory) {
+    int fd = openFileForRead(checkpointPath(directory));
+    if (fd < 0) {
+        return 0;
+    }
+    std::string data(CHECKPOINT_FILE_SIZE, '\0');
+    size_t size = readAt(fd, &data[0], data.size(), 0);
+    closeFile(fd);
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(data.data());
+    if (size != CHECKPOINT_FILE_SIZE || byteorder::loadLE<uint32_t>(in) != CHECKPOINT_FILE_MAGIC ||
+        byteorder::loadLE<uint32_t>(in + sizeof(uint32_t) + sizeof(uint64_t)) !=
+            crc32(in, sizeof(uint32_t) + sizeof(uint64_t))) {
+        std::cerr << "Ignoring invalid checkpoint file: " << checkpointPath(directory) << std::endl;
+        return 0;
+    }
+    return byteorder::loadLE<uint64_t>(in + sizeof(uint32_t));
+}
+
+uint64_t WriteAheadLog::scanSegment(int fd, uint64_t segmentNo) {
+    std::string data(SEGMENT_SIZE, '\0');
+    size_t size = readAt(fd, &data[0], data.size(), 0);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    
+    uint64_t offset = 0;
+    while (offset < size) {
+        size_t length = validRecordLength(bytes + offset, size - offset, segmentNo * SEGMENT_SIZE + offset);
+        if (length == 0) {
+            break;
+        }
+        offset += length;
+    }
+    return offset;
+}